@@ -109,6 +109,12 @@ builddirs:
 clean:
 	rm -rf $(BUILD)
 	rm -rf lib_linux	
+
+# Host test and benchmark programs in ./test, see ../firmware-template-linux/test/Rules.mk
+.PHONY: test bench
+
+test bench:
+	$(MAKE) -C test $@
 	
 $(BUILD_DIRS) :	
 	mkdir -p $(BUILD_DIRS)
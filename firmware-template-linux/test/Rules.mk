@@ -0,0 +1,69 @@
+#
+# Host test and benchmark programs of a library, included from <lib>/test/Makefile
+#
+# TESTS          : the programs, <name>.cpp in the test directory
+# SOURCES        : sources linked with each program, relative to the library directory
+# DEFINES        : as in Makefile.Linux
+# EXTRA_INCLUDES : relative to the library directory
+#
+# make        : build
+# make test   : build and run the checks
+# make bench  : build, run the checks and the benchmarks
+#
+
+PREFIX ?=
+
+CC=$(PREFIX)gcc
+CPP=$(PREFIX)g++
+
+$(info [${CURDIR}])
+
+BUILD=build_linux/
+
+DEFINES:=$(addprefix -D,$(DEFINES))
+
+INCLUDES:=-I../include -I../../firmware-template-linux/test/include -I../../lib-hal/include -I../../lib-configstore/include -I../../lib-display/include
+INCLUDES+=$(addprefix -I../,$(EXTRA_INCLUDES))
+
+COPS=$(DEFINES) $(INCLUDES)
+COPS+=-O2 -g -Wall -Werror -Wextra -Wpedantic
+COPS+=-Wunused
+COPS+=-MMD -MP
+
+CCPOPS=-fno-rtti -fno-exceptions -fno-unwind-tables -Wnon-virtual-dtor
+CCPOPS+=-std=c++20
+
+OBJECTS:=$(patsubst %.c,$(BUILD)lib/%.o,$(filter %.c,$(SOURCES)))
+OBJECTS+=$(patsubst %.cpp,$(BUILD)lib/%.o,$(filter %.cpp,$(SOURCES)))
+
+PROGRAMS:=$(addprefix $(BUILD),$(TESTS))
+
+all : $(PROGRAMS)
+
+.PHONY: all test bench clean
+
+test : $(PROGRAMS)
+	@set -e; for t in $(PROGRAMS); do ./$$t; done
+
+bench : $(PROGRAMS)
+	@set -e; for t in $(PROGRAMS); do ./$$t bench; done
+
+clean :
+	rm -rf $(BUILD)
+
+$(BUILD)lib/%.o : ../%.c
+	@mkdir -p $(dir $@)
+	$(CC) $(COPS) -c $< -o $@
+
+$(BUILD)lib/%.o : ../%.cpp
+	@mkdir -p $(dir $@)
+	$(CPP) $(COPS) $(CCPOPS) -c $< -o $@
+
+$(BUILD)test/%.o : %.cpp
+	@mkdir -p $(dir $@)
+	$(CPP) $(COPS) $(CCPOPS) -c $< -o $@
+
+$(PROGRAMS) : $(BUILD)% : $(BUILD)test/%.o $(OBJECTS)
+	$(CPP) $^ -o $@ $(LDLIBS) -lpthread
+
+-include $(patsubst %.o,%.d,$(OBJECTS) $(addprefix $(BUILD)test/,$(addsuffix .o,$(TESTS))))
@@ -0,0 +1,174 @@
+/**
+ * @file hosttest.h
+ *
+ */
+/* Copyright (C) 2024 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef HOSTTEST_H_
+#define HOSTTEST_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+/**
+ * Checks and benchmarks for the host test programs in <lib>/test, see Rules.mk
+ * A program runs the checks, the benchmarks are run only when "bench" is the first argument.
+ */
+namespace hosttest {
+inline uint64_t nanos() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<uint64_t>(ts.tv_sec) * 1000000000U + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+/**
+ * Time stamp counter, the CPU cycles on x86
+ */
+inline uint64_t ticks() {
+#if defined (__x86_64__) || defined (__i386__)
+	return __builtin_ia32_rdtsc();
+#elif defined (__aarch64__)
+	uint64_t nTicks;
+	asm volatile("mrs %0, cntvct_el0" : "=r"(nTicks));
+	return nTicks;
+#else
+	return nanos();
+#endif
+}
+
+struct Result {
+	uint32_t nChecks;
+	uint32_t nFailed;
+};
+
+inline Result& result() {
+	static Result s_Result;
+	return s_Result;
+}
+
+inline bool check(const bool isOk, const char *pExpression, const char *pFile, const int nLine) {
+	result().nChecks++;
+
+	if (!isOk) {
+		result().nFailed++;
+		fprintf(stderr, "%s:%d: check failed: %s\n", pFile, nLine, pExpression);
+	}
+
+	return isOk;
+}
+
+inline bool is_bench(const int argc, char **argv) {
+	return (argc > 1) && (strcmp(argv[1], "bench") == 0);
+}
+
+/**
+ * Keeps the compiler from removing the benchmarked code
+ */
+template<typename T>
+inline void keep(T const& value) {
+	asm volatile("" : : "r"(&value) : "memory");
+}
+
+/**
+ * Runs f() nIterations times, after a warm up
+ * @return nanoseconds per iteration
+ */
+template<typename F>
+double bench(const char *pName, const uint32_t nIterations, F f) {
+	for (uint32_t i = 0; i < (nIterations / 16) + 1; i++) {
+		f();
+	}
+
+	const auto nStart = nanos();
+	const auto nTicksStart = ticks();
+
+	for (uint32_t i = 0; i < nIterations; i++) {
+		f();
+	}
+
+	const auto fTicks = static_cast<double>(ticks() - nTicksStart) / nIterations;
+	const auto fNanos = static_cast<double>(nanos() - nStart) / nIterations;
+	printf("  %-44s %12.1f ns %12.1f ticks\n", pName, fNanos, fTicks);
+	return fNanos;
+}
+
+/**
+ * Latency histogram with power of 2 buckets
+ */
+class Histogram {
+public:
+	void Add(const uint64_t nNanos) {
+		const auto nBucket = (nNanos == 0) ? 0U : static_cast<uint32_t>(64 - __builtin_clzll(nNanos));
+		m_nBucket[nBucket < BUCKETS ? nBucket : BUCKETS - 1]++;
+		m_nCount++;
+		m_nSum += nNanos;
+		m_nMax = nNanos > m_nMax ? nNanos : m_nMax;
+	}
+
+	uint64_t GetCount() const {
+		return m_nCount;
+	}
+
+	uint64_t GetSum() const {
+		return m_nSum;
+	}
+
+	void Print(const char *pName) const {
+		if (m_nCount == 0) {
+			printf("  %s: no samples\n", pName);
+			return;
+		}
+
+		printf("  %s: %llu samples, mean %llu ns, max %llu ns\n", pName,
+				static_cast<unsigned long long>(m_nCount),
+				static_cast<unsigned long long>(m_nSum / m_nCount),
+				static_cast<unsigned long long>(m_nMax));
+
+		for (uint32_t i = 0; i < BUCKETS; i++) {
+			if (m_nBucket[i] != 0) {
+				const auto nUpper = (1ULL << i);
+				printf("    < %8llu ns %10llu %5.1f%%\n", nUpper,
+						static_cast<unsigned long long>(m_nBucket[i]),
+						100.0 * static_cast<double>(m_nBucket[i]) / static_cast<double>(m_nCount));
+			}
+		}
+	}
+
+private:
+	static constexpr uint32_t BUCKETS = 40;
+	uint64_t m_nBucket[BUCKETS] {};
+	uint64_t m_nCount { 0 };
+	uint64_t m_nSum { 0 };
+	uint64_t m_nMax { 0 };
+};
+
+inline int exit_code(const char *pName) {
+	printf("%s: %u checks, %u failed\n", pName, result().nChecks, result().nFailed);
+	return result().nFailed == 0 ? 0 : 1;
+}
+}  // namespace hosttest
+
+#define HOSTTEST_CHECK(expression)	hosttest::check((expression), #expression, __FILE__, __LINE__)
+
+#endif /* HOSTTEST_H_ */
@@ -37,10 +37,24 @@
 
 #include "artnetpolltable.h"
 
+#include "network.h"
+
 #ifndef DMX_MAX_VALUE
 #define DMX_MAX_VALUE 255
 #endif
 
+#if !defined (CONFIG_ARTNET_CONTROLLER_FRAME_UNIVERSES)
+# define CONFIG_ARTNET_CONTROLLER_FRAME_UNIVERSES	64
+#endif
+
+namespace artnet {
+namespace controller {
+static constexpr uint32_t FRAME_UNIVERSES = CONFIG_ARTNET_CONTROLLER_FRAME_UNIVERSES;
+static constexpr uint32_t FRAME_DATAGRAMS = 4 * FRAME_UNIVERSES;	///< A universe can have more than one subscriber
+static constexpr uint32_t MAX_UNICAST_SUBSCRIBERS = 40;
+}  // namespace controller
+}  // namespace artnet
+
 struct State {
 	uint32_t ArtPollIpAddress;
 	uint32_t ArtPollReplyCount;
@@ -77,6 +91,25 @@ public:
 	void HandleSync();
 	void HandleBlackout();
 
+	/**
+	 * Frame level output, all universes of a frame are sent in a single batch.
+	 * The ArtDmx packets are built in a preallocated arena. When the arena is full, the
+	 * packets so far are sent and the frame continues.
+	 * AddUniverse without BeginFrame starts a new frame.
+	 */
+	void BeginFrame() {
+		m_Frame.nPackets = 0;
+		m_Frame.nDatagrams = 0;
+	}
+	void AddUniverse(uint16_t nUniverse, const uint8_t *pDmxData, uint32_t nLength, uint8_t nPortIndex = 0);
+	/**
+	 * Sends the frame, followed by the ArtSync when synchronization is enabled
+	 */
+	void CommitFrame() {
+		FrameSend();
+		HandleSync();
+	}
+
 	void SetRunTableCleanup(const bool bDoTableCleanup) {
 		m_bDoTableCleanup = bDoTableCleanup;
 	}
@@ -136,6 +169,9 @@ private:
 	void HandleTrigger();
 	void ActiveUniversesAdd(uint16_t nUniverse);
 	void ActiveUniversesClear();
+	uint32_t GetDestinations(const uint16_t nUniverse, const uint32_t *&pIpAddresses);
+	void CopyDmxData(uint8_t *pData, const uint8_t *pDmxData, const uint32_t nLength);
+	void FrameSend();
 
 private:
 	TArtNetController m_ArtNetController;
@@ -155,6 +191,15 @@ private:
 
 	artnet::ArtDmx *m_pArtDmx;
 	artnet::ArtSync *m_pArtSync;
+
+	struct Frame {
+		artnet::ArtDmx *pArtDmx;				///< Arena, FRAME_UNIVERSES packets
+		network::Datagram *pDatagrams;
+		uint32_t nPackets;
+		uint32_t nDatagrams;
+	};
+
+	Frame m_Frame;
 	ArtNetTrigger *m_pArtNetTrigger { nullptr }; // Trigger handler
 
 	bool m_bSynchronization { true };
@@ -71,6 +71,7 @@
 #endif
 
 #include "lightset.h"
+#include "lightsetsequence.h"
 #include "hardware.h"
 #include "network.h"
 
@@ -91,6 +92,7 @@ struct State {
 	artnet::ArtPollQueue ArtPollReplyQueue[4];
 	uint32_t ArtDmxIpAddress;
 	uint32_t ArtSyncMillis;				///< Latest ArtSync received time
+	uint32_t nSequenceWindowMillis;
 	artnet::ReportCode reportCode;
 	artnet::Status status;
 	bool SendArtPollReplyOnChange;		///< ArtPoll : Flags Bit 1 : 1 = Send ArtPollReply whenever Node conditions change.
@@ -129,6 +131,7 @@ struct Node {
 };
 
 struct Source {
+	lightset::Sequence<255> sequence;	///< ArtDmx Sequence 1..255, 0 is disabled
 	uint32_t nMillis;	///< The latest time of the data received from port
 	uint32_t nIp;		///< The IP address for port
 	uint16_t nPhysical;	///< The physical input port from which DMX512 data was input.
@@ -137,6 +140,7 @@ struct Source {
 struct OutputPort {
 	Source SourceA;
 	Source SourceB;
+	lightset::sequence::Stats sequenceStats;
 	uint8_t GoodOutput;
 	uint8_t GoodOutputB;
 	uint32_t nIpRdm;
@@ -443,6 +447,30 @@ public:
 		return m_State.bDisableMergeTimeout;
 	}
 
+	/**
+	 * @param nMillis a skipped sequence number received within this time is counted as reordered, otherwise as late
+	 */
+	void SetSequenceWindow(const uint32_t nMillis) {
+		m_State.nSequenceWindowMillis = nMillis;
+#if (ARTNET_VERSION >= 4)
+		E131Bridge::SetSequenceWindow(nMillis);
+#endif
+	}
+
+	uint32_t GetSequenceWindow() const {
+		return m_State.nSequenceWindowMillis;
+	}
+
+	const lightset::sequence::Stats *GetSequenceStats(const uint32_t nPortIndex) const {
+		assert(nPortIndex < artnetnode::MAX_PORTS);
+#if (ARTNET_VERSION >= 4)
+		if (m_Node.Port[nPortIndex].protocol == artnet::PortProtocol::SACN) {
+			return E131Bridge::GetSequenceStats(nPortIndex);
+		}
+#endif
+		return &m_OutputPort[nPortIndex].sequenceStats;
+	}
+
 #if defined (ARTNET_HAVE_TIMECODE)
 	void SendTimeCode(const struct artnet::TimeCode *pArtNetTimeCode) {
 		assert(pArtNetTimeCode != nullptr);
@@ -638,6 +666,7 @@ private:
 	void SendTodRequest(uint32_t nPortIndex);
 
 	void SetNetworkDataLossCondition();
+	void SendSequenceStats();
 
 	void FailSafeRecord();
 	void FailSafePlayback();
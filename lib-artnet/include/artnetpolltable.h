@@ -30,6 +30,7 @@
 #define ARTNETPOLLTABLE_H_
 
 #include <cstdint>
+#include <cstring>
 
 #include "artnet.h"
 
@@ -39,6 +40,16 @@ static constexpr uint32_t POLL_INTERVAL_MILLIS = (POLL_INTERVAL_SECONDS * 1000U)
 static constexpr uint32_t POLL_TABLE_SIZE_ENRIES = 255;
 static constexpr uint32_t POLL_TABLE_SIZE_NODE_UNIVERSES = 64;
 static constexpr uint32_t POLL_TABLE_SIZE_UNIVERSES = 512;
+/*
+ * A node, or a universe of a node, is removed when there was no ArtPollReply for 1.5 poll interval.
+ */
+static constexpr uint32_t POLL_TABLE_TIMEOUT_MILLIS = (3U * POLL_INTERVAL_MILLIS) / 2U;
+static constexpr uint32_t POLL_TABLE_WHEEL_TICK_MILLIS = 1000;
+static constexpr uint32_t POLL_TABLE_WHEEL_SLOTS = 16;
+static constexpr uint16_t POLL_TABLE_WHEEL_NONE = 0xFFFF;
+
+static_assert(POLL_TABLE_SIZE_ENRIES < POLL_TABLE_WHEEL_NONE);
+static_assert(((POLL_TABLE_TIMEOUT_MILLIS / POLL_TABLE_WHEEL_TICK_MILLIS) + 2) < POLL_TABLE_WHEEL_SLOTS, "The timeout does not fit the timer wheel");
 
 struct NodeEntryUniverse {
 	uint8_t ShortName[artnet::SHORT_NAME_LENGTH];
@@ -51,6 +62,10 @@ struct NodeEntry {
 	uint8_t Mac[artnet::MAC_SIZE];
 	uint8_t LongName[artnet::LONG_NAME_LENGTH];
 	uint16_t nUniversesCount;
+	uint32_t nLastUpdateMillis;	///< Last ArtPollReply of the node
+	uint16_t nWheelNext;		///< Timer wheel list, index in the poll table
+	uint16_t nWheelPrev;
+	uint16_t nWheelSlot;
 	struct NodeEntryUniverse Universe[artnet::POLL_TABLE_SIZE_NODE_UNIVERSES];
 };
 
@@ -60,10 +75,103 @@ struct PollTableUniverses {
 	uint32_t *pIpAddresses;
 };
 
-struct PollTableClean {
-	uint32_t nTableIndex;
-	uint16_t nUniverseIndex;
-	bool bOffLine;
+/**
+ * Open addressing hash table with linear probing, key -> index.
+ * The keys are not stored, GetKey(nIndex) returns the key of an index.
+ * Removal shifts the following entries back, so no tombstones are needed.
+ */
+template<uint32_t SIZE_BITS>
+class PollTableHash {
+	static constexpr uint32_t SIZE = 1U << SIZE_BITS;
+	static constexpr uint32_t MASK = SIZE - 1;
+public:
+	void Clear() {
+		memset(m_nSlots, 0, sizeof(m_nSlots));
+	}
+
+	template<typename GetKey>
+	int32_t Find(const uint32_t nKey, GetKey getKey) const {
+		const auto nSlot = FindSlot(nKey, getKey);
+
+		if (nSlot < 0) {
+			return -1;
+		}
+
+		return static_cast<int32_t>(m_nSlots[nSlot]) - 1;
+	}
+
+	void Insert(const uint32_t nKey, const uint32_t nIndex) {
+		auto nSlot = Hash(nKey);
+
+		while (m_nSlots[nSlot] != 0) {
+			nSlot = (nSlot + 1) & MASK;
+		}
+
+		m_nSlots[nSlot] = static_cast<uint16_t>(nIndex + 1);
+	}
+
+	/**
+	 * The entry with nKey has moved to nIndex
+	 */
+	template<typename GetKey>
+	void Update(const uint32_t nKey, const uint32_t nIndex, GetKey getKey) {
+		const auto nSlot = FindSlot(nKey, getKey);
+
+		if (nSlot >= 0) {
+			m_nSlots[nSlot] = static_cast<uint16_t>(nIndex + 1);
+		}
+	}
+
+	template<typename GetKey>
+	void Remove(const uint32_t nKey, GetKey getKey) {
+		const auto nFound = FindSlot(nKey, getKey);
+
+		if (nFound < 0) {
+			return;
+		}
+
+		auto nHole = static_cast<uint32_t>(nFound);
+		auto nSlot = nHole;
+
+		for (;;) {
+			nSlot = (nSlot + 1) & MASK;
+
+			if (m_nSlots[nSlot] == 0) {
+				break;
+			}
+
+			const auto nHome = Hash(getKey(m_nSlots[nSlot] - 1U));
+
+			// Move back when the home slot is not between the hole and this slot
+			if (((nSlot - nHome) & MASK) >= ((nSlot - nHole) & MASK)) {
+				m_nSlots[nHole] = m_nSlots[nSlot];
+				nHole = nSlot;
+			}
+		}
+
+		m_nSlots[nHole] = 0;
+	}
+
+private:
+	static uint32_t Hash(const uint32_t nKey) {
+		return (nKey * 2654435769U) >> (32 - SIZE_BITS);
+	}
+
+	template<typename GetKey>
+	int32_t FindSlot(const uint32_t nKey, GetKey getKey) const {
+		auto nSlot = Hash(nKey);
+
+		while (m_nSlots[nSlot] != 0) {
+			if (getKey(m_nSlots[nSlot] - 1U) == nKey) {
+				return static_cast<int32_t>(nSlot);
+			}
+			nSlot = (nSlot + 1) & MASK;
+		}
+
+		return -1;
+	}
+
+	uint16_t m_nSlots[SIZE];	///< Index + 1, 0 is empty
 };
 }  // namespace artnet
 
@@ -81,6 +189,9 @@ public:
 	}
 
 	void Add(const struct artnet::ArtPollReply *ptArtPollReply);
+	/**
+	 * Removes the nodes which did not reply, one timer wheel tick per call
+	 */
 	void Clean();
 
 	const struct artnet::PollTableUniverses *GetIpAddress(uint16_t nUniverse) const;
@@ -91,13 +202,26 @@ public:
 private:
 	void ProcessUniverse(const uint32_t nIpAddress, const uint16_t nUniverse);
 	void RemoveIpAddress(const uint16_t nUniverse, const uint32_t nIpAddress);
+	void RemoveNode(const uint32_t nNodeIndex);
+	void WheelLink(const uint32_t nNodeIndex, const uint32_t nTicks);
+	void WheelUnlink(const uint32_t nNodeIndex);
+
+	uint32_t GetNodeKey(const uint32_t nIndex) const {
+		return m_pPollTable[nIndex].IPAddress;
+	}
+	uint32_t GetUniverseKey(const uint32_t nIndex) const {
+		return m_pTableUniverses[nIndex].nUniverse;
+	}
 
 private:
 	artnet::NodeEntry *m_pPollTable;
 	artnet::PollTableUniverses *m_pTableUniverses;
 	uint32_t m_nPollTableEntries { 0 };
 	uint32_t m_nTableUniversesEntries { 0 };
-	artnet::PollTableClean m_PollTableClean;
+	artnet::PollTableHash<9> m_NodeHash;		///< IP address -> m_pPollTable index
+	artnet::PollTableHash<10> m_UniverseHash;	///< Universe -> m_pTableUniverses index
+	uint16_t m_nWheelHead[artnet::POLL_TABLE_WHEEL_SLOTS];
+	uint32_t m_nWheelTick;
 };
 
 #endif /* ARTNETPOLLTABLE_H_ */
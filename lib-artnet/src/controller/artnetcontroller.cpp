@@ -127,6 +127,19 @@ ArtNetController::ArtNetController() {
 	m_pArtDmx->OpCode = static_cast<uint16_t>(artnet::OpCodes::OP_DMX);
 	m_pArtDmx->ProtVerLo = artnet::PROTOCOL_REVISION;
 
+	m_Frame.pArtDmx = new struct ArtDmx[controller::FRAME_UNIVERSES];
+	assert(m_Frame.pArtDmx != nullptr);
+
+	for (uint32_t i = 0; i < controller::FRAME_UNIVERSES; i++) {
+		memcpy(&m_Frame.pArtDmx[i], m_pArtDmx, sizeof(struct ArtDmx));
+	}
+
+	m_Frame.pDatagrams = new network::Datagram[controller::FRAME_DATAGRAMS];
+	assert(m_Frame.pDatagrams != nullptr);
+
+	m_Frame.nPackets = 0;
+	m_Frame.nDatagrams = 0;
+
 	m_pArtSync = new struct ArtSync;
 	assert(m_pArtSync != nullptr);
 
@@ -149,6 +162,12 @@ ArtNetController::ArtNetController() {
 ArtNetController::~ArtNetController() {
 	DEBUG_ENTRY
 
+	delete[] m_Frame.pDatagrams;
+	m_Frame.pDatagrams = nullptr;
+
+	delete[] m_Frame.pArtDmx;
+	m_Frame.pArtDmx = nullptr;
+
 	delete m_pArtNetPacket;
 	m_pArtNetPacket = nullptr;
 
@@ -257,6 +276,54 @@ void ArtNetController::Stop() {
 	DEBUG_EXIT
 }
 
+/**
+ * @param [OUT] pIpAddresses the unicast subscribers, nullptr for a broadcast
+ * @return the number of destinations, 0 when the universe is not sent
+ */
+uint32_t ArtNetController::GetDestinations(const uint16_t nUniverse, const uint32_t *&pIpAddresses) {
+	uint32_t nCount = 0;
+	const auto *IpAddresses = GetIpAddress(nUniverse);
+
+	pIpAddresses = nullptr;
+
+	if (m_bUnicast && !m_bForceBroadcast) {
+		if (IpAddresses != nullptr) {
+			nCount = IpAddresses->nCount;
+		} else {
+			return 0;
+		}
+	}
+
+	// If the number of universe subscribers exceeds 40 for a given universe, the transmitting device may broadcast.
+
+	if (m_bUnicast && (nCount <= controller::MAX_UNICAST_SUBSCRIBERS) && !m_bForceBroadcast) {
+		pIpAddresses = IpAddresses->pIpAddresses;
+		return nCount;
+	}
+
+	if (!m_bUnicast || (nCount > controller::MAX_UNICAST_SUBSCRIBERS) || !m_bForceBroadcast) {
+		return 1;
+	}
+
+	return 0;
+}
+
+void ArtNetController::CopyDmxData(uint8_t *pData, const uint8_t *pDmxData, const uint32_t nLength) {
+#if defined(CONFIG_ARTNET_CONTROLLER_ENABLE_MASTER)
+	if (__builtin_expect((m_nMaster == DMX_MAX_VALUE), 1)) {
+#endif
+		memcpy(pData, pDmxData, nLength);
+#if defined(CONFIG_ARTNET_CONTROLLER_ENABLE_MASTER)
+	} else if (m_nMaster == 0) {
+		memset(pData, 0, nLength);
+	} else {
+		for (uint32_t i = 0; i < nLength; i++) {
+			pData[i] = ((m_nMaster * static_cast<uint32_t>(pDmxData[i])) / DMX_MAX_VALUE) & 0xFF;
+		}
+	}
+#endif
+}
+
 void ArtNetController::HandleDmxOut(uint16_t nUniverse, const uint8_t *pDmxData, uint32_t nLength, uint8_t nPortIndex) {
 	DEBUG_ENTRY
 
@@ -275,52 +342,79 @@ void ArtNetController::HandleDmxOut(uint16_t nUniverse, const uint8_t *pDmxData,
 		m_pArtDmx->Sequence = 1;
 	}
 
-#if defined(CONFIG_ARTNET_CONTROLLER_ENABLE_MASTER)
-	if (__builtin_expect((m_nMaster == DMX_MAX_VALUE), 1)) {
-#endif
-		memcpy(m_pArtDmx->Data, pDmxData, nLength);
-#if defined(CONFIG_ARTNET_CONTROLLER_ENABLE_MASTER)
-	} else if (m_nMaster == 0) {
-		memset(m_pArtDmx->Data, 0, nLength);
-	} else {
-		for (uint32_t i = 0; i < nLength; i++) {
-			m_pArtDmx->Data[i] = ((m_nMaster * static_cast<uint32_t>(pDmxData[i])) / DMX_MAX_VALUE) & 0xFF;
-		}
-	}
-#endif
+	CopyDmxData(m_pArtDmx->Data, pDmxData, nLength);
 
-	uint32_t nCount = 0;
-	auto IpAddresses = const_cast<struct artnet::PollTableUniverses *>(GetIpAddress(nUniverse));
+	const uint32_t *pIpAddresses;
+	const auto nCount = GetDestinations(nUniverse, pIpAddresses);
 
-	if (m_bUnicast && !m_bForceBroadcast) {
-		if (IpAddresses != nullptr) {
-			nCount = IpAddresses->nCount;
-		} else {
-			DEBUG_EXIT
-			return;
-		}
+	if (nCount == 0) {
+		DEBUG_EXIT
+		return;
 	}
 
-	// If the number of universe subscribers exceeds 40 for a given universe, the transmitting device may broadcast.
-
-	if (m_bUnicast && (nCount <= 40) && !m_bForceBroadcast) {
+	if (pIpAddresses != nullptr) {
 		for (uint32_t nIndex = 0; nIndex < nCount; nIndex++) {
-			Network::Get()->SendTo(m_nHandle, m_pArtDmx, sizeof(struct ArtDmx), IpAddresses->pIpAddresses[nIndex], artnet::UDP_PORT);
+			Network::Get()->SendTo(m_nHandle, m_pArtDmx, sizeof(struct ArtDmx), pIpAddresses[nIndex], artnet::UDP_PORT);
 		}
+	} else {
+		Network::Get()->SendTo(m_nHandle, m_pArtDmx, sizeof(struct ArtDmx), m_ArtNetController.nIPAddressBroadcast, artnet::UDP_PORT);
+	}
 
-		m_bDmxHandled = true;
+	m_bDmxHandled = true;
 
-		DEBUG_EXIT
+	DEBUG_EXIT
+}
+
+void ArtNetController::AddUniverse(uint16_t nUniverse, const uint8_t *pDmxData, uint32_t nLength, uint8_t nPortIndex) {
+	ActiveUniversesAdd(nUniverse);
+
+	const uint32_t *pIpAddresses;
+	const auto nCount = GetDestinations(nUniverse, pIpAddresses);
+
+	if (nCount == 0) {
 		return;
 	}
 
-	if (!m_bUnicast || (nCount > 40) || !m_bForceBroadcast) {
-		Network::Get()->SendTo(m_nHandle, m_pArtDmx, sizeof(struct ArtDmx), m_ArtNetController.nIPAddressBroadcast, artnet::UDP_PORT);
+	if ((m_Frame.nPackets == controller::FRAME_UNIVERSES) || ((m_Frame.nDatagrams + nCount) > controller::FRAME_DATAGRAMS)) {
+		FrameSend();
+	}
+
+	auto *pArtDmx = &m_Frame.pArtDmx[m_Frame.nPackets++];
+
+	// The sequence number is shared with HandleDmxOut
+	m_pArtDmx->Sequence++;
+
+	if (m_pArtDmx->Sequence == 0) {
+		m_pArtDmx->Sequence = 1;
+	}
+
+	pArtDmx->Sequence = m_pArtDmx->Sequence;
+	pArtDmx->Physical = nPortIndex;
+	pArtDmx->PortAddress = nUniverse;
+	pArtDmx->LengthHi = static_cast<uint8_t>((nLength & 0xFF00) >> 8);
+	pArtDmx->Length = static_cast<uint8_t>(nLength & 0xFF);
 
-		m_bDmxHandled = true;
+	CopyDmxData(pArtDmx->Data, pDmxData, nLength);
+
+	for (uint32_t nIndex = 0; nIndex < nCount; nIndex++) {
+		auto& datagram = m_Frame.pDatagrams[m_Frame.nDatagrams++];
+
+		datagram.pBuffer = pArtDmx;
+		datagram.nToIp = (pIpAddresses != nullptr) ? pIpAddresses[nIndex] : m_ArtNetController.nIPAddressBroadcast;
+		datagram.nLength = sizeof(struct ArtDmx);
+		datagram.nRemotePort = artnet::UDP_PORT;
 	}
 
-	DEBUG_EXIT
+	m_bDmxHandled = true;
+}
+
+void ArtNetController::FrameSend() {
+	if (m_Frame.nDatagrams != 0) {
+		Network::Get()->SendTo(m_nHandle, m_Frame.pDatagrams, m_Frame.nDatagrams);
+	}
+
+	m_Frame.nPackets = 0;
+	m_Frame.nDatagrams = 0;
 }
 
 void ArtNetController::HandleSync() {
@@ -50,6 +50,13 @@ union uip {
 	uint8_t u8[4];
 } static ip;
 
+static_assert(artnet::POLL_TABLE_SIZE_ENRIES < (1U << 9), "m_NodeHash is too small");
+static_assert(artnet::POLL_TABLE_SIZE_UNIVERSES < (1U << 10), "m_UniverseHash is too small");
+
+static uint32_t wheel_tick() {
+	return Hardware::Get()->Millis() / artnet::POLL_TABLE_WHEEL_TICK_MILLIS;
+}
+
 ArtNetPollTable::ArtNetPollTable() {
 	DEBUG_ENTRY
 
@@ -68,9 +75,14 @@ ArtNetPollTable::ArtNetPollTable() {
 		assert(m_pTableUniverses[nIndex].pIpAddresses != nullptr);
 	}
 
-	m_PollTableClean.nTableIndex = 0;
-	m_PollTableClean.nUniverseIndex = 0;
-	m_PollTableClean.bOffLine = true;
+	m_NodeHash.Clear();
+	m_UniverseHash.Clear();
+
+	for (auto& nHead : m_nWheelHead) {
+		nHead = artnet::POLL_TABLE_WHEEL_NONE;
+	}
+
+	m_nWheelTick = wheel_tick();
 
 	DEBUG_PRINTF("NodeEntry[%d] = %u bytes [%u Kb]", artnet::POLL_TABLE_SIZE_ENRIES, static_cast<unsigned>(sizeof(artnet::NodeEntry[artnet::POLL_TABLE_SIZE_ENRIES])), static_cast<unsigned>(sizeof(artnet::NodeEntry[artnet::POLL_TABLE_SIZE_ENRIES])) / 1024U);
 	DEBUG_PRINTF("PollTableUniverses[%d] = %u bytes [%u Kb]", artnet::POLL_TABLE_SIZE_UNIVERSES, static_cast<unsigned>(sizeof(artnet::PollTableUniverses[artnet::POLL_TABLE_SIZE_UNIVERSES])), static_cast<unsigned>(sizeof(artnet::PollTableUniverses[artnet::POLL_TABLE_SIZE_UNIVERSES])) / 1024U);
@@ -91,211 +103,226 @@ ArtNetPollTable::~ArtNetPollTable() {
 }
 
 const struct artnet::PollTableUniverses *ArtNetPollTable::GetIpAddress(uint16_t nUniverse) const {
-	if (m_nTableUniversesEntries == 0) {
-		return nullptr;
-	}
+	const auto nEntry = m_UniverseHash.Find(nUniverse, [this](const uint32_t nIndex) { return GetUniverseKey(nIndex); });
 
-	// FIXME Universe lookup
-	for (uint32_t nEntry = 0; nEntry < m_nTableUniversesEntries; nEntry++) {
-		artnet::PollTableUniverses *pTableUniverses = &m_pTableUniverses[nEntry];
-		assert(pTableUniverses != nullptr);
-
-		if (pTableUniverses->nUniverse == nUniverse) {
-			return &m_pTableUniverses[nEntry];
-		}
+	if (nEntry < 0) {
+		return nullptr;
 	}
 
-	return nullptr;
+	return &m_pTableUniverses[nEntry];
 }
 
-
+/*
+ * The subscriber list of a universe is unordered, an entry is removed by moving the last one in its place.
+ * The same is done for the universe entries, where the IP address buffers are swapped.
+ */
 void ArtNetPollTable::RemoveIpAddress(const uint16_t nUniverse, const uint32_t nIpAddress) {
-	if (m_nTableUniversesEntries == 0) {
+	const auto getKey = [this](const uint32_t nIndex) { return GetUniverseKey(nIndex); };
+	const auto nFound = m_UniverseHash.Find(nUniverse, getKey);
+
+	if (nFound < 0) {
 		return;
 	}
 
-	uint32_t nEntry = 0;
+	const auto nEntry = static_cast<uint32_t>(nFound);
+	auto *pTableUniverses = &m_pTableUniverses[nEntry];
+	assert(pTableUniverses->nCount > 0);
 
-	// FIXME Universe lookup
-	for (nEntry = 0; nEntry < m_nTableUniversesEntries; nEntry++) {
-		artnet::PollTableUniverses *pTableUniverses = &m_pTableUniverses[nEntry];
-		assert(pTableUniverses != nullptr);
+	auto *p32 = pTableUniverses->pIpAddresses;
 
-		if (pTableUniverses->nUniverse == nUniverse) {
+	for (uint32_t nIpAddressIndex = 0; nIpAddressIndex < pTableUniverses->nCount; nIpAddressIndex++) {
+		if (p32[nIpAddressIndex] == nIpAddress) {
+			pTableUniverses->nCount--;
+			p32[nIpAddressIndex] = p32[pTableUniverses->nCount];
 			break;
 		}
 	}
 
-	if (nEntry == m_nTableUniversesEntries) {
-		// Universe not found
+	if (pTableUniverses->nCount != 0) {
 		return;
 	}
 
-	artnet::PollTableUniverses *pTableUniverses = &m_pTableUniverses[nEntry];
-	assert(pTableUniverses->nCount > 0);
+	DEBUG_PRINTF("Delete Universe -> m_nTableUniversesEntries=%u, nEntry=%u", m_nTableUniversesEntries, nEntry);
 
-	uint32_t nIpAddressIndex = 0;
+	m_UniverseHash.Remove(nUniverse, getKey);
 
-	// FIXME IP lookup
-	for (nIpAddressIndex = 0; nIpAddressIndex < pTableUniverses->nCount; nIpAddressIndex++) {
-		if (pTableUniverses->pIpAddresses[nIpAddressIndex] == nIpAddress) {
-			break;
-		}
-	}
+	const auto nLast = m_nTableUniversesEntries - 1;
 
-	auto *p32 = pTableUniverses->pIpAddresses;
-	int32_t i;
+	if (nEntry != nLast) {
+		auto *pLast = &m_pTableUniverses[nLast];
+		m_UniverseHash.Update(pLast->nUniverse, nEntry, getKey);
 
-	for (i = static_cast<int32_t>(nIpAddressIndex); i < static_cast<int32_t>(pTableUniverses->nCount) - 1; i++) {
-		p32[i] = p32[i + 1];
+		auto *pIpAddresses = pTableUniverses->pIpAddresses;
+		pTableUniverses->nUniverse = pLast->nUniverse;
+		pTableUniverses->nCount = pLast->nCount;
+		pTableUniverses->pIpAddresses = pLast->pIpAddresses;
+		pLast->pIpAddresses = pIpAddresses;
 	}
 
-	p32[i] = 0;
+	m_pTableUniverses[nLast].nUniverse = 0;
+	m_pTableUniverses[nLast].nCount = 0;
 
-	pTableUniverses->nCount--;
+	m_nTableUniversesEntries = nLast;
+}
 
-	if (pTableUniverses->nCount == 0) {
-		DEBUG_PRINTF("Delete Universe -> m_nTableUniversesEntries=%u, nEntry=%u", m_nTableUniversesEntries, nEntry);
+/*
+ * Called once for each new universe of a node, so the IP address is not in the list yet.
+ */
+void ArtNetPollTable::ProcessUniverse(const uint32_t nIpAddress, const uint16_t nUniverse) {
+	DEBUG_ENTRY
 
-		artnet::PollTableUniverses *p = m_pTableUniverses;
+	const auto nFound = m_UniverseHash.Find(nUniverse, [this](const uint32_t nIndex) { return GetUniverseKey(nIndex); });
+	artnet::PollTableUniverses *pTableUniverses;
 
-		for (i = static_cast<int32_t>(nEntry); i < static_cast<int32_t>(m_nTableUniversesEntries) - 1; i++) {
-			p[i].nUniverse = p[i + 1].nUniverse;
-			p[i].nCount = p[i + 1].nCount;
-			p[i].pIpAddresses = p[i + 1].pIpAddresses;
+	if (nFound >= 0) {
+		pTableUniverses = &m_pTableUniverses[nFound];
+		DEBUG_PRINTF("Universe found %u", nUniverse);
+	} else {
+		if (artnet::POLL_TABLE_SIZE_UNIVERSES == m_nTableUniversesEntries) {
+			DEBUG_PUTS("m_pTableUniverses is full");
+			DEBUG_EXIT
+			return;
 		}
 
-		p[i].nUniverse = 0;
-		p[i].nCount = 0;
+		pTableUniverses = &m_pTableUniverses[m_nTableUniversesEntries];
+		pTableUniverses->nUniverse = nUniverse;
+		pTableUniverses->nCount = 0;
+		m_UniverseHash.Insert(nUniverse, m_nTableUniversesEntries);
+		m_nTableUniversesEntries++;
+		DEBUG_PRINTF("New Universe %d", static_cast<int>(nUniverse));
+	}
 
-		m_nTableUniversesEntries--;
+	if (pTableUniverses->nCount < artnet::POLL_TABLE_SIZE_ENRIES) {
+		pTableUniverses->pIpAddresses[pTableUniverses->nCount] = nIpAddress;
+		pTableUniverses->nCount++;
+		DEBUG_PUTS("It is a new IP for the Universe");
+	} else {
+		DEBUG_PUTS("New IP does not fit");
 	}
+
+	DEBUG_EXIT
 }
 
-void ArtNetPollTable::ProcessUniverse(const uint32_t nIpAddress, const uint16_t nUniverse) {
-	DEBUG_ENTRY
+/*
+ * The timer wheel has a list of nodes per tick. A node is linked in the slot of the tick where it expires,
+ * and is moved to a new slot with each ArtPollReply. Clean() only visits the nodes in the slot of the current tick.
+ */
+void ArtNetPollTable::WheelLink(const uint32_t nNodeIndex, const uint32_t nTicks) {
+	assert(nTicks != 0);
+	assert(nTicks < artnet::POLL_TABLE_WHEEL_SLOTS);
 
-	if (artnet::POLL_TABLE_SIZE_UNIVERSES == m_nTableUniversesEntries) {
-		DEBUG_PUTS("m_pTableUniverses is full");
-		DEBUG_EXIT
-		return;
+	const auto nSlot = (m_nWheelTick + nTicks) % artnet::POLL_TABLE_WHEEL_SLOTS;
+	auto& node = m_pPollTable[nNodeIndex];
+
+	node.nWheelSlot = static_cast<uint16_t>(nSlot);
+	node.nWheelPrev = artnet::POLL_TABLE_WHEEL_NONE;
+	node.nWheelNext = m_nWheelHead[nSlot];
+
+	if (node.nWheelNext != artnet::POLL_TABLE_WHEEL_NONE) {
+		m_pPollTable[node.nWheelNext].nWheelPrev = static_cast<uint16_t>(nNodeIndex);
 	}
 
-	// FIXME Universe lookup
-	auto bFoundUniverse = false;
-	uint32_t nEntry = 0;
+	m_nWheelHead[nSlot] = static_cast<uint16_t>(nNodeIndex);
+}
 
-	for (nEntry = 0; nEntry < m_nTableUniversesEntries; nEntry++) {
-		auto *pTableUniverses = &m_pTableUniverses[nEntry];
-		assert(pTableUniverses != nullptr);
+void ArtNetPollTable::WheelUnlink(const uint32_t nNodeIndex) {
+	auto& node = m_pPollTable[nNodeIndex];
 
-		if (pTableUniverses->nUniverse == nUniverse) {
-			bFoundUniverse = true;
-			DEBUG_PRINTF("Universe found %u", nUniverse);
-			break;
-		}
+	if (node.nWheelSlot == artnet::POLL_TABLE_WHEEL_NONE) {
+		return;
 	}
 
-	auto *pTableUniverses = &m_pTableUniverses[nEntry];
-	auto bFoundIp = false;
-	uint32_t nCount = 0;
-
-	if (bFoundUniverse) {
-		// FIXME IP lookup
-		for (nCount = 0; nCount < pTableUniverses->nCount; nCount++) {
-			if (pTableUniverses->pIpAddresses[nCount] == nIpAddress) {
-				bFoundIp = true;
-				DEBUG_PUTS("IP found");
-				break;
-			}
-		}
+	if (node.nWheelPrev != artnet::POLL_TABLE_WHEEL_NONE) {
+		m_pPollTable[node.nWheelPrev].nWheelNext = node.nWheelNext;
 	} else {
-		// New universe
-		pTableUniverses->nUniverse = nUniverse;
-		m_nTableUniversesEntries++;
-		DEBUG_PRINTF("New Universe %d", static_cast<int>(nUniverse));
+		m_nWheelHead[node.nWheelSlot] = node.nWheelNext;
 	}
 
-	if (!bFoundIp) {
-		if (pTableUniverses->nCount < artnet::POLL_TABLE_SIZE_ENRIES) {
-			pTableUniverses->pIpAddresses[pTableUniverses->nCount] = nIpAddress;
-			pTableUniverses->nCount++;
-			DEBUG_PUTS("It is a new IP for the Universe");
-		} else {
-			DEBUG_PUTS("New IP does not fit");
-		}
+	if (node.nWheelNext != artnet::POLL_TABLE_WHEEL_NONE) {
+		m_pPollTable[node.nWheelNext].nWheelPrev = node.nWheelPrev;
 	}
 
-	DEBUG_EXIT
+	node.nWheelSlot = artnet::POLL_TABLE_WHEEL_NONE;
 }
 
-void ArtNetPollTable::Add(const struct artnet::ArtPollReply *ptArtPollReply) {
-	DEBUG_ENTRY
+/*
+ * The poll table is unordered, the last node is moved in the place of the removed node.
+ */
+void ArtNetPollTable::RemoveNode(const uint32_t nNodeIndex) {
+	DEBUG_PRINTF(IPSTR, IP2STR(m_pPollTable[nNodeIndex].IPAddress));
 
-	auto bFound = false;
+	auto *pNode = &m_pPollTable[nNodeIndex];
 
-	memcpy(ip.u8, ptArtPollReply->IPAddress, 4);
+	for (uint32_t nIndex = 0; nIndex < pNode->nUniversesCount; nIndex++) {
+		RemoveIpAddress(pNode->Universe[nIndex].nUniverse, pNode->IPAddress);
+	}
 
-	const auto nIpSwap = __builtin_bswap32(ip.u32);
+	WheelUnlink(nNodeIndex);
 
-	int32_t i;
-	int32_t nLow = 0;
-	int32_t nMid;
-	auto nHigh = static_cast<int32_t>(m_nPollTableEntries);
+	const auto getKey = [this](const uint32_t nIndex) { return GetNodeKey(nIndex); };
+	m_NodeHash.Remove(pNode->IPAddress, getKey);
 
-	while (nLow <= nHigh) {
-		nMid = nLow + ((nHigh - nLow) / 2);
-		const auto nMidValue = __builtin_bswap32(m_pPollTable[nMid].IPAddress);
+	const auto nLast = m_nPollTableEntries - 1;
 
-		if (nMidValue < nIpSwap) {
-			nLow = nMid + 1;
-		} else if (nMidValue > nIpSwap) {
-			nHigh = nMid - 1;
-		} else {
-			i = nMid;
-			bFound = true;
-			break;
-		}
-	}
+	if (nNodeIndex != nLast) {
+		const auto *pLast = &m_pPollTable[nLast];
+		m_NodeHash.Update(pLast->IPAddress, nNodeIndex, getKey);
 
-	if (!bFound) {
-		if (m_nPollTableEntries == artnet::POLL_TABLE_SIZE_ENRIES) {
-			DEBUG_PUTS("Full");
-			return;
+		memcpy(pNode, pLast, sizeof(struct artnet::NodeEntry));
+
+		if (pNode->nWheelSlot != artnet::POLL_TABLE_WHEEL_NONE) {
+			if (pNode->nWheelPrev != artnet::POLL_TABLE_WHEEL_NONE) {
+				m_pPollTable[pNode->nWheelPrev].nWheelNext = static_cast<uint16_t>(nNodeIndex);
+			} else {
+				m_nWheelHead[pNode->nWheelSlot] = static_cast<uint16_t>(nNodeIndex);
+			}
+
+			if (pNode->nWheelNext != artnet::POLL_TABLE_WHEEL_NONE) {
+				m_pPollTable[pNode->nWheelNext].nWheelPrev = static_cast<uint16_t>(nNodeIndex);
+			}
 		}
+	}
 
-		if (m_nPollTableEntries != static_cast<uint32_t>(nHigh)) {
-			DEBUG_PUTS("Move");
+	auto *pDst = &m_pPollTable[nLast];
+	pDst->IPAddress = 0;
+	pDst->nUniversesCount = 0;
+#ifndef NDEBUG
+	memset(pDst->Universe, 0, sizeof(struct artnet::NodeEntryUniverse[artnet::POLL_TABLE_SIZE_NODE_UNIVERSES]));
+	memset(pDst->Mac, 0, artnet::MAC_SIZE + artnet::LONG_NAME_LENGTH);
+#endif
 
-			auto *pArtNetNodeEntry = m_pPollTable; // TODO
+	m_nPollTableEntries = nLast;
+}
 
-			assert(m_nPollTableEntries >= 1);
-			assert(nLow >= 0);
+void ArtNetPollTable::Add(const struct artnet::ArtPollReply *ptArtPollReply) {
+	DEBUG_ENTRY
 
-			for (int32_t i = static_cast<int32_t>(m_nPollTableEntries) - 1;i >= nLow; i--) {
-				const struct artnet::NodeEntry *pSrc = &pArtNetNodeEntry[i];
-				struct artnet::NodeEntry *pDst = &pArtNetNodeEntry[i + 1];
-				memcpy(pDst, pSrc, sizeof(struct artnet::NodeEntry));
-			}
+	memcpy(ip.u8, ptArtPollReply->IPAddress, 4);
 
-			auto *pDst = &pArtNetNodeEntry[nLow];
-			memset(pDst, 0, sizeof(struct artnet::NodeEntry));
+	auto i = m_NodeHash.Find(ip.u32, [this](const uint32_t nIndex) { return GetNodeKey(nIndex); });
 
-			i = nLow;
-		} else {
-			i = static_cast<int32_t>(m_nPollTableEntries);
-			DEBUG_PRINTF("Add -> i=%d", i);
+	if (i < 0) {
+		if (m_nPollTableEntries == artnet::POLL_TABLE_SIZE_ENRIES) {
+			DEBUG_PUTS("Full");
+			return;
 		}
 
+		i = static_cast<int32_t>(m_nPollTableEntries);
+		DEBUG_PRINTF("Add -> i=%d", i);
+
+		memset(&m_pPollTable[i], 0, sizeof(struct artnet::NodeEntry));
 		m_pPollTable[i].IPAddress = ip.u32;
+		m_pPollTable[i].nWheelSlot = artnet::POLL_TABLE_WHEEL_NONE;
+
+		m_NodeHash.Insert(ip.u32, m_nPollTableEntries);
 		m_nPollTableEntries++;
 	}
 
+	auto& node = m_pPollTable[i];
+
 	if (ptArtPollReply->BindIndex <= 1) {
-		memcpy(m_pPollTable[i].Mac, ptArtPollReply->MAC, artnet::MAC_SIZE);
-		const uint8_t *pSrc = ptArtPollReply->LongName;
-		uint8_t *pDst = m_pPollTable[i].LongName;
-		memcpy(pDst, pSrc, artnet::LONG_NAME_LENGTH);
+		memcpy(node.Mac, ptArtPollReply->MAC, artnet::MAC_SIZE);
+		memcpy(node.LongName, ptArtPollReply->LongName, artnet::LONG_NAME_LENGTH);
 	}
 
 	const auto nMillis = Hardware::Get()->Millis();
@@ -308,20 +335,18 @@ void ArtNetPollTable::Add(const struct artnet::ArtPollReply *ptArtPollReply) {
 
 			uint32_t nIndexUniverse;
 
-			for (nIndexUniverse = 0; nIndexUniverse < m_pPollTable[i].nUniversesCount; nIndexUniverse++) {
-				if (m_pPollTable[i].Universe[nIndexUniverse].nUniverse == nUniverse) {
+			for (nIndexUniverse = 0; nIndexUniverse < node.nUniversesCount; nIndexUniverse++) {
+				if (node.Universe[nIndexUniverse].nUniverse == nUniverse) {
 					break;
 				}
 			}
 
-			if (nIndexUniverse == m_pPollTable[i].nUniversesCount) {
+			if (nIndexUniverse == node.nUniversesCount) {
 				// Not found
-				if (m_pPollTable[i].nUniversesCount < artnet::POLL_TABLE_SIZE_NODE_UNIVERSES) {
-					m_pPollTable[i].nUniversesCount++;
-					m_pPollTable[i].Universe[nIndexUniverse].nUniverse = nUniverse;
-					const uint8_t *pSrc = ptArtPollReply->ShortName;
-					uint8_t *pDst = m_pPollTable[i].Universe[nIndexUniverse].ShortName;
-					memcpy(pDst, pSrc, artnet::SHORT_NAME_LENGTH);
+				if (node.nUniversesCount < artnet::POLL_TABLE_SIZE_NODE_UNIVERSES) {
+					node.nUniversesCount++;
+					node.Universe[nIndexUniverse].nUniverse = nUniverse;
+					memcpy(node.Universe[nIndexUniverse].ShortName, ptArtPollReply->ShortName, artnet::SHORT_NAME_LENGTH);
 					ProcessUniverse(ip.u32, nUniverse);
 				} else {
 					// No room
@@ -329,67 +354,59 @@ void ArtNetPollTable::Add(const struct artnet::ArtPollReply *ptArtPollReply) {
 				}
 			}
 
-			m_pPollTable[i].Universe[nIndexUniverse].nLastUpdateMillis = nMillis;
+			node.Universe[nIndexUniverse].nLastUpdateMillis = nMillis;
 		}
 	}
 
-	DEBUG_EXIT;
-}
+	/*
+	 * The universes which are no longer reported by the node
+	 */
+	for (uint32_t nIndexUniverse = 0; nIndexUniverse < node.nUniversesCount;) {
+		auto& universe = node.Universe[nIndexUniverse];
 
-void ArtNetPollTable::Clean() {
-	if (m_nPollTableEntries == 0) {
-		return;
+		if ((nMillis - universe.nLastUpdateMillis) > artnet::POLL_TABLE_TIMEOUT_MILLIS) {
+			RemoveIpAddress(universe.nUniverse, node.IPAddress);
+			node.nUniversesCount--;
+			universe = node.Universe[node.nUniversesCount];
+		} else {
+			nIndexUniverse++;
+		}
 	}
 
-	assert(m_PollTableClean.nTableIndex < m_nPollTableEntries);
-	assert(m_PollTableClean.nUniverseIndex < artnet::POLL_TABLE_SIZE_NODE_UNIVERSES);
+	node.nLastUpdateMillis = nMillis;
 
-	if (m_PollTableClean.nUniverseIndex == 0) {
-		m_PollTableClean.bOffLine = true;
-	}
+	WheelUnlink(static_cast<uint32_t>(i));
+	WheelLink(static_cast<uint32_t>(i), (artnet::POLL_TABLE_TIMEOUT_MILLIS / artnet::POLL_TABLE_WHEEL_TICK_MILLIS) + 1);
 
-	auto *pArtNetNodeEntryBind = &m_pPollTable[m_PollTableClean.nTableIndex].Universe[m_PollTableClean.nUniverseIndex];
+	DEBUG_EXIT;
+}
 
-	if (pArtNetNodeEntryBind->nLastUpdateMillis != 0) {
-		if ((Hardware::Get()->Millis() - pArtNetNodeEntryBind->nLastUpdateMillis) > (1.5 * artnet::POLL_INTERVAL_MILLIS)) {
-			pArtNetNodeEntryBind->nLastUpdateMillis = 0;
-			RemoveIpAddress(pArtNetNodeEntryBind->nUniverse, m_pPollTable[m_PollTableClean.nTableIndex].IPAddress);
-		} else {
-			m_PollTableClean.bOffLine = false;
-		}
+/*
+ * Advances the timer wheel with at most one tick per call.
+ * A node in the slot is removed when it did not reply within the timeout,
+ * otherwise it is linked again in the slot where it expires.
+ */
+void ArtNetPollTable::Clean() {
+	if (m_nWheelTick == wheel_tick()) {
+		return;
 	}
 
-	m_PollTableClean.nUniverseIndex++;
-
-	if (m_PollTableClean.nUniverseIndex == artnet::POLL_TABLE_SIZE_NODE_UNIVERSES) {
-		if (m_PollTableClean.bOffLine) {
-			DEBUG_PUTS("Node is off-line");
-
-			auto *pArtNetNodeEntry = m_pPollTable;
-			// Move
-			for (uint32_t i = m_PollTableClean.nTableIndex; i < (m_nPollTableEntries - 1); i++) {
-				const auto *pSrc = &pArtNetNodeEntry[i + 1];
-				auto *pDst = &pArtNetNodeEntry[i];
-				memcpy(pDst, pSrc, sizeof(struct artnet::NodeEntry));
-			}
+	m_nWheelTick++;
 
-			m_nPollTableEntries--;
+	const auto nSlot = m_nWheelTick % artnet::POLL_TABLE_WHEEL_SLOTS;
+	const auto nMillis = Hardware::Get()->Millis();
 
-			auto *pDst = &pArtNetNodeEntry[m_nPollTableEntries];
-			pDst->IPAddress = 0;
-			pDst->nUniversesCount = 0;
-			memset(pDst->Universe, 0, sizeof(struct artnet::NodeEntryUniverse[artnet::POLL_TABLE_SIZE_NODE_UNIVERSES]));
-#ifndef NDEBUG
-			memset(pDst->Mac, 0, artnet::MAC_SIZE + artnet::LONG_NAME_LENGTH);
-#endif
-		}
+	while (m_nWheelHead[nSlot] != artnet::POLL_TABLE_WHEEL_NONE) {
+		const auto nNodeIndex = m_nWheelHead[nSlot];
+		const auto nElapsed = nMillis - m_pPollTable[nNodeIndex].nLastUpdateMillis;
 
-		m_PollTableClean.nUniverseIndex = 0;
-		m_PollTableClean.bOffLine = true;
-		m_PollTableClean.nTableIndex++;
+		WheelUnlink(nNodeIndex);
 
-		if (m_PollTableClean.nTableIndex >= m_nPollTableEntries) {
-			m_PollTableClean.nTableIndex = 0;
+		if (nElapsed > artnet::POLL_TABLE_TIMEOUT_MILLIS) {
+			DEBUG_PUTS("Node is off-line");
+			RemoveNode(nNodeIndex);
+		} else {
+			WheelLink(nNodeIndex, ((artnet::POLL_TABLE_TIMEOUT_MILLIS - nElapsed) / artnet::POLL_TABLE_WHEEL_TICK_MILLIS) + 1);
 		}
 	}
 }
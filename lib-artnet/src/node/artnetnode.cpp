@@ -93,6 +93,7 @@ ArtNetNode::ArtNetNode() {
 	memset(&m_State, 0, sizeof(struct artnetnode::State));
 	m_State.reportCode = artnet::ReportCode::RCPOWEROK;
 	m_State.status = artnet::Status::STANDBY;
+	m_State.nSequenceWindowMillis = lightset::sequence::WINDOW_MILLIS_DEFAULT;
 	// The device should wait for a random delay of up to 1s before sending the reply.
 	m_State.ArtPollReplyDelayMillis = (m_ArtPollReply.MAC[5] | (static_cast<uint32_t>(m_ArtPollReply.MAC[4]) << 8)) % 1000;
 
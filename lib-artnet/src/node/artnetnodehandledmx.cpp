@@ -42,6 +42,18 @@
 
 #include "lightsetdata.h"
 
+static artnetnode::Source *find_source(artnetnode::OutputPort& outputPort, const uint32_t nIp, const uint8_t nPhysical) {
+	if ((outputPort.SourceA.nIp == nIp) && (outputPort.SourceA.nPhysical == nPhysical)) {
+		return &outputPort.SourceA;
+	}
+
+	if ((outputPort.SourceB.nIp == nIp) && (outputPort.SourceB.nPhysical == nPhysical)) {
+		return &outputPort.SourceB;
+	}
+
+	return nullptr;
+}
+
 void ArtNetNode::UpdateMergeStatus(const uint32_t nPortIndex) {
 	if (!m_State.IsMergeMode) {
 		m_State.IsMergeMode = true;
@@ -96,6 +108,19 @@ void ArtNetNode::HandleDmx() {
 				}
 			}
 
+			/*
+			 * The Sequence field is used to discard the packets which arrive out of order.
+			 * A value of 0 disables the sequence check.
+			 */
+			auto *pSource = find_source(m_OutputPort[nPortIndex], m_nIpAddressFrom, pArtDmx->Physical);
+
+			if ((pSource != nullptr) && (pArtDmx->Sequence != 0)) {
+				if (pSource->sequence.Check(pArtDmx->Sequence, m_nCurrentPacketMillis, m_State.nSequenceWindowMillis, m_OutputPort[nPortIndex].sequenceStats) == lightset::sequence::Result::DISCARD) {
+					SendDiag(artnet::PriorityCodes::DIAG_LOW, "%u:%u Out of sequence, discarding data", nPortIndex, pArtDmx->Physical);
+					continue;
+				}
+			}
+
 			const auto ipA = m_OutputPort[nPortIndex].SourceA.nIp;
 			const auto ipB = m_OutputPort[nPortIndex].SourceB.nIp;
 			const auto mergeMode = ((m_OutputPort[nPortIndex].GoodOutput & artnet::GoodOutput::MERGE_MODE_LTP) == artnet::GoodOutput::MERGE_MODE_LTP) ? lightset::MergeMode::LTP : lightset::MergeMode::HTP;
@@ -205,6 +230,17 @@ void ArtNetNode::HandleDmx() {
 				return;
 			}
 
+			if (pSource == nullptr) {
+				// A new source
+				if ((pSource = find_source(m_OutputPort[nPortIndex], m_nIpAddressFrom, pArtDmx->Physical)) != nullptr) {
+					if (pArtDmx->Sequence != 0) {
+						pSource->sequence.Start(pArtDmx->Sequence, m_nCurrentPacketMillis);
+					} else {
+						pSource->sequence.Reset();
+					}
+				}
+			}
+
 			if ((m_State.IsSynchronousMode) && ((m_OutputPort[nPortIndex].GoodOutput & artnet::GoodOutput::OUTPUT_IS_MERGING) != artnet::GoodOutput::OUTPUT_IS_MERGING)) {
 				lightset::Data::Set(m_pLightSet, nPortIndex);
 				m_OutputPort[nPortIndex].IsDataPending = true;
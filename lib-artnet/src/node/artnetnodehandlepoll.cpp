@@ -143,6 +143,22 @@ void ArtNetNode::SendPollRelply(const uint32_t nBindIndex, const uint32_t nDesti
 	m_State.IsChanged = false;
 }
 
+void ArtNetNode::SendSequenceStats() {
+#if defined (ARTNET_ENABLE_SENDDIAG)
+	for (uint32_t nPortIndex = 0; nPortIndex < artnetnode::MAX_PORTS; nPortIndex++) {
+		if (m_Node.Port[nPortIndex].direction != lightset::PortDir::OUTPUT) {
+			continue;
+		}
+
+		const auto *pStats = GetSequenceStats(nPortIndex);
+
+		SendDiag(artnet::PriorityCodes::DIAG_LOW, "%u: Sequence lost %u duplicate %u reordered %u late %u", nPortIndex,
+				static_cast<unsigned>(pStats->nLost), static_cast<unsigned>(pStats->nDuplicate),
+				static_cast<unsigned>(pStats->nReordered), static_cast<unsigned>(pStats->nLate));
+	}
+#endif
+}
+
 void ArtNetNode::HandlePoll() {
 	const auto *const pArtPoll = reinterpret_cast<artnet::ArtPoll *>(m_pReceiveBuffer);
 
@@ -177,6 +193,8 @@ void ArtNetNode::HandlePoll() {
 		} else {
 			m_State.ArtDiagIpAddress = Network::Get()->GetBroadcastIp();
 		}
+
+		SendSequenceStats();
 	} else {
 		m_State.SendArtDiagData = false;
 		m_State.ArtDiagIpAddress = 0;
@@ -48,6 +48,7 @@
 #endif
 
 #include "lightsetparamsconst.h"
+#include "lightsetsequence.h"
 #include "lightset.h"
 
 #include "network.h"
@@ -96,6 +97,7 @@ ArtNetParams::ArtNetParams() {
 
 	pArtnetNode->GetLongNameDefault(reinterpret_cast<char *>(m_Params.aLongName));
 	m_Params.nFailSafe = static_cast<uint8_t>(lightset::FailSafe::HOLD);
+	m_Params.nSequenceWindow = lightset::sequence::WINDOW_MILLIS_DEFAULT;
 
 	DEBUG_PRINTF("s_nPortsMax=%u", s_nPortsMax);
 	DEBUG_EXIT
@@ -339,6 +341,19 @@ void ArtNetParams::callbackFunction(const char *pLine) {
 		SetBool(nValue8, Mask::DISABLE_MERGE_TIMEOUT);
 		return;
 	}
+
+	uint16_t nValue16;
+
+	if (Sscan::Uint16(pLine, LightSetParamsConst::SEQUENCE_WINDOW, nValue16) == Sscan::OK) {
+		m_Params.nSequenceWindow = nValue16;
+
+		if (nValue16 != lightset::sequence::WINDOW_MILLIS_DEFAULT) {
+			m_Params.nSetList |= Mask::SEQUENCE_WINDOW;
+		} else {
+			m_Params.nSetList &= ~Mask::SEQUENCE_WINDOW;
+		}
+		return;
+	}
 }
 
 void ArtNetParams::Builder(const struct Params *pParams, char *pBuffer, uint32_t nLength, uint32_t& nSize) {
@@ -427,6 +442,7 @@ void ArtNetParams::Builder(const struct Params *pParams, char *pBuffer, uint32_t
 	builder.AddComment("#");
 
 	builder.Add(LightSetParamsConst::DISABLE_MERGE_TIMEOUT, isMaskSet(Mask::DISABLE_MERGE_TIMEOUT));
+	builder.Add(LightSetParamsConst::SEQUENCE_WINDOW, m_Params.nSequenceWindow, isMaskSet(Mask::SEQUENCE_WINDOW));
 
 	nSize = builder.GetSize();
 
@@ -509,6 +525,10 @@ void ArtNetParams::Set() {
 		p->SetDisableMergeTimeout(true);
 	}
 
+	if (isMaskSet(Mask::SEQUENCE_WINDOW)) {
+		p->SetSequenceWindow(m_Params.nSequenceWindow);
+	}
+
 	DEBUG_EXIT
 }
 
@@ -574,4 +594,8 @@ void ArtNetParams::Dump() {
 	 */
 
 	printf(" %s=1 [Yes]\n", LightSetParamsConst::DISABLE_MERGE_TIMEOUT);
+
+	if (isMaskSet(Mask::SEQUENCE_WINDOW)) {
+		printf(" %s=%u\n", LightSetParamsConst::SEQUENCE_WINDOW, m_Params.nSequenceWindow);
+	}
 }
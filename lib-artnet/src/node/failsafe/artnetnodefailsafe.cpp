@@ -55,6 +55,7 @@ void ArtNetNode::FailSafePlayback() {
 
 	for (uint32_t nPortIndex = 0; nPortIndex < artnetnode::MAX_PORTS; nPortIndex++) {
 		if (m_Node.Port[nPortIndex].direction == lightset::PortDir::OUTPUT) {
+			lightset::Data::Invalidate(nPortIndex);
 			artnetnode::failsafe_read(nPortIndex, const_cast<uint8_t *>(lightset::Data::Backup(nPortIndex)));
 			lightset::Data::Output(m_pLightSet, nPortIndex);
 
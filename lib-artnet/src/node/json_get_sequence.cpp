@@ -0,0 +1,46 @@
+/**
+ * @file json_get_sequence.cpp
+ *
+ */
+/* Copyright (C) 2024 by Arjan van Vught mailto:info@gd32-dmx.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstdint>
+
+#include "artnetnode.h"
+#include "lightsetsequence.h"
+
+namespace remoteconfig {
+namespace artnet {
+static bool get_port(const uint32_t nPortIndex, uint16_t& nUniverse, const lightset::sequence::Stats *&pStats) {
+	if (!ArtNetNode::Get()->GetPortAddress(nPortIndex, nUniverse, lightset::PortDir::OUTPUT)) {
+		return false;
+	}
+
+	pStats = ArtNetNode::Get()->GetSequenceStats(nPortIndex);
+	return true;
+}
+
+uint32_t json_get_sequence(char *pOutBuffer, const uint32_t nOutBufferSize) {
+	return lightset::sequence::json_get(pOutBuffer, nOutBufferSize, artnetnode::MAX_PORTS, get_port);
+}
+}  // namespace artnet
+}  // namespace remoteconfig
@@ -0,0 +1,491 @@
+/**
+ * @file polltable.cpp
+ *
+ */
+/* Copyright (C) 2024 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "artnetpolltable.h"
+
+#include "hardware.h"
+
+#include "hosttest.h"
+
+/*
+ * The poll table at the supported maximum: 255 nodes with 4 output universes each.
+ * Node n reports the universes 4n .. 4n+3 modulo 512, so each universe has 1 or 2 subscribers
+ * and the universe table is full.
+ */
+static constexpr uint32_t NODES = artnet::POLL_TABLE_SIZE_ENRIES;
+static constexpr uint32_t UNIVERSES_PER_NODE = artnet::PORTS;
+static constexpr uint32_t UNIVERSES = artnet::POLL_TABLE_SIZE_UNIVERSES;
+static constexpr uint32_t TICK = artnet::POLL_TABLE_WHEEL_TICK_MILLIS;
+
+static_assert((NODES * UNIVERSES_PER_NODE) > UNIVERSES);
+
+/*
+ * The host Hardware, with a clock set by the test
+ */
+static uint32_t s_nMillis;
+
+Hardware *Hardware::s_pThis;
+
+Hardware::Hardware() {
+	s_pThis = this;
+}
+
+uint32_t Hardware::Millis() {
+	return s_nMillis;
+}
+
+static artnet::ArtPollReply s_Reply[NODES + 1];
+static uint32_t s_nLastReply[NODES + 1];	///< Millis of the last reply of the node, the model
+
+static uint32_t node_ip(const uint32_t nNode) {
+	return 0x0000000A | ((nNode + 1) << 24);	// 10.0.0.x, nNode + 1
+}
+
+static uint16_t node_universe(const uint32_t nNode, const uint32_t nPort) {
+	return static_cast<uint16_t>(((nNode * UNIVERSES_PER_NODE) + nPort) % UNIVERSES);
+}
+
+static void set_universes(artnet::ArtPollReply& reply, const uint16_t nFirstUniverse) {
+	reply.NetSwitch = static_cast<uint8_t>(nFirstUniverse >> 8);
+	reply.SubSwitch = static_cast<uint8_t>((nFirstUniverse >> 4) & 0x0F);
+
+	for (uint32_t nPort = 0; nPort < artnet::PORTS; nPort++) {
+		reply.PortTypes[nPort] = static_cast<uint8_t>(artnet::PortType::OUTPUT_ARTNET);
+		reply.SwOut[nPort] = static_cast<uint8_t>((nFirstUniverse + nPort) & 0x0F);
+	}
+}
+
+static void fill() {
+	for (uint32_t nNode = 0; nNode < NODES + 1; nNode++) {
+		auto& reply = s_Reply[nNode];
+		memset(&reply, 0, sizeof(reply));
+
+		const auto nIp = node_ip(nNode);
+		memcpy(reply.IPAddress, &nIp, 4);
+		reply.MAC[5] = static_cast<uint8_t>(rand());
+		snprintf(reinterpret_cast<char *>(reply.ShortName), artnet::SHORT_NAME_LENGTH, "Node %u", nNode);
+		snprintf(reinterpret_cast<char *>(reply.LongName), artnet::LONG_NAME_LENGTH, "Host test node %u", nNode);
+		reply.BindIndex = 1;
+
+		set_universes(reply, node_universe(nNode, 0));
+	}
+}
+
+static void reply(ArtNetPollTable& pollTable, const uint32_t nNode) {
+	pollTable.Add(&s_Reply[nNode]);
+	s_nLastReply[nNode] = s_nMillis;
+}
+
+/*
+ * Clean() advances one timer wheel tick per call, as it is called from the controller Run()
+ */
+static void advance(ArtNetPollTable& pollTable, const uint32_t nMillis) {
+	const auto nEnd = s_nMillis + nMillis;
+
+	while (s_nMillis != nEnd) {
+		s_nMillis += 100;
+		pollTable.Clean();
+	}
+}
+
+static int32_t find_node(const ArtNetPollTable& pollTable, const uint32_t nIp) {
+	const auto *pPollTable = pollTable.GetPollTable();
+
+	for (uint32_t nIndex = 0; nIndex < pollTable.GetPollTableEntries(); nIndex++) {
+		if (pPollTable[nIndex].IPAddress == nIp) {
+			return static_cast<int32_t>(nIndex);
+		}
+	}
+
+	return -1;
+}
+
+static bool has_ip(const artnet::PollTableUniverses *pTableUniverses, const uint32_t nIp) {
+	for (uint32_t nIndex = 0; nIndex < pTableUniverses->nCount; nIndex++) {
+		if (pTableUniverses->pIpAddresses[nIndex] == nIp) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+ * The subscriber list of each universe must match the universes of the nodes in the poll table
+ */
+static bool is_consistent(const ArtNetPollTable& pollTable) {
+	const auto *pPollTable = pollTable.GetPollTable();
+	uint32_t nSubscriptions = 0;
+
+	for (uint32_t nIndex = 0; nIndex < pollTable.GetPollTableEntries(); nIndex++) {
+		const auto& node = pPollTable[nIndex];
+
+		for (uint32_t nUniverse = 0; nUniverse < node.nUniversesCount; nUniverse++) {
+			const auto *pTableUniverses = pollTable.GetIpAddress(node.Universe[nUniverse].nUniverse);
+
+			if ((pTableUniverses == nullptr) || !has_ip(pTableUniverses, node.IPAddress)) {
+				return false;
+			}
+		}
+
+		nSubscriptions += node.nUniversesCount;
+	}
+
+	uint32_t nCount = 0;
+
+	for (uint32_t nUniverse = 0; nUniverse < (1U << 15); nUniverse++) {
+		const auto *pTableUniverses = pollTable.GetIpAddress(static_cast<uint16_t>(nUniverse));
+
+		if (pTableUniverses != nullptr) {
+			if ((pTableUniverses->nUniverse != nUniverse) || (pTableUniverses->nCount == 0)) {
+				return false;
+			}
+			nCount += pTableUniverses->nCount;
+		}
+	}
+
+	return nCount == nSubscriptions;
+}
+
+static void check_full() {
+	s_nMillis = 0;
+	auto *pPollTable = new ArtNetPollTable;
+
+	for (uint32_t nNode = 0; nNode < NODES; nNode++) {
+		reply(*pPollTable, nNode);
+	}
+
+	HOSTTEST_CHECK(pPollTable->GetPollTableEntries() == NODES);
+
+	// The table is full, the next node is not added
+	reply(*pPollTable, NODES);
+	HOSTTEST_CHECK(pPollTable->GetPollTableEntries() == NODES);
+	HOSTTEST_CHECK(find_node(*pPollTable, node_ip(NODES)) < 0);
+
+	uint32_t nFailed = 0;
+
+	for (uint32_t nUniverse = 0; nUniverse < UNIVERSES; nUniverse++) {
+		const auto *pTableUniverses = pPollTable->GetIpAddress(static_cast<uint16_t>(nUniverse));
+		const auto nFirst = nUniverse / UNIVERSES_PER_NODE;
+		const auto nSecond = nFirst + (UNIVERSES / UNIVERSES_PER_NODE);
+		const auto nExpected = (nSecond < NODES) ? 2U : 1U;
+
+		if ((pTableUniverses == nullptr) || (pTableUniverses->nCount != nExpected) || !has_ip(pTableUniverses, node_ip(nFirst))) {
+			nFailed++;
+		} else if ((nExpected == 2) && !has_ip(pTableUniverses, node_ip(nSecond))) {
+			nFailed++;
+		}
+	}
+
+	HOSTTEST_CHECK(nFailed == 0);
+	HOSTTEST_CHECK(pPollTable->GetIpAddress(static_cast<uint16_t>(UNIVERSES)) == nullptr);
+	HOSTTEST_CHECK(is_consistent(*pPollTable));
+
+	delete pPollTable;
+}
+
+/*
+ * The odd nodes stop replying, they must be removed after the timeout and the even nodes must stay
+ */
+static void check_aging() {
+	s_nMillis = 0;
+	auto *pPollTable = new ArtNetPollTable;
+
+	for (uint32_t nNode = 0; nNode < NODES; nNode++) {
+		reply(*pPollTable, nNode);
+	}
+
+	for (uint32_t nPoll = 0; nPoll < 4; nPoll++) {
+		advance(*pPollTable, artnet::POLL_INTERVAL_MILLIS);
+
+		for (uint32_t nNode = 0; nNode < NODES; nNode += 2) {
+			reply(*pPollTable, nNode);
+		}
+	}
+
+	HOSTTEST_CHECK(pPollTable->GetPollTableEntries() == (NODES + 1) / 2);
+
+	uint32_t nFailed = 0;
+
+	for (uint32_t nNode = 0; nNode < NODES; nNode++) {
+		const auto isFound = find_node(*pPollTable, node_ip(nNode)) >= 0;
+
+		if (isFound != ((nNode & 1) == 0)) {
+			nFailed++;
+		}
+	}
+
+	HOSTTEST_CHECK(nFailed == 0);
+	HOSTTEST_CHECK(is_consistent(*pPollTable));
+
+	// Nobody replies
+	advance(*pPollTable, artnet::POLL_TABLE_TIMEOUT_MILLIS + 2 * TICK);
+
+	HOSTTEST_CHECK(pPollTable->GetPollTableEntries() == 0);
+	HOSTTEST_CHECK(pPollTable->GetIpAddress(0) == nullptr);
+
+	delete pPollTable;
+}
+
+/*
+ * A node which is patched to other universes: the old universes are dropped with its first reply after the timeout
+ */
+static void check_repatch() {
+	s_nMillis = 0;
+	auto *pPollTable = new ArtNetPollTable;
+
+	fill();
+	reply(*pPollTable, 0);
+	reply(*pPollTable, 1);
+
+	set_universes(s_Reply[0], 0x100);
+
+	for (uint32_t nPoll = 0; nPoll < 3; nPoll++) {
+		advance(*pPollTable, artnet::POLL_INTERVAL_MILLIS);
+		reply(*pPollTable, 0);
+		reply(*pPollTable, 1);
+	}
+
+	const auto nIndex = find_node(*pPollTable, node_ip(0));
+	HOSTTEST_CHECK(nIndex >= 0);
+
+	if (nIndex >= 0) {
+		HOSTTEST_CHECK(pPollTable->GetPollTable()[nIndex].nUniversesCount == artnet::PORTS);
+	}
+
+	HOSTTEST_CHECK(pPollTable->GetIpAddress(0) == nullptr);
+	HOSTTEST_CHECK(pPollTable->GetIpAddress(0x100) != nullptr);
+	HOSTTEST_CHECK(pPollTable->GetIpAddress(4) != nullptr);
+	HOSTTEST_CHECK(is_consistent(*pPollTable));
+
+	delete pPollTable;
+	fill();
+}
+
+/*
+ * Random replies against the model: a node which replied within the timeout must be in the table,
+ * a node must be removed at most two wheel ticks after the timeout.
+ */
+static void check_random() {
+	s_nMillis = 0;
+	auto *pPollTable = new ArtNetPollTable;
+
+	for (uint32_t nNode = 0; nNode < NODES; nNode++) {
+		s_nLastReply[nNode] = UINT32_MAX;
+	}
+
+	uint32_t nFailed = 0;
+	uint32_t nInconsistent = 0;
+
+	for (uint32_t nSecond = 0; nSecond < 600; nSecond++) {
+		advance(*pPollTable, TICK);
+
+		for (uint32_t nNode = 0; nNode < NODES; nNode++) {
+			if ((rand() % 16) == 0) {
+				reply(*pPollTable, nNode);
+			}
+		}
+
+		for (uint32_t nNode = 0; nNode < NODES; nNode++) {
+			const auto isFound = find_node(*pPollTable, node_ip(nNode)) >= 0;
+
+			if (s_nLastReply[nNode] == UINT32_MAX) {
+				nFailed += isFound ? 1 : 0;
+				continue;
+			}
+
+			const auto nElapsed = s_nMillis - s_nLastReply[nNode];
+
+			if ((nElapsed <= artnet::POLL_TABLE_TIMEOUT_MILLIS) && !isFound) {
+				nFailed++;
+			}
+
+			if ((nElapsed > artnet::POLL_TABLE_TIMEOUT_MILLIS + 2 * TICK) && isFound) {
+				nFailed++;
+			}
+		}
+
+		if ((nSecond % 60) == 0) {
+			nInconsistent += is_consistent(*pPollTable) ? 0 : 1;
+		}
+	}
+
+	HOSTTEST_CHECK(nFailed == 0);
+	HOSTTEST_CHECK(nInconsistent == 0);
+	HOSTTEST_CHECK(is_consistent(*pPollTable));
+
+	delete pPollTable;
+}
+
+/*
+ * The universe lookup before the hash: a linear scan of the universe table
+ */
+__attribute__((noinline)) static const artnet::PollTableUniverses *get_ip_address_linear(const artnet::PollTableUniverses *pTableUniverses, const uint32_t nEntries, const uint16_t nUniverse) {
+	for (uint32_t nEntry = 0; nEntry < nEntries; nEntry++) {
+		if (pTableUniverses[nEntry].nUniverse == nUniverse) {
+			return &pTableUniverses[nEntry];
+		}
+	}
+
+	return nullptr;
+}
+
+static void bench() {
+	printf("Poll table, %u nodes x %u universes, %u universes\n", NODES, UNIVERSES_PER_NODE, UNIVERSES);
+
+	s_nMillis = 0;
+	auto *pPollTable = new ArtNetPollTable;
+
+	for (uint32_t nNode = 0; nNode < NODES; nNode++) {
+		reply(*pPollTable, nNode);
+	}
+
+	// The universe table in the order of insertion, as the linear scan walked it
+	static artnet::PollTableUniverses tableUniverses[UNIVERSES];
+	uint32_t nEntries = 0;
+
+	for (uint32_t nNode = 0; nNode < NODES; nNode++) {
+		for (uint32_t nPort = 0; nPort < UNIVERSES_PER_NODE; nPort++) {
+			const auto *p = pPollTable->GetIpAddress(node_universe(nNode, nPort));
+
+			if ((p != nullptr) && (get_ip_address_linear(tableUniverses, nEntries, p->nUniverse) == nullptr)) {
+				tableUniverses[nEntries++] = *p;
+			}
+		}
+	}
+
+	// The controller sends the active universes in a random order
+	static uint16_t universes[UNIVERSES];
+
+	for (uint32_t nIndex = 0; nIndex < UNIVERSES; nIndex++) {
+		universes[nIndex] = static_cast<uint16_t>(nIndex);
+	}
+
+	for (uint32_t nIndex = UNIVERSES - 1; nIndex > 0; nIndex--) {
+		const auto nOther = static_cast<uint32_t>(rand()) % (nIndex + 1);
+		const auto nUniverse = universes[nIndex];
+		universes[nIndex] = universes[nOther];
+		universes[nOther] = nUniverse;
+	}
+
+	uint32_t nNext = 0;
+
+	const auto fLinear = hosttest::bench("GetIpAddress, linear scan (before)", 1000000, [&]() {
+		hosttest::keep(get_ip_address_linear(tableUniverses, nEntries, universes[nNext++ % UNIVERSES]));
+	});
+
+	const auto fHash = hosttest::bench("GetIpAddress, hash", 1000000, [&]() {
+		hosttest::keep(pPollTable->GetIpAddress(universes[nNext++ % UNIVERSES]));
+	});
+
+	printf("  %-44s %12.1fx\n", "speedup", fLinear / fHash);
+
+	hosttest::bench("GetIpAddress, not found", 1000000, [&]() {
+		hosttest::keep(pPollTable->GetIpAddress(static_cast<uint16_t>(UNIVERSES + (nNext++ % UNIVERSES))));
+	});
+
+	/*
+	 * Steady state: all nodes reply to each ArtPoll, Clean() runs every 100 ms
+	 */
+	const auto fPoll = hosttest::bench("Poll interval, 255 replies + 80 x Clean()", 200, [&]() {
+		advance(*pPollTable, artnet::POLL_INTERVAL_MILLIS);
+
+		for (uint32_t nNode = 0; nNode < NODES; nNode++) {
+			reply(*pPollTable, nNode);
+		}
+	});
+
+	printf("  %-44s %12.1f ns\n", "per ArtPollReply", fPoll / NODES);
+
+	hosttest::Histogram add;
+
+	for (uint32_t nPoll = 0; nPoll < 100; nPoll++) {
+		advance(*pPollTable, artnet::POLL_INTERVAL_MILLIS);
+
+		for (uint32_t nNode = 0; nNode < NODES; nNode++) {
+			const auto nStart = hosttest::nanos();
+			reply(*pPollTable, nNode);
+			add.Add(hosttest::nanos() - nStart);
+		}
+	}
+
+	add.Print("Add(), refresh");
+
+	/*
+	 * All nodes come on-line and go off-line again
+	 */
+	hosttest::Histogram clean;
+	hosttest::Histogram insert;
+
+	const auto fChurn = hosttest::bench("Fill and expire 255 nodes", 100, [&]() {
+		advance(*pPollTable, artnet::POLL_TABLE_TIMEOUT_MILLIS + 2 * TICK);
+
+		for (uint32_t nNode = 0; nNode < NODES; nNode++) {
+			const auto nStart = hosttest::nanos();
+			reply(*pPollTable, nNode);
+			insert.Add(hosttest::nanos() - nStart);
+		}
+
+		const auto nEnd = s_nMillis + artnet::POLL_TABLE_TIMEOUT_MILLIS + 2 * TICK;
+
+		while (s_nMillis != nEnd) {
+			s_nMillis += TICK;
+			const auto nStart = hosttest::nanos();
+			pPollTable->Clean();
+			clean.Add(hosttest::nanos() - nStart);
+		}
+	});
+
+	printf("  %-44s %12.1f ns\n", "per node", fChurn / NODES);
+
+	insert.Print("Add(), new node");
+	clean.Print("Clean(), per tick");
+
+	delete pPollTable;
+}
+
+int main(int argc, char **argv) {
+	srand(1);
+
+	Hardware hardware;
+
+	fill();
+
+	check_full();
+	check_aging();
+	check_repatch();
+	check_random();
+
+	if (hosttest::is_bench(argc, argv)) {
+		bench();
+	}
+
+	return hosttest::exit_code("polltable");
+}
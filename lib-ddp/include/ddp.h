@@ -42,10 +42,11 @@ struct Header {
 static constexpr auto HEADER_LEN = (sizeof(struct Header));
 static constexpr auto DATA_LEN = 1440;
 static constexpr auto PACKET_LEN = (HEADER_LEN + DATA_LEN);
+static constexpr auto TIMECODE_LEN = 4;	///< Precedes the data when flags1::TIME is set
 
 struct Packet {
 	struct Header header;
-	uint8_t data[DATA_LEN];
+	uint8_t data[TIMECODE_LEN + DATA_LEN];
 }__attribute__((packed));
 
 namespace flags1 {
@@ -30,6 +30,7 @@
 #include <algorithm>
 
 #include "ddp.h"
+#include "ddpdisplayoutput.h"
 
 #include "lightset.h"
 
@@ -60,6 +61,19 @@ namespace dmx {
 }  // namespace dmx
 static constexpr uint32_t MAX_PORTS = configuration::pixel::MAX_PORTS + configuration::dmx::MAX_PORTS;
 }  // namespace configuration
+namespace timecode {
+static constexpr int32_t LATE = 66;			///< 1 ms in 1/65536 seconds
+static constexpr int32_t MAX_HOLD = 65536;	///< 1 second, further ahead the clocks are not in sync
+static constexpr uint32_t MAX_RANGES = 16;	///< The received byte ranges of a held frame
+}  // namespace timecode
+
+struct PresentStats {
+	uint32_t nScheduled;	///< Frames held until their timecode
+	uint32_t nLate;			///< The timecode had already passed at PUSH
+	uint32_t nDropped;		///< A held frame which is replaced before its timecode
+	uint32_t nOutOfRange;	///< The timecode is too far ahead, presented at PUSH
+	uint32_t nFragmented;	///< A packet which did not fit in the ranges of the frame, written directly
+};
 }  // namespace ddpdisplay
 
 static_assert(ddpdisplay::lightset::MAX_PORTS == ddpdisplay::configuration::dmx::MAX_PORTS + ddpdisplay::configuration::pixel::MAX_PORTS * 4, "Configuration errror");
@@ -72,12 +86,19 @@ public:
 	void Start();
 	void Stop();
 
-	void Run();
+	void Run() {
+		if (m_bPresentPending) {
+			PresentPending();
+		}
+
+		HandleRequest();
+	}
 
 	void Print();
 
 	void SetCount(uint32_t nCount, uint32_t nChannelsPerPixel, uint32_t nActivePorts) {
 		m_nCount = nCount;
+		m_nChannelsPerPixel = nChannelsPerPixel;
 		m_nStripDataLength = nCount * nChannelsPerPixel;
 		m_nLightSetDataMaxLength = (nChannelsPerPixel == 4 ? 512U : 510U);
 		m_nActivePorts = std::min(nActivePorts, ddpdisplay::configuration::pixel::MAX_PORTS);
@@ -88,7 +109,7 @@ public:
 	}
 
 	uint32_t GetChannelsPerPixel() const {
-		return m_nStripDataLength / m_nCount;
+		return m_nChannelsPerPixel;
 	}
 
 	void SetOutput(LightSet *pLightSet) {
@@ -99,6 +120,18 @@ public:
 		return m_pLightSet;
 	}
 
+	/**
+	 * The pixel ports are written at the DDP offset directly into the pixel output.
+	 * The DMX ports remain on the LightSet.
+	 */
+	void SetPixelOutput(DdpDisplayOutput *pPixelOutput) {
+		m_pPixelOutput = pPixelOutput;
+	}
+
+	const ddpdisplay::PresentStats& GetPresentStats() const {
+		return m_PresentStats;
+	}
+
 	static DdpDisplay* Get() {
 		return s_pThis;
 	}
@@ -106,18 +139,62 @@ public:
 private:
 	void CalculateOffsets();
 	void HandleQuery();
+	void HandleRequest();
 	void HandleData();
+	void Scatter(uint32_t nOffset, const uint8_t *receiveBuffer, uint32_t nLength);
+	void Present();
+	void FrameStoreInit();
+	bool FrameAdd(uint32_t nOffset, const uint8_t *pData, uint32_t nLength);
+	void PresentPending();
+	void ScatterFrame(uint32_t nIndex);
+	void HandlePixelData(uint32_t& nOffset, const uint8_t *&pData, uint32_t& nLength);
+	void HandleDmxData(uint32_t nOffset, const uint8_t *pData, uint32_t nLength);
+	void SetPixels(const uint32_t nPortIndex, const uint32_t nPortOffset, const uint8_t *pData, uint32_t nLength);
+	void SetPartial(const uint32_t nPortIndex, const uint32_t nPixelIndex, const uint32_t nChannel, const uint8_t *pData, const uint32_t nLength);
 
 private:
 	uint8_t m_macAddress[network::MAC_SIZE];
 	int32_t m_nHandle { -1 };
 	uint32_t m_nFromIp { 0 };
 	uint32_t m_nCount { 0 };
+	uint32_t m_nChannelsPerPixel { 0 };
 	uint32_t m_nStripDataLength { 0 };
 	uint32_t m_nLightSetDataMaxLength { 0 };
 	uint32_t m_nActivePorts { 0 };
 
 	LightSet *m_pLightSet { nullptr };
+	DdpDisplayOutput *m_pPixelOutput { nullptr };
+
+	/*
+	 * A pixel which is split over two packets
+	 */
+	struct Partial {
+		uint32_t nPixelIndex;
+		uint32_t nMask;		///< Bit n is set when channel n has been received, 0 : empty
+		uint8_t data[4];
+	};
+
+	Partial m_Partial[ddpdisplay::configuration::pixel::MAX_PORTS] {};
+
+	/*
+	 * Frame store for the packets with a timecode, allocated in Start.
+	 * Only the byte ranges which are received are written to the output.
+	 */
+	struct Frame {
+		uint8_t *pData;
+		uint32_t nRanges;
+		struct {
+			uint32_t nBegin;
+			uint32_t nEnd;
+		} range[ddpdisplay::timecode::MAX_RANGES];
+	};
+
+	uint8_t *m_pFrameStore { nullptr };
+	Frame m_Frame[2] {};	///< [0] assembly, [1] held until m_nPresentTimecode
+	uint32_t m_nFrameLength { 0 };
+	uint32_t m_nPresentTimecode { 0 };
+	bool m_bPresentPending { false };
+	ddpdisplay::PresentStats m_PresentStats {};
 
 	ddp::Packet m_Packet;
 
@@ -0,0 +1,53 @@
+/**
+ * @file ddpdisplayoutput.h
+ *
+ */
+/* Copyright (C) 2024 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef DDPDISPLAYOUTPUT_H_
+#define DDPDISPLAYOUTPUT_H_
+
+#include <cstdint>
+
+/**
+ * Pixel output which is addressed with the DDP offset directly,
+ * without the universe staging of lightset::Data.
+ */
+class DdpDisplayOutput {
+public:
+	virtual ~DdpDisplayOutput() = default;
+
+	/**
+	 * Write the pixels into the frame buffer, nothing is sent.
+	 * @param nPortIndex pixel port
+	 * @param nPixelIndex first pixel (group) on the port
+	 * @param pData channels per pixel x nPixels
+	 * @param nPixels
+	 */
+	virtual void SetPixels(const uint32_t nPortIndex, const uint32_t nPixelIndex, const uint8_t *pData, const uint32_t nPixels)=0;
+	/**
+	 * Send the frame buffer, called for the PUSH flag
+	 */
+	virtual void Update()=0;
+};
+
+#endif /* DDPDISPLAYOUTPUT_H_ */
@@ -25,6 +25,9 @@
 
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <sys/time.h>
 #include <cassert>
 
 #include "ddpdisplay.h"
@@ -34,6 +37,7 @@
 
 #include "hardware.h"
 #include "network.h"
+#include "ntp.h"
 
 #include "debug.h"
 
@@ -93,6 +97,9 @@ DdpDisplay::~DdpDisplay() {
 
 	Stop();
 
+	delete[] m_pFrameStore;
+	m_pFrameStore = nullptr;
+
 	DEBUG_EXIT
 }
 
@@ -129,6 +136,7 @@ void DdpDisplay::CalculateOffsets() {
 void DdpDisplay::Start() {
 	DEBUG_ENTRY
 	assert(m_pLightSet != nullptr);
+	assert((m_nChannelsPerPixel == 3) || (m_nChannelsPerPixel == 4));
 
 	m_nHandle = Network::Get()->Begin(ddp::UDP_PORT);
 	assert(m_nHandle != -1);
@@ -144,6 +152,7 @@ void DdpDisplay::Start() {
 	debug_dump(&m_Packet, HEADER_LEN + json::size::START);
 
 	CalculateOffsets();
+	FrameStoreInit();
 	DEBUG_EXIT
 }
 
@@ -214,17 +223,113 @@ void DdpDisplay::HandleQuery() {
 	DEBUG_EXIT
 }
 
-void DdpDisplay::HandleData() {
-	auto nOffset = static_cast<uint32_t>(
-			  (m_Packet.header.offset[0] << 24)
-			| (m_Packet.header.offset[1] << 16)
-			| (m_Packet.header.offset[2] << 8)
-			|  m_Packet.header.offset[3]);
+/*
+ * The pixel ports are addressed with the DDP offset: port = offset / strip length.
+ * A packet can start anywhere, packets can arrive in any order.
+ */
+void DdpDisplay::SetPartial(const uint32_t nPortIndex, const uint32_t nPixelIndex, const uint32_t nChannel, const uint8_t *pData, const uint32_t nLength) {
+	assert((nChannel + nLength) <= m_nChannelsPerPixel);
+
+	auto& partial = m_Partial[nPortIndex];
+
+	if (partial.nPixelIndex != nPixelIndex) {
+		partial.nPixelIndex = nPixelIndex;
+		partial.nMask = 0;
+	}
+
+	for (uint32_t i = 0; i < nLength; i++) {
+		partial.data[nChannel + i] = pData[i];
+		partial.nMask |= (1U << (nChannel + i));
+	}
+
+	if (partial.nMask == ((1U << m_nChannelsPerPixel) - 1U)) {
+		m_pPixelOutput->SetPixels(nPortIndex, nPixelIndex, partial.data, 1);
+		partial.nMask = 0;
+	}
+}
 
-	auto nLength = ((static_cast<uint32_t>(m_Packet.header.len[0]) << 8) | m_Packet.header.len[1]);
-	const auto *receiveBuffer = m_Packet.data;
+void DdpDisplay::SetPixels(const uint32_t nPortIndex, const uint32_t nPortOffset, const uint8_t *pData, uint32_t nLength) {
+	auto nPixelIndex = nPortOffset / m_nChannelsPerPixel;
+	const auto nChannel = nPortOffset - (nPixelIndex * m_nChannelsPerPixel);
 
-//	DEBUG_PRINTF("nOffset=%u, nLength=%u, s_nOffsetCompare[0]=%u", nOffset, nLength, s_nOffsetCompare[0]);
+	if (nChannel != 0) {
+		const auto nPartialLength = std::min(nLength, m_nChannelsPerPixel - nChannel);
+
+		SetPartial(nPortIndex, nPixelIndex, nChannel, pData, nPartialLength);
+
+		pData += nPartialLength;
+		nLength -= nPartialLength;
+		nPixelIndex++;
+	}
+
+	const auto nPixels = nLength / m_nChannelsPerPixel;
+
+	if (nPixels != 0) {
+		m_pPixelOutput->SetPixels(nPortIndex, nPixelIndex, pData, nPixels);
+
+		const auto nPixelsLength = nPixels * m_nChannelsPerPixel;
+		pData += nPixelsLength;
+		nLength -= nPixelsLength;
+		nPixelIndex += nPixels;
+	}
+
+	if (nLength != 0) {
+		SetPartial(nPortIndex, nPixelIndex, 0, pData, nLength);
+	}
+}
+
+void DdpDisplay::HandlePixelData(uint32_t& nOffset, const uint8_t *&pData, uint32_t& nLength) {
+	const auto nPixelDataEnd = ddpdisplay::configuration::pixel::MAX_PORTS * m_nStripDataLength;
+
+	while ((nLength != 0) && (nOffset < nPixelDataEnd)) {
+		const auto nPortIndex = nOffset / m_nStripDataLength;
+		const auto nPortOffset = nOffset - (nPortIndex * m_nStripDataLength);
+		const auto nPortLength = std::min(nLength, m_nStripDataLength - nPortOffset);
+
+		if (nPortIndex < m_nActivePorts) {
+			SetPixels(nPortIndex, nPortOffset, pData, nPortLength);
+		}
+
+		pData += nPortLength;
+		nOffset += nPortLength;
+		nLength -= nPortLength;
+	}
+}
+
+/*
+ * The DMX ports follow the pixel ports, each with a universe size.
+ */
+void DdpDisplay::HandleDmxData(uint32_t nOffset, const uint8_t *pData, uint32_t nLength) {
+	const auto nDmxDataBegin = ddpdisplay::configuration::pixel::MAX_PORTS * m_nStripDataLength;
+	const auto nDmxDataEnd = nDmxDataBegin + ddpdisplay::configuration::dmx::MAX_PORTS * lightset::dmx::UNIVERSE_SIZE;
+
+	while ((nLength != 0) && (nOffset >= nDmxDataBegin) && (nOffset < nDmxDataEnd)) {
+		const auto nDmxPortIndex = (nOffset - nDmxDataBegin) / lightset::dmx::UNIVERSE_SIZE;
+		const auto nSlot = (nOffset - nDmxDataBegin) - (nDmxPortIndex * lightset::dmx::UNIVERSE_SIZE);
+		const auto nSlots = std::min(nLength, lightset::dmx::UNIVERSE_SIZE - nSlot);
+		const auto nLightSetPortIndex = ddpdisplay::lightset::MAX_PORTS - ddpdisplay::configuration::dmx::MAX_PORTS + nDmxPortIndex;
+
+		if (nSlot == 0) {
+			lightset::Data::SetSourceA(nLightSetPortIndex, pData, nSlots);
+		} else {
+			uint8_t data[lightset::dmx::UNIVERSE_SIZE];
+			memcpy(data, lightset::Data::Backup(nLightSetPortIndex), nSlot);
+			memcpy(&data[nSlot], pData, nSlots);
+			lightset::Data::SetSourceA(nLightSetPortIndex, data, nSlot + nSlots);
+		}
+
+		pData += nSlots;
+		nOffset += nSlots;
+		nLength -= nSlots;
+	}
+}
+
+void DdpDisplay::Scatter(uint32_t nOffset, const uint8_t *receiveBuffer, uint32_t nLength) {
+	if (m_pPixelOutput != nullptr) {
+		HandlePixelData(nOffset, receiveBuffer, nLength);
+		HandleDmxData(nOffset, receiveBuffer, nLength);
+		return;
+	}
 
 	uint32_t nLightSetPortIndex = 0;
 	uint32_t nReceiverBufferIndex = 0;
@@ -278,16 +383,196 @@ void DdpDisplay::HandleData() {
 //			DEBUG_PRINTF("nPortIndex=%u, nOffset=%u, nLength=%u, nLightSetLength=%u, nLightSetPortIndex=%u", nPortIndex, nOffset, nLength, nLightSetLength, nLightSetPortIndex);
 		}
 	}
+}
 
-	if ((m_Packet.header.flags1 & flags1::PUSH) == flags1::PUSH) {
-		for (uint32_t nLightSetPortIndex = 0; nLightSetPortIndex < ddpdisplay::lightset::MAX_PORTS; nLightSetPortIndex++) {
+void DdpDisplay::Present() {
+	if (m_pPixelOutput != nullptr) {
+		m_pPixelOutput->Update();
+
+		for (auto nLightSetPortIndex = ddpdisplay::lightset::MAX_PORTS - ddpdisplay::configuration::dmx::MAX_PORTS; nLightSetPortIndex < ddpdisplay::lightset::MAX_PORTS; nLightSetPortIndex++) {
 			lightset::Data::Output(m_pLightSet, nLightSetPortIndex);
 			lightset::Data::ClearLength(nLightSetPortIndex);
 		}
+
+		return;
+	}
+
+	for (uint32_t nLightSetPortIndex = 0; nLightSetPortIndex < ddpdisplay::lightset::MAX_PORTS; nLightSetPortIndex++) {
+		lightset::Data::Output(m_pLightSet, nLightSetPortIndex);
+		lightset::Data::ClearLength(nLightSetPortIndex);
 	}
 }
 
-void DdpDisplay::Run() {
+/*
+ * Scheduled presentation
+ *
+ * The DDP timecode is the middle 32 bits of an NTP timestamp: 16 bits seconds and 16 bits fraction.
+ * It is compared with the node clock, which is synchronized with NTP or PTP.
+ * The packets with a timecode are assembled in the frame store, and a completed frame is held until its timecode.
+ * The packets without a timecode are written directly, as are the packets of a frame which is presented at PUSH.
+ */
+static uint32_t timecode_now() {
+	struct timeval tv;
+	gettimeofday(&tv, nullptr);
+
+	const auto nSeconds = static_cast<uint32_t>(tv.tv_sec) + ntp::JAN_1970;
+	const auto nFraction = static_cast<uint32_t>((static_cast<uint64_t>(tv.tv_usec) << 16) / 1000000U);
+
+	return (nSeconds << 16) | nFraction;
+}
+
+void DdpDisplay::FrameStoreInit() {
+	DEBUG_ENTRY
+
+	const auto nFrameLength = s_nOffsetCompare[ddpdisplay::configuration::MAX_PORTS - 1];
+
+	if ((m_pFrameStore != nullptr) && (nFrameLength == m_nFrameLength)) {
+		DEBUG_EXIT
+		return;
+	}
+
+	delete[] m_pFrameStore;
+
+	m_nFrameLength = nFrameLength;
+	m_pFrameStore = new uint8_t[2 * m_nFrameLength];
+	assert(m_pFrameStore != nullptr);
+
+	m_Frame[0].pData = m_pFrameStore;
+	m_Frame[0].nRanges = 0;
+	m_Frame[1].pData = m_pFrameStore + m_nFrameLength;
+	m_Frame[1].nRanges = 0;
+	m_bPresentPending = false;
+
+	DEBUG_PRINTF("m_nFrameLength=%u", m_nFrameLength);
+	DEBUG_EXIT
+}
+
+/**
+ * Copies the packet into the assembly frame, overlapping and adjacent ranges are merged.
+ * @return false when the frame has no free range
+ */
+bool DdpDisplay::FrameAdd(uint32_t nOffset, const uint8_t *pData, uint32_t nLength) {
+	if (nOffset >= m_nFrameLength) {
+		return true;
+	}
+
+	nLength = std::min(nLength, m_nFrameLength - nOffset);
+
+	auto& frame = m_Frame[0];
+	auto nBegin = nOffset;
+	auto nEnd = nOffset + nLength;
+	uint32_t i = 0;
+
+	while (i < frame.nRanges) {
+		auto& range = frame.range[i];
+
+		if ((nBegin <= range.nEnd) && (nEnd >= range.nBegin)) {
+			nBegin = std::min(nBegin, range.nBegin);
+			nEnd = std::max(nEnd, range.nEnd);
+			range = frame.range[--frame.nRanges];
+			continue;
+		}
+
+		i++;
+	}
+
+	if (frame.nRanges == ddpdisplay::timecode::MAX_RANGES) {
+		return false;
+	}
+
+	frame.range[frame.nRanges].nBegin = nBegin;
+	frame.range[frame.nRanges].nEnd = nEnd;
+	frame.nRanges++;
+
+	memcpy(&frame.pData[nOffset], pData, nLength);
+
+	return true;
+}
+
+void DdpDisplay::ScatterFrame(const uint32_t nIndex) {
+	auto& frame = m_Frame[nIndex];
+
+	for (uint32_t i = 0; i < frame.nRanges; i++) {
+		const auto& range = frame.range[i];
+		Scatter(range.nBegin, &frame.pData[range.nBegin], range.nEnd - range.nBegin);
+	}
+
+	frame.nRanges = 0;
+}
+
+void DdpDisplay::PresentPending() {
+	if (static_cast<int32_t>(m_nPresentTimecode - timecode_now()) > 0) {
+		return;
+	}
+
+	m_bPresentPending = false;
+	ScatterFrame(1);
+	Present();
+}
+
+void DdpDisplay::HandleData() {
+	auto nOffset = static_cast<uint32_t>(
+			  (m_Packet.header.offset[0] << 24)
+			| (m_Packet.header.offset[1] << 16)
+			| (m_Packet.header.offset[2] << 8)
+			|  m_Packet.header.offset[3]);
+
+	auto nLength = std::min(((static_cast<uint32_t>(m_Packet.header.len[0]) << 8) | m_Packet.header.len[1]), static_cast<uint32_t>(ddp::DATA_LEN));
+	const auto *pData = m_Packet.data;
+
+	const auto isPush = ((m_Packet.header.flags1 & flags1::PUSH) == flags1::PUSH);
+
+	if ((m_Packet.header.flags1 & flags1::TIME) != flags1::TIME) {
+		Scatter(nOffset, pData, nLength);
+
+		if (isPush) {
+			Present();
+		}
+
+		return;
+	}
+
+	const auto nTimecode = static_cast<uint32_t>((pData[0] << 24) | (pData[1] << 16) | (pData[2] << 8) | pData[3]);
+	pData += TIMECODE_LEN;
+
+	if (!FrameAdd(nOffset, pData, nLength)) {
+		m_PresentStats.nFragmented++;
+		Scatter(nOffset, pData, nLength);
+	}
+
+	if (!isPush) {
+		return;
+	}
+
+	// A held frame which is replaced before its timecode is the base for the next frame, as a frame can be partial
+	if (m_bPresentPending) {
+		m_bPresentPending = false;
+		m_PresentStats.nDropped++;
+		ScatterFrame(1);
+	}
+
+	const auto nDiff = static_cast<int32_t>(nTimecode - timecode_now());
+
+	if ((nDiff <= 0) || (nDiff > ddpdisplay::timecode::MAX_HOLD)) {
+		if (nDiff < -ddpdisplay::timecode::LATE) {
+			m_PresentStats.nLate++;
+		} else if (nDiff > ddpdisplay::timecode::MAX_HOLD) {
+			m_PresentStats.nOutOfRange++;
+		}
+
+		ScatterFrame(0);
+		Present();
+		return;
+	}
+
+	std::swap(m_Frame[0], m_Frame[1]);
+
+	m_nPresentTimecode = nTimecode;
+	m_bPresentPending = true;
+	m_PresentStats.nScheduled++;
+}
+
+void DdpDisplay::HandleRequest() {
 	uint16_t nFromPort;
 
 	const auto nBytesReceived = Network::Get()->RecvFrom(m_nHandle, &m_Packet, sizeof(m_Packet), &m_nFromIp, &nFromPort);
@@ -322,4 +607,8 @@ void DdpDisplay::Print() {
 	printf(" Count             : %u\n", m_nCount);
 	printf(" Channels per pixel: %u\n", GetChannelsPerPixel());
 	printf(" Active ports      : %u\n", m_nActivePorts);
+	printf(" Pixel output      : %s\n", m_pPixelOutput != nullptr ? "Direct" : "LightSet");
+
+	printf(" Timecode          : scheduled %u, late %u, dropped %u, out of range %u, fragmented %u\n",
+			m_PresentStats.nScheduled, m_PresentStats.nLate, m_PresentStats.nDropped, m_PresentStats.nOutOfRange, m_PresentStats.nFragmented);
 }
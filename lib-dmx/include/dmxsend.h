@@ -75,6 +75,7 @@ public:
 		}
 
 		m_nStarted = static_cast<uint8_t>(m_nStarted & ~(1U << nPortIndex));
+		m_nDataValid = static_cast<uint8_t>(m_nDataValid & ~(1U << nPortIndex));
 
 		Dmx::Get()->SetPortDirection(nPortIndex, dmx::PortDirection::OUTP, false);
 
@@ -92,9 +93,25 @@ public:
 			Dmx::Get()->SetSendDataWithoutSC(nPortIndex, pData, nLength);
 			Dmx::Get()->StartOutput(nPortIndex);
 			hal::panel_led_on(hal::panelled::PORT_A_TX << nPortIndex);
+			m_nDataValid = static_cast<uint8_t>(m_nDataValid | (1U << nPortIndex));
 		}
 	}
 
+	void SetDataRange(const uint32_t nPortIndex, const uint8_t *pData, uint32_t nLength, [[maybe_unused]] const uint32_t nOffset, const uint32_t nCount, const bool doUpdate) override {
+		assert(nPortIndex < CHAR_BIT);
+
+		/*
+		 * With continuous output the identical data is already being transmitted.
+		 * A delta output must be triggered for each frame.
+		 */
+		if ((nCount == 0) && (doUpdate) && (is_started(m_nDataValid, nPortIndex)) && (Dmx::Get()->GetOutputStyle(nPortIndex) == dmx::OutputStyle::CONTINOUS)) {
+			hal::panel_led_on(hal::panelled::PORT_A_TX << nPortIndex);
+			return;
+		}
+
+		SetData(nPortIndex, pData, nLength, doUpdate);
+	}
+
 	void Sync(uint32_t const nPortIndex) override {
 		assert(lightset::Data::GetLength(nPortIndex) != 0);
 		Dmx::Get()->SetSendDataWithoutSC(nPortIndex, lightset::Data::Backup(nPortIndex), lightset::Data::GetLength(nPortIndex));
@@ -126,10 +143,12 @@ public:
 
 	void Blackout([[maybe_unused]] bool bBlackout) override {
 		Dmx::Get()->Blackout();
+		m_nDataValid = 0;
 	}
 
 	void FullOn() override {
 		Dmx::Get()->FullOn();
+		m_nDataValid = 0;
 	}
 
 	void Print() override {
@@ -147,6 +166,7 @@ private:
 
 private:
 	uint8_t m_nStarted { 0 };
+	uint8_t m_nDataValid { 0 };
 };
 
 #endif /* DMXSEND_H_ */
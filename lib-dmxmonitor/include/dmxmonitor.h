@@ -29,6 +29,7 @@
 #include <cstdint>
 
 #include "lightset.h"
+#include "lightsetsequence.h"
 
 #include "debug.h"
 
@@ -127,6 +128,21 @@ public:
 		return m_Format;
 	}
 
+	/**
+	 * Shows the sequence statistics of the node port below the data
+	 */
+	void SetSequenceStats(const uint32_t nPortIndex, const lightset::sequence::Stats *pStats) {
+#if defined (__linux__) || defined(__APPLE__)
+		if (nPortIndex < dmxmonitor::output::text::MAX_PORTS) {
+			m_pSequenceStats[nPortIndex] = pStats;
+		}
+#else
+		if (nPortIndex == 0) {
+			m_pSequenceStats = pStats;
+		}
+#endif
+	}
+
 #if defined (__linux__) || defined(__APPLE__)
 	void Cls() {}
 #else
@@ -141,6 +157,7 @@ public:
 private:
 	void DisplayDateTime(const uint32_t nPortIndex, const char *pString);
 	void Update(const uint32_t nPortIndex, const uint8_t *pData, const uint32_t nLength);
+	void ShowSequenceStats(const uint32_t nPortIndex);
 #else
 private:
 	void Update();
@@ -163,10 +180,13 @@ private:
 		uint32_t nLength;
 	};
 	struct Data m_Data[dmxmonitor::output::text::MAX_PORTS];
+	const lightset::sequence::Stats *m_pSequenceStats[dmxmonitor::output::text::MAX_PORTS];
+	lightset::sequence::Stats m_SequenceStatsShown[dmxmonitor::output::text::MAX_PORTS];
 #else
 	uint16_t m_nSlots { 0 };
 	bool m_bIsStarted { false };
 	uint8_t m_Data[512];
+	const lightset::sequence::Stats *m_pSequenceStats { nullptr };
 #endif
 };
 
@@ -206,4 +206,13 @@ void DMXMonitor::Update() {
 			console_puts("                                                                                               ");
 		}
 	}
+
+	if (m_pSequenceStats != nullptr) {
+		console_set_cursor(4, ++row);
+		printf("Sequence lost %u duplicate %u reordered %u late %u   ",
+				static_cast<unsigned int>(m_pSequenceStats->nLost),
+				static_cast<unsigned int>(m_pSequenceStats->nDuplicate),
+				static_cast<unsigned int>(m_pSequenceStats->nReordered),
+				static_cast<unsigned int>(m_pSequenceStats->nLate));
+	}
 }
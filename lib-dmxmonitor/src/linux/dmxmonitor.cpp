@@ -39,6 +39,8 @@ using namespace dmxmonitor;
 DMXMonitor::DMXMonitor() {
 	for (uint32_t nPortIndex = 0; nPortIndex < dmxmonitor::output::text::MAX_PORTS; nPortIndex++) {
 		memset(&m_Data[nPortIndex], 0, sizeof(struct Data));
+		m_pSequenceStats[nPortIndex] = nullptr;
+		memset(&m_SequenceStatsShown[nPortIndex], 0, sizeof(lightset::sequence::Stats));
 	}
 
 	for (uint32_t i = 0; i < sizeof(m_bIsStarted); i++) {
@@ -140,4 +142,23 @@ void DMXMonitor::Update(const uint32_t nPortIndex, const uint8_t *pData, const u
 	}
 
 	puts("");
+
+	ShowSequenceStats(nPortIndex);
+}
+
+void DMXMonitor::ShowSequenceStats(const uint32_t nPortIndex) {
+	const auto *pStats = m_pSequenceStats[nPortIndex];
+
+	if ((pStats == nullptr) || (memcmp(pStats, &m_SequenceStatsShown[nPortIndex], sizeof(lightset::sequence::Stats)) == 0)) {
+		return;
+	}
+
+	memcpy(&m_SequenceStatsShown[nPortIndex], pStats, sizeof(lightset::sequence::Stats));
+
+	printf("Sequence:%c lost %u duplicate %u reordered %u late %u\n",
+			nPortIndex + 'A',
+			static_cast<unsigned int>(pStats->nLost),
+			static_cast<unsigned int>(pStats->nDuplicate),
+			static_cast<unsigned int>(pStats->nReordered),
+			static_cast<unsigned int>(pStats->nLate));
 }
@@ -36,6 +36,7 @@
 
 #include "lightset.h"
 #include "lightsetdata.h"
+#include "lightsetsequence.h"
 
 #if !(ARTNET_VERSION >= 4)
 # if defined(OUTPUT_DMX_SEND) || defined(OUTPUT_DMX_SEND_MULTI)
@@ -62,6 +63,23 @@ namespace e131bridge {
  static constexpr uint32_t MAX_PORTS = LIGHTSET_PORTS;
 #endif
 
+/**
+ * Maximum number of sources per universe
+ */
+#if !defined (E131_MAX_SOURCES)
+# if defined (GD32)
+#  define E131_MAX_SOURCES	4
+# else
+#  define E131_MAX_SOURCES	8
+# endif
+#endif
+
+ static constexpr uint32_t MAX_SOURCES = E131_MAX_SOURCES;
+ static_assert((MAX_SOURCES >= 2) && (MAX_SOURCES <= 64), "E131_MAX_SOURCES out of range");
+
+ static constexpr uint32_t SOURCE_LOOKUP_SIZE = 2U << (31 - __builtin_clz(MAX_SOURCES));	///< Power of 2, more than MAX_SOURCES
+ static constexpr uint8_t SOURCE_NONE = 0xFF;
+
  enum class Status : uint8_t {
  	OFF, STANDBY, ON
  };
@@ -76,12 +94,12 @@ struct State {
 	bool bDisableSynchronize;
 	uint32_t SynchronizationTime;
 	uint32_t DiscoveryTime;
+	uint32_t nSequenceWindowMillis;
 	uint16_t DiscoveryPacketLength;
 	uint16_t nSynchronizationAddressSourceA;
 	uint16_t nSynchronizationAddressSourceB;
 	uint8_t nEnabledInputPorts;
 	uint8_t nEnableOutputPorts;
-	uint8_t nPriority;
 	uint8_t nReceivingDmx;
 	lightset::FailSafe failsafe;
 	e131bridge::Status status;
@@ -99,12 +117,24 @@ struct Source {
 	uint32_t nMillis;
 	uint32_t nIp;
 	uint8_t cid[e131::CID_LENGTH];
-	uint8_t nSequenceNumberData;
+	lightset::Sequence<256> sequence;
+	uint16_t nLength;				///< Length of the stored data, when not merged as source A
+	uint8_t nPriority;
 };
 
+/**
+ * All sources in the table have the same (highest) priority.
+ * The source with index nSourceA is merged as lightset source A,
+ * all other sources are combined and merged as lightset source B.
+ */
 struct OutputPort {
-	Source sourceA;
-	Source sourceB;
+	Source source[MAX_SOURCES];
+	uint8_t nLookup[SOURCE_LOOKUP_SIZE];	///< CID hash -> source index, SOURCE_NONE when empty
+	lightset::sequence::Stats sequenceStats;
+	uint32_t nExpireMillis;
+	uint8_t nSources;
+	uint8_t nSourceA;
+	uint8_t nPriority;
 	lightset::MergeMode mergeMode;
 	lightset::OutputStyle outputStyle;
 	bool IsMerging;
@@ -206,6 +236,21 @@ public:
 		return m_State.bDisableMergeTimeout;
 	}
 
+	/**
+	 * @param nMillis a skipped sequence number received within this time is counted as reordered, otherwise as late
+	 */
+	void SetSequenceWindow(const uint32_t nMillis) {
+		m_State.nSequenceWindowMillis = nMillis;
+	}
+	uint32_t GetSequenceWindow() const {
+		return m_State.nSequenceWindowMillis;
+	}
+
+	const lightset::sequence::Stats *GetSequenceStats(const uint32_t nPortIndex) const {
+		assert(nPortIndex < e131bridge::MAX_PORTS);
+		return &m_OutputPort[nPortIndex].sequenceStats;
+	}
+
 	void SetEnableDataIndicator(bool bEnable) {
 		m_bEnableDataIndicator = bEnable;
 	}
@@ -383,15 +428,22 @@ private:
 	bool IsValidRoot();
 	bool IsValidDataPacket();
 
-	void SetNetworkDataLossCondition(bool bSourceA = true, bool bSourceB = true);
+	void SetNetworkDataLossCondition();
+	void SetNetworkDataLossCondition(const uint32_t nPortIndex);
 
 	void SetSynchronizationAddress(bool bSourceA, bool bSourceB, uint16_t nSynchronizationAddress);
 
-	void CheckMergeTimeouts(uint32_t nPortIndex);
-	bool IsPriorityTimeOut(uint32_t nPortIndex) const;
-	bool isIpCidMatch(const e131bridge::Source *const) const;
 	void UpdateMergeStatus(const uint32_t nPortIndex);
 
+	// Source table, e131bridgesources.cpp
+	uint32_t SourceFind(const uint32_t nPortIndex, const uint8_t *pCid) const;
+	uint32_t SourceAdd(const uint32_t nPortIndex, const uint8_t *pCid, const uint8_t nPriority);
+	void SourceRemove(const uint32_t nPortIndex, const uint32_t nSourceIndex);
+	void SourcesClear(const uint32_t nPortIndex);
+	void SourcesExpire(const uint32_t nPortIndex);
+	void SourceSetData(const uint32_t nPortIndex, const uint32_t nSourceIndex, const uint8_t *pData, const uint32_t nLength);
+	void SourcesMergeB(const uint32_t nPortIndex);
+
 	void HandleDmx();
 	void HandleSynchronization();
 
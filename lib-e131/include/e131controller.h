@@ -31,6 +31,8 @@
 #include "e131.h"
 #include "e131packets.h"
 
+#include "network.h"
+
 enum {
 	DEFAULT_SYNCHRONIZATION_ADDRESS = 5000
 };
@@ -39,6 +41,17 @@ enum {
 #define DMX_MAX_VALUE 255
 #endif
 
+#if !defined (CONFIG_E131_CONTROLLER_FRAME_UNIVERSES)
+# define CONFIG_E131_CONTROLLER_FRAME_UNIVERSES	64
+#endif
+
+namespace e131 {
+namespace controller {
+static constexpr uint32_t FRAME_UNIVERSES = CONFIG_E131_CONTROLLER_FRAME_UNIVERSES;
+static constexpr uint32_t MAX_UNIVERSES = 512;	///< A single universe discovery page
+}  // namespace controller
+}  // namespace e131
+
 struct TE131ControllerState {
 	bool bIsRunning;
 	uint16_t nActiveUniverses;
@@ -66,6 +79,29 @@ public:
 	void HandleSync();
 	void HandleBlackout();
 
+	/**
+	 * Frame level output, all universes of a frame are sent in a single batch.
+	 * The data packets are built in a preallocated arena. When the arena is full, the
+	 * packets so far are sent and the frame continues.
+	 * AddUniverse without BeginFrame starts a new frame.
+	 */
+	void BeginFrame() {
+		m_Frame.nPackets = 0;
+	}
+	void AddUniverse(uint16_t nUniverse, const uint8_t *pDmxData, uint32_t nLength);
+	/**
+	 * Sends the frame, followed by the synchronization packet when enabled
+	 */
+	void CommitFrame() {
+		const auto bHasData = (m_Frame.nPackets != 0);
+
+		FrameSend();
+
+		if (bHasData) {
+			HandleSync();
+		}
+	}
+
 	void SetSynchronizationAddress(uint16_t nSynchronizationAddress = DEFAULT_SYNCHRONIZATION_ADDRESS) {
 		m_State.SynchronizationPacket.nUniverseNumber = nSynchronizationAddress;
 		m_State.SynchronizationPacket.nIpAddress = e131::universe_to_multicast_ip(nSynchronizationAddress);
@@ -99,7 +135,11 @@ private:
 	void FillDiscoveryPacket();
 	void FillSynchronizationPacket();
 	void SendDiscoveryPacket();
+	void DiscoveryAdd(const uint16_t nUniverse);
+	void DiscoverySetLength();
 	uint8_t GetSequenceNumber(uint16_t nUniverse, uint32_t &nMulticastIpAddress);
+	uint32_t BuildDataPacket(TE131DataPacket *pDataPacket, const uint16_t nUniverse, const uint8_t *pDmxData, const uint32_t nLength);
+	void FrameSend();
 
 private:
 	int32_t m_nHandle { -1 };
@@ -108,6 +148,14 @@ private:
 	TE131DataPacket *m_pE131DataPacket { nullptr };
 	TE131DiscoveryPacket *m_pE131DiscoveryPacket { nullptr };
 	TE131SynchronizationPacket *m_pE131SynchronizationPacket { nullptr };
+
+	struct Frame {
+		TE131DataPacket *pDataPackets { nullptr };	///< Arena, FRAME_UNIVERSES packets
+		network::Datagram *pDatagrams { nullptr };
+		uint32_t nPackets { 0 };
+	};
+
+	Frame m_Frame;
 	uint32_t m_DiscoveryIpAddress { 0 };
 	uint8_t m_Cid[e131::CID_LENGTH];
 	char m_SourceName[e131::SOURCE_NAME_LENGTH];
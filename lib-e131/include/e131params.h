@@ -69,8 +69,10 @@ struct Params {
 	uint32_t nDestinationIp[e131params::MAX_PORTS];
 	// sACN E1.31
 	uint8_t nPriority[e131params::MAX_PORTS];
+	// Extra's
+	uint16_t nSequenceWindow;
 	// Reserved
-	uint8_t Filler2[40];
+	uint8_t Filler2[38];
 } __attribute__((packed));
 
  static_assert(sizeof(struct Params) <= 320, "struct Params is too large");
@@ -96,6 +98,7 @@ struct Mask {
 	static constexpr uint32_t LABEL_C   			= (1U << 9);
 	static constexpr uint32_t LABEL_D   			= (1U << 10);
 	static constexpr uint32_t DISABLE_MERGE_TIMEOUT	= (1U << 11);
+	static constexpr uint32_t SEQUENCE_WINDOW		= (1U << 12);
 	// Art-Net 4
 	static constexpr uint32_t ENABLE_RDM    		= (1U << 16);
 	static constexpr uint32_t MAP_UNIVERSE0 		= (1U << 17);
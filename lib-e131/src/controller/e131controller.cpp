@@ -45,13 +45,18 @@ using namespace e131;
 
 static const uint8_t DEVICE_SOFTWARE_VERSION[] = { 1, 0 };
 
-struct TSequenceNumbers {
+struct Universe {
+	uint32_t nIpAddress;
 	uint16_t nUniverse;
 	uint8_t nSequenceNumber;
-	uint32_t nIpAddress;
 };
 
-static struct TSequenceNumbers s_SequenceNumbers[512] __attribute__ ((aligned (8)));
+/*
+ * The universes are stored in the order they are first sent.
+ * s_UniverseToSlot gives the slot of a universe without a search.
+ */
+static struct Universe s_Universes[controller::MAX_UNIVERSES] __attribute__ ((aligned (8)));
+static uint16_t s_UniverseToSlot[universe::MAX + 1];	///< Slot + 1, 0 is not used
 
 E131Controller *E131Controller::s_pThis = nullptr;
 
@@ -71,9 +76,8 @@ E131Controller::E131Controller() {
 
 	Hardware::Get()->GetUuid(m_Cid);
 
-	for (uint32_t nIndex = 0; nIndex < sizeof(s_SequenceNumbers) / sizeof(s_SequenceNumbers[0]); nIndex++) {
-		memset(&s_SequenceNumbers[nIndex], 0, sizeof(s_SequenceNumbers[0]));
-	}
+	memset(s_Universes, 0, sizeof(s_Universes));
+	memset(s_UniverseToSlot, 0, sizeof(s_UniverseToSlot));
 
 	SetSynchronizationAddress();
 
@@ -92,6 +96,12 @@ E131Controller::E131Controller() {
 	m_pE131SynchronizationPacket = new struct TE131SynchronizationPacket;
 	assert(m_pE131SynchronizationPacket != nullptr);
 
+	m_Frame.pDataPackets = new struct TE131DataPacket[controller::FRAME_UNIVERSES];
+	assert(m_Frame.pDataPackets != nullptr);
+
+	m_Frame.pDatagrams = new network::Datagram[controller::FRAME_UNIVERSES];
+	assert(m_Frame.pDatagrams != nullptr);
+
 	m_nHandle = Network::Get()->Begin(e131::UDP_PORT);
 	assert(m_nHandle != -1);
 
@@ -103,6 +113,12 @@ E131Controller::~E131Controller() {
 
 	Network::Get()->End(e131::UDP_PORT);
 
+	delete[] m_Frame.pDatagrams;
+	m_Frame.pDatagrams = nullptr;
+
+	delete[] m_Frame.pDataPackets;
+	m_Frame.pDataPackets = nullptr;
+
 	if (m_pE131SynchronizationPacket != nullptr) {
 		delete m_pE131SynchronizationPacket;
 		m_pE131SynchronizationPacket = nullptr;
@@ -128,6 +144,13 @@ void E131Controller::Start() {
 	FillDiscoveryPacket();
 	FillSynchronizationPacket();
 
+	// The layers up to and including the DMX start code are the same for all packets
+	for (uint32_t i = 0; i < controller::FRAME_UNIVERSES; i++) {
+		memcpy(&m_Frame.pDataPackets[i], m_pE131DataPacket, DATA_PACKET_SIZE(1U));
+	}
+
+	m_Frame.nPackets = 0;
+
 	m_State.bIsRunning = true;
 
 	DEBUG_EXIT
@@ -182,6 +205,49 @@ void E131Controller::FillDiscoveryPacket() {
 
 	// Universe Discovery Layer (See Section 8)
 	m_pE131DiscoveryPacket->UniverseDiscoveryLayer.Vector = __builtin_bswap32(vector::universe::DISCOVERY_UNIVERSE_LIST);
+
+	// The universes sent before a restart
+	const auto nActiveUniverses = m_State.nActiveUniverses;
+	m_State.nActiveUniverses = 0;
+
+	for (uint32_t nSlot = 0; nSlot < nActiveUniverses; nSlot++) {
+		DiscoveryAdd(s_Universes[nSlot].nUniverse);
+		m_State.nActiveUniverses++;
+	}
+
+	DiscoverySetLength();
+}
+
+/**
+ * Inserts the universe in the sorted list of the discovery packet.
+ * Only called when a universe is sent for the first time.
+ */
+void E131Controller::DiscoveryAdd(const uint16_t nUniverse) {
+	auto& discoveryLayer = m_pE131DiscoveryPacket->UniverseDiscoveryLayer;
+	uint32_t nLow = 0;
+	uint32_t nHigh = m_State.nActiveUniverses;
+
+	while (nLow < nHigh) {
+		const auto nMid = nLow + ((nHigh - nLow) / 2);
+
+		if (__builtin_bswap16(discoveryLayer.ListOfUniverses[nMid]) < nUniverse) {
+			nLow = nMid + 1;
+		} else {
+			nHigh = nMid;
+		}
+	}
+
+	for (auto i = static_cast<uint32_t>(m_State.nActiveUniverses); i > nLow; i--) {
+		discoveryLayer.ListOfUniverses[i] = discoveryLayer.ListOfUniverses[i - 1];
+	}
+
+	discoveryLayer.ListOfUniverses[nLow] = __builtin_bswap16(nUniverse);
+}
+
+void E131Controller::DiscoverySetLength() {
+	m_pE131DiscoveryPacket->RootLayer.FlagsLength = __builtin_bswap16(static_cast<uint16_t>((0x07 << 12) | (DISCOVERY_ROOT_LAYER_LENGTH(m_State.nActiveUniverses))));
+	m_pE131DiscoveryPacket->FrameLayer.FLagsLength = __builtin_bswap16(static_cast<uint16_t>((0x07 << 12) | (DISCOVERY_FRAME_LAYER_LENGTH(m_State.nActiveUniverses))));
+	m_pE131DiscoveryPacket->UniverseDiscoveryLayer.FlagsLength = __builtin_bswap16(static_cast<uint16_t>((0x07 << 12) | DISCOVERY_LAYER_LENGTH(m_State.nActiveUniverses)));
 }
 
 void E131Controller::FillSynchronizationPacket() {
@@ -200,35 +266,67 @@ void E131Controller::FillSynchronizationPacket() {
 	m_pE131SynchronizationPacket->FrameLayer.UniverseNumber = __builtin_bswap16(m_State.SynchronizationPacket.nUniverseNumber);
 }
 
-void E131Controller::HandleDmxOut(uint16_t nUniverse, const uint8_t *pDmxData, uint32_t nLength) {
+/**
+ * Fills in the universe dependent fields and the DMX data
+ * @return the multicast address of the universe
+ */
+uint32_t E131Controller::BuildDataPacket(TE131DataPacket *pDataPacket, const uint16_t nUniverse, const uint8_t *pDmxData, const uint32_t nLength) {
 	uint32_t nIp;
 
 	// Root Layer (See Section 5)
-	m_pE131DataPacket->RootLayer.FlagsLength = __builtin_bswap16(static_cast<uint16_t>((0x07 << 12) | (DATA_ROOT_LAYER_LENGTH(1U + nLength))));
+	pDataPacket->RootLayer.FlagsLength = __builtin_bswap16(static_cast<uint16_t>((0x07 << 12) | (DATA_ROOT_LAYER_LENGTH(1U + nLength))));
 
 	// E1.31 Framing Layer (See Section 6)
-	m_pE131DataPacket->FrameLayer.FLagsLength = __builtin_bswap16(static_cast<uint16_t>((0x07 << 12) | (DATA_FRAME_LAYER_LENGTH(1U + nLength))));
-	m_pE131DataPacket->FrameLayer.SequenceNumber = GetSequenceNumber(nUniverse, nIp);
-	m_pE131DataPacket->FrameLayer.Universe = __builtin_bswap16(nUniverse);
+	pDataPacket->FrameLayer.FLagsLength = __builtin_bswap16(static_cast<uint16_t>((0x07 << 12) | (DATA_FRAME_LAYER_LENGTH(1U + nLength))));
+	pDataPacket->FrameLayer.SequenceNumber = GetSequenceNumber(nUniverse, nIp);
+	pDataPacket->FrameLayer.Universe = __builtin_bswap16(nUniverse);
 
 	// Data Layer
-	m_pE131DataPacket->DMPLayer.FlagsLength = __builtin_bswap16(static_cast<uint16_t>((0x07 << 12) | (DATA_LAYER_LENGTH(1U + nLength))));
+	pDataPacket->DMPLayer.FlagsLength = __builtin_bswap16(static_cast<uint16_t>((0x07 << 12) | (DATA_LAYER_LENGTH(1U + nLength))));
 
 	if (__builtin_expect((m_nMaster == DMX_MAX_VALUE), 1)) {
-		memcpy(&m_pE131DataPacket->DMPLayer.PropertyValues[1], pDmxData, nLength);
+		memcpy(&pDataPacket->DMPLayer.PropertyValues[1], pDmxData, nLength);
 	} else if (m_nMaster == 0) {
-		memset(&m_pE131DataPacket->DMPLayer.PropertyValues[1], 0, nLength);
+		memset(&pDataPacket->DMPLayer.PropertyValues[1], 0, nLength);
 	} else {
 		for (uint32_t i = 0; i < nLength; i++) {
-			m_pE131DataPacket->DMPLayer.PropertyValues[1 + i] = static_cast<uint8_t>((m_nMaster * pDmxData[i]) / DMX_MAX_VALUE);
+			pDataPacket->DMPLayer.PropertyValues[1 + i] = static_cast<uint8_t>((m_nMaster * pDmxData[i]) / DMX_MAX_VALUE);
 		}
 	}
 
-	m_pE131DataPacket->DMPLayer.PropertyValueCount = __builtin_bswap16(static_cast<uint16_t>(1 + nLength));
+	pDataPacket->DMPLayer.PropertyValueCount = __builtin_bswap16(static_cast<uint16_t>(1 + nLength));
+
+	return nIp;
+}
+
+void E131Controller::HandleDmxOut(uint16_t nUniverse, const uint8_t *pDmxData, uint32_t nLength) {
+	const auto nIp = BuildDataPacket(m_pE131DataPacket, nUniverse, pDmxData, nLength);
 
 	Network::Get()->SendTo(m_nHandle, m_pE131DataPacket, static_cast<uint16_t>(DATA_PACKET_SIZE(1U + nLength)), nIp, e131::UDP_PORT);
 }
 
+void E131Controller::AddUniverse(uint16_t nUniverse, const uint8_t *pDmxData, uint32_t nLength) {
+	if (m_Frame.nPackets == controller::FRAME_UNIVERSES) {
+		FrameSend();
+	}
+
+	const auto nIndex = m_Frame.nPackets++;
+	auto *pDataPacket = &m_Frame.pDataPackets[nIndex];
+	auto& datagram = m_Frame.pDatagrams[nIndex];
+
+	datagram.pBuffer = pDataPacket;
+	datagram.nToIp = BuildDataPacket(pDataPacket, nUniverse, pDmxData, nLength);
+	datagram.nLength = static_cast<uint16_t>(DATA_PACKET_SIZE(1U + nLength));
+	datagram.nRemotePort = e131::UDP_PORT;
+}
+
+void E131Controller::FrameSend() {
+	if (m_Frame.nPackets != 0) {
+		Network::Get()->SendTo(m_nHandle, m_Frame.pDatagrams, m_Frame.nPackets);
+		m_Frame.nPackets = 0;
+	}
+}
+
 void E131Controller::HandleSync() {
 	if (m_State.SynchronizationPacket.nUniverseNumber != 0) {
 		m_pE131SynchronizationPacket->FrameLayer.SequenceNumber = m_State.SynchronizationPacket.nSequenceNumber++;
@@ -250,7 +348,7 @@ void E131Controller::HandleBlackout() {
 
 	for (uint32_t nIndex = 0; nIndex < m_State.nActiveUniverses; nIndex++) {
 		uint32_t nIp;
-		uint16_t nUniverse = s_SequenceNumbers[nIndex].nUniverse;
+		const auto nUniverse = s_Universes[nIndex].nUniverse;
 
 		m_pE131DataPacket->FrameLayer.SequenceNumber = GetSequenceNumber(nUniverse, nIp);
 		m_pE131DataPacket->FrameLayer.Universe = __builtin_bswap16(nUniverse);
@@ -292,14 +390,6 @@ void E131Controller::SendDiscoveryPacket() {
 	if (m_nCurrentPacketMillis - m_State.DiscoveryTime >= (UNIVERSE_DISCOVERY_INTERVAL_SECONDS * 1000)) {
 		m_State.DiscoveryTime = m_nCurrentPacketMillis;
 
-		m_pE131DiscoveryPacket->RootLayer.FlagsLength = __builtin_bswap16(static_cast<uint16_t>((0x07 << 12) | (DISCOVERY_ROOT_LAYER_LENGTH(m_State.nActiveUniverses))));
-		m_pE131DiscoveryPacket->FrameLayer.FLagsLength = __builtin_bswap16(static_cast<uint16_t>((0x07 << 12) | (DISCOVERY_FRAME_LAYER_LENGTH(m_State.nActiveUniverses))));
-		m_pE131DiscoveryPacket->UniverseDiscoveryLayer.FlagsLength = __builtin_bswap16(static_cast<uint16_t>((0x07 << 12) | DISCOVERY_LAYER_LENGTH(m_State.nActiveUniverses)));
-
-		for (uint32_t i = 0; i < m_State.nActiveUniverses; i++) {
-			m_pE131DiscoveryPacket->UniverseDiscoveryLayer.ListOfUniverses[i] = __builtin_bswap16(s_SequenceNumbers[i].nUniverse);
-		}
-
 		Network::Get()->SendTo(m_nHandle, m_pE131DiscoveryPacket, static_cast<uint16_t>(DISCOVERY_PACKET_SIZE(m_State.nActiveUniverses)), m_DiscoveryIpAddress, e131::UDP_PORT);
 
 		DEBUG_PUTS("Discovery sent");
@@ -307,63 +397,43 @@ void E131Controller::SendDiscoveryPacket() {
 }
 
 uint8_t E131Controller::GetSequenceNumber(uint16_t nUniverse, uint32_t &nMulticastIpAddress) {
-	assert(sizeof(struct TSequenceNumbers) == sizeof(uint64_t));
-
-	int32_t nLow = 0;
-	int32_t nMid = 0;
-	int32_t nHigh = m_State.nActiveUniverses;
-
-	while (nLow <= nHigh) {
+	if (__builtin_expect((nUniverse <= universe::MAX), 1)) {
+		const auto nSlot = s_UniverseToSlot[nUniverse];
 
-		nMid = nLow + ((nHigh - nLow) / 2);
-
-		const uint32_t nMidValue = s_SequenceNumbers[nMid].nUniverse;
-
-		if (nMidValue < nUniverse) {
-			nLow = nMid + 1;
-		} else if (nMidValue > nUniverse) {
-			nHigh = nMid - 1;
-		} else {
-			DEBUG_PRINTF("Found nUniverse=%u", nUniverse);
-			nMulticastIpAddress = s_SequenceNumbers[nMid].nIpAddress;
-			s_SequenceNumbers[nMid].nSequenceNumber++;
-			return s_SequenceNumbers[nMid].nSequenceNumber;
+		if (__builtin_expect((nSlot != 0), 1)) {
+			auto& universe = s_Universes[nSlot - 1U];
+			nMulticastIpAddress = universe.nIpAddress;
+			return ++universe.nSequenceNumber;
 		}
 	}
 
-	DEBUG_PRINTF("nActiveUniverses=%u -> %u : nLow=%d, nMid=%d, nHigh=%d", m_State.nActiveUniverses, nUniverse, nLow, nMid, nHigh);
+	nMulticastIpAddress = universe_to_multicast_ip(nUniverse);
 
-	if ((nHigh != -1) && (m_State.nActiveUniverses != static_cast<uint32_t>(nHigh))) {
-		auto p64 = reinterpret_cast<uint64_t *>(s_SequenceNumbers);
-
-		for (int32_t i = m_State.nActiveUniverses - 1; i >= nLow; i--) {
-			p64[i + 1] = p64[i];
-		}
-
-		s_SequenceNumbers[nLow].nIpAddress = universe_to_multicast_ip(nUniverse);
-		s_SequenceNumbers[nLow].nUniverse = nUniverse;
-		s_SequenceNumbers[nLow].nSequenceNumber = 0;
-
-		nMulticastIpAddress = s_SequenceNumbers[nLow].nIpAddress;
+	if ((nUniverse == 0) || (nUniverse > universe::MAX) || (m_State.nActiveUniverses == controller::MAX_UNIVERSES)) {
+		DEBUG_PRINTF("Universe %u is not tracked", nUniverse);
+		return 0;
+	}
 
-		DEBUG_PRINTF(">m< nUniverse=%u, nLow=%d", nUniverse, nLow);
-	} else {
-		s_SequenceNumbers[nMid].nIpAddress = universe_to_multicast_ip(nUniverse);
-		s_SequenceNumbers[nMid].nUniverse = nUniverse;
+	const auto nSlot = m_State.nActiveUniverses;
+	auto& universe = s_Universes[nSlot];
 
-		nMulticastIpAddress = s_SequenceNumbers[nMid].nIpAddress;
+	universe.nIpAddress = nMulticastIpAddress;
+	universe.nUniverse = nUniverse;
+	universe.nSequenceNumber = 0;
 
-		DEBUG_PRINTF(">a< nUniverse=%u, nMid=%d", nUniverse, nMid);
-	}
+	s_UniverseToSlot[nUniverse] = static_cast<uint16_t>(nSlot + 1U);
 
+	DiscoveryAdd(nUniverse);
 	m_State.nActiveUniverses++;
+	DiscoverySetLength();
 
+	DEBUG_PRINTF("nUniverse=%u, nSlot=%u", nUniverse, nSlot);
 	return 0;
 }
 
 void E131Controller::Print() {
 	puts("sACN E1.31 Controller");
-	printf(" Max Universes : %d\n", static_cast<int>(sizeof(s_SequenceNumbers) / sizeof(s_SequenceNumbers[0])));
+	printf(" Max Universes : %d\n", static_cast<int>(controller::MAX_UNIVERSES));
 	if (m_State.SynchronizationPacket.nUniverseNumber != 0) {
 		printf(" Synchronization Universe : %u\n", m_State.SynchronizationPacket.nUniverseNumber);
 	} else {
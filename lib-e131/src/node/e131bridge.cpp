@@ -62,11 +62,12 @@ E131Bridge::E131Bridge() {
 	}
 
 	memset(&m_State, 0, sizeof(e131bridge::State));
-	m_State.nPriority = e131::priority::LOWEST;
 	m_State.failsafe = lightset::FailSafe::HOLD;
+	m_State.nSequenceWindowMillis = lightset::sequence::WINDOW_MILLIS_DEFAULT;
 
 	for (uint32_t i = 0; i < e131bridge::MAX_PORTS; i++) {
 		memset(&m_OutputPort[i], 0, sizeof(e131bridge::OutputPort));
+		SourcesClear(i);
 		memset(&m_InputPort[i], 0, sizeof(e131bridge::InputPort));
 		m_InputPort[i].nPriority = 100;
 	}
@@ -235,17 +236,8 @@ void E131Bridge::SetLocalMerging() {
 					nOutputPortIndex,
 					m_Bridge.Port[nOutputPortIndex].nUniverse);
 
+			// The local input is merged as a source with the own CID
 			if (m_Bridge.Port[nInputPortIndex].nUniverse == m_Bridge.Port[nOutputPortIndex].nUniverse) {
-
-				if (!m_Bridge.Port[nOutputPortIndex].bLocalMerge) {
-					m_OutputPort[nOutputPortIndex].sourceA.nIp = Network::Get()->GetIp();
-					DEBUG_PUTS("Local merge Source A");
-				} else {
-					m_OutputPort[nOutputPortIndex].sourceB.nIp = Network::Get()->GetIp();
-					DEBUG_PUTS("Local merge Source B");
-				}
-
-				DEBUG_PUTS("");
 				m_Bridge.Port[nInputPortIndex].bLocalMerge = true;
 				m_Bridge.Port[nOutputPortIndex].bLocalMerge = true;
 			}
@@ -330,82 +322,24 @@ void E131Bridge::SetUniverse(const uint32_t nPortIndex, const lightset::PortDir
 }
 
 void E131Bridge::UpdateMergeStatus(const uint32_t nPortIndex) {
-	if (!m_State.IsMergeMode) {
-		m_State.IsMergeMode = true;
-		m_State.IsChanged = true;
-	}
+	const auto isMerging = (m_OutputPort[nPortIndex].nSources >= 2);
 
-	m_OutputPort[nPortIndex].IsMerging = true;
-}
-
-void E131Bridge::CheckMergeTimeouts(uint32_t nPortIndex) {
-	assert(nPortIndex < e131bridge::MAX_PORTS);
-
-	const auto timeOutA = m_nCurrentPacketMillis - m_OutputPort[nPortIndex].sourceA.nMillis;
-
-	if (timeOutA > (e131::MERGE_TIMEOUT_SECONDS * 1000U)) {
-		m_OutputPort[nPortIndex].sourceA.nIp = 0;
-		memset(m_OutputPort[nPortIndex].sourceA.cid, 0, e131::CID_LENGTH);
-		m_OutputPort[nPortIndex].IsMerging = false;
+	if (__builtin_expect((m_OutputPort[nPortIndex].IsMerging == isMerging), 1)) {
+		return;
 	}
 
-	const auto timeOutB = m_nCurrentPacketMillis - m_OutputPort[nPortIndex].sourceB.nMillis;
+	m_OutputPort[nPortIndex].IsMerging = isMerging;
 
-	if (timeOutB > (e131::MERGE_TIMEOUT_SECONDS * 1000U)) {
-		m_OutputPort[nPortIndex].sourceB.nIp = 0;
-		memset(m_OutputPort[nPortIndex].sourceB.cid, 0, e131::CID_LENGTH);
-		m_OutputPort[nPortIndex].IsMerging = false;
-	}
-
-	auto bIsMerging = false;
+	auto isMergeMode = false;
 
 	for (uint32_t i = 0; i < e131bridge::MAX_PORTS; i++) {
-		bIsMerging |= m_OutputPort[i].IsMerging;
+		isMergeMode |= m_OutputPort[i].IsMerging;
 	}
 
-	if (!bIsMerging) {
+	if (m_State.IsMergeMode != isMergeMode) {
+		m_State.IsMergeMode = isMergeMode;
 		m_State.IsChanged = true;
-		m_State.IsMergeMode = false;
-	}
-}
-
-bool E131Bridge::IsPriorityTimeOut(uint32_t nPortIndex) const {
-	assert(nPortIndex < e131bridge::MAX_PORTS);
-
-	const auto timeOutA = m_nCurrentPacketMillis - m_OutputPort[nPortIndex].sourceA.nMillis;
-	const auto timeOutB = m_nCurrentPacketMillis - m_OutputPort[nPortIndex].sourceB.nMillis;
-
-	if ( (m_OutputPort[nPortIndex].sourceA.nIp != 0) && (m_OutputPort[nPortIndex].sourceB.nIp != 0) ) {
-		if ( (timeOutA < (e131::PRIORITY_TIMEOUT_SECONDS * 1000U)) || (timeOutB < (e131::PRIORITY_TIMEOUT_SECONDS * 1000U)) ) {
-			return false;
-		} else {
-			return true;
-		}
-	} else if ( (m_OutputPort[nPortIndex].sourceA.nIp != 0) && (m_OutputPort[nPortIndex].sourceB.nIp == 0) ) {
-		if (timeOutA > (e131::PRIORITY_TIMEOUT_SECONDS * 1000U)) {
-			return true;
-		}
-	} else if ( (m_OutputPort[nPortIndex].sourceA.nIp == 0) && (m_OutputPort[nPortIndex].sourceB.nIp != 0) ) {
-		if (timeOutB > (e131::PRIORITY_TIMEOUT_SECONDS * 1000U)) {
-			return true;
-		}
 	}
-
-	return false;
-}
-
-bool E131Bridge::isIpCidMatch(const e131bridge::Source *const source) const {
-	if (source->nIp != m_nIpAddressFrom) {
-		return false;
-	}
-
-	const auto *const pRaw = reinterpret_cast<TE131RawPacket *>(m_pReceiveBuffer);
-
-	if (memcmp(source->cid, pRaw->RootLayer.Cid, e131::CID_LENGTH) != 0) {
-		return false;
-	}
-
-	return true;
 }
 
 void E131Bridge::HandleDmx() {
@@ -423,29 +357,22 @@ void E131Bridge::HandleDmx() {
 				continue;
 			}
 
-			auto *pSourceA = &m_OutputPort[nPortIndex].sourceA;
-			auto *pSourceB = &m_OutputPort[nPortIndex].sourceB;
+			auto& outputPort = m_OutputPort[nPortIndex];
 
-			const auto ipA = pSourceA->nIp;
-			const auto ipB = pSourceB->nIp;
+			if ((m_nCurrentPacketMillis - outputPort.nExpireMillis) >= 1000) {
+				outputPort.nExpireMillis = m_nCurrentPacketMillis;
+				SourcesExpire(nPortIndex);
+			}
 
-			const auto isSourceA = isIpCidMatch(pSourceA);
-			const auto isSourceB = isIpCidMatch(pSourceB);
+			auto nSourceIndex = SourceFind(nPortIndex, pData->RootLayer.Cid);
 
 			// 6.9.2 Sequence Numbering
 			// Having first received a packet with sequence number A, a second packet with sequence number B
 			// arrives. If, using signed 8-bit binary arithmetic, B – A is less than or equal to 0, but greater than -20 then
 			// the packet containing sequence number B shall be deemed out of sequence and discarded
-			if (isSourceA) {
-				const auto diff = static_cast<int8_t>(pData->FrameLayer.SequenceNumber - pSourceA->nSequenceNumberData);
-				pSourceA->nSequenceNumberData = pData->FrameLayer.SequenceNumber;
-				if ((diff <= 0) && (diff > -20)) {
-					continue;
-				}
-			} else if (isSourceB) {
-				const auto diff = static_cast<int8_t>(pData->FrameLayer.SequenceNumber - pSourceB->nSequenceNumberData);
-				pSourceB->nSequenceNumberData = pData->FrameLayer.SequenceNumber;
-				if ((diff <= 0) && (diff > -20)) {
+			if (nSourceIndex != e131bridge::SOURCE_NONE) {
+				auto& source = outputPort.source[nSourceIndex];
+				if (source.sequence.Check(pData->FrameLayer.SequenceNumber, m_nCurrentPacketMillis, m_State.nSequenceWindowMillis, outputPort.sequenceStats) == lightset::sequence::Result::DISCARD) {
 					continue;
 				}
 			}
@@ -459,89 +386,77 @@ void E131Bridge::HandleDmx() {
 			// Upon receipt of a packet containing this bit set to a value of 1, receiver shall enter network data loss condition.
 			// Any property values in these packets shall be ignored.
 			if ((pData->FrameLayer.Options & e131::OptionsMask::STREAM_TERMINATED) != 0) {
-				if (isSourceA || isSourceB) {
-					SetNetworkDataLossCondition(isSourceA, isSourceB);
+				if (nSourceIndex != e131bridge::SOURCE_NONE) {
+					SourceRemove(nPortIndex, nSourceIndex);
+
+					if (outputPort.nSources == 0) {
+						SetNetworkDataLossCondition(nPortIndex);
+					}
+
+					UpdateMergeStatus(nPortIndex);
 				}
 				continue;
 			}
 
-			if (m_State.IsMergeMode) {
-				if (__builtin_expect((!m_State.bDisableMergeTimeout), 1)) {
-					CheckMergeTimeouts(nPortIndex);
+			/*
+			 * Priority arbitration per universe.
+			 * Only the sources with the highest priority are in the table and are merged.
+			 */
+			const auto nPriority = pData->FrameLayer.Priority;
+
+			if (nSourceIndex == e131bridge::SOURCE_NONE) {
+				if ((outputPort.nSources != 0) && (nPriority < outputPort.nPriority)) {
+					continue;
 				}
-			}
 
-			if (pData->FrameLayer.Priority < m_State.nPriority ){
-				if (!IsPriorityTimeOut(nPortIndex)) {
+				if (nPriority > outputPort.nPriority) {
+					SourcesClear(nPortIndex);
+				}
+
+				outputPort.nPriority = nPriority;
+
+				if ((nSourceIndex = SourceAdd(nPortIndex, pData->RootLayer.Cid, nPriority)) == e131bridge::SOURCE_NONE) {
 					continue;
 				}
-				m_State.nPriority = pData->FrameLayer.Priority;
-			} else if (pData->FrameLayer.Priority > m_State.nPriority) {
-				m_OutputPort[nPortIndex].sourceA.nIp = 0;
-				m_OutputPort[nPortIndex].sourceB.nIp = 0;
-				m_State.IsMergeMode = false;
-				m_State.nPriority = pData->FrameLayer.Priority;
+
+				outputPort.source[nSourceIndex].sequence.Start(pData->FrameLayer.SequenceNumber, m_nCurrentPacketMillis);
+			} else if (nPriority != outputPort.nPriority) {
+				if (nPriority > outputPort.nPriority) {
+					// This source takes over from all other sources
+					SourcesClear(nPortIndex);
+					nSourceIndex = SourceAdd(nPortIndex, pData->RootLayer.Cid, nPriority);
+					outputPort.source[nSourceIndex].sequence.Start(pData->FrameLayer.SequenceNumber, m_nCurrentPacketMillis);
+				} else if (outputPort.nSources > 1) {
+					// This source lowered its priority below the other sources
+					SourceRemove(nPortIndex, nSourceIndex);
+					UpdateMergeStatus(nPortIndex);
+					continue;
+				}
+
+				outputPort.nPriority = nPriority;
+				outputPort.source[nSourceIndex].nPriority = nPriority;
 			}
 
-			if ((ipA == 0) && (ipB == 0)) {
-//				printf("1. First package from Source\n");
-				pSourceA->nIp = m_nIpAddressFrom;
-				pSourceA->nSequenceNumberData = pData->FrameLayer.SequenceNumber;
-				memcpy(pSourceA->cid, pData->RootLayer.Cid, 16);
-				pSourceA->nMillis = m_nCurrentPacketMillis;
-				lightset::Data::SetSourceA(nPortIndex, pDmxData, nDmxSlots);
-			} else if (isSourceA && (ipB == 0)) {
-//				printf("2. Continue package from SourceA\n");
-				pSourceA->nSequenceNumberData = pData->FrameLayer.SequenceNumber;
-				pSourceA->nMillis = m_nCurrentPacketMillis;
+			outputPort.source[nSourceIndex].nMillis = m_nCurrentPacketMillis;
+
+			UpdateMergeStatus(nPortIndex);
+
+			const auto isSourceA = (nSourceIndex == outputPort.nSourceA);
+
+			if (outputPort.nSources == 1) {
 				lightset::Data::SetSourceA(nPortIndex, pDmxData, nDmxSlots);
-			} else if ((ipA == 0) && isSourceB) {
-//				printf("3. Continue package from SourceB\n");
-				pSourceB->nSequenceNumberData = pData->FrameLayer.SequenceNumber;
-				pSourceB->nMillis = m_nCurrentPacketMillis;
-				lightset::Data::SetSourceB(nPortIndex, pDmxData, nDmxSlots);
-			} else if (!isSourceA && (ipB == 0)) {
-//				printf("4. New ip, start merging\n");
-				pSourceB->nIp = m_nIpAddressFrom;
-				pSourceB->nSequenceNumberData = pData->FrameLayer.SequenceNumber;
-				memcpy(pSourceB->cid, pData->RootLayer.Cid, 16);
-				pSourceB->nMillis = m_nCurrentPacketMillis;
-				UpdateMergeStatus(nPortIndex);
-				lightset::Data::MergeSourceB(nPortIndex, pDmxData, nDmxSlots, m_OutputPort[nPortIndex].mergeMode);
-			} else if ((ipA == 0) && !isSourceB) {
-//				printf("5. New ip, start merging\n");
-				pSourceA->nIp = m_nIpAddressFrom;
-				pSourceA->nSequenceNumberData = pData->FrameLayer.SequenceNumber;
-				memcpy(pSourceA->cid, pData->RootLayer.Cid, 16);
-				pSourceA->nMillis = m_nCurrentPacketMillis;
-				UpdateMergeStatus(nPortIndex);
-				lightset::Data::MergeSourceA(nPortIndex, pDmxData, nDmxSlots, m_OutputPort[nPortIndex].mergeMode);
-			} else if (isSourceA && !isSourceB) {
-//				printf("6. Continue merging\n");
-				pSourceA->nSequenceNumberData = pData->FrameLayer.SequenceNumber;
-				pSourceA->nMillis = m_nCurrentPacketMillis;
-				UpdateMergeStatus(nPortIndex);
-				lightset::Data::MergeSourceA(nPortIndex, pDmxData, nDmxSlots, m_OutputPort[nPortIndex].mergeMode);
-			} else if (!isSourceA && isSourceB) {
-//				printf("7. Continue merging\n");
-				pSourceB->nSequenceNumberData = pData->FrameLayer.SequenceNumber;
-				pSourceB->nMillis = m_nCurrentPacketMillis;
-				UpdateMergeStatus(nPortIndex);
-				lightset::Data::MergeSourceB(nPortIndex, pDmxData, nDmxSlots, m_OutputPort[nPortIndex].mergeMode);
-			}
-#ifndef NDEBUG
-			else if (isSourceA && isSourceB) {
-				puts("WARN: 8. Source matches both ip, discarding data");
-				return;
-			} else if (!isSourceA && !isSourceB) {
-				puts("WARN: 9. More than two sources, discarding data");
-				return;
-			}
-			else {
-				puts("ERROR: 0. No cases matched, this shouldn't happen!");
-				return;
+			} else if (isSourceA) {
+				lightset::Data::MergeSourceA(nPortIndex, pDmxData, nDmxSlots, outputPort.mergeMode);
+			} else {
+				SourceSetData(nPortIndex, nSourceIndex, pDmxData, nDmxSlots);
+
+				if ((outputPort.nSources > 2) && (outputPort.mergeMode == lightset::MergeMode::HTP)) {
+					SourcesMergeB(nPortIndex);
+				} else {
+					lightset::Data::MergeSourceB(nPortIndex, pDmxData, nDmxSlots, outputPort.mergeMode);
+				}
 			}
-#endif
+
 			// This bit indicates whether to lock or revert to an unsynchronized state when synchronization is lost
 			// (See Section 11 on Universe Synchronization and 11.1 for discussion on synchronization states).
 			// When set to 0, components that had been operating in a synchronized state shall not update with any
@@ -555,11 +470,7 @@ void E131Bridge::HandleDmx() {
 				// Receivers shall ignore E1.31 Synchronization Packets containing a Synchronization Address of 0.
 				if (pData->FrameLayer.SynchronizationAddress != 0) {
 					if (!m_State.IsForcedSynchronized) {
-						if (!(isSourceA || isSourceB)) {
-							SetSynchronizationAddress((pSourceA->nIp != 0), (pSourceB->nIp != 0), __builtin_bswap16(pData->FrameLayer.SynchronizationAddress));
-						} else {
-							SetSynchronizationAddress(isSourceA, isSourceB, __builtin_bswap16(pData->FrameLayer.SynchronizationAddress));
-						}
+						SetSynchronizationAddress(isSourceA, !isSourceA, __builtin_bswap16(pData->FrameLayer.SynchronizationAddress));
 						m_State.IsForcedSynchronized = true;
 						m_State.IsSynchronized = true;
 					}
@@ -587,72 +498,47 @@ void E131Bridge::HandleDmx() {
 	}
 }
 
-void E131Bridge::SetNetworkDataLossCondition(bool bSourceA, bool bSourceB) {
+static void failsafe(LightSet *pLightSet, const lightset::FailSafe failsafe) {
+	switch (failsafe) {
+	case lightset::FailSafe::HOLD:
+		break;
+	case lightset::FailSafe::OFF:
+		pLightSet->Blackout(true);
+		break;
+	case lightset::FailSafe::ON:
+		pLightSet->FullOn();
+		break;
+	default:
+		DEBUG_PRINTF("failsafe=%u", static_cast<uint32_t>(failsafe));
+		assert(0);
+		__builtin_unreachable();
+		break;
+	}
+}
+
+void E131Bridge::SetNetworkDataLossCondition() {
 	DEBUG_ENTRY
-	DEBUG_PRINTF("%d %d", bSourceA, bSourceB);
 
 	m_State.IsChanged = true;
-	auto doFailsafe = false;
-
-	if (bSourceA && bSourceB) {
-		m_State.IsNetworkDataLoss = true;
-		m_State.IsMergeMode = false;
-		m_State.IsSynchronized = false;
-		m_State.IsForcedSynchronized = false;
-		m_State.nPriority = e131::priority::LOWEST;
-
-		for (uint32_t i = 0; i < e131bridge::MAX_PORTS; i++) {
-			if (m_OutputPort[i].IsTransmitting) {
-				doFailsafe = true;
-				m_OutputPort[i].sourceA.nIp = 0;
-				memset(m_OutputPort[i].sourceA.cid, 0, e131::CID_LENGTH);
-				m_OutputPort[i].sourceB.nIp = 0;
-				memset(m_OutputPort[i].sourceB.cid, 0, e131::CID_LENGTH);
-				lightset::Data::ClearLength(i);
-				m_OutputPort[i].IsTransmitting = false;
-				m_OutputPort[i].IsMerging = false;
-			}
-		}
-	} else {
-		for (uint32_t i = 0; i < e131bridge::MAX_PORTS; i++) {
-			if (m_OutputPort[i].IsTransmitting) {
-				if ((bSourceA) && (m_OutputPort[i].sourceA.nIp != 0)) {
-					m_OutputPort[i].sourceA.nIp = 0;
-					memset(m_OutputPort[i].sourceA.cid, 0, e131::CID_LENGTH);
-					m_OutputPort[i].IsMerging = false;
-				}
+	m_State.IsNetworkDataLoss = true;
+	m_State.IsMergeMode = false;
+	m_State.IsSynchronized = false;
+	m_State.IsForcedSynchronized = false;
 
-				if ((bSourceB) && (m_OutputPort[i].sourceB.nIp != 0)) {
-					m_OutputPort[i].sourceB.nIp = 0;
-					memset(m_OutputPort[i].sourceB.cid, 0, e131::CID_LENGTH);
-					m_OutputPort[i].IsMerging = false;
-				}
+	auto doFailsafe = false;
 
-				if (!m_State.IsMergeMode) {
-					doFailsafe = true;
-					lightset::Data::ClearLength(i);
-					m_OutputPort[i].IsTransmitting = false;
-				}
-			}
+	for (uint32_t i = 0; i < e131bridge::MAX_PORTS; i++) {
+		if (m_OutputPort[i].IsTransmitting) {
+			doFailsafe = true;
+			SourcesClear(i);
+			lightset::Data::ClearLength(i);
+			m_OutputPort[i].IsTransmitting = false;
+			m_OutputPort[i].IsMerging = false;
 		}
 	}
 
 	if (doFailsafe) {
-		switch (m_State.failsafe) {
-		case lightset::FailSafe::HOLD:
-			break;
-		case lightset::FailSafe::OFF:
-			m_pLightSet->Blackout(true);
-			break;
-		case lightset::FailSafe::ON:
-			m_pLightSet->FullOn();
-			break;
-		default:
-			DEBUG_PRINTF("m_State.failsafe=%u", static_cast<uint32_t>(m_State.failsafe));
-			assert(0);
-			__builtin_unreachable();
-			break;
-		}
+		failsafe(m_pLightSet, m_State.failsafe);
 	}
 
 	Hardware::Get()->SetMode(hardware::ledblink::Mode::NORMAL);
@@ -667,6 +553,24 @@ void E131Bridge::SetNetworkDataLossCondition(bool bSourceA, bool bSourceB) {
 	DEBUG_EXIT
 }
 
+/**
+ * The last source of the output port has terminated its stream
+ */
+void E131Bridge::SetNetworkDataLossCondition(const uint32_t nPortIndex) {
+	DEBUG_ENTRY
+	DEBUG_PRINTF("nPortIndex=%u", nPortIndex);
+
+	m_State.IsChanged = true;
+
+	if (m_OutputPort[nPortIndex].IsTransmitting) {
+		lightset::Data::ClearLength(nPortIndex);
+		m_OutputPort[nPortIndex].IsTransmitting = false;
+		failsafe(m_pLightSet, m_State.failsafe);
+	}
+
+	DEBUG_EXIT
+}
+
 bool E131Bridge::IsValidRoot() {
 	const auto *const pRaw = reinterpret_cast<TE131RawPacket *>(m_pReceiveBuffer);
 	// 5 E1.31 use of the ACN Root Layer Protocol
@@ -0,0 +1,247 @@
+/**
+ * @file e131bridgesources.cpp
+ *
+ */
+/* Copyright (C) 2024 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <cassert>
+
+#include "e131bridge.h"
+
+#include "lightset.h"
+#include "lightsetdata.h"
+#include "lightsetmerge.h"
+
+#include "debug.h"
+
+/*
+ * The data of the sources which are merged as lightset source B.
+ * It is needed for combining more than two sources, and for promoting a source to source A.
+ */
+static uint8_t s_SourceData[e131bridge::MAX_PORTS][e131bridge::MAX_SOURCES][lightset::dmx::UNIVERSE_SIZE];
+static uint8_t s_MergeData[lightset::dmx::UNIVERSE_SIZE];
+
+static uint32_t lookup_index(const uint8_t *pCid) {
+	uint32_t nWords[4];
+	memcpy(nWords, pCid, e131::CID_LENGTH);
+	const auto nHash = (nWords[0] ^ nWords[1] ^ nWords[2] ^ nWords[3]) * 2654435761U; // Knuth multiplicative hash
+	return nHash >> (32 - __builtin_ctz(e131bridge::SOURCE_LOOKUP_SIZE));
+}
+
+static void lookup_insert(e131bridge::OutputPort& outputPort, const uint32_t nSourceIndex) {
+	auto nLookup = lookup_index(outputPort.source[nSourceIndex].cid);
+
+	while (outputPort.nLookup[nLookup] != e131bridge::SOURCE_NONE) {
+		nLookup = (nLookup + 1) & (e131bridge::SOURCE_LOOKUP_SIZE - 1);
+	}
+
+	outputPort.nLookup[nLookup] = static_cast<uint8_t>(nSourceIndex);
+}
+
+uint32_t E131Bridge::SourceFind(const uint32_t nPortIndex, const uint8_t *pCid) const {
+	assert(nPortIndex < e131bridge::MAX_PORTS);
+
+	const auto& outputPort = m_OutputPort[nPortIndex];
+	auto nLookup = lookup_index(pCid);
+
+	// The lookup table is never full, so there is always an empty entry
+	for (;;) {
+		const auto nSourceIndex = outputPort.nLookup[nLookup];
+
+		if (nSourceIndex == e131bridge::SOURCE_NONE) {
+			return e131bridge::SOURCE_NONE;
+		}
+
+		if (memcmp(outputPort.source[nSourceIndex].cid, pCid, e131::CID_LENGTH) == 0) {
+			return nSourceIndex;
+		}
+
+		nLookup = (nLookup + 1) & (e131bridge::SOURCE_LOOKUP_SIZE - 1);
+	}
+}
+
+uint32_t E131Bridge::SourceAdd(const uint32_t nPortIndex, const uint8_t *pCid, const uint8_t nPriority) {
+	assert(nPortIndex < e131bridge::MAX_PORTS);
+
+	auto& outputPort = m_OutputPort[nPortIndex];
+
+	for (uint32_t nSourceIndex = 0; nSourceIndex < e131bridge::MAX_SOURCES; nSourceIndex++) {
+		auto& source = outputPort.source[nSourceIndex];
+
+		if (source.nIp == 0) {
+			source.nIp = m_nIpAddressFrom;
+			memcpy(source.cid, pCid, e131::CID_LENGTH);
+			source.nPriority = nPriority;
+			source.nLength = 0;
+
+			lookup_insert(outputPort, nSourceIndex);
+			outputPort.nSources++;
+
+			if (outputPort.nSourceA == e131bridge::SOURCE_NONE) {
+				outputPort.nSourceA = static_cast<uint8_t>(nSourceIndex);
+			}
+
+			DEBUG_PRINTF("nPortIndex=%u, nSourceIndex=%u, nSources=%u", nPortIndex, nSourceIndex, outputPort.nSources);
+			return nSourceIndex;
+		}
+	}
+
+	DEBUG_PRINTF("nPortIndex=%u: source table is full", nPortIndex);
+	return e131bridge::SOURCE_NONE;
+}
+
+void E131Bridge::SourceRemove(const uint32_t nPortIndex, const uint32_t nSourceIndex) {
+	DEBUG_PRINTF("nPortIndex=%u, nSourceIndex=%u", nPortIndex, nSourceIndex);
+	assert(nPortIndex < e131bridge::MAX_PORTS);
+	assert(nSourceIndex < e131bridge::MAX_SOURCES);
+
+	auto& outputPort = m_OutputPort[nPortIndex];
+
+	outputPort.source[nSourceIndex].nIp = 0;
+	memset(outputPort.source[nSourceIndex].cid, 0, e131::CID_LENGTH);
+	outputPort.nSources--;
+
+	memset(outputPort.nLookup, e131bridge::SOURCE_NONE, sizeof(outputPort.nLookup));
+
+	for (uint32_t i = 0; i < e131bridge::MAX_SOURCES; i++) {
+		if (outputPort.source[i].nIp != 0) {
+			lookup_insert(outputPort, i);
+		}
+	}
+
+	if (nSourceIndex == outputPort.nSourceA) {
+		outputPort.nSourceA = e131bridge::SOURCE_NONE;
+
+		for (uint32_t i = 0; i < e131bridge::MAX_SOURCES; i++) {
+			const auto& source = outputPort.source[i];
+
+			if ((source.nIp != 0) && (source.nLength != 0)) {
+				outputPort.nSourceA = static_cast<uint8_t>(i);
+				lightset::Data::SetSourceA(nPortIndex, s_SourceData[nPortIndex][i], source.nLength);
+				break;
+			}
+		}
+	}
+
+	if (outputPort.nSourceA != e131bridge::SOURCE_NONE) {
+		SourcesMergeB(nPortIndex);
+	}
+}
+
+void E131Bridge::SourcesClear(const uint32_t nPortIndex) {
+	assert(nPortIndex < e131bridge::MAX_PORTS);
+
+	auto& outputPort = m_OutputPort[nPortIndex];
+
+	for (auto& source : outputPort.source) {
+		source.nIp = 0;
+		memset(source.cid, 0, e131::CID_LENGTH);
+		source.nLength = 0;
+	}
+
+	memset(outputPort.nLookup, e131bridge::SOURCE_NONE, sizeof(outputPort.nLookup));
+
+	outputPort.nSources = 0;
+	outputPort.nSourceA = e131bridge::SOURCE_NONE;
+	outputPort.nPriority = e131::priority::LOWEST;
+}
+
+void E131Bridge::SourcesExpire(const uint32_t nPortIndex) {
+	assert(nPortIndex < e131bridge::MAX_PORTS);
+
+	if (m_State.bDisableMergeTimeout) {
+		return;
+	}
+
+	auto& outputPort = m_OutputPort[nPortIndex];
+
+	for (uint32_t nSourceIndex = 0; nSourceIndex < e131bridge::MAX_SOURCES; nSourceIndex++) {
+		const auto& source = outputPort.source[nSourceIndex];
+
+		if ((source.nIp != 0) && ((m_nCurrentPacketMillis - source.nMillis) > (e131::MERGE_TIMEOUT_SECONDS * 1000U))) {
+			SourceRemove(nPortIndex, nSourceIndex);
+		}
+	}
+}
+
+void E131Bridge::SourceSetData(const uint32_t nPortIndex, const uint32_t nSourceIndex, const uint8_t *pData, const uint32_t nLength) {
+	assert(nPortIndex < e131bridge::MAX_PORTS);
+	assert(nSourceIndex < e131bridge::MAX_SOURCES);
+
+	auto& source = m_OutputPort[nPortIndex].source[nSourceIndex];
+	auto *pSourceData = s_SourceData[nPortIndex][nSourceIndex];
+	const auto nSize = std::min(nLength, lightset::dmx::UNIVERSE_SIZE);
+
+	memcpy(pSourceData, pData, nSize);
+
+	// Slots beyond the length do not contribute to a HTP merge
+	if (source.nLength > nSize) {
+		memset(&pSourceData[nSize], 0, source.nLength - nSize);
+	}
+
+	source.nLength = static_cast<uint16_t>(nSize);
+}
+
+/**
+ * Merge all sources, other than source A, as lightset source B.
+ */
+void E131Bridge::SourcesMergeB(const uint32_t nPortIndex) {
+	assert(nPortIndex < e131bridge::MAX_PORTS);
+
+	const auto& outputPort = m_OutputPort[nPortIndex];
+	uint32_t nLength = 0;
+	uint32_t nCount = 0;
+
+	for (uint32_t nSourceIndex = 0; nSourceIndex < e131bridge::MAX_SOURCES; nSourceIndex++) {
+		const auto& source = outputPort.source[nSourceIndex];
+
+		if ((source.nIp == 0) || (nSourceIndex == outputPort.nSourceA) || (source.nLength == 0)) {
+			continue;
+		}
+
+		if (nCount == 0) {
+			memcpy(s_MergeData, s_SourceData[nPortIndex][nSourceIndex], source.nLength);
+		} else if (outputPort.mergeMode == lightset::MergeMode::HTP) {
+			if (source.nLength > nLength) {
+				memset(&s_MergeData[nLength], 0, source.nLength - nLength);
+			}
+			lightset::merge::max(s_MergeData, s_SourceData[nPortIndex][nSourceIndex], source.nLength);
+		}
+
+		nLength = std::max(nLength, static_cast<uint32_t>(source.nLength));
+		nCount++;
+	}
+
+	if (nCount != 0) {
+		lightset::Data::MergeSourceB(nPortIndex, s_MergeData, nLength, outputPort.mergeMode);
+		return;
+	}
+
+	// No other source left, remove its contribution to the HTP merge
+	if ((outputPort.mergeMode == lightset::MergeMode::HTP) && (lightset::Data::GetLength(nPortIndex) != 0)) {
+		memset(s_MergeData, 0, lightset::dmx::UNIVERSE_SIZE);
+		lightset::Data::MergeSourceB(nPortIndex, s_MergeData, lightset::Data::GetLength(nPortIndex), lightset::MergeMode::HTP);
+	}
+}
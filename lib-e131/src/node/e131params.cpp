@@ -45,6 +45,7 @@
 
 #include "lightset.h"
 #include "lightsetparamsconst.h"
+#include "lightsetsequence.h"
 
 #include "debug.h"
 
@@ -84,6 +85,7 @@ E131Params::E131Params() {
 	}
 
 	m_Params.nFailSafe = static_cast<uint8_t>(lightset::FailSafe::HOLD);
+	m_Params.nSequenceWindow = lightset::sequence::WINDOW_MILLIS_DEFAULT;
 
 	DEBUG_PRINTF("s_nPortsMax=%u", s_nPortsMax);
 	DEBUG_EXIT
@@ -249,6 +251,17 @@ void E131Params::callbackFunction(const char *pLine) {
 		}
 		return;
 	}
+
+	if (Sscan::Uint16(pLine, LightSetParamsConst::SEQUENCE_WINDOW, value16) == Sscan::OK) {
+		m_Params.nSequenceWindow = value16;
+
+		if (value16 != lightset::sequence::WINDOW_MILLIS_DEFAULT) {
+			m_Params.nSetList |= Mask::SEQUENCE_WINDOW;
+		} else {
+			m_Params.nSetList &= ~Mask::SEQUENCE_WINDOW;
+		}
+		return;
+	}
 }
 
 void E131Params::Builder(const struct Params *pParams, char *pBuffer, uint32_t nLength, uint32_t& nSize) {
@@ -299,6 +312,7 @@ void E131Params::Builder(const struct Params *pParams, char *pBuffer, uint32_t n
 
 	builder.AddComment("#");
 	builder.Add(LightSetParamsConst::DISABLE_MERGE_TIMEOUT, isMaskSet(Mask::DISABLE_MERGE_TIMEOUT));
+	builder.Add(LightSetParamsConst::SEQUENCE_WINDOW, m_Params.nSequenceWindow, isMaskSet(Mask::SEQUENCE_WINDOW));
 
 	nSize = builder.GetSize();
 
@@ -348,6 +362,10 @@ void E131Params::Set() {
 	if (isMaskSet(Mask::DISABLE_MERGE_TIMEOUT)) {
 		p->SetDisableMergeTimeout(true);
 	}
+
+	if (isMaskSet(Mask::SEQUENCE_WINDOW)) {
+		p->SetSequenceWindow(m_Params.nSequenceWindow);
+	}
 }
 
 void E131Params::staticCallbackFunction(void *p, const char *s) {
@@ -393,4 +411,8 @@ void E131Params::Dump() {
 	if (isMaskSet(e131params::Mask::DISABLE_MERGE_TIMEOUT)) {
 		printf(" %s=1 [Yes]\n", LightSetParamsConst::DISABLE_MERGE_TIMEOUT);
 	}
+
+	if (isMaskSet(e131params::Mask::SEQUENCE_WINDOW)) {
+		printf(" %s=%u\n", LightSetParamsConst::SEQUENCE_WINDOW, m_Params.nSequenceWindow);
+	}
 }
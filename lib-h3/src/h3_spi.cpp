@@ -242,6 +242,15 @@ static void _interrupt_handler(void) {
 	EXT_SPI->IS = intr;
 }
 
+/*
+ * A DMA transfer started with h3_spi_dma_tx_start runs in the background.
+ * Another device on the bus must wait until it is completed.
+ */
+inline static void _dma_tx_wait() {
+	while (h3_spi_dma_tx_is_active()) {
+	}
+}
+
 void __attribute__((cold)) h3_spi_begin(void) {
 	h3_gpio_fsel(EXT_SPI_CS, ALT_FUNCTION_CS);
 	h3_gpio_fsel(EXT_SPI_CLK, ALT_FUNCTION_CLK);
@@ -332,6 +341,7 @@ void __attribute__((cold)) h3_spi_end() {
 
 void h3_spi_set_speed_hz(uint32_t speed_hz) {
 	assert(speed_hz != 0);
+	_dma_tx_wait();
 
 	if (__builtin_expect((s_current_speed_hz != speed_hz), 0)) {
 		s_current_speed_hz = speed_hz;
@@ -352,6 +362,8 @@ void h3_spi_setBitOrder(h3_spi_bit_order_t bit_order) {
 }
 
 void h3_spi_setDataMode(uint8_t mode) {
+	_dma_tx_wait();
+
 	uint32_t value = EXT_SPI->TC;
 	value &= static_cast<uint32_t>(~TC_CPHA);
 	value &= static_cast<uint32_t>(~TC_CPOL);
@@ -360,6 +372,8 @@ void h3_spi_setDataMode(uint8_t mode) {
 }
 
 void h3_spi_chipSelect(uint8_t chip_select) {
+	_dma_tx_wait();
+
 	uint32_t value = EXT_SPI->TC;
 
 	if (chip_select < H3_SPI_CS_NONE) {
@@ -386,6 +400,8 @@ void h3_spi_setChipSelectPolarity([[maybe_unused]] uint8_t chip_select, uint8_t
 }
 
 void h3_spi_transfernb(char *tx_buffer, char *rx_buffer, uint32_t data_length) {
+	_dma_tx_wait();
+
 	s_spi_status.rxbuf = reinterpret_cast<uint8_t *>(rx_buffer);
 	s_spi_status.rxcnt = 0;
 	s_spi_status.txbuf = reinterpret_cast<uint8_t *>(tx_buffer);
@@ -419,6 +435,7 @@ void h3_spi_transfern(char *buffer, uint32_t data_length) {
 
 void h3_spi_writenb(const char *tx_buffer, uint32_t data_length) {
 	assert(tx_buffer != 0);
+	_dma_tx_wait();
 
 	EXT_SPI->GC &= static_cast<uint32_t>(~(GC_TP_EN));	// ignore RXFIFO
 
@@ -477,6 +494,8 @@ void h3_spi_writenb(const char *tx_buffer, uint32_t data_length) {
 }
 
 void h3_spi_write(uint16_t data) {
+	_dma_tx_wait();
+
 	EXT_SPI->GC &= static_cast<uint32_t>(~(GC_TP_EN));	// ignore RXFIFO
 
 	_clear_fifos();
@@ -503,6 +522,8 @@ void h3_spi_write(uint16_t data) {
 }
 
 uint8_t h3_spi_transfer(uint8_t data) {
+	_dma_tx_wait();
+
 	uint8_t ret;
 
 	_clear_fifos();
@@ -44,12 +44,24 @@
 # endif
 #else
 # define FUNC_PREFIX(x) x
-# if defined(LINUX_HAVE_I2C)
+# if defined(LINUX_HAVE_I2C) || defined (CONFIG_HAL_I2C_MOCK)
   void i2c_begin();
   void i2c_set_baudrate(uint32_t);
   void i2c_set_address(uint8_t);
   uint8_t i2c_write(const char *, uint32_t);
   uint8_t i2c_read(char *, uint32_t);
+# if defined (CONFIG_HAL_I2C_MOCK)
+  /**
+   * No device is accessed, the bus traffic is counted.
+   * A transaction is the address byte and the data bytes.
+   * Each address is a register file: the first byte written is the register pointer,
+   * which is incremented for each byte written or read.
+   */
+  void i2c_mock_reset();
+  uint32_t i2c_mock_get_transactions();
+  uint32_t i2c_mock_get_bytes();
+  uint8_t i2c_mock_get_register(const uint8_t nAddress, const uint8_t nRegister);
+# endif
 #else
   inline static void i2c_begin() {}
   inline static void i2c_set_baudrate([[maybe_unused]] uint32_t _q) {}
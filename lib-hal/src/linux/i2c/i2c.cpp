@@ -34,6 +34,72 @@
 
 #include "debug.h"
 
+#if defined (CONFIG_HAL_I2C_MOCK)
+static uint32_t s_nTransactions;
+static uint32_t s_nBytes;
+/*
+ * Each address is a register file with an auto-incremented register pointer
+ */
+static uint8_t s_nAddress;
+static uint8_t s_nPointer[128];
+static uint8_t s_Registers[128][256];
+
+void i2c_mock_reset() {
+	s_nTransactions = 0;
+	s_nBytes = 0;
+}
+
+uint32_t i2c_mock_get_transactions() {
+	return s_nTransactions;
+}
+
+uint32_t i2c_mock_get_bytes() {
+	return s_nBytes;
+}
+
+uint8_t i2c_mock_get_register(const uint8_t nAddress, const uint8_t nRegister) {
+	return s_Registers[nAddress & 0x7F][nRegister];
+}
+
+void i2c_begin() {
+}
+
+void i2c_set_baudrate([[maybe_unused]] uint32_t baudrate) {
+}
+
+void i2c_set_address(uint8_t address) {
+	s_nAddress = address & 0x7F;
+}
+
+uint8_t i2c_write(const char *buf, uint32_t len) {
+	s_nTransactions++;
+	s_nBytes += 1 + len;
+
+	if (len != 0) {
+		auto& nPointer = s_nPointer[s_nAddress];
+		nPointer = static_cast<uint8_t>(buf[0]);
+
+		for (uint32_t i = 1; i < len; i++) {
+			s_Registers[s_nAddress][nPointer++] = static_cast<uint8_t>(buf[i]);
+		}
+	}
+
+	return 0;
+}
+
+uint8_t i2c_read(char *buf, uint32_t len) {
+	s_nTransactions++;
+	s_nBytes += 1 + len;
+
+	auto& nPointer = s_nPointer[s_nAddress];
+
+	for (uint32_t i = 0; i < len; i++) {
+		buf[i] = static_cast<char>(s_Registers[s_nAddress][nPointer++]);
+	}
+
+	return 0;
+}
+#else
 static int i2cbus;
 static constexpr char fileName[] = "/dev/i2c-1";
 
@@ -101,3 +167,4 @@ uint8_t i2c_read(char *buf, uint32_t len) {
 
 	return 0;
 }
+#endif
@@ -202,6 +202,14 @@ public:
 	virtual lightset::OutputStyle GetOutputStyle(const uint32_t nPortIndex) const=0;
 #endif
 	// Optional
+	/**
+	 * Only the slots [nOffset, nOffset + nCount> have changed since the previous call for this port.
+	 * A nCount of 0 means that the data is identical to the previous data.
+	 * The default implementation outputs the full buffer.
+	 */
+	virtual void SetDataRange(const uint32_t nPortIndex, const uint8_t *pData, uint32_t nLength, [[maybe_unused]] const uint32_t nOffset, [[maybe_unused]] const uint32_t nCount, const bool doUpdate = true) {
+		SetData(nPortIndex, pData, nLength, doUpdate);
+	}
 	virtual void Blackout([[maybe_unused]] bool bBlackout) {}
 	virtual void FullOn() {}
 	virtual void Print() {}
@@ -80,6 +80,15 @@ public:
 		}
 	}
 
+	void SetDataRange(const uint32_t nPortIndex, const uint8_t *pData, uint32_t nLength, const uint32_t nOffset, const uint32_t nCount, const bool doUpdate) override {
+		if ((nPortIndex < 32) && (m_pA != nullptr)) {
+			return m_pA->SetDataRange(nPortIndex, pData, nLength, nOffset, nCount, doUpdate);
+		}
+		if (m_pB != nullptr) {
+			return m_pB->SetDataRange(nPortIndex & 0x3, pData, nLength, nOffset, nCount, doUpdate);
+		}
+	}
+
 	void Sync(const uint32_t nPortIndex) override {
 		if (m_pA != nullptr) {
 			m_pA->Sync(nPortIndex);
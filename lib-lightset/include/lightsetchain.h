@@ -46,6 +46,7 @@ public:
 	void Stop(const uint32_t nPortIndex) override;
 
 	void SetData(const uint32_t nPortIndex, const uint8_t *pData, uint32_t nLength, const bool doUpdate = true) override;
+	void SetDataRange(const uint32_t nPortIndex, const uint8_t *pData, uint32_t nLength, const uint32_t nOffset, const uint32_t nCount, const bool doUpdate = true) override;
 	void Sync(const uint32_t nPortIndex) override;
 	void Sync(const bool doForce = false) override;
 #if defined (OUTPUT_HAVE_STYLESWITCH)
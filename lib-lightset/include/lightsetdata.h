@@ -32,6 +32,7 @@
 #include <cassert>
 
 #include "lightset.h"
+#include "lightsetmerge.h"
 
 #if defined (GD32)
 /**
@@ -101,6 +102,13 @@ public:
 		Get().IRestore(nPortIndex, pData);
 	}
 
+	/**
+	 * Must be called before the data is modified through Backup()
+	 */
+	static void Invalidate(const uint32_t nPortIndex) {
+		Get().IInvalidate(nPortIndex);
+	}
+
 private:
 //	Data() {}
 
@@ -108,60 +116,37 @@ private:
 		assert(nPortIndex < PORTS);
 		assert(pData != nullptr);
 
-		memcpy(m_OutputPort[nPortIndex].sourceA.data, pData, nLength);
-
-		m_OutputPort[nPortIndex].nLength = nLength;
-
-		if (mergeMode == MergeMode::HTP) {
-			for (uint32_t i = 0; i < nLength; i++) {
-				const auto data = std::max(m_OutputPort[nPortIndex].sourceA.data[i], m_OutputPort[nPortIndex].sourceB.data[i]);
-				m_OutputPort[nPortIndex].data[i] = data;
-			}
-
-			return;
-		}
-
-		memcpy(m_OutputPort[nPortIndex].data, pData, nLength);
+		auto &outputPort = m_OutputPort[nPortIndex];
+		IMerge(outputPort, outputPort.sourceA, outputPort.sourceB, pData, nLength, mergeMode);
 	}
 
 	void IMergeSourceB(const uint32_t nPortIndex, const uint8_t *pData, const uint32_t nLength, const MergeMode mergeMode) {
 		assert(nPortIndex < PORTS);
 		assert(pData != nullptr);
 
-		memcpy(m_OutputPort[nPortIndex].sourceB.data, pData, nLength);
-
-		m_OutputPort[nPortIndex].nLength = nLength;
-
-		if (mergeMode == MergeMode::HTP) {
-			for (uint32_t i = 0; i < nLength; i++) {
-				const auto data = std::max(m_OutputPort[nPortIndex].sourceA.data[i], m_OutputPort[nPortIndex].sourceB.data[i]);
-				m_OutputPort[nPortIndex].data[i] = data;
-			}
-
-			return;
-		}
-
-		memcpy(m_OutputPort[nPortIndex].data, pData, nLength);
+		auto &outputPort = m_OutputPort[nPortIndex];
+		IMerge(outputPort, outputPort.sourceB, outputPort.sourceA, pData, nLength, mergeMode);
 	}
 
-	void ISet(LightSet *const pLightSet, const uint32_t nPortIndex) const {
+	void ISet(LightSet *const pLightSet, const uint32_t nPortIndex) {
 		assert(pLightSet != nullptr);
 		assert(nPortIndex < PORTS);
 
-		pLightSet->SetData(nPortIndex, m_OutputPort[nPortIndex].data, m_OutputPort[nPortIndex].nLength, false);
+		IHandOver(pLightSet, nPortIndex, false);
 	}
 
-	void IOutput(LightSet *const pLightSet, const uint32_t nPortIndex) const {
+	void IOutput(LightSet *const pLightSet, const uint32_t nPortIndex) {
 		assert(pLightSet != nullptr);
 		assert(nPortIndex < PORTS);
 
-		pLightSet->SetData(nPortIndex, m_OutputPort[nPortIndex].data, m_OutputPort[nPortIndex].nLength, true);
+		IHandOver(pLightSet, nPortIndex, true);
 	}
 
 	void IOutputClear(LightSet *const pLightSet, const uint32_t nPortIndex) {
 		assert(pLightSet != nullptr);
 		assert(nPortIndex < PORTS);
 
+		IInvalidate(nPortIndex);
 		memset(m_OutputPort[nPortIndex].data, 0, dmx::UNIVERSE_SIZE);
 		m_OutputPort[nPortIndex].nLength = dmx::UNIVERSE_SIZE;
 		IOutput(pLightSet, nPortIndex);
@@ -171,6 +156,7 @@ private:
 		assert(nPortIndex < PORTS);
 
 		m_OutputPort[nPortIndex].nLength = 0;
+		m_OutputPort[nPortIndex].IsMergedHtp = false;
 	}
 
 	uint32_t IGetLength(const uint32_t nPortIndex) const {
@@ -186,9 +172,25 @@ private:
 		assert(nPortIndex < PORTS);
 		assert(pData != nullptr);
 
+		IInvalidate(nPortIndex);
 		memcpy(m_OutputPort[nPortIndex].data, pData, dmx::UNIVERSE_SIZE);
 	}
 
+	/**
+	 * The sources which are only held in the output data are copied out,
+	 * as the output data is about to be overwritten.
+	 */
+	void IInvalidate(const uint32_t nPortIndex) {
+		assert(nPortIndex < PORTS);
+
+		auto &outputPort = m_OutputPort[nPortIndex];
+
+		IMaterialize(outputPort, outputPort.sourceA);
+		IMaterialize(outputPort, outputPort.sourceB);
+		outputPort.IsMergedHtp = false;
+		IMarkChanged(outputPort, 0, dmx::UNIVERSE_SIZE);
+	}
+
 private:
 #if !defined (LIGHTSET_PORTS)
 # define LIGHTSET_PORTS 0
@@ -202,6 +204,7 @@ private:
 
 	struct Source {
 		uint8_t data[dmx::UNIVERSE_SIZE];
+		bool IsInData;	///< The source is only held in OutputPort::data, data[] is not valid
 	};
 
 	struct OutputPort {
@@ -209,8 +212,97 @@ private:
 		Source sourceB;
 		uint8_t data[dmx::UNIVERSE_SIZE];
 		uint32_t nLength;
+		uint32_t nLengthOutput;		///< The length last handed over to the LightSet
+		uint32_t nChangedOffset;	///< Changed slots [nChangedOffset, nChangedEnd>
+		uint32_t nChangedEnd;		///< 0 : nothing has changed
+		bool IsMergedHtp;			///< data holds max(sourceA, sourceB) for nLength slots
 	};
 
+	static void IMarkChanged(OutputPort& outputPort, const uint32_t nOffset, const uint32_t nEnd) {
+		if (outputPort.nChangedEnd == 0) {
+			outputPort.nChangedOffset = nOffset;
+			outputPort.nChangedEnd = nEnd;
+			return;
+		}
+
+		outputPort.nChangedOffset = std::min(outputPort.nChangedOffset, nOffset);
+		outputPort.nChangedEnd = std::max(outputPort.nChangedEnd, nEnd);
+	}
+
+	static void IMarkChanged(OutputPort& outputPort, const uint32_t nLength, const bool isChanged, const uint32_t nOffset, const uint32_t nEnd) {
+		if (isChanged) {
+			IMarkChanged(outputPort, nOffset, nEnd);
+		}
+
+		// Slots which have not been handed over before
+		if (nLength > outputPort.nLengthOutput) {
+			IMarkChanged(outputPort, outputPort.nLengthOutput, nLength);
+		}
+	}
+
+	/**
+	 * A source which is only held in the output data must be copied
+	 * before the output data is overwritten by the other source.
+	 */
+	static void IMaterialize(const OutputPort& outputPort, Source& source) {
+		if (source.IsInData) {
+			memcpy(source.data, outputPort.data, dmx::UNIVERSE_SIZE);
+			source.IsInData = false;
+		}
+	}
+
+	static void IMerge(OutputPort& outputPort, Source& source, Source& other, const uint8_t *pData, const uint32_t nLength, const MergeMode mergeMode) {
+		uint32_t nOffset = 0;
+		uint32_t nEnd = 0;
+
+		IMaterialize(outputPort, other);
+
+		if (mergeMode == MergeMode::HTP) {
+			if (outputPort.IsMergedHtp && (outputPort.nLength == nLength)) {
+				const auto isChanged = merge::changed(source.data, pData, nLength, nOffset, nEnd);
+				IMarkChanged(outputPort, nLength, isChanged, nOffset, nEnd);
+				merge::htp_changed(outputPort.data, source.data, pData, other.data, nLength);
+			} else {
+				IMarkChanged(outputPort, 0, nLength);
+				merge::htp(outputPort.data, source.data, pData, other.data, nLength);
+				outputPort.IsMergedHtp = true;
+			}
+
+			source.IsInData = false;
+			outputPort.nLength = nLength;
+			return;
+		}
+
+		/*
+		 * LTP: the source is not copied into its own buffer, the output data holds it.
+		 * Only the changed slots are copied.
+		 */
+		const auto isChanged = merge::changed(outputPort.data, pData, nLength, nOffset, nEnd);
+
+		if (isChanged) {
+			memcpy(&outputPort.data[nOffset], &pData[nOffset], nEnd - nOffset);
+		}
+
+		IMarkChanged(outputPort, nLength, isChanged, nOffset, nEnd);
+
+		source.IsInData = true;
+		outputPort.nLength = nLength;
+		outputPort.IsMergedHtp = false;
+	}
+
+	void IHandOver(LightSet *const pLightSet, const uint32_t nPortIndex, const bool doUpdate) {
+		auto &outputPort = m_OutputPort[nPortIndex];
+		const auto nLength = outputPort.nLength;
+		const auto nEnd = std::min(outputPort.nChangedEnd, nLength);
+		const auto nOffset = std::min(outputPort.nChangedOffset, nEnd);
+
+		pLightSet->SetDataRange(nPortIndex, outputPort.data, nLength, nOffset, nEnd - nOffset, doUpdate);
+
+		outputPort.nLengthOutput = nLength;
+		outputPort.nChangedOffset = 0;
+		outputPort.nChangedEnd = 0;
+	}
+
 	OutputPort m_OutputPort[PORTS];
 };
 
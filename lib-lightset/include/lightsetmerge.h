@@ -0,0 +1,218 @@
+/**
+ * @file lightsetmerge.h
+ *
+ */
+/* Copyright (C) 2024 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef LIGHTSETMERGE_H_
+#define LIGHTSETMERGE_H_
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#if defined (__ARM_NEON) || defined (__ARM_NEON__)
+# include <arm_neon.h>
+# define LIGHTSET_MERGE_NEON
+#elif defined (__SSE2__)
+# include <emmintrin.h>
+# define LIGHTSET_MERGE_SSE2
+#endif
+
+namespace lightset {
+namespace merge {
+/**
+ * Unsigned per byte maximum of two 32-bit words (SWAR).
+ * The high bit of each byte in x is set when the lower 7 bits of a >= b.
+ * Bytes with different high bits are decided by the high bit of a.
+ */
+inline uint32_t max_u8x4(const uint32_t a, const uint32_t b) {
+	constexpr uint32_t H = 0x80808080;
+	const auto x = (a | H) - (b & ~H);
+	const auto ge = ((a & ~b) | (~(a ^ b) & x)) & H;
+	const auto mask = (ge >> 7) * 0xFF;
+	return (a & mask) | (b & ~mask);
+}
+
+inline uint32_t load_u32(const uint8_t *p) {
+	uint32_t n;
+	memcpy(&n, p, sizeof(uint32_t));
+	return n;
+}
+
+inline void store_u32(uint8_t *p, const uint32_t n) {
+	memcpy(p, &n, sizeof(uint32_t));
+}
+
+#if defined (LIGHTSET_MERGE_NEON) || defined (LIGHTSET_MERGE_SSE2)
+inline bool equal_u8x16(const uint8_t *pA, const uint8_t *pB) {
+# if defined (LIGHTSET_MERGE_NEON)
+	const auto v = vreinterpretq_u64_u8(vceqq_u8(vld1q_u8(pA), vld1q_u8(pB)));
+	return (vgetq_lane_u64(v, 0) & vgetq_lane_u64(v, 1)) == UINT64_MAX;
+# else
+	const auto v = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(pA)), _mm_loadu_si128(reinterpret_cast<const __m128i *>(pB)));
+	return _mm_movemask_epi8(v) == 0xFFFF;
+# endif
+}
+#endif
+
+/**
+ * Find the range of slots where pA and pB differ.
+ * @param [OUT] nOffset first changed slot
+ * @param [OUT] nEnd one past the last changed slot
+ * @return false when the buffers are identical
+ */
+inline bool changed(const uint8_t *pA, const uint8_t *pB, const uint32_t nLength, uint32_t& nOffset, uint32_t& nEnd) {
+	uint32_t i = 0;
+#if defined (LIGHTSET_MERGE_NEON) || defined (LIGHTSET_MERGE_SSE2)
+	while (((i + 16) <= nLength) && equal_u8x16(&pA[i], &pB[i])) {
+		i += 16;
+	}
+#endif
+	while (((i + 4) <= nLength) && (load_u32(&pA[i]) == load_u32(&pB[i]))) {
+		i += 4;
+	}
+
+	while ((i < nLength) && (pA[i] == pB[i])) {
+		i++;
+	}
+
+	if (i == nLength) {
+		return false;
+	}
+
+	nOffset = i;
+
+	auto j = nLength;
+#if defined (LIGHTSET_MERGE_NEON) || defined (LIGHTSET_MERGE_SSE2)
+	while ((j >= (nOffset + 16)) && equal_u8x16(&pA[j - 16], &pB[j - 16])) {
+		j -= 16;
+	}
+#endif
+	while ((j >= (nOffset + 4)) && (load_u32(&pA[j - 4]) == load_u32(&pB[j - 4]))) {
+		j -= 4;
+	}
+
+	// Terminates, as the slot at nOffset differs
+	while (pA[j - 1] == pB[j - 1]) {
+		j--;
+	}
+
+	nEnd = j;
+	return true;
+}
+
+/**
+ * HTP merge of a full source.
+ * Stores pNew in pSource and writes max(pNew, pOther) to pOutput.
+ * @param [OUT] pOutput
+ * @param [OUT] pSource the stored source buffer which is updated
+ * @param [IN] pNew the new data for the source
+ * @param [IN] pOther the stored buffer of the other source
+ * @param [IN] nLength
+ */
+inline void htp(uint8_t *pOutput, uint8_t *pSource, const uint8_t *pNew, const uint8_t *pOther, const uint32_t nLength) {
+	uint32_t i = 0;
+#if defined (LIGHTSET_MERGE_NEON)
+	for (; (i + 16) <= nLength; i += 16) {
+		const auto vNew = vld1q_u8(&pNew[i]);
+		vst1q_u8(&pSource[i], vNew);
+		vst1q_u8(&pOutput[i], vmaxq_u8(vNew, vld1q_u8(&pOther[i])));
+	}
+#elif defined (LIGHTSET_MERGE_SSE2)
+	for (; (i + 16) <= nLength; i += 16) {
+		const auto vNew = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&pNew[i]));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(&pSource[i]), vNew);
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(&pOutput[i]), _mm_max_epu8(vNew, _mm_loadu_si128(reinterpret_cast<const __m128i *>(&pOther[i]))));
+	}
+#else
+	for (; (i + 4) <= nLength; i += 4) {
+		const auto nNew = load_u32(&pNew[i]);
+		store_u32(&pSource[i], nNew);
+		store_u32(&pOutput[i], max_u8x4(nNew, load_u32(&pOther[i])));
+	}
+#endif
+	for (; i < nLength; i++) {
+		pSource[i] = pNew[i];
+		pOutput[i] = std::max(pNew[i], pOther[i]);
+	}
+}
+
+/**
+ * HTP merge where only the changed slots of the source are merged.
+ * The caller must guarantee that pOutput already holds max(pSource, pOther).
+ * Parameters are the same as for htp().
+ */
+inline void htp_changed(uint8_t *pOutput, uint8_t *pSource, const uint8_t *pNew, const uint8_t *pOther, const uint32_t nLength) {
+#if defined (LIGHTSET_MERGE_NEON) || defined (LIGHTSET_MERGE_SSE2)
+	// A full vector merge is cheaper than the compare and branch
+	htp(pOutput, pSource, pNew, pOther, nLength);
+#else
+	uint32_t i = 0;
+
+	for (; (i + 4) <= nLength; i += 4) {
+		const auto nNew = load_u32(&pNew[i]);
+
+		if (nNew != load_u32(&pSource[i])) {
+			store_u32(&pSource[i], nNew);
+			store_u32(&pOutput[i], max_u8x4(nNew, load_u32(&pOther[i])));
+		}
+	}
+
+	for (; i < nLength; i++) {
+		if (pNew[i] != pSource[i]) {
+			pSource[i] = pNew[i];
+			pOutput[i] = std::max(pNew[i], pOther[i]);
+		}
+	}
+#endif
+}
+
+/**
+ * Accumulating HTP, used for combining more than two sources.
+ * Writes max(pOutput, pInput) to pOutput.
+ */
+inline void max(uint8_t *pOutput, const uint8_t *pInput, const uint32_t nLength) {
+	uint32_t i = 0;
+#if defined (LIGHTSET_MERGE_NEON)
+	for (; (i + 16) <= nLength; i += 16) {
+		vst1q_u8(&pOutput[i], vmaxq_u8(vld1q_u8(&pOutput[i]), vld1q_u8(&pInput[i])));
+	}
+#elif defined (LIGHTSET_MERGE_SSE2)
+	for (; (i + 16) <= nLength; i += 16) {
+		const auto vOutput = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&pOutput[i]));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(&pOutput[i]), _mm_max_epu8(vOutput, _mm_loadu_si128(reinterpret_cast<const __m128i *>(&pInput[i]))));
+	}
+#else
+	for (; (i + 4) <= nLength; i += 4) {
+		store_u32(&pOutput[i], max_u8x4(load_u32(&pOutput[i]), load_u32(&pInput[i])));
+	}
+#endif
+	for (; i < nLength; i++) {
+		pOutput[i] = std::max(pOutput[i], pInput[i]);
+	}
+}
+
+}  // namespace merge
+}  // namespace lightset
+
+#endif /* LIGHTSETMERGE_H_ */
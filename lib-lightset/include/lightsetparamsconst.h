@@ -48,6 +48,7 @@ struct LightSetParamsConst {
 	static const char DMX_SLOT_INFO[];
 
 	static const char DISABLE_MERGE_TIMEOUT[];
+	static const char SEQUENCE_WINDOW[];
 
 	static const char FAILSAFE[];
 
@@ -0,0 +1,150 @@
+/**
+ * @file lightsetsequence.h
+ *
+ */
+/* Copyright (C) 2024 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef LIGHTSETSEQUENCE_H_
+#define LIGHTSETSEQUENCE_H_
+
+#include <cstdint>
+
+namespace lightset {
+namespace sequence {
+#if !defined (CONFIG_LIGHTSET_SEQUENCE_WINDOW_MILLIS)
+# define CONFIG_LIGHTSET_SEQUENCE_WINDOW_MILLIS	20
+#endif
+static constexpr uint32_t WINDOW_MILLIS_DEFAULT = CONFIG_LIGHTSET_SEQUENCE_WINDOW_MILLIS;
+/*
+ * E1.31 6.9.2: a packet which is -20 < B - A <= 0 behind shall be discarded.
+ * The same rule is used for Art-Net, anything further behind is a restart of the source.
+ */
+static constexpr int32_t DISCARD_RANGE = 20;
+
+enum class Result {
+	OK,			///< Output the data
+	DISCARD		///< Older than the data already output
+};
+
+struct Stats {
+	uint32_t nLost;			///< Sequence numbers skipped and not (yet) received
+	uint32_t nDuplicate;	///< Sequence number already received
+	uint32_t nReordered;	///< A skipped sequence number received within the window
+	uint32_t nLate;			///< A skipped sequence number received after the window
+};
+
+/**
+ * @return false when the port is not an output port
+ */
+typedef bool (*GetPort)(const uint32_t nPortIndex, uint16_t& nUniverse, const Stats *&pStats);
+
+/**
+ * The /json/sequence array, an element for each output port
+ */
+uint32_t json_get(char *pOutBuffer, const uint32_t nOutBufferSize, const uint32_t nPorts, GetPort getPort);
+}  // namespace sequence
+
+/**
+ * Tracks the sequence numbers of one source.
+ * A DMX packet is a complete frame, so an older frame is never output after a newer one.
+ * The packets behind the newest are discarded and counted, the window only decides
+ * whether a filled gap is counted as reordered or as late.
+ * The owner clears the tracker with memset or Reset() before use.
+ *
+ * @tparam MODULO 256 for E1.31 (0..255), 255 for Art-Net (1..255, 0 is disabled and handled by the caller)
+ */
+template<uint32_t MODULO>
+class Sequence {
+public:
+	void Reset() {
+		m_bValid = false;
+	}
+
+	void Start(const uint8_t nSequence, const uint32_t nMillis) {
+		m_nSequence = nSequence;
+		m_nMillis = nMillis;
+		m_nReceived = 1;
+		m_bValid = true;
+	}
+
+	sequence::Result Check(const uint8_t nSequence, const uint32_t nMillis, const uint32_t nWindowMillis, sequence::Stats& stats) {
+		if (__builtin_expect((!m_bValid), 0)) {
+			Start(nSequence, nMillis);
+			return sequence::Result::OK;
+		}
+
+		auto nDiff = static_cast<int32_t>((static_cast<uint32_t>(nSequence) + MODULO - m_nSequence) % MODULO);
+
+		if (nDiff >= static_cast<int32_t>(MODULO / 2)) {
+			nDiff -= static_cast<int32_t>(MODULO);
+		}
+
+		if (__builtin_expect((nDiff == 1), 1)) {
+			m_nReceived = (m_nReceived << 1) | 1;
+			m_nSequence = nSequence;
+			m_nMillis = nMillis;
+			return sequence::Result::OK;
+		}
+
+		if (nDiff > 1) {
+			stats.nLost += static_cast<uint32_t>(nDiff - 1);
+			m_nReceived = (nDiff < 32) ? ((m_nReceived << nDiff) | 1) : 1;
+			m_nSequence = nSequence;
+			m_nMillis = nMillis;
+			return sequence::Result::OK;
+		}
+
+		if (nDiff <= -sequence::DISCARD_RANGE) {
+			Start(nSequence, nMillis);
+			return sequence::Result::OK;
+		}
+
+		const auto nBit = 1U << static_cast<uint32_t>(-nDiff);
+
+		if ((m_nReceived & nBit) != 0) {
+			stats.nDuplicate++;
+		} else {
+			m_nReceived |= nBit;
+
+			if (stats.nLost != 0) {
+				stats.nLost--;
+			}
+
+			if ((nMillis - m_nMillis) <= nWindowMillis) {
+				stats.nReordered++;
+			} else {
+				stats.nLate++;
+			}
+		}
+
+		return sequence::Result::DISCARD;
+	}
+
+private:
+	uint32_t m_nMillis;		///< Arrival of the newest packet
+	uint32_t m_nReceived;	///< Bit n is set when sequence number (m_nSequence - n) was received
+	uint8_t m_nSequence;	///< The newest
+	bool m_bValid;
+};
+}  // namespace lightset
+
+#endif /* LIGHTSETSEQUENCE_H_ */
@@ -0,0 +1,76 @@
+/**
+ * @file json_get_sequence.cpp
+ *
+ */
+/* Copyright (C) 2024 by Arjan van Vught mailto:info@gd32-dmx.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cassert>
+
+#include "lightsetsequence.h"
+
+namespace lightset {
+namespace sequence {
+uint32_t json_get(char *pOutBuffer, const uint32_t nOutBufferSize, const uint32_t nPorts, GetPort getPort) {
+	const auto nBufferSize = nOutBufferSize - 2U;
+	pOutBuffer[0] = '[';
+
+	auto nLength = 1U;
+
+	for (uint32_t nPortIndex = 0; (nPortIndex < nPorts) && (nLength < nBufferSize); nPortIndex++) {
+		uint16_t nUniverse;
+		const Stats *pStats;
+
+		if (!getPort(nPortIndex, nUniverse, pStats)) {
+			continue;
+		}
+
+		const auto nSize = nBufferSize - nLength;
+		const auto n = static_cast<uint32_t>(snprintf(&pOutBuffer[nLength], nSize,
+				"{\"port\":\"%c\",\"universe\":%u,\"lost\":%u,\"duplicate\":%u,\"reordered\":%u,\"late\":%u},",
+				static_cast<char>('A' + nPortIndex),
+				static_cast<unsigned int>(nUniverse),
+				static_cast<unsigned int>(pStats->nLost),
+				static_cast<unsigned int>(pStats->nDuplicate),
+				static_cast<unsigned int>(pStats->nReordered),
+				static_cast<unsigned int>(pStats->nLate)));
+
+		if (n >= nSize) {
+			break;
+		}
+
+		nLength += n;
+	}
+
+	if (nLength != 1) {
+		pOutBuffer[nLength - 1] = ']';
+	} else {
+		pOutBuffer[1] = ']';
+		nLength = 2;
+	}
+
+	assert(nLength <= nOutBufferSize);
+	return nLength;
+}
+}  // namespace sequence
+}  // namespace lightset
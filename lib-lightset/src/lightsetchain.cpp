@@ -72,6 +72,14 @@ void LightSetChain::SetData(const uint32_t nPortIndex, const uint8_t *pData, uin
 	}
 }
 
+void LightSetChain::SetDataRange(const uint32_t nPortIndex, const uint8_t *pData, uint32_t nLength, const uint32_t nOffset, const uint32_t nCount, const bool doUpdate) {
+	assert(pData != nullptr);
+
+	for (uint32_t i = 0; i < m_nSize; i++) {
+		m_pTable[i].pLightSet->SetDataRange(nPortIndex, pData, nLength, nOffset, nCount, doUpdate);
+	}
+}
+
 void LightSetChain::Sync(const uint32_t nPortIndex) {
 	for (uint32_t i = 0; i < m_nSize; i++) {
 		m_pTable[i].pLightSet->Sync(nPortIndex);
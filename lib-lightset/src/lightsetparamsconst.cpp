@@ -75,6 +75,7 @@ const char LightSetParamsConst::DMX_START_ADDRESS[] = "dmx_start_address";
 const char LightSetParamsConst::DMX_SLOT_INFO[] = "dmx_slot_info";
 
 const char LightSetParamsConst::DISABLE_MERGE_TIMEOUT[] = "disable_merge_timeout";
+const char LightSetParamsConst::SEQUENCE_WINDOW[] = "sequence_window";
 
 const char LightSetParamsConst::FAILSAFE[] = "failsafe";
 
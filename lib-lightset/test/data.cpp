@@ -0,0 +1,232 @@
+/**
+ * @file data.cpp
+ *
+ */
+/* Copyright (C) 2024 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#include "lightset.h"
+#include "lightsetdata.h"
+
+#include "hosttest.h"
+
+using namespace lightset;
+
+namespace {
+constexpr uint32_t SLOTS = dmx::UNIVERSE_SIZE;
+
+/**
+ * Keeps a copy of the output, as a driver would do
+ */
+class Output final: public LightSet {
+public:
+	void Start([[maybe_unused]] const uint32_t nPortIndex) override {}
+	void Stop([[maybe_unused]] const uint32_t nPortIndex) override {}
+
+	void SetData([[maybe_unused]] const uint32_t nPortIndex, const uint8_t *pData, uint32_t nLength, [[maybe_unused]] const bool doUpdate) override {
+		memcpy(data, pData, nLength);
+		nOffset = 0;
+		nCount = nLength;
+	}
+
+	void SetDataRange([[maybe_unused]] const uint32_t nPortIndex, const uint8_t *pData, [[maybe_unused]] uint32_t nLength, const uint32_t nOffset, const uint32_t nCount, [[maybe_unused]] const bool doUpdate) override {
+		memcpy(&data[nOffset], &pData[nOffset], nCount);
+		this->nOffset = nOffset;
+		this->nCount = nCount;
+	}
+
+	void Sync([[maybe_unused]] const uint32_t nPortIndex) override {}
+	void Sync([[maybe_unused]] const bool doForce) override {}
+	void Blackout([[maybe_unused]] bool bBlackout) override {}
+	void FullOn() override {}
+	void Print() override {}
+	bool SetDmxStartAddress([[maybe_unused]] uint16_t nDmxStartAddress) override { return false; }
+	uint16_t GetDmxStartAddress() override { return dmx::ADDRESS_INVALID; }
+	uint16_t GetDmxFootprint() override { return 0; }
+
+	uint8_t data[SLOTS];
+	uint32_t nOffset;
+	uint32_t nCount;
+};
+
+void fill(uint8_t *pData) {
+	for (uint32_t i = 0; i < SLOTS; i++) {
+		pData[i] = static_cast<uint8_t>(rand());
+	}
+}
+
+bool is_max(const uint8_t *pOutput, const uint8_t *pA, const uint8_t *pB) {
+	for (uint32_t i = 0; i < SLOTS; i++) {
+		if (pOutput[i] != std::max(pA[i], pB[i])) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ * A single LTP source is only held in the output data.
+ * After the output data has been overwritten, a second source which joins with HTP
+ * must be merged with the last frame of the first source.
+ */
+void check_second_source(Output& output, const uint32_t nPortIndex, void (*overwrite)(Output& output, const uint32_t nPortIndex)) {
+	uint8_t a[SLOTS], b[SLOTS], old[SLOTS];
+
+	Data::ClearLength(nPortIndex);
+
+	fill(old);
+	Data::SetSourceA(nPortIndex, old, SLOTS);
+	Data::Output(&output, nPortIndex);
+
+	fill(a);
+	Data::SetSourceA(nPortIndex, a, SLOTS);
+	Data::Output(&output, nPortIndex);
+	HOSTTEST_CHECK(memcmp(output.data, a, SLOTS) == 0);
+
+	overwrite(output, nPortIndex);
+
+	fill(b);
+	Data::MergeSourceB(nPortIndex, b, SLOTS, MergeMode::HTP);
+	Data::Output(&output, nPortIndex);
+	HOSTTEST_CHECK(is_max(output.data, a, b));
+}
+
+void check_changed(Output& output, const uint32_t nPortIndex) {
+	uint8_t a[SLOTS];
+
+	Data::ClearLength(nPortIndex);
+	fill(a);
+	Data::SetSourceA(nPortIndex, a, SLOTS);
+	Data::Output(&output, nPortIndex);
+
+	a[100]++;
+	a[107]++;
+	Data::SetSourceA(nPortIndex, a, SLOTS);
+	Data::Output(&output, nPortIndex);
+	HOSTTEST_CHECK(output.nOffset == 100);
+	HOSTTEST_CHECK(output.nCount == 8);
+	HOSTTEST_CHECK(memcmp(output.data, a, SLOTS) == 0);
+
+	Data::SetSourceA(nPortIndex, a, SLOTS);
+	Data::Output(&output, nPortIndex);
+	HOSTTEST_CHECK(output.nCount == 0);
+}
+
+/*
+ * The receive path before the zero copy path: copy into the source buffer,
+ * copy into the output data, then hand over the full universe.
+ */
+struct Copies {
+	uint8_t source[SLOTS];
+	uint8_t data[SLOTS];
+};
+
+__attribute__((noinline)) void receive_copies(Copies& copies, LightSet *pLightSet, const uint8_t *pData) {
+	memcpy(copies.source, pData, SLOTS);
+	memcpy(copies.data, copies.source, SLOTS);
+	pLightSet->SetData(0, copies.data, SLOTS, true);
+}
+
+void bench(Output& output) {
+	static constexpr uint32_t ITERATIONS = 200000;
+	static constexpr uint32_t FRAMES = 64;
+	static uint8_t frames[FRAMES][SLOTS];
+	static Copies copies;
+
+	for (auto &frame : frames) {
+		fill(frame);
+	}
+
+	puts("Receive path, one universe per packet");
+
+	uint32_t nFrame = 0;
+
+	hosttest::bench("copies, full universe (before)", ITERATIONS, [&]() {
+		receive_copies(copies, &output, frames[nFrame++ % FRAMES]);
+	});
+
+	Data::ClearLength(0);
+
+	hosttest::bench("Data, LTP, all slots changed", ITERATIONS, [&]() {
+		Data::SetSourceA(0, frames[nFrame++ % FRAMES], SLOTS);
+		Data::Output(&output, 0);
+	});
+
+	// A pixel controller which changes a few pixels per frame
+	uint8_t frame[SLOTS];
+	fill(frame);
+	uint32_t nSlot = 0;
+
+	hosttest::bench("Data, LTP, 3 slots changed", ITERATIONS, [&]() {
+		frame[nSlot]++; frame[nSlot + 1]++; frame[nSlot + 2]++;
+		nSlot = (nSlot + 3) % (SLOTS - 3);
+		Data::SetSourceA(0, frame, SLOTS);
+		Data::Output(&output, 0);
+	});
+
+	hosttest::bench("Data, HTP two sources, 3 slots changed", ITERATIONS, [&]() {
+		frame[nSlot]++; frame[nSlot + 1]++; frame[nSlot + 2]++;
+		nSlot = (nSlot + 3) % (SLOTS - 3);
+		Data::MergeSourceA(0, frame, SLOTS, MergeMode::HTP);
+		Data::MergeSourceB(0, frames[0], SLOTS, MergeMode::HTP);
+		Data::Output(&output, 0);
+	});
+}
+}  // namespace
+
+int main(int argc, char **argv) {
+	srand(1);
+
+	static Output output;
+
+	check_second_source(output, 1, [](Output& output, const uint32_t nPortIndex) {
+		uint8_t restore[SLOTS];
+		fill(restore);
+		Data::Restore(nPortIndex, restore);
+		Data::Output(&output, nPortIndex);
+	});
+
+	check_second_source(output, 2, [](Output& output, const uint32_t nPortIndex) {
+		Data::OutputClear(&output, nPortIndex);
+	});
+
+	check_second_source(output, 3, [](Output& output, const uint32_t nPortIndex) {
+		// As the Art-Net failsafe playback
+		Data::Invalidate(nPortIndex);
+		memset(const_cast<uint8_t *>(Data::Backup(nPortIndex)), 0x55, SLOTS);
+		Data::Output(&output, nPortIndex);
+	});
+
+	check_changed(output, 0);
+
+	if (hosttest::is_bench(argc, argv)) {
+		bench(output);
+	}
+
+	return hosttest::exit_code("data");
+}
@@ -0,0 +1,183 @@
+/**
+ * @file merge.cpp
+ *
+ */
+/* Copyright (C) 2024 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+
+#include "lightsetmerge.h"
+
+#include "hosttest.h"
+
+using namespace lightset;
+
+static constexpr uint32_t SLOTS = 512;
+
+/*
+ * The merge before the merge engine: copy the source, then a byte loop over all slots
+ */
+__attribute__((noinline)) static void htp_bytes(uint8_t *pOutput, uint8_t *pSource, const uint8_t *pNew, const uint8_t *pOther, const uint32_t nLength) {
+	memcpy(pSource, pNew, nLength);
+
+	for (uint32_t i = 0; i < nLength; i++) {
+		pOutput[i] = std::max(pSource[i], pOther[i]);
+	}
+}
+
+static void fill(uint8_t *pData, const uint32_t nLength) {
+	for (uint32_t i = 0; i < nLength; i++) {
+		pData[i] = static_cast<uint8_t>(rand());
+	}
+}
+
+static void check_max_u8x4() {
+	uint32_t nFailed = 0;
+
+	for (uint32_t a = 0; a < 256; a++) {
+		for (uint32_t b = 0; b < 256; b++) {
+			const auto nExpected = std::max(a, b);
+			// Each byte lane, the other lanes with a different value
+			for (uint32_t nShift = 0; nShift < 32; nShift += 8) {
+				const auto nA = (a << nShift) | (0x7F807F80U & ~(0xFFU << nShift));
+				const auto nB = (b << nShift) | (0x807F807FU & ~(0xFFU << nShift));
+				const auto nMax = merge::max_u8x4(nA, nB);
+
+				if (((nMax >> nShift) & 0xFF) != nExpected) {
+					nFailed++;
+				}
+			}
+		}
+	}
+
+	HOSTTEST_CHECK(nFailed == 0);
+}
+
+static void check_htp() {
+	uint8_t new_[SLOTS], other[SLOTS], source[SLOTS], output[SLOTS], sourceRef[SLOTS], outputRef[SLOTS];
+
+	for (uint32_t nLength = 0; nLength <= SLOTS; nLength += (nLength < 40 ? 1 : 37)) {
+		fill(new_, SLOTS); fill(other, SLOTS); fill(source, SLOTS);
+		memcpy(sourceRef, source, SLOTS);
+		fill(output, SLOTS);
+		memcpy(outputRef, output, SLOTS);
+
+		merge::htp(output, source, new_, other, nLength);
+		htp_bytes(outputRef, sourceRef, new_, other, nLength);
+
+		HOSTTEST_CHECK(memcmp(output, outputRef, SLOTS) == 0);
+		HOSTTEST_CHECK(memcmp(source, sourceRef, SLOTS) == 0);
+
+		// htp_changed, starting from a merged output
+		for (uint32_t i = 0; i < nLength; i += 7) {
+			new_[i] = static_cast<uint8_t>(rand());
+		}
+
+		merge::htp_changed(output, source, new_, other, nLength);
+		htp_bytes(outputRef, sourceRef, new_, other, nLength);
+
+		HOSTTEST_CHECK(memcmp(output, outputRef, SLOTS) == 0);
+		HOSTTEST_CHECK(memcmp(source, sourceRef, SLOTS) == 0);
+
+		// max
+		merge::max(output, other, nLength);
+		for (uint32_t i = 0; i < nLength; i++) {
+			outputRef[i] = std::max(outputRef[i], other[i]);
+		}
+
+		HOSTTEST_CHECK(memcmp(output, outputRef, SLOTS) == 0);
+	}
+}
+
+static void check_changed() {
+	uint8_t a[SLOTS], b[SLOTS];
+	uint32_t nOffset = 0, nEnd = 0;
+
+	fill(a, SLOTS);
+	memcpy(b, a, SLOTS);
+
+	HOSTTEST_CHECK(!merge::changed(a, b, SLOTS, nOffset, nEnd));
+
+	for (uint32_t nRun = 0; nRun < 1000; nRun++) {
+		memcpy(b, a, SLOTS);
+
+		const auto nFirst = static_cast<uint32_t>(rand()) % SLOTS;
+		const auto nLast = nFirst + static_cast<uint32_t>(rand()) % (SLOTS - nFirst);
+
+		b[nFirst] ^= 0x01;
+		b[nLast] ^= 0x80;
+
+		HOSTTEST_CHECK(merge::changed(a, b, SLOTS, nOffset, nEnd));
+		HOSTTEST_CHECK(nOffset == nFirst);
+		HOSTTEST_CHECK(nEnd == (nLast + 1));
+	}
+}
+
+static void bench() {
+	static constexpr uint32_t ITERATIONS = 200000;
+	uint8_t new_[SLOTS], other[SLOTS], source[SLOTS], output[SLOTS];
+
+	fill(new_, SLOTS); fill(other, SLOTS); fill(source, SLOTS);
+
+	puts("HTP merge of 512 slots");
+
+	const auto fBytes = hosttest::bench("byte loop (before)", ITERATIONS, [&]() {
+		htp_bytes(output, source, new_, other, SLOTS);
+		hosttest::keep(output);
+	});
+
+	const auto fHtp = hosttest::bench("merge::htp", ITERATIONS, [&]() {
+		merge::htp(output, source, new_, other, SLOTS);
+		hosttest::keep(output);
+	});
+
+	// A typical pixel frame: a few slots changed
+	uint32_t nSlot = 0;
+	const auto fChanged = hosttest::bench("merge::changed + htp_changed, 3 slots", ITERATIONS, [&]() {
+		new_[nSlot] ^= 0x55; new_[nSlot + 1] ^= 0x55; new_[nSlot + 2] ^= 0x55;
+		nSlot = (nSlot + 3) % (SLOTS - 3);
+		uint32_t nOffset = 0, nEnd = 0;
+		hosttest::keep(merge::changed(source, new_, SLOTS, nOffset, nEnd));
+		merge::htp_changed(output, source, new_, other, SLOTS);
+		hosttest::keep(output);
+	});
+
+	printf("  slots/s: byte loop %.0f M, htp %.0f M, changed %.0f M\n",
+			SLOTS * 1e3 / fBytes, SLOTS * 1e3 / fHtp, SLOTS * 1e3 / fChanged);
+}
+
+int main(int argc, char **argv) {
+	srand(1);
+
+	check_max_u8x4();
+	check_htp();
+	check_changed();
+
+	if (hosttest::is_bench(argc, argv)) {
+		bench();
+	}
+
+	return hosttest::exit_code("merge");
+}
@@ -38,8 +38,17 @@
 #   define HOST_NAME_PREFIX				"allwinner_"
 #  endif
 #  define UDP_MAX_PORTS_ALLOWED			16
+#  if !defined (UDP_RX_QUEUE_ENTRIES)
+#   define UDP_RX_QUEUE_ENTRIES			4
+#  endif
 #  define IGMP_MAX_JOINS_ALLOWED		(4 + (8 * 4)) /* 8 outputs x 4 Universes */
 #  define TCP_MAX_TCBS_ALLOWED			16
+#  if !defined (TCP_RX_MAX_ENTRIES)
+#   define TCP_RX_MAX_ENTRIES			4
+#  endif
+#  if !defined (TCP_TX_BUFFER_SIZE)
+#   define TCP_TX_BUFFER_SIZE			8192
+#  endif
 # elif defined (GD32)
 /*
  * Supports checking IPv4 header checksum and TCP, UDP, or ICMP checksum encapsulated in IPv4 or IPv6 datagram.
@@ -51,12 +60,18 @@
 #  if !defined (UDP_MAX_PORTS_ALLOWED)
 #   define UDP_MAX_PORTS_ALLOWED		8
 #  endif
+#  if !defined (UDP_RX_QUEUE_ENTRIES)
+#   define UDP_RX_QUEUE_ENTRIES			1
+#  endif
 #  if !defined (IGMP_MAX_JOINS_ALLOWED)
 #   define IGMP_MAX_JOINS_ALLOWED		(4 + (8 * 4)) /* 8 outputs x 4 Universes */
 #  endif
 #  if !defined (TCP_MAX_TCBS_ALLOWED)
 #   define TCP_MAX_TCBS_ALLOWED			6
 #  endif
+#  if !defined (TCP_TX_BUFFER_SIZE)
+#   define TCP_TX_BUFFER_SIZE			2048
+#  endif
 # else
 #  error
 # endif
@@ -66,6 +81,10 @@
 # error
 #endif
 
+#if !defined (UDP_RX_QUEUE_ENTRIES)
+# define UDP_RX_QUEUE_ENTRIES			1
+#endif
+
 #if !defined (IGMP_MAX_JOINS_ALLOWED)
 # error
 #endif
@@ -78,4 +97,12 @@
 # error
 #endif
 
+#if !defined (TCP_RX_MAX_ENTRIES)
+# define TCP_RX_MAX_ENTRIES				2	// Must always be a power of 2
+#endif
+
+#if !defined (TCP_TX_BUFFER_SIZE)
+# define TCP_TX_BUFFER_SIZE				4096	// Per connection, must always be a power of 2
+#endif
+
 #endif /* NET_CONFIG_H_ */
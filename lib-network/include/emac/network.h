@@ -173,6 +173,12 @@ public:
 		udp_send(nHandle, reinterpret_cast<const uint8_t *>(pBuffer), nLength, to_ip, remote_port);
 	}
 
+	void SendTo(int32_t nHandle, const network::Datagram *pDatagrams, uint32_t nCount) {
+		for (uint32_t i = 0; i < nCount; i++) {
+			udp_send(nHandle, reinterpret_cast<const uint8_t *>(pDatagrams[i].pBuffer), pDatagrams[i].nLength, pDatagrams[i].nToIp, pDatagrams[i].nRemotePort);
+		}
+	}
+
 	/*
 	 * TCP/IP
 	 */
@@ -187,8 +193,11 @@ public:
 		return tcp_read(nHandleListen, ppBuffer, HandleConnection);
 	}
 
-	void TcpWrite(const int32_t nHandleListen, const uint8_t *pBuffer, uint16_t nLength, const uint32_t HandleConnection) {
-		tcp_write(nHandleListen, pBuffer, nLength, HandleConnection);
+	/**
+	 * @return the number of bytes queued, -1 when the connection is not open
+	 */
+	int32_t TcpWrite(const int32_t nHandleListen, const uint8_t *pBuffer, uint16_t nLength, const uint32_t HandleConnection) {
+		return tcp_write(nHandleListen, pBuffer, nLength, HandleConnection);
 	}
 
 	/*
@@ -37,6 +37,18 @@
 
 #include "networkparams.h"
 
+namespace network {
+namespace udp {
+static constexpr auto PORTS_ALLOWED = 32;
+
+struct Stats {
+	uint32_t nReceived;
+	uint32_t nDropped;	///< The socket receive buffer was full
+	uint32_t nOverrun;	///< The datagram was truncated to MAX_SEGMENT_LENGTH
+};
+}  // namespace udp
+}  // namespace network
+
 class Network {
 public:
 	Network(int argc, char **argv);
@@ -57,6 +69,9 @@ public:
 	uint16_t RecvFrom(int32_t nHandle, void *pBuffer, uint16_t nLength, uint32_t *pFromIp, uint16_t *pFromPort);
 	uint16_t RecvFrom(int32_t nHandle, const void **ppBuffer, uint32_t *pFromIp, uint16_t *pFromPort);
 	void SendTo(int32_t nHandle, const void *pBuffer, uint16_t nLength, uint32_t nToIp, uint16_t nRemotePort);
+	void SendTo(int32_t nHandle, const network::Datagram *pDatagrams, uint32_t nCount);
+
+	void Run();
 
 	void SetIp(uint32_t nIp);
 	void SetNetmask(uint32_t nNetmask);
@@ -188,6 +203,12 @@ public:
 		return (m_nLocalIp & m_nNetmask) == (nIp & m_nNetmask);
 	}
 
+	/**
+	 * @return 0 when nIndex is not in use
+	 */
+	uint16_t GetUdpPort(const uint32_t nIndex) const;
+	const network::udp::Stats& GetUdpStats(const uint32_t nIndex) const;
+
 	static Network *Get() {
 		return s_pThis;
 	}
@@ -198,7 +219,7 @@ public:
 
 	int32_t TcpBegin(uint16_t nLocalPort);
 	uint16_t TcpRead(const int32_t nHandle, const uint8_t **ppBuffer, uint32_t &HandleConnection);
-	void TcpWrite(const int32_t nHandle, const uint8_t *pBuffer, uint16_t nLength, const uint32_t HandleConnection);
+	int32_t TcpWrite(const int32_t nHandle, const uint8_t *pBuffer, uint16_t nLength, const uint32_t HandleConnection);
 	int32_t TcpEnd(const int32_t nHandle);
 
 private:
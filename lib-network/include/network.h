@@ -52,6 +52,16 @@ enum class ClientStatus {
 };
 }  // namespace dhcp
 
+/**
+ * Datagram for sending a batch with a single call.
+ */
+struct Datagram {
+	const void *pBuffer;
+	uint32_t nToIp;
+	uint16_t nLength;
+	uint16_t nRemotePort;
+};
+
 static constexpr uint32_t convert_to_uint(const uint8_t a, const uint8_t b, const uint8_t c, const uint8_t d) {
 	return static_cast<uint32_t>(a)       |
 		   static_cast<uint32_t>(b) << 8  |
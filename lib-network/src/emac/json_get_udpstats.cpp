@@ -0,0 +1,75 @@
+/**
+ * json_get_udpstats.cpp
+ *
+ */
+/* Copyright (C) 2024 by Arjan van Vught mailto:info@gd32-dmx.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cassert>
+
+#include "../net/net.h"
+#include "../../config/net_config.h"
+
+namespace remoteconfig {
+namespace net {
+uint32_t json_get_udpstats(char *pOutBuffer, const uint32_t nOutBufferSize) {
+	const auto nBufferSize = nOutBufferSize - 2U;
+	pOutBuffer[0] = '[';
+
+	auto nLength = 1U;
+
+	for (int nIndex = 0; (nIndex < UDP_MAX_PORTS_ALLOWED) && (nLength < nBufferSize); nIndex++) {
+		const auto nPort = udp_get_port(nIndex);
+
+		if (nPort == 0) {
+			continue;
+		}
+
+		const auto *pStats = udp_get_stats(nIndex);
+		const auto nSize = nBufferSize - nLength;
+		const auto n = static_cast<uint32_t>(snprintf(&pOutBuffer[nLength], nSize,
+				"{\"port\":%u,\"received\":%u,\"dropped\":%u,\"overrun\":%u},",
+				static_cast<unsigned int>(nPort),
+				static_cast<unsigned int>(pStats->nReceived),
+				static_cast<unsigned int>(pStats->nDropped),
+				static_cast<unsigned int>(pStats->nOverrun)));
+
+		if (n >= nSize) {
+			break;
+		}
+
+		nLength += n;
+	}
+
+	if (nLength != 1) {
+		pOutBuffer[nLength - 1] = ']';
+	} else {
+		pOutBuffer[1] = ']';
+		nLength = 2;
+	}
+
+	assert(nLength <= nOutBufferSize);
+	return nLength;
+}
+}  // namespace net
+}  // namespace remoteconfig
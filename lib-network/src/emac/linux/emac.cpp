@@ -0,0 +1,146 @@
+/**
+ * @file emac.cpp
+ *
+ */
+/* Copyright (C) 2024 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * The emac platform layer on a Linux TAP device.
+ * The bare-metal IP stack (src/net) then runs as a normal process.
+ *
+ * sudo ip tuntap add dev tap0 mode tap user $USER
+ * sudo ip addr add 192.168.2.1/24 dev tap0
+ * sudo ip link set tap0 up
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cassert>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <net/if.h>
+#include <linux/if_tun.h>
+
+#include "emac/phy.h"
+#include "emac/emac.h"
+#include "emac/net_link_check.h"
+
+#include "debug.h"
+
+#if !defined (CONFIG_NETWORK_TAP_NAME)
+# define CONFIG_NETWORK_TAP_NAME	"tap0"
+#endif
+
+static constexpr uint32_t FRAME_SIZE = 1518;
+
+static int s_nFd = -1;
+static uint8_t s_Frame[FRAME_SIZE] __attribute__ ((aligned (4)));
+
+/*
+ * The stack reports errors through the console of the board
+ */
+extern "C" int __attribute__((weak)) console_error(const char *s) {
+	return fputs(s, stderr);
+}
+
+namespace net {
+net::Link link_status_read() {
+	return (s_nFd >= 0) ? net::Link::STATE_UP : net::Link::STATE_DOWN;
+}
+}  // namespace net
+
+void __attribute__((cold)) emac_config() {
+	DEBUG_ENTRY
+
+	s_nFd = open("/dev/net/tun", O_RDWR | O_NONBLOCK);
+
+	if (s_nFd < 0) {
+		perror("open(/dev/net/tun)");
+		DEBUG_EXIT
+		return;
+	}
+
+	struct ifreq ifr;
+	memset(&ifr, 0, sizeof(struct ifreq));
+	ifr.ifr_flags = IFF_TAP | IFF_NO_PI;
+	strncpy(ifr.ifr_name, CONFIG_NETWORK_TAP_NAME, IFNAMSIZ - 1);
+
+	if (ioctl(s_nFd, TUNSETIFF, &ifr) < 0) {
+		perror("ioctl(TUNSETIFF)");
+		close(s_nFd);
+		s_nFd = -1;
+	}
+
+	DEBUG_EXIT
+}
+
+void __attribute__((cold)) emac_start(uint8_t macAddress[], net::Link& link) {
+	DEBUG_ENTRY
+
+	// Locally administered, unique per host
+	const auto nHostId = static_cast<uint32_t>(gethostid());
+
+	macAddress[0] = 0x02;
+	macAddress[1] = 0x00;
+	macAddress[2] = 0x00;
+	macAddress[3] = static_cast<uint8_t>(nHostId >> 16);
+	macAddress[4] = static_cast<uint8_t>(nHostId >> 8);
+	macAddress[5] = static_cast<uint8_t>(nHostId);
+
+	link = net::link_status_read();
+
+	printf("TAP %s, link %s\n", CONFIG_NETWORK_TAP_NAME, link == net::Link::STATE_UP ? "Up" : "Down");
+
+	DEBUG_EXIT
+}
+
+__attribute__((hot)) int emac_eth_recv(uint8_t **packetp) {
+	if (__builtin_expect((s_nFd < 0), 0)) {
+		return -1;
+	}
+
+	const auto nLength = read(s_nFd, s_Frame, sizeof(s_Frame));
+
+	if (nLength <= 0) {
+		return -1;
+	}
+
+	*packetp = s_Frame;
+	return static_cast<int>(nLength);
+}
+
+void emac_eth_send(void *packet, int len) {
+	assert(len > 0);
+
+	if (__builtin_expect((s_nFd < 0), 0)) {
+		return;
+	}
+
+	if (write(s_nFd, packet, static_cast<size_t>(len)) != len) {
+		perror("write");
+	}
+}
+
+void emac_free_pkt() {
+}
@@ -31,10 +31,17 @@
 #include <arpa/inet.h>
 #include <sys/ioctl.h>
 #include <sys/types.h>
+#include <sys/socket.h>
+#if defined (__linux__)
+# include <sys/epoll.h>
+#else
+# include <poll.h>
+#endif
 #include <net/if.h>
 #include <ifaddrs.h>
 #include <errno.h>
 #include <cassert>
+#include <algorithm>
 
 #include "network.h"
 
@@ -47,16 +54,162 @@
 
 #define MAX_SEGMENT_LENGTH		1400
 
-static uint8_t s_ReadBuffer[MAX_SEGMENT_LENGTH];
+/*
+ * Wait time in Run() when no datagrams are queued.
+ * With CONFIG_NETWORK_BUSY_POLL the sockets are polled without waiting, for the lowest latency.
+ */
+#if !defined (CONFIG_NETWORK_POLL_TIMEOUT_MS)
+# define CONFIG_NETWORK_POLL_TIMEOUT_MS		1
+#endif
+
+#if defined (CONFIG_NETWORK_BUSY_POLL)
+static constexpr auto POLL_TIMEOUT_MS = 0;
+#else
+static constexpr auto POLL_TIMEOUT_MS = CONFIG_NETWORK_POLL_TIMEOUT_MS;
+#endif
 
 namespace max {
-	static constexpr auto PORTS_ALLOWED = 32;
-	static constexpr auto ENTRIES = (1 << 2); // Must always be a power of 2
-	static constexpr auto ENTRIES_MASK [[maybe_unused]] = (ENTRIES - 1);
+	static constexpr auto PORTS_ALLOWED = network::udp::PORTS_ALLOWED;
+	static constexpr auto ENTRIES = 64;	///< Datagrams received with a single system call
+	static constexpr auto RCVBUF = (4 * 1024 * 1024);
+	static constexpr auto HANDLES = 1024;	///< Sockets below this value are direct mapped to the port index
 }
 
 static int s_ports_allowed[max::PORTS_ALLOWED];
 static int snHandles[max::PORTS_ALLOWED];
+static uint8_t s_HandleToIndex[max::HANDLES];	///< Port index + 1, 0 is not used
+
+static network::udp::Stats s_PortStats[max::PORTS_ALLOWED];
+
+/*
+ * Per port receive queue, filled in a batch and then read one datagram at the time.
+ */
+struct RxQueue {
+	uint32_t nRead;
+	uint32_t nCount;
+	uint16_t nSize[max::ENTRIES];
+	struct sockaddr_in from[max::ENTRIES];
+#if defined (__linux__)
+	struct mmsghdr msgs[max::ENTRIES];
+	struct iovec iovecs[max::ENTRIES];
+	uint8_t control[max::ENTRIES][CMSG_SPACE(sizeof(uint32_t))];	///< SO_RXQ_OVFL
+#endif
+	uint8_t data[max::ENTRIES][MAX_SEGMENT_LENGTH];
+};
+
+static RxQueue s_RxQueue[max::PORTS_ALLOWED];
+
+#if defined (__linux__)
+static int s_nEpollFd = -1;
+#endif
+
+static int32_t get_port_index(const int32_t nHandle) {
+	if (__builtin_expect((static_cast<uint32_t>(nHandle) < max::HANDLES), 1)) {
+		return static_cast<int32_t>(s_HandleToIndex[nHandle]) - 1;
+	}
+
+	for (int32_t i = 0; i < max::PORTS_ALLOWED; i++) {
+		if (snHandles[i] == nHandle) {
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+static void rx_queue_init(const uint32_t nPortIndex) {
+	auto &queue = s_RxQueue[nPortIndex];
+
+	queue.nRead = 0;
+	queue.nCount = 0;
+
+#if defined (__linux__)
+	for (uint32_t i = 0; i < max::ENTRIES; i++) {
+		queue.iovecs[i].iov_base = queue.data[i];
+		queue.iovecs[i].iov_len = MAX_SEGMENT_LENGTH;
+		memset(&queue.msgs[i], 0, sizeof(struct mmsghdr));
+		queue.msgs[i].msg_hdr.msg_iov = &queue.iovecs[i];
+		queue.msgs[i].msg_hdr.msg_iovlen = 1;
+		queue.msgs[i].msg_hdr.msg_name = &queue.from[i];
+		queue.msgs[i].msg_hdr.msg_control = queue.control[i];
+	}
+#endif
+
+	memset(&s_PortStats[nPortIndex], 0, sizeof(network::udp::Stats));
+}
+
+/**
+ * Receive all pending datagrams for the port, up to max::ENTRIES.
+ * Only called when the queue is empty.
+ */
+static void rx_queue_fill(const uint32_t nPortIndex) {
+	auto &queue = s_RxQueue[nPortIndex];
+	const auto nSocket = snHandles[nPortIndex];
+
+	assert(queue.nRead == queue.nCount);
+
+	queue.nRead = 0;
+	queue.nCount = 0;
+
+#if defined (__linux__)
+	for (uint32_t i = 0; i < max::ENTRIES; i++) {
+		queue.msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+		queue.msgs[i].msg_hdr.msg_controllen = sizeof(queue.control[i]);
+	}
+
+	const auto nMessages = recvmmsg(nSocket, queue.msgs, max::ENTRIES, MSG_DONTWAIT, nullptr);
+
+	if (nMessages == -1) {
+		if (1 && (errno != EAGAIN) && (errno != EWOULDBLOCK)) { // EAGAIN and EWOULDBLOCK can be equal
+			DEBUG_PRINTF("nSocket=%d", nSocket);
+			perror("recvmmsg");
+		}
+		return;
+	}
+
+	auto& stats = s_PortStats[nPortIndex];
+
+	for (int i = 0; i < nMessages; i++) {
+		queue.nSize[i] = static_cast<uint16_t>(queue.msgs[i].msg_len);
+
+		if (__builtin_expect(((queue.msgs[i].msg_hdr.msg_flags & MSG_TRUNC) != 0), 0)) {
+			stats.nOverrun++;
+		}
+	}
+
+	// The drop counter of the socket is cumulative, the last datagram has the most recent value
+	auto *pMsgHdr = &queue.msgs[nMessages - 1].msg_hdr;
+
+	for (auto *pCmsg = CMSG_FIRSTHDR(pMsgHdr); pCmsg != nullptr; pCmsg = CMSG_NXTHDR(pMsgHdr, pCmsg)) {
+		if ((pCmsg->cmsg_level == SOL_SOCKET) && (pCmsg->cmsg_type == SO_RXQ_OVFL)) {
+			memcpy(&stats.nDropped, CMSG_DATA(pCmsg), sizeof(uint32_t));
+		}
+	}
+
+	stats.nReceived += static_cast<uint32_t>(nMessages);
+	queue.nCount = static_cast<uint32_t>(nMessages);
+#else
+	while (queue.nCount < max::ENTRIES) {
+		socklen_t slen = sizeof(struct sockaddr_in);
+		const auto nLength = recvfrom(nSocket, queue.data[queue.nCount], MAX_SEGMENT_LENGTH, MSG_DONTWAIT, reinterpret_cast<struct sockaddr *>(&queue.from[queue.nCount]), &slen);
+
+		if (nLength == -1) {
+			if (1 && (errno != EAGAIN) && (errno != EWOULDBLOCK)) { // EAGAIN and EWOULDBLOCK can be equal
+				DEBUG_PRINTF("nSocket=%d", nSocket);
+				perror("recvfrom");
+			}
+			return;
+		}
+
+		queue.nSize[queue.nCount++] = static_cast<uint16_t>(nLength);
+		s_PortStats[nPortIndex].nReceived++;
+	}
+#endif
+}
+
+static bool rx_queue_is_empty(const uint32_t nPortIndex) {
+	return s_RxQueue[nPortIndex].nRead == s_RxQueue[nPortIndex].nCount;
+}
 
 /**
  * END
@@ -88,6 +241,13 @@ Network::Network(int argc, char **argv) {
 		snHandles[i] = -1;
 	}
 
+#if defined (__linux__)
+	if ((s_nEpollFd = epoll_create1(0)) == -1) {
+		perror("epoll_create1");
+		exit(EXIT_FAILURE);
+	}
+#endif
+
 	NetworkParams params;
 	params.Load();
 
@@ -153,6 +313,11 @@ Network::~Network() {
 			Network::End(s_ports_allowed[i]);
 		}
 	}
+
+#if defined (__linux__)
+	close(s_nEpollFd);
+	s_nEpollFd = -1;
+#endif
 }
 
 int32_t Network::Begin(uint16_t nPort) {
@@ -201,16 +366,26 @@ int32_t Network::Begin(uint16_t nPort) {
 		exit(EXIT_FAILURE);
 	}
 
-	struct timeval recv_timeout;
-	recv_timeout.tv_sec = 0;
-	recv_timeout.tv_usec = 10;
+	int val = max::RCVBUF;
+	if (setsockopt(nSocket, SOL_SOCKET, SO_RCVBUF, &val, sizeof(val)) == -1) {
+		perror("setsockopt(SO_RCVBUF)"); // Not fatal, limited by net.core.rmem_max
+	}
 
-	if (setsockopt(nSocket, SOL_SOCKET, SO_RCVTIMEO, static_cast<void*>(&recv_timeout), sizeof(recv_timeout)) == -1) {
-		perror("setsockopt(SO_RCVTIMEO)");
-		exit(EXIT_FAILURE);
+#if defined (__linux__)
+	val = 1;
+	if (setsockopt(nSocket, SOL_SOCKET, SO_RXQ_OVFL, &val, sizeof(val)) == -1) {
+		perror("setsockopt(SO_RXQ_OVFL)"); // Not fatal, the dropped counter stays 0
+	}
+#endif
+
+#if defined (CONFIG_NETWORK_BUSY_POLL) && defined (SO_BUSY_POLL)
+	val = 50; // us
+	if (setsockopt(nSocket, SOL_SOCKET, SO_BUSY_POLL, &val, sizeof(val)) == -1) {
+		perror("setsockopt(SO_BUSY_POLL)"); // Not fatal, requires CAP_NET_ADMIN
 	}
+#endif
 
-	int val = 1;
+	val = 1;
 	if (setsockopt(nSocket, SOL_SOCKET, SO_REUSEADDR, &val, sizeof(val)) == -1) {
 		perror("setsockopt(SO_REUSEADDR)");
 		exit(EXIT_FAILURE);
@@ -248,6 +423,23 @@ int32_t Network::Begin(uint16_t nPort) {
 
 	snHandles[i] = nSocket;
 
+	if (nSocket < max::HANDLES) {
+		s_HandleToIndex[nSocket] = static_cast<uint8_t>(i + 1);
+	}
+
+	rx_queue_init(static_cast<uint32_t>(i));
+
+#if defined (__linux__)
+	struct epoll_event event;
+	event.events = EPOLLIN;
+	event.data.u32 = static_cast<uint32_t>(i);
+
+	if (epoll_ctl(s_nEpollFd, EPOLL_CTL_ADD, nSocket, &event) == -1) {
+		perror("epoll_ctl(EPOLL_CTL_ADD)");
+		exit(EXIT_FAILURE);
+	}
+#endif
+
 	DEBUG_PRINTF("nSocket=%d", nSocket);
 	DEBUG_EXIT
 	return nSocket;
@@ -277,6 +469,15 @@ int32_t Network::End(uint16_t nPort) {
 			s_ports_allowed[i] = 0;
 			puts("close");
 
+#if defined (__linux__)
+			epoll_ctl(s_nEpollFd, EPOLL_CTL_DEL, snHandles[i], nullptr);
+#endif
+			rx_queue_init(i);
+
+			if (snHandles[i] < max::HANDLES) {
+				s_HandleToIndex[snHandles[i]] = 0;
+			}
+
 			if (close(snHandles[i]) == -1) {
 				perror("unbind");
 				exit(EXIT_FAILURE);
@@ -380,33 +581,99 @@ void Network::LeaveGroup(int32_t nHandle, uint32_t ip) {
 	}
 }
 
-uint16_t Network::RecvFrom(int32_t nHandle, void *pPacket, uint16_t nSize, uint32_t *pFromIp, uint16_t *pFromPort) {
-	assert(pPacket != nullptr);
+/**
+ * Wait for datagrams on all ports, unless there are queued datagrams not yet read.
+ */
+void Network::Run() {
+	for (uint32_t i = 0; i < max::PORTS_ALLOWED; i++) {
+		if ((snHandles[i] != -1) && !rx_queue_is_empty(i)) {
+			return;
+		}
+	}
+
+#if defined (__linux__)
+	struct epoll_event events[max::PORTS_ALLOWED];
+
+	const auto nEvents = epoll_wait(s_nEpollFd, events, max::PORTS_ALLOWED, POLL_TIMEOUT_MS);
+
+	if (nEvents == -1) {
+		if (errno != EINTR) {
+			perror("epoll_wait");
+		}
+		return;
+	}
+
+	for (int i = 0; i < nEvents; i++) {
+		if (events[i].events & EPOLLIN) {
+			rx_queue_fill(events[i].data.u32);
+		}
+	}
+#else
+	struct pollfd fds[max::PORTS_ALLOWED];
+	uint32_t nPortIndex[max::PORTS_ALLOWED];
+	nfds_t nfds = 0;
+
+	for (uint32_t i = 0; i < max::PORTS_ALLOWED; i++) {
+		if (snHandles[i] != -1) {
+			fds[nfds].fd = snHandles[i];
+			fds[nfds].events = POLLIN;
+			fds[nfds].revents = 0;
+			nPortIndex[nfds++] = i;
+		}
+	}
+
+	if (poll(fds, nfds, POLL_TIMEOUT_MS) <= 0) {
+		return;
+	}
+
+	for (nfds_t i = 0; i < nfds; i++) {
+		if (fds[i].revents & POLLIN) {
+			rx_queue_fill(nPortIndex[i]);
+		}
+	}
+#endif
+}
+
+uint16_t Network::RecvFrom(int32_t nHandle, const void **ppBuffer, uint32_t *pFromIp, uint16_t *pFromPort) {
+	assert(ppBuffer != nullptr);
 	assert(pFromIp != nullptr);
 	assert(pFromPort != nullptr);
 
-	int recv_len;
-	struct sockaddr_in si_other;
-	socklen_t slen = sizeof(si_other);
+	const auto nPortIndex = get_port_index(nHandle);
 
+	if (__builtin_expect((nPortIndex < 0), 0)) {
+		return 0;
+	}
 
-	if ((recv_len = recvfrom(nHandle, pPacket, nSize, 0, reinterpret_cast<struct sockaddr*>(&si_other), &slen)) == -1) {
-		if (1 && (errno != EAGAIN) && (errno != EWOULDBLOCK)) { // EAGAIN and EWOULDBLOCK can be equal
-			DEBUG_PRINTF("nHandle=%d", nHandle);
-			perror("recvfrom");
+	if (rx_queue_is_empty(static_cast<uint32_t>(nPortIndex))) {
+		rx_queue_fill(static_cast<uint32_t>(nPortIndex));
+
+		if (rx_queue_is_empty(static_cast<uint32_t>(nPortIndex))) {
+			return 0;
 		}
-		return 0;
 	}
 
-	*pFromIp = si_other.sin_addr.s_addr;
-	*pFromPort = ntohs(si_other.sin_port);
+	auto &queue = s_RxQueue[nPortIndex];
+	const auto nEntry = queue.nRead++;
+
+	*ppBuffer = queue.data[nEntry];
+	*pFromIp = queue.from[nEntry].sin_addr.s_addr;
+	*pFromPort = ntohs(queue.from[nEntry].sin_port);
 
-	return recv_len;
+	return queue.nSize[nEntry];
 }
 
-uint16_t Network::RecvFrom(int32_t nHandle, const void **ppBuffer, uint32_t *pFromIp, uint16_t *pFromPort) {
-	*ppBuffer = &s_ReadBuffer;
-	return RecvFrom(nHandle, s_ReadBuffer, MAX_SEGMENT_LENGTH, pFromIp, pFromPort);
+uint16_t Network::RecvFrom(int32_t nHandle, void *pPacket, uint16_t nSize, uint32_t *pFromIp, uint16_t *pFromPort) {
+	assert(pPacket != nullptr);
+
+	const void *pBuffer;
+	const auto nLength = std::min(nSize, RecvFrom(nHandle, &pBuffer, pFromIp, pFromPort));
+
+	if (nLength != 0) {
+		memcpy(pPacket, pBuffer, nLength);
+	}
+
+	return nLength;
 }
 
 void Network::SendTo(int32_t nHandle, const void *pPacket, uint16_t nSize, uint32_t nToIp, uint16_t nRemotePort) {
@@ -428,6 +695,55 @@ void Network::SendTo(int32_t nHandle, const void *pPacket, uint16_t nSize, uint3
 	}
 }
 
+void Network::SendTo(int32_t nHandle, const network::Datagram *pDatagrams, uint32_t nCount) {
+	assert(pDatagrams != nullptr);
+#if defined (__linux__)
+	struct sockaddr_in to[max::ENTRIES];
+	struct iovec iovecs[max::ENTRIES];
+	struct mmsghdr msgs[max::ENTRIES];
+
+	while (nCount != 0) {
+		const auto nBatch = std::min(nCount, static_cast<uint32_t>(max::ENTRIES));
+
+		memset(msgs, 0, nBatch * sizeof(struct mmsghdr));
+
+		for (uint32_t i = 0; i < nBatch; i++) {
+			to[i].sin_family = AF_INET;
+			to[i].sin_addr.s_addr = pDatagrams[i].nToIp;
+			to[i].sin_port = htons(pDatagrams[i].nRemotePort);
+
+			iovecs[i].iov_base = const_cast<void *>(pDatagrams[i].pBuffer);
+			iovecs[i].iov_len = pDatagrams[i].nLength;
+
+			msgs[i].msg_hdr.msg_name = &to[i];
+			msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+			msgs[i].msg_hdr.msg_iov = &iovecs[i];
+			msgs[i].msg_hdr.msg_iovlen = 1;
+		}
+
+		uint32_t nSent = 0;
+
+		while (nSent < nBatch) {
+			const auto nResult = sendmmsg(nHandle, &msgs[nSent], nBatch - nSent, 0);
+
+			if (nResult == -1) {
+				perror("sendmmsg");
+				break;
+			}
+
+			nSent += static_cast<uint32_t>(nResult);
+		}
+
+		pDatagrams += nBatch;
+		nCount -= nBatch;
+	}
+#else
+	for (uint32_t i = 0; i < nCount; i++) {
+		SendTo(nHandle, pDatagrams[i].pBuffer, pDatagrams[i].nLength, pDatagrams[i].nToIp, pDatagrams[i].nRemotePort);
+	}
+#endif
+}
+
 #if defined(__linux__)
 bool Network::IsDhclient(const char* if_name) {
 	char cmd[255];
@@ -640,4 +956,14 @@ void Network::Print() {
 	printf(" Mac       : " MACSTR "\n", MAC2STR(m_aNetMacaddr));
 	printf(" Mode      : %c\n", GetAddressingMode());
 }
+
+uint16_t Network::GetUdpPort(const uint32_t nIndex) const {
+	assert(nIndex < static_cast<uint32_t>(max::PORTS_ALLOWED));
+	return static_cast<uint16_t>(s_ports_allowed[nIndex]);
+}
+
+const network::udp::Stats& Network::GetUdpStats(const uint32_t nIndex) const {
+	assert(nIndex < static_cast<uint32_t>(max::PORTS_ALLOWED));
+	return s_PortStats[nIndex];
+}
 #endif
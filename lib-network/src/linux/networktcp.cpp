@@ -25,6 +25,7 @@
  */
 
 #include <cstdio>
+#include <cerrno>
 #include <string.h>
 #include <sys/socket.h>
 #include <sys/ioctl.h>
@@ -189,15 +190,22 @@ uint16_t Network::TcpRead(const int32_t nHandle, const uint8_t **ppBuffer, uint3
 	return 0;
 }
 
-void Network::TcpWrite(const int32_t nHandle, const uint8_t *pBuffer, uint16_t nLength, const uint32_t HandleConnectionIndex) {
+int32_t Network::TcpWrite(const int32_t nHandle, const uint8_t *pBuffer, uint16_t nLength, const uint32_t HandleConnectionIndex) {
 	assert(nHandle < MAX_PORTS_ALLOWED);
 
 	DEBUG_PRINTF("Write client on fd %d [%u]", poll_set[nHandle][HandleConnectionIndex].fd, HandleConnectionIndex);
 
-	const int c = write(poll_set[nHandle][HandleConnectionIndex].fd, pBuffer, nLength);
+	const auto c = write(poll_set[nHandle][HandleConnectionIndex].fd, pBuffer, nLength);
 
 	if (c < 0) {
+		if (errno == EAGAIN) {
+			return 0;
+		}
+
 		perror("write");
+		return -1;
 	}
+
+	return static_cast<int32_t>(c);
 }
 #endif
@@ -41,31 +41,179 @@
 #include "../../config/net_config.h"
 
 #if !defined ARP_MAX_RECORDS
-static constexpr auto MAX_RECORDS = 32;
+static constexpr uint32_t MAX_RECORDS = 32;
 #else
-static constexpr auto MAX_RECORDS = ARP_MAX_RECORDS;
+static constexpr uint32_t MAX_RECORDS = ARP_MAX_RECORDS;
 #endif
 
+#if !defined ARP_MAX_PENDING
+static constexpr uint32_t MAX_PENDING = 4;
+#else
+static constexpr uint32_t MAX_PENDING = ARP_MAX_PENDING;
+#endif
+
+static_assert(MAX_RECORDS < UINT8_MAX);
+
+/*
+ * The timer runs every 100 ms
+ */
+static constexpr uint32_t MAX_AGE_TICKS = 3000;	///< 5 minutes, then a used entry is refreshed
+static constexpr uint32_t RETRY_TICKS = 5;		///< 500 ms between requests
+static constexpr uint32_t MAX_RETRIES = 3;
+
+static constexpr uint32_t HASH_BITS = 5;
+static constexpr uint32_t HASH_SIZE = 1U << HASH_BITS;
+static constexpr uint8_t END_OF_CHAIN = UINT8_MAX;
+
+enum class State: uint8_t {
+	FREE, PENDING, VALID
+};
+
 struct ArpRecord {
 	uint32_t nIp;
+	uint32_t nTicks;		///< VALID: last update, PENDING: last request
+	uint32_t nLastUsed;		///< LRU
 	uint8_t mac_address[ETH_ADDR_LEN];
+	State state;
+	uint8_t nRetries;
+	uint8_t nNext;			///< Hash chain
+};
+
+/*
+ * Frames waiting for the ARP reply of their next hop
+ */
+struct PendingFrame {
+	uint32_t nIp;			///< 0 is free
+	uint32_t nSequence;		///< Keep the order of the frames
+	uint16_t nLength;
+	uint8_t frame[sizeof(struct ether_header) + MTU_SIZE] ALIGNED;
 };
 
 static ArpRecord s_ArpRecords[MAX_RECORDS] SECTION_NETWORK ALIGNED;
-static uint16_t s_Entries SECTION_NETWORK ALIGNED;
+static uint8_t s_Hash[HASH_SIZE] SECTION_NETWORK ALIGNED;
+static PendingFrame s_PendingFrames[MAX_PENDING] SECTION_NETWORK ALIGNED;
+static uint32_t s_nTicks SECTION_NETWORK ALIGNED;
+static uint32_t s_nSequence SECTION_NETWORK ALIGNED;
 
 #ifndef NDEBUG
 # define TICKER_COUNT 100	///< 10 seconds
   static uint32_t s_ticker ;
 #endif
 
-void __attribute__((cold)) arp_cache_init() {
-	s_Entries = 0;
+static uint32_t hash(const uint32_t nIp) {
+	return (nIp * 2654435761U) >> (32 - HASH_BITS);
+}
+
+static ArpRecord *find(const uint32_t nIp) {
+	for (auto nIndex = s_Hash[hash(nIp)]; nIndex != END_OF_CHAIN; nIndex = s_ArpRecords[nIndex].nNext) {
+		if (s_ArpRecords[nIndex].nIp == nIp) {
+			return &s_ArpRecords[nIndex];
+		}
+	}
+
+	return nullptr;
+}
+
+static void pending_drop(const uint32_t nIp) {
+	for (auto& pending : s_PendingFrames) {
+		if (pending.nIp == nIp) {
+			pending.nIp = 0;
+		}
+	}
+}
+
+/**
+ * Send the parked frames for nIp in their original order
+ */
+static void pending_flush(const uint32_t nIp, const uint8_t *pMacAddress) {
+	for (;;) {
+		PendingFrame *pFirst = nullptr;
+
+		for (auto& pending : s_PendingFrames) {
+			if ((pending.nIp == nIp) && ((pFirst == nullptr) || (static_cast<int32_t>(pending.nSequence - pFirst->nSequence) < 0))) {
+				pFirst = &pending;
+			}
+		}
+
+		if (pFirst == nullptr) {
+			return;
+		}
+
+		memcpy(reinterpret_cast<struct ether_header *>(pFirst->frame)->dst, pMacAddress, ETH_ADDR_LEN);
+		emac_eth_send(reinterpret_cast<void *>(pFirst->frame), pFirst->nLength);
+		pFirst->nIp = 0;
+	}
+}
+
+static void remove(ArpRecord *pRecord) {
+	const auto nIndex = static_cast<uint8_t>(pRecord - s_ArpRecords);
+	auto *pLink = &s_Hash[hash(pRecord->nIp)];
+
+	while (*pLink != nIndex) {
+		assert(*pLink != END_OF_CHAIN);
+		pLink = &s_ArpRecords[*pLink].nNext;
+	}
+
+	*pLink = pRecord->nNext;
+
+	if (pRecord->state == State::PENDING) {
+		pending_drop(pRecord->nIp);
+	}
+
+	pRecord->nIp = 0;
+	pRecord->state = State::FREE;
+}
+
+/**
+ * A free record, otherwise the least recently used one is evicted.
+ * Resolved records are evicted before pending ones.
+ */
+static ArpRecord *allocate(const uint32_t nIp) {
+	ArpRecord *pVictim = nullptr;
 
+	for (auto& record : s_ArpRecords) {
+		if (record.state == State::FREE) {
+			pVictim = &record;
+			break;
+		}
+
+		if ((pVictim == nullptr)
+				|| ((record.state == State::VALID) && (pVictim->state == State::PENDING))
+				|| ((record.state == pVictim->state) && (static_cast<int32_t>(record.nLastUsed - pVictim->nLastUsed) < 0))) {
+			pVictim = &record;
+		}
+	}
+
+	assert(pVictim != nullptr);
+
+	if (pVictim->state != State::FREE) {
+		DEBUG_PRINTF("Evict " IPSTR, IP2STR(pVictim->nIp));
+		remove(pVictim);
+	}
+
+	const auto nBucket = hash(nIp);
+
+	pVictim->nIp = nIp;
+	pVictim->nTicks = s_nTicks;
+	pVictim->nLastUsed = s_nTicks;
+	pVictim->nRetries = 0;
+	pVictim->nNext = s_Hash[nBucket];
+	s_Hash[nBucket] = static_cast<uint8_t>(pVictim - s_ArpRecords);
+
+	return pVictim;
+}
+
+void __attribute__((cold)) arp_cache_init() {
 	for (auto& record : s_ArpRecords) {
 		memset(&record, 0, sizeof(struct ArpRecord));
 	}
 
+	memset(s_Hash, END_OF_CHAIN, sizeof(s_Hash));
+
+	for (auto& pending : s_PendingFrames) {
+		pending.nIp = 0;
+	}
+
 #ifndef NDEBUG
 	s_ticker = TICKER_COUNT;
 #endif
@@ -75,94 +223,144 @@ void arp_cache_update(const uint8_t *pMacAddress, uint32_t nIp) {
 	DEBUG_ENTRY
 	DEBUG_PRINTF(MACSTR " " IPSTR, MAC2STR(pMacAddress), IP2STR(nIp));
 
-	if (s_Entries == MAX_RECORDS) {
-		console_error("ARP cache is full\n");
-		return;
-	}
+	auto *pRecord = find(nIp);
 
-	for (auto i = 0; i < s_Entries; i++) {
-		if (s_ArpRecords[i].nIp == nIp) {
-			DEBUG_EXIT
-			return;
-		}
+	if (pRecord == nullptr) {
+		pRecord = allocate(nIp);
 	}
 
-	memcpy(s_ArpRecords[s_Entries].mac_address, pMacAddress, ETH_ADDR_LEN);
-	s_ArpRecords[s_Entries].nIp = nIp;
+	memcpy(pRecord->mac_address, pMacAddress, ETH_ADDR_LEN);
+	pRecord->nTicks = s_nTicks;
+	pRecord->nRetries = 0;
 
-	s_Entries++;
+	const auto isPending = (pRecord->state == State::PENDING);
+
+	pRecord->state = State::VALID;
+
+	if (isPending) {
+		pending_flush(nIp, pMacAddress);
+	}
 
 	DEBUG_EXIT
 }
 
+/**
+ * Does not wait for the ARP reply.
+ * On a miss, a request is sent and 0 is returned.
+ * The frame can then be parked with \ref arp_cache_pending_add.
+ */
 uint32_t arp_cache_lookup(uint32_t nIp, uint8_t *pMacAddress) {
-	DEBUG_ENTRY
-	DEBUG_PRINTF(IPSTR " " MACSTR, IP2STR(nIp), MAC2STR(pMacAddress));
+	auto *pRecord = find(nIp);
 
-	for (auto& record : s_ArpRecords) {
-		if (record.nIp == nIp) {
-			memcpy(pMacAddress, record.mac_address, ETH_ADDR_LEN);
-			DEBUG_EXIT
+	if (__builtin_expect((pRecord != nullptr), 1)) {
+		pRecord->nLastUsed = s_nTicks;
+
+		if (pRecord->state == State::VALID) {
+			memcpy(pMacAddress, pRecord->mac_address, ETH_ADDR_LEN);
 			return nIp;
 		}
 
-		if (record.nIp == 0) {
-			break;
-		}
+		return 0;	// The request is pending
 	}
 
-	if (net::link_status_read() == net::Link::STATE_DOWN) {
-		DEBUG_EXIT
+	if ((nIp == 0) || (net::link_status_read() == net::Link::STATE_DOWN)) {
 		return 0;
 	}
 
-	const auto nEntries = s_Entries;
-	int32_t nTimeout;
-	auto nRetries = 3;
+	DEBUG_PRINTF("Resolve " IPSTR, IP2STR(nIp));
 
-	while (nRetries--) {
-		arp_send_request(nIp);
+	pRecord = allocate(nIp);
+	pRecord->state = State::PENDING;
 
-		nTimeout = 0x1FFFF;
-#ifndef NDEBUG
-		nTimeout+= 0x40000;
-#endif
+	arp_send_request(nIp);
 
-		while ((nTimeout-- > 0) && (nEntries == s_Entries)) {
-			net_handle();
-		}
+	return 0;
+}
 
-		if (nEntries != s_Entries) {
-			memcpy(pMacAddress, s_ArpRecords[nEntries].mac_address, ETH_ADDR_LEN);
-			DEBUG_PRINTF("timeout=%x", nTimeout);
-			DEBUG_EXIT
-			return nIp;
-		}
+/**
+ * Park a frame until the ARP reply for nIp arrives.
+ * The frame is dropped when the resolution fails.
+ * @return false when there is no pending resolution for nIp or the queue is full
+ */
+bool arp_cache_pending_add(uint32_t nIp, const void *pFrame, uint32_t nLength) {
+	assert(nLength <= sizeof(PendingFrame::frame));
+
+	const auto *pRecord = find(nIp);
 
-		DEBUG_PRINTF("timeout=%d, current_entry=%d, s_entry_current=%d", nTimeout, nEntries, s_Entries);
+	if ((pRecord == nullptr) || (pRecord->state != State::PENDING)) {
+		return false;
 	}
 
-	DEBUG_EXIT
-	return 0;
+	for (auto& pending : s_PendingFrames) {
+		if (pending.nIp == 0) {
+			pending.nIp = nIp;
+			pending.nSequence = s_nSequence++;
+			pending.nLength = static_cast<uint16_t>(nLength);
+			memcpy(pending.frame, pFrame, nLength);
+			return true;
+		}
+	}
+
+	DEBUG_PUTS("ARP pending queue is full");
+	return false;
 }
 
 void arp_cache_dump() {
 #ifndef NDEBUG
-	printf("ARP Cache size=%d\n", s_Entries);
+	printf("ARP Cache\n");
+
+	for (uint32_t i = 0; i < MAX_RECORDS; i++) {
+		const auto& record = s_ArpRecords[i];
 
-	for (auto i = 0; i < s_Entries; i++) {
-		printf("%02d " IPSTR " " MACSTR "\n", i, IP2STR(s_ArpRecords[i].nIp),MAC2STR(s_ArpRecords[i].mac_address));
+		if (record.state != State::FREE) {
+			printf("%02d " IPSTR " " MACSTR " %c %u\n", i, IP2STR(record.nIp), MAC2STR(record.mac_address),
+					record.state == State::VALID ? 'V' : 'P', s_nTicks - record.nTicks);
+		}
 	}
 #endif
 }
 
-#ifndef NDEBUG
+/**
+ * Retries the pending requests and ages the resolved entries.
+ * An entry which has been used since its last update is refreshed before it expires,
+ * so the output is not interrupted.
+ */
 void arp_cache_timer() {
+	s_nTicks++;
+
+	for (auto& record : s_ArpRecords) {
+		if (record.state == State::PENDING) {
+			if ((s_nTicks - record.nTicks) >= RETRY_TICKS) {
+				if (++record.nRetries >= MAX_RETRIES) {
+					DEBUG_PRINTF("Failed " IPSTR, IP2STR(record.nIp));
+					remove(&record);
+				} else {
+					record.nTicks = s_nTicks;
+					arp_send_request(record.nIp);
+				}
+			}
+		} else if (record.state == State::VALID) {
+			const auto nAge = s_nTicks - record.nTicks;
+
+			if (nAge >= MAX_AGE_TICKS) {
+				const auto isUsed = static_cast<int32_t>(record.nLastUsed - record.nTicks) > 0;
+				const auto nOverdue = nAge - MAX_AGE_TICKS;
+
+				if (!isUsed || (nOverdue >= (MAX_RETRIES * RETRY_TICKS))) {
+					remove(&record);
+				} else if ((nOverdue % RETRY_TICKS) == 0) {
+					arp_send_request(record.nIp);
+				}
+			}
+		}
+	}
+
+#ifndef NDEBUG
 	s_ticker--;
 
 	if (s_ticker == 0) {
 		s_ticker = TICKER_COUNT;
 		arp_cache_dump();
 	}
-}
 #endif
+}
@@ -57,17 +57,25 @@ bool net_set_zeroconf(struct IpInfo *);
 bool net_set_dhcp(struct IpInfo *, const char *const, bool *);
 void net_dhcp_release();
 
+struct UdpStats {
+	uint32_t nReceived;
+	uint32_t nDropped;	///< The receive queue was full
+	uint32_t nOverrun;	///< The datagram was truncated to UDP_DATA_SIZE
+};
+
 int udp_begin(uint16_t);
 int udp_end(uint16_t);
 uint16_t udp_recv1(int, uint8_t *, uint16_t, uint32_t *, uint16_t *);
 uint16_t udp_recv2(int, const uint8_t **, uint32_t *, uint16_t *);
 int udp_send(int, const uint8_t *, uint16_t, uint32_t, uint16_t);
+const struct UdpStats *udp_get_stats(int);
+uint16_t udp_get_port(int);
 
 void igmp_join(uint32_t);
 void igmp_leave(uint32_t);
 
 int tcp_begin(const uint16_t);
 uint16_t tcp_read(const int32_t, const uint8_t **, uint32_t &);
-void tcp_write(const int32_t, const uint8_t *, uint16_t, const uint32_t);
+int32_t tcp_write(const int32_t, const uint8_t *, uint16_t, const uint32_t);
 
 #endif /* NET_H_ */
@@ -60,6 +60,8 @@ void arp_send_probe();
 void arp_send_announcement();
 void arp_cache_update(const uint8_t *, uint32_t);
 uint32_t arp_cache_lookup(uint32_t, uint8_t *);
+bool arp_cache_pending_add(uint32_t, const void *, uint32_t);
+void arp_cache_timer();
 
 void ip_init();
 void ip_set_ip();
@@ -87,6 +89,7 @@ void icmp_shutdown();
 
 void tcp_init();
 void tcp_run();
+void tcp_timer();
 void tcp_handle(struct t_tcp *);
 void tcp_shutdown();
 
@@ -35,10 +35,6 @@
 
 #include "../../config/net_config.h"
 
-#ifndef NDEBUG
- extern void arp_cache_timer(void);
-#endif
-
 static volatile uint32_t s_ticker;
 
 #define INTERVAL_MS (100)	// 100 msec, 1/10 second
@@ -49,8 +45,9 @@ void net_timers_run() {
 	if (__builtin_expect(((nMillis - s_ticker) > INTERVAL_MS), 0)) {
 		s_ticker = nMillis;
 		igmp_timer();
-#ifndef NDEBUG
-		arp_cache_timer();
+#if defined (ENABLE_HTTPD)
+		tcp_timer();
 #endif
+		arp_cache_timer();
 	}
 }
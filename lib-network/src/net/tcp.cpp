@@ -52,11 +52,28 @@
 #include "../config/net_config.h"
 
 #define TCP_RX_MSS						(TCP_DATA_SIZE)
-#define TCP_RX_MAX_ENTRIES				(1U << 1) // Must always be a power of 2
 #define TCP_RX_MAX_ENTRIES_MASK			(TCP_RX_MAX_ENTRIES - 1)
 #define TCP_MAX_RX_WND 					(TCP_RX_MAX_ENTRIES * TCP_RX_MSS);
 #define TCP_TX_MSS						(TCP_DATA_SIZE)
 
+static_assert((TCP_RX_MAX_ENTRIES & TCP_RX_MAX_ENTRIES_MASK) == 0, "TCP_RX_MAX_ENTRIES must be a power of 2");
+static_assert((TCP_RX_MAX_ENTRIES * TCP_RX_MSS) <= UINT16_MAX, "The receive window is 16-bit");
+static_assert((TCP_TX_BUFFER_SIZE & (TCP_TX_BUFFER_SIZE - 1)) == 0, "TCP_TX_BUFFER_SIZE must be a power of 2");
+
+static constexpr uint32_t TCP_TX_BUFFER_MASK = TCP_TX_BUFFER_SIZE - 1U;
+static constexpr uint32_t TCP_DEFAULT_MSS = 536;		///< RFC 9293 3.7.1, when there is no MSS option
+static constexpr uint32_t TCP_INITIAL_WINDOW = 3;		///< RFC 5681 3.1, segments
+static constexpr uint32_t TCP_DUPACK_THRESHOLD = 3;		///< RFC 5681 3.2
+/*
+ * RFC 6298 Retransmission timer, in milliseconds.
+ * The minimum is below the RFC's 1 second, as we are serving a LAN.
+ */
+static constexpr uint32_t TCP_RTO_INITIAL = 1000;
+static constexpr uint32_t TCP_RTO_MIN = 200;
+static constexpr uint32_t TCP_RTO_MAX = 60000;
+static constexpr uint32_t TCP_CLOCK_GRANULARITY = 100;	///< net_timers_run interval
+static constexpr uint32_t TCP_MAX_RETRIES = 8;			///< Then the connection is aborted
+
 namespace net {
 namespace tcp {
 }  // namespace tcp
@@ -85,6 +102,7 @@ struct tcb {
 		uint16_t UP;	/* send urgent pointer */
 		uint32_t WL1;	/* segment sequence number used for last window update */
 		uint32_t WL2;	/* segment acknowledgment number used for last window */
+		uint32_t MAX;	/* highest sequence number sent */
 	} SND;
 
 	uint32_t ISS;		/* initial send sequence number */
@@ -95,11 +113,35 @@ struct tcb {
 
 	uint16_t SendMSS;
 
+	/*
+	 * Send buffer, the byte with sequence number n is at pBuffer[n & TCP_TX_BUFFER_MASK].
+	 * It holds the data from SND.UNA up to nEnd.
+	 */
 	struct {
-		uint8_t *data;
-		uint16_t size;
+		uint8_t *pBuffer;
+		uint32_t nEnd;		/* sequence number following the last queued byte */
+		uint32_t nCwnd;		/* congestion window */
+		uint32_t nSsthresh;	/* slow start threshold */
+		uint32_t nRecover;	/* SND.MAX when fast recovery was entered */
+		uint16_t size;		/* data length of the segment in send_package */
+		uint8_t nDupAcks;
+		bool bFastRecovery;
 	} TX;
 
+	/* Retransmission timer */
+	struct {
+		uint32_t nStartMillis;
+		uint32_t nRTO;
+		uint32_t nSRTT;
+		uint32_t nRTTVAR;
+		uint32_t nRttSeq;	/* the segment being timed */
+		uint32_t nRttMillis;
+		uint8_t nRetries;
+		bool bRunning;
+		bool bRttActive;
+		bool bRttValid;		/* there is a first measurement */
+	} RTX;
+
 	/* Receive Sequence Variables */
 	struct {
 		uint32_t NXT; 	/* receive next */
@@ -125,7 +167,7 @@ struct QueueEntry {
 };
 
 struct ReceiveQueue {
-	uint16_t nHead;
+	uint16_t nHead;	///< Free running, the entry is at nHead & TCP_RX_MAX_ENTRIES_MASK
 	uint16_t nTail;
 	QueueEntry Entries[TCP_RX_MAX_ENTRIES];
 };
@@ -137,6 +179,7 @@ struct Port {
 };
 
 static struct Port s_Port[TCP_MAX_PORTS_ALLOWED] SECTION_NETWORK ALIGNED;
+static uint8_t s_TxBuffer[TCP_MAX_PORTS_ALLOWED][TCP_MAX_TCBS_ALLOWED][TCP_TX_BUFFER_SIZE] SECTION_NETWORK ALIGNED;
 static uint16_t s_id SECTION_NETWORK ALIGNED;
 static struct t_tcp s_tcp SECTION_NETWORK ALIGNED;
 
@@ -306,6 +349,8 @@ static void _bswap32(struct t_tcp *p_tcp) {
 }
 
 static void _init_tcb(struct tcb *pTcb, const uint16_t nLocalPort) {
+	auto *pBuffer = pTcb->TX.pBuffer;	// Assigned once in tcp_begin
+
 	memset(pTcb, 0, sizeof(struct tcb));
 
 	pTcb->nLocalPort = nLocalPort;
@@ -317,6 +362,13 @@ static void _init_tcb(struct tcb *pTcb, const uint16_t nLocalPort) {
 	pTcb->SND.UNA = pTcb->ISS;
 	pTcb->SND.NXT = pTcb->ISS;
 	pTcb->SND.WL2 = pTcb->ISS;
+	pTcb->SND.MAX = pTcb->ISS;
+
+	pTcb->TX.pBuffer = pBuffer;
+	pTcb->TX.nEnd = pTcb->ISS + 1;	// The SYN occupies ISS
+	pTcb->TX.nSsthresh = UINT16_MAX;
+
+	pTcb->RTX.nRTO = TCP_RTO_INITIAL;
 
 	NEW_STATE(pTcb, STATE_LISTEN);
 }
@@ -437,10 +489,11 @@ static void send_package(const struct tcb *pTcb, const struct SendInfo &sendInfo
 
 	DEBUG_PRINTF("SEQ=%u, ACK=%u, tcplen=%u, data_offset=%u, p_tcb->TX.size=%u", s_tcp.tcp.seqnum, s_tcp.tcp.acknum, tcplen, nDataOffset, pTcb->TX.size);
 
-	if (pTcb->TX.data != nullptr) {
-		for (auto i = 0; i < pTcb->TX.size; i++) {
-			*pData++ = pTcb->TX.data[i];
-		}
+	if (pTcb->TX.size != 0) {
+		const auto nIndex = sendInfo.SEQ & TCP_TX_BUFFER_MASK;
+		const auto nFirst = std::min(static_cast<uint32_t>(pTcb->TX.size), TCP_TX_BUFFER_SIZE - nIndex);
+		memcpy(pData, &pTcb->TX.pBuffer[nIndex], nFirst);
+		memcpy(pData + nFirst, pTcb->TX.pBuffer, pTcb->TX.size - nFirst);
 	}
 
 	s_tcp.tcp.srcpt = __builtin_bswap16(s_tcp.tcp.srcpt);
@@ -499,14 +552,24 @@ static void scan_options(struct t_tcp *pTcp, struct tcb *pTcb, const int32_t nDa
 
 	auto *pOptions = reinterpret_cast<struct Options *>(pTcp->tcp.data);
 
-	while (reinterpret_cast<uint8_t *>(pOptions + 2) <= pTcpHeaderEnd) {
+	while (reinterpret_cast<uint8_t *>(pOptions) < pTcpHeaderEnd) {
 		switch (pOptions->nKind) {
 		case Option::KIND_END:
 			return;
 			break;
 		case Option::KIND_NOP:
 			pOptions = reinterpret_cast<struct Options *>(reinterpret_cast<uint8_t *>(pOptions) + 1);
+			continue;
+		default:
 			break;
+		}
+
+		// The other options have a length, which includes the kind and length octets
+		if (((reinterpret_cast<uint8_t *>(pOptions) + 2) > pTcpHeaderEnd) || (pOptions->nLength < 2)) {
+			return;
+		}
+
+		switch (pOptions->nKind) {
 		case Option::KIND_MSS:
 			if ((pOptions->nLength == OPTION_MSS_LENGTH) && ((reinterpret_cast<uint8_t *>(pOptions) + OPTION_MSS_LENGTH) <= pTcpHeaderEnd)) {
 				const auto *p = &pOptions->Data;
@@ -547,20 +610,269 @@ static void scan_options(struct t_tcp *pTcp, struct tcb *pTcb, const int32_t nDa
 	}
 }
 
+static uint32_t send_mss(const struct tcb *pTCB) {
+	return (pTCB->SendMSS != 0) ? pTCB->SendMSS : TCP_DEFAULT_MSS;
+}
+
+static void timer_start(struct tcb *pTCB) {
+	pTCB->RTX.nStartMillis = Hardware::Get()->Millis();
+	pTCB->RTX.bRunning = true;
+}
+
+static void advance_snd_nxt(struct tcb *pTCB, const uint32_t nLength) {
+	pTCB->SND.NXT += nLength;
+
+	if (SEQ_GT(pTCB->SND.NXT, pTCB->SND.MAX)) {
+		pTCB->SND.MAX = pTCB->SND.NXT;
+	}
+}
+
+/**
+ * Sends nSize bytes from the send buffer, starting at sequence number nSeq
+ */
+static void send_data(struct tcb *pTCB, const uint32_t nSeq, const uint32_t nSize) {
+	assert(nSize <= send_mss(pTCB));
+	assert(SEQ_LEQ(nSeq + nSize, pTCB->TX.nEnd));
+
+	struct SendInfo info;
+	info.SEQ = nSeq;
+	info.ACK = pTCB->RCV.NXT;
+	info.CTL = Control::ACK;
+
+	if ((nSeq + nSize) == pTCB->TX.nEnd) {
+		info.CTL |= Control::PSH;
+	}
+
+	pTCB->TX.size = static_cast<uint16_t>(nSize);
+	send_package(pTCB, info);
+	pTCB->TX.size = 0;
+}
+
+static void send_fin(struct tcb *pTCB, const uint32_t nSeq) {
+	struct SendInfo info;
+	info.SEQ = nSeq;
+	info.ACK = pTCB->RCV.NXT;
+	info.CTL = Control::FIN | Control::ACK;
+
+	send_package(pTCB, info);
+}
+
+/**
+ * Sends the queued data as far as the send and congestion window allow.
+ * When all data is sent in the CLOSE-WAIT state, the FIN follows.
+ */
+static void tcp_output(struct tcb *pTCB) {
+	if ((pTCB->state != STATE_ESTABLISHED) && (pTCB->state != STATE_CLOSE_WAIT) && (pTCB->state != STATE_LAST_ACK)) {
+		return;
+	}
+
+	const auto nMSS = send_mss(pTCB);
+	const auto nWindow = std::min(pTCB->SND.WND, pTCB->TX.nCwnd);
+
+	while (SEQ_LT(pTCB->SND.NXT, pTCB->TX.nEnd)) {
+		const auto nInFlight = pTCB->SND.NXT - pTCB->SND.UNA;
+
+		if (nInFlight >= nWindow) {
+			if ((nInFlight == 0) && !pTCB->RTX.bRunning) {
+				timer_start(pTCB);	// Zero window, the timeout sends a probe
+			}
+			return;
+		}
+
+		const auto nPending = pTCB->TX.nEnd - pTCB->SND.NXT;
+		const auto nSize = std::min(std::min(nPending, nMSS), nWindow - nInFlight);
+
+		// RFC 1122 4.2.3.4 Sender silly window syndrome avoidance
+		if ((nSize < nMSS) && (nSize < nPending) && (nInFlight != 0)) {
+			return;
+		}
+
+		send_data(pTCB, pTCB->SND.NXT, nSize);
+
+		if (!pTCB->RTX.bRttActive) {
+			pTCB->RTX.nRttSeq = pTCB->SND.NXT;
+			pTCB->RTX.nRttMillis = Hardware::Get()->Millis();
+			pTCB->RTX.bRttActive = true;
+		}
+
+		if (!pTCB->RTX.bRunning) {
+			timer_start(pTCB);
+		}
+
+		advance_snd_nxt(pTCB, nSize);
+	}
+
+	// In LAST-ACK, SND.NXT is only at the FIN after going back for a retransmission
+	if ((pTCB->SND.NXT == pTCB->TX.nEnd) && ((pTCB->state == STATE_CLOSE_WAIT) || (pTCB->state == STATE_LAST_ACK))) {
+		send_fin(pTCB, pTCB->SND.NXT);
+		advance_snd_nxt(pTCB, 1);
+
+		if (!pTCB->RTX.bRunning) {
+			timer_start(pTCB);
+		}
+
+		if (pTCB->state == STATE_CLOSE_WAIT) {
+			NEW_STATE(pTCB, STATE_LAST_ACK);
+		}
+	}
+}
+
+/**
+ * Resends the first unacknowledged segment, or the FIN
+ */
+static void retransmit_first(struct tcb *pTCB) {
+	if (SEQ_LT(pTCB->SND.UNA, pTCB->TX.nEnd)) {
+		send_data(pTCB, pTCB->SND.UNA, std::min(pTCB->TX.nEnd - pTCB->SND.UNA, send_mss(pTCB)));
+	} else if ((pTCB->state == STATE_LAST_ACK) && (pTCB->SND.UNA != pTCB->SND.MAX)) {
+		send_fin(pTCB, pTCB->SND.UNA);
+	}
+
+	pTCB->RTX.bRttActive = false;	// Karn's algorithm
+}
+
+/**
+ * RFC 6298 2. The Basic Algorithm
+ */
+static void rtt_update(struct tcb *pTCB, const uint32_t nRTT) {
+	if (!pTCB->RTX.bRttValid) {
+		pTCB->RTX.nSRTT = nRTT;
+		pTCB->RTX.nRTTVAR = nRTT / 2;
+		pTCB->RTX.bRttValid = true;
+	} else {
+		const auto nDelta = (pTCB->RTX.nSRTT > nRTT) ? (pTCB->RTX.nSRTT - nRTT) : (nRTT - pTCB->RTX.nSRTT);
+		pTCB->RTX.nRTTVAR = (3 * pTCB->RTX.nRTTVAR + nDelta) / 4;
+		pTCB->RTX.nSRTT = (7 * pTCB->RTX.nSRTT + nRTT) / 8;
+	}
+
+	const auto nRTO = pTCB->RTX.nSRTT + std::max(TCP_CLOCK_GRANULARITY, 4 * pTCB->RTX.nRTTVAR);
+	pTCB->RTX.nRTO = std::min(std::max(nRTO, TCP_RTO_MIN), TCP_RTO_MAX);
+}
+
+/**
+ * SND.UNA < SEG.ACK =< SND.MAX
+ */
+static void ack_new(struct tcb *pTCB, const uint32_t nAck) {
+	const auto nMSS = send_mss(pTCB);
+	const auto nAcked = nAck - pTCB->SND.UNA;
+
+	pTCB->SND.UNA = nAck;
+
+	if (SEQ_LT(pTCB->SND.NXT, nAck)) {
+		pTCB->SND.NXT = nAck;
+	}
+
+	if (pTCB->RTX.bRttActive && SEQ_GT(nAck, pTCB->RTX.nRttSeq)) {
+		rtt_update(pTCB, Hardware::Get()->Millis() - pTCB->RTX.nRttMillis);
+		pTCB->RTX.bRttActive = false;
+	}
+
+	pTCB->RTX.nRetries = 0;
+
+	if (pTCB->TX.bFastRecovery) {
+		if (SEQ_GEQ(nAck, pTCB->TX.nRecover)) {
+			pTCB->TX.nCwnd = pTCB->TX.nSsthresh;
+			pTCB->TX.bFastRecovery = false;
+		} else {
+			// RFC 6582 NewReno, a partial acknowledgment
+			retransmit_first(pTCB);
+			pTCB->TX.nCwnd = (pTCB->TX.nCwnd > nAcked) ? (pTCB->TX.nCwnd - nAcked + nMSS) : nMSS;
+		}
+	} else if (pTCB->TX.nCwnd < pTCB->TX.nSsthresh) {
+		pTCB->TX.nCwnd += std::min(nAcked, nMSS);
+	} else {
+		pTCB->TX.nCwnd += std::max(1U, (nMSS * nMSS) / pTCB->TX.nCwnd);
+	}
+
+	pTCB->TX.nDupAcks = 0;
+
+	if (pTCB->SND.UNA == pTCB->SND.MAX) {
+		pTCB->RTX.bRunning = false;
+	} else {
+		timer_start(pTCB);
+	}
+}
+
+/**
+ * RFC 5681 3.2 Fast Retransmit/Fast Recovery
+ */
+static void ack_duplicate(struct tcb *pTCB) {
+	const auto nMSS = send_mss(pTCB);
+
+	pTCB->TX.nDupAcks++;
+
+	if (pTCB->TX.bFastRecovery) {
+		pTCB->TX.nCwnd += nMSS;
+		return;
+	}
+
+	if (pTCB->TX.nDupAcks == TCP_DUPACK_THRESHOLD) {
+		DEBUG_PRINTF("Fast retransmit SND.UNA=%u", pTCB->SND.UNA);
+		pTCB->TX.nSsthresh = std::max((pTCB->SND.MAX - pTCB->SND.UNA) / 2, 2 * nMSS);
+		retransmit_first(pTCB);
+		pTCB->TX.nCwnd = pTCB->TX.nSsthresh + TCP_DUPACK_THRESHOLD * nMSS;
+		pTCB->TX.nRecover = pTCB->SND.MAX;
+		pTCB->TX.bFastRecovery = true;
+	}
+}
+
+static void retransmit_timeout(struct tcb *pTCB) {
+	if (++pTCB->RTX.nRetries > TCP_MAX_RETRIES) {
+		DEBUG_PUTS("Connection timed out");
+		_init_tcb(pTCB, pTCB->nLocalPort);
+		return;
+	}
+
+	pTCB->RTX.nRTO = std::min(pTCB->RTX.nRTO * 2, TCP_RTO_MAX);
+	pTCB->RTX.bRttActive = false;
+
+	timer_start(pTCB);
+
+	if (pTCB->state == STATE_SYN_RECEIVED) {
+		struct SendInfo info;
+		info.SEQ = pTCB->ISS;
+		info.ACK = pTCB->RCV.NXT;
+		info.CTL = Control::SYN | Control::ACK;
+
+		send_package(pTCB, info);
+		return;
+	}
+
+	const auto nMSS = send_mss(pTCB);
+
+	// RFC 5681 3.1 (4)
+	pTCB->TX.nSsthresh = std::max((pTCB->SND.MAX - pTCB->SND.UNA) / 2, 2 * nMSS);
+	pTCB->TX.nCwnd = nMSS;
+	pTCB->TX.nDupAcks = 0;
+	pTCB->TX.bFastRecovery = false;
+
+	// Go back to the first unacknowledged byte
+	pTCB->SND.NXT = pTCB->SND.UNA;
+
+	if ((pTCB->SND.WND == 0) && SEQ_LT(pTCB->SND.NXT, pTCB->TX.nEnd)) {
+		// Zero window probe
+		send_data(pTCB, pTCB->SND.NXT, 1);
+		advance_snd_nxt(pTCB, 1);
+		return;
+	}
+
+	tcp_output(pTCB);
+}
+
 __attribute__((hot)) void tcp_run() {
 	for (auto& port : s_Port) {
 		for (auto& tcb : port.TCB) {
-			if (tcb.state == STATE_CLOSE_WAIT) {
-				SendInfo info;
-				info.SEQ = tcb.SND.NXT;
-				info.ACK = tcb.RCV.NXT;
-				info.CTL = Control::FIN | Control::ACK;
-
-				send_package(&tcb, info);
+			tcp_output(&tcb);
+		}
+	}
+}
 
-				NEW_STATE(&tcb, STATE_LAST_ACK);
+void tcp_timer() {
+	const auto nMillis = Hardware::Get()->Millis();
 
-				tcb.SND.NXT++;
+	for (auto& port : s_Port) {
+		for (auto& tcb : port.TCB) {
+			if (tcb.RTX.bRunning && ((nMillis - tcb.RTX.nStartMillis) >= tcb.RTX.nRTO)) {
+				retransmit_timeout(&tcb);
 			}
 		}
 	}
@@ -739,6 +1051,14 @@ __attribute__((hot)) void tcp_handle(struct t_tcp *pTcp) {
 			// SND.NXT is set to ISS+1 and SND.UNA to ISS. The connection state should be changed to SYN-RECEIVED.
 			pTCB->SND.NXT = pTCB->ISS + 1;
 			pTCB->SND.UNA = pTCB->ISS;
+			pTCB->SND.MAX = pTCB->SND.NXT;
+
+			pTCB->TX.nCwnd = TCP_INITIAL_WINDOW * send_mss(pTCB);
+
+			pTCB->RTX.nRttSeq = pTCB->ISS;
+			pTCB->RTX.nRttMillis = Hardware::Get()->Millis();
+			pTCB->RTX.bRttActive = true;
+			timer_start(pTCB);
 
 			NEW_STATE(pTCB, STATE_SYN_RECEIVED);
 			DEBUG_EXIT
@@ -877,7 +1197,9 @@ __attribute__((hot)) void tcp_handle(struct t_tcp *pTcp) {
 				pTCB->SND.WL1 = SEG_SEQ;
 				pTCB->SND.WL2 = SEG_ACK;
 
-				pTCB->SND.UNA = SEG_ACK;		// got ACK for SYN
+				if (SEQ_GT(SEG_ACK, pTCB->SND.UNA)) {
+					ack_new(pTCB, SEG_ACK);		// got ACK for SYN
+				}
 
 				NEW_STATE(pTCB, STATE_ESTABLISHED);
 				return;
@@ -893,24 +1215,20 @@ __attribute__((hot)) void tcp_handle(struct t_tcp *pTcp) {
 		case STATE_FIN_WAIT_2:
 		case STATE_CLOSE_WAIT:
 		case STATE_CLOSING:
-			DEBUG_PRINTF("SND.UNA=%u, SEG_ACK=%u, SND.NXT=%u", pTCB->SND.UNA, SEG_ACK, pTCB->SND.NXT);
-
-			if (SEQ_BETWEEN_H(pTCB->SND.UNA, SEG_ACK, pTCB->SND.NXT)) {
+		case STATE_LAST_ACK:
+			DEBUG_PRINTF("SND.UNA=%u, SEG_ACK=%u, SND.NXT=%u, SND.MAX=%u", pTCB->SND.UNA, SEG_ACK, pTCB->SND.NXT, pTCB->SND.MAX);
 
-				auto nBytesAck = SEG_ACK - pTCB->SND.UNA;
-				pTCB->SND.UNA = SEG_ACK;
+			// After going back for a retransmission, the ACK can be beyond SND.NXT
+			if (SEQ_BETWEEN_H(pTCB->SND.UNA, SEG_ACK, pTCB->SND.MAX)) {
+				ack_new(pTCB, SEG_ACK);
 
-				if (SEG_ACK == pTCB->SND.NXT) {
+				if (SEG_ACK == pTCB->SND.MAX) {
 					DEBUG_PUTS("/* all segments are acknowledged */");
-				}
-
-				if (pTCB->state == STATE_FIN_WAIT_1 || pTCB->state == STATE_CLOSING) {
-					nBytesAck--;
-					DEBUG_PUTS("/* acknowledged FIN does not count */");
-				}
 
-				if (pTCB->state == STATE_ESTABLISHED && nBytesAck == 1) {
-					nBytesAck--;
+					if (pTCB->state == STATE_LAST_ACK) { 	// our FIN is now acknowledged
+						_init_tcb(pTCB, pTCB->nLocalPort);
+						break;
+					}
 				}
 
 				// update send window
@@ -920,7 +1238,16 @@ __attribute__((hot)) void tcp_handle(struct t_tcp *pTcp) {
 					pTCB->SND.WL2 = SEG_ACK;
 				}
 			} else if (SEQ_LEQ(SEG_ACK, pTCB->SND.UNA)) { /* RFC 1122 section 4.2.2.20 (g) */
-				DEBUG_PUTS("/* ignore duplicate ACK */");
+				// RFC 5681 2. Definitions, DUPLICATE ACKNOWLEDGMENT
+				if ((SEG_ACK == pTCB->SND.UNA) && (SEG_LEN == 0) && !(pTcp->tcp.control & (Control::SYN | Control::FIN))
+						&& (SEG_WND == pTCB->SND.WND) && (pTCB->SND.UNA != pTCB->SND.MAX)) {
+					ack_duplicate(pTCB);
+				}
+
+				if (pTCB->SND.WND == 0) {
+					pTCB->RTX.nRetries = 0;	// The peer answers the window probes
+				}
+
 				if (SEQ_BETWEEN_LH(pTCB->SND.UNA, SEG_ACK, pTCB->SND.NXT)) {
 					// ... but update send window
 					if ( SEQ_LT(pTCB->SND.WL1, SEG_SEQ) || (pTCB->SND.WL1 == SEG_SEQ && SEQ_LEQ(pTCB->SND.WL2, SEG_ACK))) {
@@ -929,8 +1256,8 @@ __attribute__((hot)) void tcp_handle(struct t_tcp *pTcp) {
 						pTCB->SND.WL2 = SEG_ACK;
 					}
 				}
-			} else if (SEQ_GT(SEG_ACK, pTCB->SND.NXT)) {
-				DEBUG_PRINTF("SEG_ACK=%u, SND.NXT=%u", SEG_ACK,pTCB->SND.NXT);
+			} else if (SEQ_GT(SEG_ACK, pTCB->SND.MAX)) {
+				DEBUG_PRINTF("SEG_ACK=%u, SND.MAX=%u", SEG_ACK, pTCB->SND.MAX);
 
 				sendInfo.SEQ = pTCB->SND.NXT;
 				sendInfo.ACK = pTCB->RCV.NXT;
@@ -940,11 +1267,6 @@ __attribute__((hot)) void tcp_handle(struct t_tcp *pTcp) {
 				return;
 			}
 			break;
-		case STATE_LAST_ACK:
-			if (SEG_ACK == pTCB->SND.NXT) { 	// if our FIN is now acknowledged
-				_init_tcb(pTCB, pTCB->nLocalPort);
-			}
-			break;
 		case STATE_TIME_WAIT:
 			if (SEG_ACK == pTCB->SND.NXT) {		// if our FIN is now acknowledged
 				sendInfo.SEQ = pTCB->SND.NXT;
@@ -968,9 +1290,10 @@ __attribute__((hot)) void tcp_handle(struct t_tcp *pTcp) {
 		case STATE_FIN_WAIT_1:
 		case STATE_FIN_WAIT_2:
 			if (nDataLength > 0) {
-				if (SEG_SEQ == pTCB->RCV.NXT) {
-					auto *pQueue = &s_Port[nIndexPort].receiveQueue;
-					auto *pQueueEntry = &pQueue->Entries[pQueue->nHead];
+				auto *pQueue = &s_Port[nIndexPort].receiveQueue;
+
+				if ((SEG_SEQ == pTCB->RCV.NXT) && (static_cast<uint16_t>(pQueue->nHead - pQueue->nTail) < TCP_RX_MAX_ENTRIES)) {
+					auto *pQueueEntry = &pQueue->Entries[pQueue->nHead & TCP_RX_MAX_ENTRIES_MASK];
 
 					pQueueEntry->nHandleConnection = static_cast<uint16_t>(nIndexTCB);
 					memcpy(pQueueEntry->data, reinterpret_cast<uint8_t *>(&pTcp->tcp) + nDataOffset, nDataLength);
@@ -985,7 +1308,7 @@ __attribute__((hot)) void tcp_handle(struct t_tcp *pTcp) {
 
 					send_package(pTCB, sendInfo);
 
-					pQueue->nHead = (pQueue->nHead + 1) & TCP_RX_MAX_ENTRIES_MASK;
+					pQueue->nHead++;
 				} else {
 					sendInfo.SEQ = pTCB->SND.NXT;
 					sendInfo.ACK = pTCB->RCV.NXT;
@@ -993,7 +1316,7 @@ __attribute__((hot)) void tcp_handle(struct t_tcp *pTcp) {
 
 					send_package(pTCB, sendInfo);
 
-					DEBUG_PUTS("Out of order");
+					DEBUG_PUTS("Out of order or receive queue full");
 					DEBUG_EXIT
 					return;
 				}
@@ -1095,6 +1418,7 @@ int tcp_begin(const uint16_t nLocalPort) {
 
 			for (uint32_t nIndexTCB = 0; nIndexTCB < TCP_MAX_TCBS_ALLOWED; nIndexTCB++) {
 				// create transmission control block's (TCB)
+				s_Port[i].TCB[nIndexTCB].TX.pBuffer = s_TxBuffer[i][nIndexTCB];
 				_init_tcb(&s_Port[i].TCB[nIndexTCB], nLocalPort);
 			}
 
@@ -1120,8 +1444,7 @@ uint16_t tcp_read(const int32_t nHandleListen, const uint8_t **pData, uint32_t &
 		return 0;
 	}
 
-	const auto nEntry = pQueue->nTail;
-	const auto *const pQueueEntry = &pQueue->Entries[nEntry];
+	const auto *const pQueueEntry = &pQueue->Entries[pQueue->nTail & TCP_RX_MAX_ENTRIES_MASK];
 
 	nHandleConnection = pQueueEntry->nHandleConnection;
 	*pData = pQueueEntry->data;
@@ -1130,61 +1453,55 @@ uint16_t tcp_read(const int32_t nHandleListen, const uint8_t **pData, uint32_t &
 
 	pTCB->RCV.WND += TCP_DATA_SIZE;
 
-	pQueue->nTail = (pQueue->nTail + 1) & TCP_RX_MAX_ENTRIES_MASK;
+	pQueue->nTail++;
 
 	return pQueueEntry->nSize;
 }
 
-static void _write(struct tcb *pTCB, const uint8_t *pBuffer, const uint32_t nLength, const bool isLastSegment) {
-	assert(nLength != 0);
-	assert(nLength <= static_cast<uint32_t>(TCP_DATA_SIZE));
+/**
+ * The data is queued in the send buffer of the connection and is sent as far as the windows allow.
+ * The remaining data is sent when the acknowledgments arrive.
+ * When the send buffer is full, only the part that fits is queued and the caller must write the rest later.
+ * @return the number of bytes queued, -1 when the connection is not open
+ */
+int32_t tcp_write(const int32_t nHandleListen, const uint8_t *pBuffer, uint16_t nLength, uint32_t nHandleConnection) {
+	assert(nHandleListen >= 0);
+	assert(nHandleListen < TCP_MAX_PORTS_ALLOWED);
+	assert(pBuffer != nullptr);
+	assert(nHandleConnection < TCP_MAX_TCBS_ALLOWED);
+
+	auto *pTCB = &s_Port[nHandleListen].TCB[nHandleConnection];
+	assert(pTCB != nullptr);
 
-	DEBUG_PRINTF("nLength=%u, pTCB->SND.WND=%u", nLength, pTCB->SND.WND);
+	if ((pTCB->state != STATE_ESTABLISHED) && (pTCB->state != STATE_CLOSE_WAIT)) {
+		DEBUG_PUTS("Connection is not open");
+		return -1;
+	}
 
-    if (nLength > pTCB->SND.WND) {
-    	console_error("Retry or queue the data for later transmission\n");
-        // TODO retry or queue the data for later transmission.
-        return;
-    }
+	const auto nFree = TCP_TX_BUFFER_SIZE - (pTCB->TX.nEnd - pTCB->SND.UNA);
 
-	pTCB->TX.data = const_cast<uint8_t *>(pBuffer);
-	pTCB->TX.size = nLength;
+	DEBUG_PRINTF("nLength=%u, nFree=%u, pTCB->SND.WND=%u", nLength, nFree, pTCB->SND.WND);
 
-	struct SendInfo info;
-	info.SEQ = pTCB->SND.NXT;
-	info.ACK = pTCB->RCV.NXT;
-	info.CTL = Control::ACK;
-	if (isLastSegment) {
-		info.CTL |= Control::PSH;
+	if (nLength > nFree) {
+		DEBUG_PUTS("TCP send buffer full");
+		nLength = static_cast<uint16_t>(nFree);
 	}
 
-	send_package(pTCB, info);
-
-	pTCB->TX.data = nullptr;
-	pTCB->TX.size = 0;
+	if (nLength == 0) {
+		return 0;
+	}
 
-    pTCB->SND.NXT += nLength;
-    pTCB->SND.WND -= nLength;
-}
+	const auto nIndex = pTCB->TX.nEnd & TCP_TX_BUFFER_MASK;
+	const auto nFirst = std::min(static_cast<uint32_t>(nLength), TCP_TX_BUFFER_SIZE - nIndex);
 
-void tcp_write(const int32_t nHandleListen, const uint8_t *pBuffer, uint16_t nLength, uint32_t nHandleConnection) {
-	assert(nHandleListen >= 0);
-	assert(nHandleListen < TCP_MAX_PORTS_ALLOWED);
-	assert(pBuffer != nullptr);
-	assert(nHandleConnection < TCP_MAX_TCBS_ALLOWED);
+	memcpy(&pTCB->TX.pBuffer[nIndex], pBuffer, nFirst);
+	memcpy(pTCB->TX.pBuffer, &pBuffer[nFirst], nLength - nFirst);
 
-	auto *pTCB = &s_Port[nHandleListen].TCB[nHandleConnection];
-	assert(pTCB != nullptr);
+	pTCB->TX.nEnd += nLength;
 
-	const auto *p = pBuffer;
+	tcp_output(pTCB);
 
-	while (nLength > 0) {
-		const auto nWriteLength = (nLength > TCP_DATA_SIZE) ? TCP_DATA_SIZE : nLength;
-		const bool isLastSegment = (nLength < TCP_DATA_SIZE);
-		_write(pTCB, p, nWriteLength, isLastSegment);
-		p += nWriteLength;
-		nLength -= nWriteLength;
-	}
+	return nLength;
 }
 
 // <---
@@ -39,6 +39,23 @@
 
 #include "../../config/net_config.h"
 
+static_assert((UDP_RX_QUEUE_ENTRIES & (UDP_RX_QUEUE_ENTRIES - 1)) == 0, "UDP_RX_QUEUE_ENTRIES must be a power of 2");
+
+/*
+ * Open addressing hash table, destination port -> port index.
+ * The table is at most half full, so a probe sequence always ends at an empty slot.
+ */
+static constexpr uint32_t PORT_HASH_BITS = (UDP_MAX_PORTS_ALLOWED <= 8) ? 4 : (UDP_MAX_PORTS_ALLOWED <= 16) ? 5 : 6;
+static constexpr uint32_t PORT_HASH_SIZE = 1U << PORT_HASH_BITS;
+static constexpr uint32_t PORT_HASH_MASK = PORT_HASH_SIZE - 1;
+
+static_assert(UDP_MAX_PORTS_ALLOWED <= 32, "UDP_MAX_PORTS_ALLOWED is too large for the port hash table");
+
+struct port_hash_entry {
+	uint16_t port;	// 0 is an empty slot
+	uint16_t index;
+};
+
 struct data_entry {
 	uint32_t from_ip;
 	uint16_t from_port;
@@ -46,8 +63,20 @@ struct data_entry {
 	uint8_t data[UDP_DATA_SIZE];
 } ALIGNED;
 
+/*
+ * Per port receive ring. When the ring is full, the oldest entry is overwritten.
+ * The entry returned by udp_recv2 is reused when UDP_RX_QUEUE_ENTRIES - 1 new datagrams have arrived.
+ */
+struct data_queue {
+	struct data_entry entries[UDP_RX_QUEUE_ENTRIES];
+	uint32_t head;	// next entry to write
+	uint32_t tail;	// next entry to read
+} ALIGNED;
+
 static uint16_t s_Port[UDP_MAX_PORTS_ALLOWED] SECTION_NETWORK ALIGNED;
-static struct data_entry s_data[UDP_MAX_PORTS_ALLOWED] SECTION_NETWORK ALIGNED;
+static struct port_hash_entry s_PortHash[PORT_HASH_SIZE] SECTION_NETWORK ALIGNED;
+static struct data_queue s_data[UDP_MAX_PORTS_ALLOWED] SECTION_NETWORK ALIGNED;
+static struct UdpStats s_stats[UDP_MAX_PORTS_ALLOWED] SECTION_NETWORK ALIGNED;
 static struct t_udp s_send_packet SECTION_NETWORK ALIGNED;
 static uint16_t s_id SECTION_NETWORK ALIGNED;
 static uint8_t s_multicast_mac[ETH_ADDR_LEN] SECTION_NETWORK ALIGNED;
@@ -95,30 +124,91 @@ void __attribute__((cold)) udp_shutdown() {
 	DEBUG_EXIT
 }
 
-__attribute__((hot)) void udp_handle(struct t_udp *pUdp) {
-	const auto nDestinationPort = __builtin_bswap16(pUdp->udp.destination_port);
+static void queue_clear(struct data_queue *p_queue) {
+	p_queue->head = 0;
+	p_queue->tail = 0;
+}
+
+/*
+ * Fibonacci hashing, 40503 is 2^16 divided by the golden ratio
+ */
+static uint32_t port_hash(const uint16_t nPort) {
+	return ((static_cast<uint32_t>(nPort) * 40503U) & 0xFFFF) >> (16 - PORT_HASH_BITS);
+}
+
+static int32_t port_hash_find(const uint16_t nPort) {
+	auto nSlot = port_hash(nPort);
+
+	while (s_PortHash[nSlot].port != 0) {
+		if (s_PortHash[nSlot].port == nPort) {
+			return s_PortHash[nSlot].index;
+		}
+		nSlot = (nSlot + 1) & PORT_HASH_MASK;
+	}
+
+	return -1;
+}
+
+/*
+ * Only called from udp_begin and udp_end, the table is rebuilt
+ * so that removing a port does not break a probe sequence.
+ */
+static void __attribute__((cold)) port_hash_build() {
+	memset(s_PortHash, 0, sizeof(s_PortHash));
 
 	for (uint32_t nPortIndex = 0; nPortIndex < UDP_MAX_PORTS_ALLOWED; nPortIndex++) {
-		if (s_Port[nPortIndex] == nDestinationPort) {
-			if (__builtin_expect ((s_data[nPortIndex].size != 0), 0)) {
-				DEBUG_PRINTF(IPSTR ":%d[%x]", pUdp->ip4.src[0],pUdp->ip4.src[1],pUdp->ip4.src[2],pUdp->ip4.src[3], nDestinationPort, nDestinationPort);
+		const auto nPort = s_Port[nPortIndex];
+
+		if (nPort != 0) {
+			auto nSlot = port_hash(nPort);
+
+			while (s_PortHash[nSlot].port != 0) {
+				nSlot = (nSlot + 1) & PORT_HASH_MASK;
 			}
 
-			auto *p_queue_entry = &s_data[nPortIndex];
-			const auto nDataLength = static_cast<uint16_t>(__builtin_bswap16(pUdp->udp.len) - UDP_HEADER_SIZE);
-			const auto i = std::min(static_cast<uint16_t>(UDP_DATA_SIZE), nDataLength);
+			s_PortHash[nSlot].port = nPort;
+			s_PortHash[nSlot].index = static_cast<uint16_t>(nPortIndex);
+		}
+	}
+}
+
+__attribute__((hot)) void udp_handle(struct t_udp *pUdp) {
+	const auto nDestinationPort = __builtin_bswap16(pUdp->udp.destination_port);
+	const auto nPortIndex = port_hash_find(nDestinationPort);
 
-			net::memcpy(p_queue_entry->data, pUdp->udp.data, i);
+	if (__builtin_expect((nPortIndex < 0), 0)) {
+		DEBUG_PRINTF(IPSTR ":%d[%x]", pUdp->ip4.src[0],pUdp->ip4.src[1],pUdp->ip4.src[2],pUdp->ip4.src[3], nDestinationPort, nDestinationPort);
+		return;
+	}
 
-			p_queue_entry->from_ip = net::memcpy_ip(pUdp->ip4.src);
-			p_queue_entry->from_port = __builtin_bswap16(pUdp->udp.source_port);
-			p_queue_entry->size = static_cast<uint16_t>(i);
+	auto *p_queue = &s_data[nPortIndex];
+	auto& stats = s_stats[nPortIndex];
 
-			return;
-		}
+	stats.nReceived++;
+
+	// The queue is full, the oldest datagram is dropped in favour of the newest
+	if (__builtin_expect(((p_queue->head - p_queue->tail) == UDP_RX_QUEUE_ENTRIES), 0)) {
+		p_queue->tail++;
+		stats.nDropped++;
+		DEBUG_PRINTF(IPSTR ":%d[%x]", pUdp->ip4.src[0],pUdp->ip4.src[1],pUdp->ip4.src[2],pUdp->ip4.src[3], nDestinationPort, nDestinationPort);
+	}
+
+	auto *p_queue_entry = &p_queue->entries[p_queue->head & (UDP_RX_QUEUE_ENTRIES - 1)];
+	const auto nDataLength = static_cast<uint16_t>(__builtin_bswap16(pUdp->udp.len) - UDP_HEADER_SIZE);
+
+	if (__builtin_expect((nDataLength > UDP_DATA_SIZE), 0)) {
+		stats.nOverrun++;
 	}
 
-	DEBUG_PRINTF(IPSTR ":%d[%x]", pUdp->ip4.src[0],pUdp->ip4.src[1],pUdp->ip4.src[2],pUdp->ip4.src[3], nDestinationPort, nDestinationPort);
+	const auto i = std::min(static_cast<uint16_t>(UDP_DATA_SIZE), nDataLength);
+
+	net::memcpy(p_queue_entry->data, pUdp->udp.data, i);
+
+	p_queue_entry->from_ip = net::memcpy_ip(pUdp->ip4.src);
+	p_queue_entry->from_port = __builtin_bswap16(pUdp->udp.source_port);
+	p_queue_entry->size = static_cast<uint16_t>(i);
+
+	p_queue->head++;
 }
 
 // -->
@@ -126,13 +216,18 @@ __attribute__((hot)) void udp_handle(struct t_udp *pUdp) {
 int udp_begin(uint16_t nLocalPort) {
 	DEBUG_PRINTF("nLocalPort=%u", nLocalPort);
 
-	for (int i = 0; i < UDP_MAX_PORTS_ALLOWED; i++) {
-		if (s_Port[i] == nLocalPort) {
-			return i;
-		}
+	const auto nPortIndex = port_hash_find(nLocalPort);
+
+	if (nPortIndex >= 0) {
+		return nPortIndex;
+	}
 
+	for (int i = 0; i < UDP_MAX_PORTS_ALLOWED; i++) {
 		if (s_Port[i] == 0) {
 			s_Port[i] = nLocalPort;
+			queue_clear(&s_data[i]);
+			memset(&s_stats[i], 0, sizeof(struct UdpStats));
+			port_hash_build();
 
 			DEBUG_PRINTF("i=%d, local_port=%d[%x]", i, nLocalPort, nLocalPort);
 			return i;
@@ -148,12 +243,13 @@ int udp_begin(uint16_t nLocalPort) {
 int udp_end(uint16_t nLocalPort) {
 	DEBUG_PRINTF("nLocalPort=%u[%x]", nLocalPort, nLocalPort);
 
-	for (auto i = 0; i < UDP_MAX_PORTS_ALLOWED; i++) {
-		if (s_Port[i] == nLocalPort) {
-			s_Port[i] = 0;
-			s_data[i].size = 0;
-			return 0;
-		}
+	const auto nPortIndex = port_hash_find(nLocalPort);
+
+	if (nPortIndex >= 0) {
+		s_Port[nPortIndex] = 0;
+		queue_clear(&s_data[nPortIndex]);
+		port_hash_build();
+		return 0;
 	}
 
 	console_error("unbind\n");
@@ -164,11 +260,13 @@ uint16_t udp_recv1(int nIndex, uint8_t *pData, uint16_t nSize, uint32_t *pFromIp
 	assert(nIndex >= 0);
 	assert(nIndex < UDP_MAX_PORTS_ALLOWED);
 
-	if (__builtin_expect((s_data[nIndex].size == 0), 1)) {
+	auto *p_queue = &s_data[nIndex];
+
+	if (__builtin_expect((p_queue->head == p_queue->tail), 1)) {
 		return 0;
 	}
 
-	auto *p_data = &s_data[nIndex];
+	auto *p_data = &p_queue->entries[p_queue->tail & (UDP_RX_QUEUE_ENTRIES - 1)];
 	const auto i = std::min(nSize, p_data->size);
 
 	net::memcpy(pData, p_data->data, i);
@@ -176,7 +274,7 @@ uint16_t udp_recv1(int nIndex, uint8_t *pData, uint16_t nSize, uint32_t *pFromIp
 	*pFromIp = p_data->from_ip;
 	*FromPort = p_data->from_port;
 
-	p_data->size = 0;
+	p_queue->tail++;
 
 	return i;
 }
@@ -185,21 +283,35 @@ uint16_t udp_recv2(int nIndex, const uint8_t **pData, uint32_t *pFromIp, uint16_
 	assert(nIndex >= 0);
 	assert(nIndex < UDP_MAX_PORTS_ALLOWED);
 
-	if (__builtin_expect((s_data[nIndex].size == 0), 1)) {
+	auto *p_queue = &s_data[nIndex];
+
+	if (__builtin_expect((p_queue->head == p_queue->tail), 1)) {
 		return 0;
 	}
 
-	auto *p_data = &s_data[nIndex];
+	auto *p_data = &p_queue->entries[p_queue->tail & (UDP_RX_QUEUE_ENTRIES - 1)];
 
 	*pData = p_data->data;
 	*pFromIp = p_data->from_ip;
 	*pFromPort = p_data->from_port;
 
-	const auto nSize = p_data->size;
+	p_queue->tail++;
+
+	return p_data->size;
+}
+
+const struct UdpStats *udp_get_stats(int nIndex) {
+	assert(nIndex >= 0);
+	assert(nIndex < UDP_MAX_PORTS_ALLOWED);
+
+	return &s_stats[nIndex];
+}
 
-	p_data->size = 0;
+uint16_t udp_get_port(int nIndex) {
+	assert(nIndex >= 0);
+	assert(nIndex < UDP_MAX_PORTS_ALLOWED);
 
-	return nSize;
+	return s_Port[nIndex];
 }
 
 int udp_send(int nIndex, const uint8_t *pData, uint16_t nSize, uint32_t RemoteIp, uint16_t RemotePort) {
@@ -211,6 +323,8 @@ int udp_send(int nIndex, const uint8_t *pData, uint16_t nSize, uint32_t RemoteIp
 		return -1;
 	}
 
+	uint32_t nUnresolvedIp = 0;	///< Next hop of which the ARP reply is awaited
+
 	if (RemoteIp == IPv4_BROADCAST) {
 		memset(s_send_packet.ether.dst, 0xFF, ETH_ADDR_LEN);
 		memset(s_send_packet.ip4.dst, 0xFF, IPv4_ADDR_LEN);
@@ -229,27 +343,13 @@ int udp_send(int nIndex, const uint8_t *pData, uint16_t nSize, uint32_t RemoteIp
 			memcpy(s_send_packet.ether.dst, s_multicast_mac, ETH_ADDR_LEN);
 			net::memcpy_ip(s_send_packet.ip4.dst, RemoteIp);
 		} else {
-			if  (__builtin_expect((net::globals::nOnNetworkMask != (RemoteIp & net::globals::nOnNetworkMask)), 0)) {
-				if (net::globals::ipInfo.gw.addr == arp_cache_lookup(net::globals::ipInfo.gw.addr, s_send_packet.ether.dst)) {
-					net::memcpy_ip(s_send_packet.ip4.dst, RemoteIp);
-				} else {
-#ifndef NDEBUG
-					console_error("ARP lookup failed -> default gateway :");
-					printf(IPSTR " [%d]\n", IP2STR(RemoteIp), s_Port[nIndex]);
-#endif
-					return -3;
-				}
-			} else {
-				if (RemoteIp == arp_cache_lookup(RemoteIp, s_send_packet.ether.dst)) {
-					net::memcpy_ip(s_send_packet.ip4.dst, RemoteIp);
-				} else {
-#ifndef NDEBUG
-					console_error("ARP lookup failed: ");
-					printf(IPSTR "\n", IP2STR(RemoteIp));
-#endif
-					return -2;
-				}
+			const auto nNextHopIp = __builtin_expect((net::globals::nOnNetworkMask != (RemoteIp & net::globals::nOnNetworkMask)), 0) ? net::globals::ipInfo.gw.addr : RemoteIp;
+
+			if (__builtin_expect((nNextHopIp != arp_cache_lookup(nNextHopIp, s_send_packet.ether.dst)), 0)) {
+				nUnresolvedIp = nNextHopIp;
 			}
+
+			net::memcpy_ip(s_send_packet.ip4.dst, RemoteIp);
 		}
 	}
 
@@ -267,7 +367,18 @@ int udp_send(int nIndex, const uint8_t *pData, uint16_t nSize, uint32_t RemoteIp
 
 	net::memcpy(s_send_packet.udp.data, pData, std::min(static_cast<uint16_t>(UDP_DATA_SIZE), nSize));
 
-	emac_eth_send(reinterpret_cast<void *>(&s_send_packet), nSize + UDP_PACKET_HEADERS_SIZE);
+	if (__builtin_expect((nUnresolvedIp != 0), 0)) {
+		// Sent from arp_cache_update when the reply arrives
+		if (!arp_cache_pending_add(nUnresolvedIp, &s_send_packet, nSize + UDP_PACKET_HEADERS_SIZE)) {
+#ifndef NDEBUG
+			console_error("ARP lookup failed: ");
+			printf(IPSTR " [%d]\n", IP2STR(RemoteIp), s_Port[nIndex]);
+#endif
+			return (nUnresolvedIp == RemoteIp) ? -2 : -3;
+		}
+	} else {
+		emac_eth_send(reinterpret_cast<void *>(&s_send_packet), nSize + UDP_PACKET_HEADERS_SIZE);
+	}
 
 	s_id++;
 
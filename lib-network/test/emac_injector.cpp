@@ -0,0 +1,117 @@
+/**
+ * @file emac_injector.cpp
+ *
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cassert>
+
+#include "emac_injector.h"
+
+#include "hardware.h"
+
+#include "emac/phy.h"
+#include "emac/net_link_check.h"
+
+struct Frame {
+	uint32_t nLength;
+	uint8_t data[injector::FRAME_SIZE] __attribute__ ((aligned (4)));
+};
+
+static Frame s_Queue[injector::QUEUE_ENTRIES];
+static uint32_t s_nHead;	///< Next entry to write
+static uint32_t s_nTail;	///< Next entry to read
+static injector::Transmit s_Transmit;
+static uint32_t s_nMillis;
+static uint32_t s_nIdleMillis = 1;
+
+namespace injector {
+bool inject(const void *pFrame, const uint32_t nLength) {
+	assert(nLength <= FRAME_SIZE);
+
+	if ((s_nHead - s_nTail) == QUEUE_ENTRIES) {
+		return false;
+	}
+
+	auto& frame = s_Queue[s_nHead % QUEUE_ENTRIES];
+	memcpy(frame.data, pFrame, nLength);
+	frame.nLength = nLength;
+	s_nHead++;
+
+	return true;
+}
+
+uint32_t queued() {
+	return s_nHead - s_nTail;
+}
+
+void set_transmit(Transmit transmit) {
+	s_Transmit = transmit;
+}
+
+uint32_t millis() {
+	return s_nMillis;
+}
+
+void set_millis(const uint32_t nMillis) {
+	s_nMillis = nMillis;
+}
+
+void advance(const uint32_t nMillis) {
+	s_nMillis += nMillis;
+}
+
+void set_idle_millis(const uint32_t nMillis) {
+	s_nIdleMillis = nMillis;
+}
+}  // namespace injector
+
+/*
+ * The host Hardware, only the clock is used by the stack
+ */
+Hardware *Hardware::s_pThis;
+
+Hardware::Hardware() {
+	s_pThis = this;
+}
+
+uint32_t Hardware::Millis() {
+	return s_nMillis;
+}
+
+extern "C" int console_error(const char *s) {
+	return fputs(s, stderr);
+}
+
+namespace net {
+net::Link link_status_read() {
+	return net::Link::STATE_UP;
+}
+}  // namespace net
+
+int emac_eth_recv(uint8_t **packetp) {
+	if (s_nHead == s_nTail) {
+		s_nMillis += s_nIdleMillis;
+		return -1;
+	}
+
+	auto& frame = s_Queue[s_nTail % injector::QUEUE_ENTRIES];
+	*packetp = frame.data;
+
+	return static_cast<int>(frame.nLength);
+}
+
+void emac_free_pkt() {
+	assert(s_nHead != s_nTail);
+	s_nTail++;
+}
+
+void emac_eth_send(void *packet, int len) {
+	assert(len > 0);
+
+	if (s_Transmit != nullptr) {
+		s_Transmit(reinterpret_cast<const uint8_t *>(packet), static_cast<uint32_t>(len));
+	}
+}
@@ -0,0 +1,46 @@
+/**
+ * @file emac_injector.h
+ *
+ */
+
+#ifndef EMAC_INJECTOR_H_
+#define EMAC_INJECTOR_H_
+
+#include <cstdint>
+
+/**
+ * The emac platform layer for the host test programs.
+ * Frames are injected by the program and the frames sent by the stack are passed to a callback,
+ * so the bare-metal IP stack (src/net) runs without a network device.
+ *
+ * Hardware::Millis() is a virtual clock. It advances 1 ms each time the stack polls while no frame is
+ * queued, so the waits in the stack (ARP probe, timers, TCP retransmission) end as on a quiet link.
+ */
+namespace injector {
+static constexpr uint32_t FRAME_SIZE = 1518;
+static constexpr uint32_t QUEUE_ENTRIES = 64;
+
+typedef void (*Transmit)(const uint8_t *pFrame, const uint32_t nLength);
+
+/**
+ * Queue a frame for emac_eth_recv, the frames are received in order
+ * @return false when the queue is full
+ */
+bool inject(const void *pFrame, const uint32_t nLength);
+uint32_t queued();
+
+/**
+ * Called for each frame sent by the stack, nullptr discards the frames
+ */
+void set_transmit(Transmit transmit);
+
+uint32_t millis();
+void set_millis(const uint32_t nMillis);
+void advance(const uint32_t nMillis);
+/**
+ * @param nMillis added to the clock by an idle poll, 0 stops the clock
+ */
+void set_idle_millis(const uint32_t nMillis);
+}  // namespace injector
+
+#endif /* EMAC_INJECTOR_H_ */
@@ -0,0 +1,618 @@
+/**
+ * @file netbench.cpp
+ *
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+
+#include "net.h"
+#include "net_private.h"
+#include "net_packets.h"
+
+#include "emac_injector.h"
+#include "hardware.h"
+
+#include "hosttest.h"
+
+/*
+ * Replay of a capture through net_handle -> ip_handle -> udp_handle -> udp_recv2.
+ * Without a file a capture is generated: Art-Net and sACN at 44 Hz with ARP traffic, in pcap format,
+ * so that both go through the same reader.
+ *
+ * ./netbench bench [capture.pcap]
+ */
+
+static constexpr uint16_t ARTNET_PORT = 6454;
+static constexpr uint16_t E131_PORT = 5568;
+
+static constexpr uint32_t make_ip(const uint32_t a, const uint32_t b, const uint32_t c, const uint32_t d) {
+	return a | (b << 8) | (c << 16) | (d << 24);
+}
+
+static constexpr uint32_t NODE_IP = make_ip(192, 168, 2, 100);
+static constexpr uint8_t s_NodeMac[ETH_ADDR_LEN] = { 0x02, 0x00, 0x00, 0x12, 0x34, 0x56 };
+
+/*
+ * Reference checksum, RFC 1071 on big-endian 16-bit words
+ */
+static uint16_t chksum_reference(const uint8_t *pData, const uint32_t nLength) {
+	uint32_t nSum = 0;
+
+	for (uint32_t i = 0; i < nLength; i += 2) {
+		const uint32_t nWord = (static_cast<uint32_t>(pData[i]) << 8) | ((i + 1 < nLength) ? pData[i + 1] : 0);
+		nSum += nWord;
+	}
+
+	while (nSum >> 16) {
+		nSum = (nSum & 0xFFFF) + (nSum >> 16);
+	}
+
+	return static_cast<uint16_t>(__builtin_bswap16(static_cast<uint16_t>(~nSum)));
+}
+
+/*
+ * pcap file format, microsecond time stamps, LINKTYPE_ETHERNET
+ */
+namespace pcap {
+static constexpr uint32_t MAGIC = 0xa1b2c3d4;
+static constexpr uint32_t MAGIC_NANOS = 0xa1b23c4d;
+static constexpr uint32_t LINKTYPE_ETHERNET = 1;
+
+struct FileHeader {
+	uint32_t nMagic;
+	uint16_t nVersionMajor;
+	uint16_t nVersionMinor;
+	int32_t nThisZone;
+	uint32_t nSigFigs;
+	uint32_t nSnapLength;
+	uint32_t nLinkType;
+};
+
+struct RecordHeader {
+	uint32_t nSeconds;
+	uint32_t nFraction;
+	uint32_t nCapturedLength;
+	uint32_t nOriginalLength;
+};
+
+class Writer {
+public:
+	Writer(uint8_t *pBuffer, const uint32_t nSize): m_pBuffer(pBuffer), m_nSize(nSize) {
+		const FileHeader header = { MAGIC, 2, 4, 0, 0, injector::FRAME_SIZE, LINKTYPE_ETHERNET };
+		Append(&header, sizeof(header));
+	}
+
+	bool Add(const uint64_t nMicros, const void *pFrame, const uint32_t nLength) {
+		if ((m_nLength + sizeof(RecordHeader) + nLength) > m_nSize) {
+			return false;
+		}
+
+		const RecordHeader record = { static_cast<uint32_t>(nMicros / 1000000U), static_cast<uint32_t>(nMicros % 1000000U), nLength, nLength };
+		Append(&record, sizeof(record));
+		Append(pFrame, nLength);
+		return true;
+	}
+
+	uint32_t GetLength() const {
+		return m_nLength;
+	}
+
+private:
+	void Append(const void *p, const uint32_t nLength) {
+		memcpy(&m_pBuffer[m_nLength], p, nLength);
+		m_nLength += nLength;
+	}
+
+	uint8_t *m_pBuffer;
+	uint32_t m_nSize;
+	uint32_t m_nLength { 0 };
+};
+
+class Reader {
+public:
+	Reader(const uint8_t *pBuffer, const uint32_t nLength): m_pBuffer(pBuffer), m_nLength(nLength) {
+		FileHeader header;
+
+		if (nLength < sizeof(header)) {
+			return;
+		}
+
+		memcpy(&header, pBuffer, sizeof(header));
+
+		if (((header.nMagic != MAGIC) && (header.nMagic != MAGIC_NANOS)) || (header.nLinkType != LINKTYPE_ETHERNET)) {
+			return;
+		}
+
+		m_isNanos = (header.nMagic == MAGIC_NANOS);
+		m_nOffset = sizeof(header);
+		m_isValid = true;
+	}
+
+	bool IsValid() const {
+		return m_isValid;
+	}
+
+	/**
+	 * @return nullptr at the end of the capture
+	 */
+	const uint8_t *Next(uint64_t& nMicros, uint32_t& nFrameLength) {
+		RecordHeader record;
+
+		if (!m_isValid || ((m_nOffset + sizeof(record)) > m_nLength)) {
+			return nullptr;
+		}
+
+		memcpy(&record, &m_pBuffer[m_nOffset], sizeof(record));
+		m_nOffset += static_cast<uint32_t>(sizeof(record));
+
+		if ((m_nOffset + record.nCapturedLength) > m_nLength) {
+			return nullptr;
+		}
+
+		const auto *pFrame = &m_pBuffer[m_nOffset];
+		m_nOffset += record.nCapturedLength;
+
+		nMicros = (static_cast<uint64_t>(record.nSeconds) * 1000000U) + (m_isNanos ? (record.nFraction / 1000U) : record.nFraction);
+		nFrameLength = record.nCapturedLength;
+
+		return pFrame;
+	}
+
+private:
+	const uint8_t *m_pBuffer;
+	uint32_t m_nLength;
+	uint32_t m_nOffset { 0 };
+	bool m_isNanos { false };
+	bool m_isValid { false };
+};
+}  // namespace pcap
+
+static uint32_t build_udp(uint8_t *pFrame, const uint32_t nSrcIp, const uint32_t nDstIp, const uint16_t nSrcPort, const uint16_t nDstPort, const uint32_t nDataLength) {
+	auto *pUdp = reinterpret_cast<struct t_udp *>(pFrame);
+
+	if ((nDstIp & 0xF0) == 0xE0) {
+		const uint8_t mac[ETH_ADDR_LEN] = { 0x01, 0x00, 0x5E, static_cast<uint8_t>((nDstIp >> 8) & 0x7F), static_cast<uint8_t>(nDstIp >> 16), static_cast<uint8_t>(nDstIp >> 24) };
+		memcpy(pUdp->ether.dst, mac, ETH_ADDR_LEN);
+	} else {
+		memcpy(pUdp->ether.dst, s_NodeMac, ETH_ADDR_LEN);
+	}
+
+	const uint8_t src[ETH_ADDR_LEN] = { 0x02, 0x00, 0x00, 0x00, 0x00, static_cast<uint8_t>(nSrcIp >> 24) };
+	memcpy(pUdp->ether.src, src, ETH_ADDR_LEN);
+	pUdp->ether.type = __builtin_bswap16(ETHER_TYPE_IPv4);
+
+	pUdp->ip4.ver_ihl = 0x45;
+	pUdp->ip4.tos = 0;
+	pUdp->ip4.len = __builtin_bswap16(static_cast<uint16_t>(sizeof(struct ip4_header) + UDP_HEADER_SIZE + nDataLength));
+	pUdp->ip4.id = static_cast<uint16_t>(rand());
+	pUdp->ip4.flags_froff = __builtin_bswap16(IPv4_FLAG_DF);
+	pUdp->ip4.ttl = 64;
+	pUdp->ip4.proto = IPv4_PROTO_UDP;
+	pUdp->ip4.chksum = 0;
+	memcpy(pUdp->ip4.src, &nSrcIp, IPv4_ADDR_LEN);
+	memcpy(pUdp->ip4.dst, &nDstIp, IPv4_ADDR_LEN);
+	pUdp->ip4.chksum = chksum_reference(reinterpret_cast<const uint8_t *>(&pUdp->ip4), sizeof(struct ip4_header));
+
+	pUdp->udp.source_port = __builtin_bswap16(nSrcPort);
+	pUdp->udp.destination_port = __builtin_bswap16(nDstPort);
+	pUdp->udp.len = __builtin_bswap16(static_cast<uint16_t>(UDP_HEADER_SIZE + nDataLength));
+	pUdp->udp.checksum = 0;
+
+	for (uint32_t i = 0; i < nDataLength; i++) {
+		pUdp->udp.data[i] = static_cast<uint8_t>(rand());
+	}
+
+	return static_cast<uint32_t>(sizeof(struct ether_header) + sizeof(struct ip4_header) + UDP_HEADER_SIZE + nDataLength);
+}
+
+static uint32_t build_arp_request(uint8_t *pFrame, const uint32_t nSenderIp, const uint32_t nTargetIp) {
+	auto *pArp = reinterpret_cast<struct t_arp *>(pFrame);
+	memset(pArp, 0, sizeof(struct t_arp));
+
+	const uint8_t src[ETH_ADDR_LEN] = { 0x02, 0x00, 0x00, 0x00, 0x00, static_cast<uint8_t>(nSenderIp >> 24) };
+
+	memset(pArp->ether.dst, 0xFF, ETH_ADDR_LEN);
+	memcpy(pArp->ether.src, src, ETH_ADDR_LEN);
+	pArp->ether.type = __builtin_bswap16(ETHER_TYPE_ARP);
+
+	pArp->arp.hardware_type = __builtin_bswap16(ARP_HWTYPE_ETHERNET);
+	pArp->arp.protocol_type = __builtin_bswap16(ARP_PRTYPE_IPv4);
+	pArp->arp.hardware_size = ARP_HARDWARE_SIZE;
+	pArp->arp.protocol_size = ARP_PROTOCOL_SIZE;
+	pArp->arp.opcode = __builtin_bswap16(ARP_OPCODE_RQST);
+	memcpy(pArp->arp.sender_mac, src, ETH_ADDR_LEN);
+	memcpy(pArp->arp.sender_ip, &nSenderIp, IPv4_ADDR_LEN);
+	memcpy(pArp->arp.target_ip, &nTargetIp, IPv4_ADDR_LEN);
+
+	return sizeof(struct t_arp);
+}
+
+/*
+ * One second of traffic per iteration: a controller sends 8 Art-Net universes unicast and a
+ * second one 4 sACN universes multicast, both at 44 Hz. Every 100 ms there is an ARP request,
+ * every second one for the node.
+ */
+static uint32_t generate(uint8_t *pBuffer, const uint32_t nSize, const uint32_t nSeconds) {
+	pcap::Writer writer(pBuffer, nSize);
+	uint8_t frame[injector::FRAME_SIZE];
+
+	for (uint32_t nSecond = 0; nSecond < nSeconds; nSecond++) {
+		for (uint32_t nFrame = 0; nFrame < 44; nFrame++) {
+			uint64_t nMicros = (nSecond * 1000000ULL) + (nFrame * 22727ULL);
+
+			for (uint32_t nUniverse = 0; nUniverse < 8; nUniverse++) {
+				const auto nLength = build_udp(frame, make_ip(192, 168, 2, 10), NODE_IP, ARTNET_PORT, ARTNET_PORT, 18 + 512);
+				writer.Add(nMicros + nUniverse * 20, frame, nLength);
+			}
+
+			for (uint32_t nUniverse = 0; nUniverse < 4; nUniverse++) {
+				const auto nLength = build_udp(frame, make_ip(192, 168, 2, 11), make_ip(239, 255, 0, 1 + nUniverse), 49152, E131_PORT, 126 + 512);
+				writer.Add(nMicros + 200 + nUniverse * 20, frame, nLength);
+			}
+
+			// Not for a port of the node
+			if ((nFrame % 11) == 0) {
+				const auto nLength = build_udp(frame, make_ip(192, 168, 2, 12), make_ip(192, 168, 2, 255), 5353, 5354, 64);
+				writer.Add(nMicros + 300, frame, nLength);
+			}
+		}
+
+		for (uint32_t nArp = 0; nArp < 10; nArp++) {
+			const auto nTarget = ((nArp % 2) == 0) ? NODE_IP : make_ip(192, 168, 2, 20 + nArp);
+			const auto nLength = build_arp_request(frame, make_ip(192, 168, 2, 30 + nArp), nTarget);
+			writer.Add((nSecond * 1000000ULL) + (nArp * 100000ULL) + 500, frame, nLength);
+		}
+	}
+
+	return writer.GetLength();
+}
+
+struct Replay {
+	uint32_t nFrames;
+	uint32_t nUdpForNode;	///< UDP datagrams for a bound port, from the capture
+	uint32_t nArpForNode;	///< ARP requests for the node IP, from the capture
+	uint32_t nReceived;		///< Returned by udp_recv2
+	uint32_t nPayloadErrors;
+	uint64_t nNanos;		///< Total time in net_handle
+};
+
+static int s_nHandleArtNet;
+static int s_nHandleE131;
+static uint32_t s_nArpReplies;
+
+static void transmit(const uint8_t *pFrame, [[maybe_unused]] const uint32_t nLength) {
+	const auto *pArp = reinterpret_cast<const struct t_arp *>(pFrame);
+
+	if ((pArp->ether.type == __builtin_bswap16(ETHER_TYPE_ARP)) && (pArp->arp.opcode == __builtin_bswap16(ARP_OPCODE_REPLY))) {
+		uint32_t nSenderIp;
+		memcpy(&nSenderIp, pArp->arp.sender_ip, IPv4_ADDR_LEN);
+
+		if (nSenderIp == NODE_IP) {
+			s_nArpReplies++;
+		}
+	}
+}
+
+static int handle_of(const uint16_t nPort) {
+	if (nPort == ARTNET_PORT) {
+		return s_nHandleArtNet;
+	}
+	if (nPort == E131_PORT) {
+		return s_nHandleE131;
+	}
+	return -1;
+}
+
+static Replay replay(const uint8_t *pCapture, const uint32_t nLength, hosttest::Histogram *pNetHandle, hosttest::Histogram *pRecv) {
+	Replay result {};
+	pcap::Reader reader(pCapture, nLength);
+	uint64_t nMicros;
+	uint32_t nFrameLength;
+	const uint8_t *pFrame;
+
+	injector::set_idle_millis(0);
+
+	while ((pFrame = reader.Next(nMicros, nFrameLength)) != nullptr) {
+		if ((nFrameLength < sizeof(struct ether_header)) || (nFrameLength > injector::FRAME_SIZE)) {
+			continue;
+		}
+
+		result.nFrames++;
+
+		const auto *pUdp = reinterpret_cast<const struct t_udp *>(pFrame);
+		int nHandle = -1;
+
+		if ((pUdp->ether.type == __builtin_bswap16(ETHER_TYPE_IPv4)) && (pUdp->ip4.ver_ihl == 0x45) && (pUdp->ip4.proto == IPv4_PROTO_UDP)) {
+			nHandle = handle_of(__builtin_bswap16(pUdp->udp.destination_port));
+			result.nUdpForNode += (nHandle >= 0) ? 1 : 0;
+		} else if (pUdp->ether.type == __builtin_bswap16(ETHER_TYPE_ARP)) {
+			const auto *pArp = reinterpret_cast<const struct t_arp *>(pFrame);
+			uint32_t nTargetIp;
+			memcpy(&nTargetIp, pArp->arp.target_ip, IPv4_ADDR_LEN);
+			result.nArpForNode += ((pArp->arp.opcode == __builtin_bswap16(ARP_OPCODE_RQST)) && (nTargetIp == NODE_IP)) ? 1 : 0;
+		}
+
+		injector::set_millis(static_cast<uint32_t>(nMicros / 1000U));
+		injector::inject(pFrame, nFrameLength);
+
+		const auto nStart = hosttest::nanos();
+		net_handle();
+		const auto nElapsed = hosttest::nanos() - nStart;
+
+		result.nNanos += nElapsed;
+
+		if (pNetHandle != nullptr) {
+			pNetHandle->Add(nElapsed);
+		}
+
+		if (nHandle >= 0) {
+			const uint8_t *pData;
+			uint32_t nFromIp;
+			uint16_t nFromPort;
+
+			const auto nRecvStart = hosttest::nanos();
+			const auto nSize = udp_recv2(nHandle, &pData, &nFromIp, &nFromPort);
+			const auto nRecvElapsed = hosttest::nanos() - nRecvStart;
+
+			if (pRecv != nullptr) {
+				pRecv->Add(nRecvElapsed);
+			}
+
+			if (nSize != 0) {
+				result.nReceived++;
+
+				const auto nDataLength = static_cast<uint32_t>(__builtin_bswap16(pUdp->udp.len) - UDP_HEADER_SIZE);
+				uint32_t nSrcIp;
+				memcpy(&nSrcIp, pUdp->ip4.src, IPv4_ADDR_LEN);
+
+				if ((nSize != nDataLength) || (memcmp(pData, pUdp->udp.data, nSize) != 0) || (nFromIp != nSrcIp) || (nFromPort != __builtin_bswap16(pUdp->udp.source_port))) {
+					result.nPayloadErrors++;
+				}
+			}
+		}
+	}
+
+	injector::set_idle_millis(1);
+
+	return result;
+}
+
+/*
+ * The stages without the layers above them: ip_handle and udp_handle are called directly
+ */
+static void replay_stages(const uint8_t *pCapture, const uint32_t nLength) {
+	hosttest::Histogram ip;
+	hosttest::Histogram udp;
+	static uint8_t frame[injector::FRAME_SIZE] __attribute__ ((aligned (4)));
+
+	for (uint32_t nStage = 0; nStage < 2; nStage++) {
+		pcap::Reader reader(pCapture, nLength);
+		uint64_t nMicros;
+		uint32_t nFrameLength;
+		const uint8_t *pFrame;
+
+		while ((pFrame = reader.Next(nMicros, nFrameLength)) != nullptr) {
+			const auto *pUdp = reinterpret_cast<const struct t_udp *>(pFrame);
+
+			if ((nFrameLength > injector::FRAME_SIZE) || (pUdp->ether.type != __builtin_bswap16(ETHER_TYPE_IPv4)) || (pUdp->ip4.ver_ihl != 0x45) || (pUdp->ip4.proto != IPv4_PROTO_UDP)) {
+				continue;
+			}
+
+			memcpy(frame, pFrame, nFrameLength);
+
+			const auto nStart = hosttest::nanos();
+
+			if (nStage == 0) {
+				ip_handle(reinterpret_cast<struct t_ip4 *>(frame));
+			} else {
+				udp_handle(reinterpret_cast<struct t_udp *>(frame));
+			}
+
+			const auto nElapsed = hosttest::nanos() - nStart;
+			(nStage == 0 ? ip : udp).Add(nElapsed);
+
+			const auto nHandle = handle_of(__builtin_bswap16(pUdp->udp.destination_port));
+
+			if (nHandle >= 0) {
+				const uint8_t *pData;
+				uint32_t nFromIp;
+				uint16_t nFromPort;
+				hosttest::keep(udp_recv2(nHandle, &pData, &nFromIp, &nFromPort));
+			}
+		}
+	}
+
+	ip.Print("ip_handle, UDP");
+	udp.Print("udp_handle");
+}
+
+static void check_chksum() {
+	static uint8_t buffer[MTU_SIZE + 4] __attribute__ ((aligned (4)));
+	uint32_t nFailed = 0;
+
+	for (auto& n : buffer) {
+		n = static_cast<uint8_t>(rand());
+	}
+
+	for (uint32_t nLength = 0; nLength <= MTU_SIZE; nLength++) {
+		// The stack calls net_chksum on 16-bit aligned headers
+		for (uint32_t nOffset = 0; nOffset < 4; nOffset += 2) {
+			if (net_chksum(&buffer[nOffset], nLength) != chksum_reference(&buffer[nOffset], nLength)) {
+				nFailed++;
+			}
+		}
+	}
+
+	HOSTTEST_CHECK(nFailed == 0);
+
+	// A header with its checksum sums to zero
+	uint8_t frame[injector::FRAME_SIZE] __attribute__ ((aligned (4)));
+	build_udp(frame, make_ip(10, 0, 0, 1), NODE_IP, 1, 2, 100);
+	HOSTTEST_CHECK(net_chksum(&reinterpret_cast<struct t_udp *>(frame)->ip4, sizeof(struct ip4_header)) == 0);
+}
+
+static void check_arp_cache() {
+	uint32_t nFailed = 0;
+	uint8_t mac[ETH_ADDR_LEN];
+
+	for (uint32_t nHost = 1; nHost <= 16; nHost++) {
+		const uint8_t macHost[ETH_ADDR_LEN] = { 0x02, 0x00, 0x00, 0x00, 0x01, static_cast<uint8_t>(nHost) };
+		arp_cache_update(macHost, make_ip(192, 168, 2, nHost));
+	}
+
+	for (uint32_t nHost = 1; nHost <= 16; nHost++) {
+		memset(mac, 0, sizeof(mac));
+
+		if ((arp_cache_lookup(make_ip(192, 168, 2, nHost), mac) != make_ip(192, 168, 2, nHost)) || (mac[4] != 0x01) || (mac[5] != nHost)) {
+			nFailed++;
+		}
+	}
+
+	HOSTTEST_CHECK(nFailed == 0);
+}
+
+static uint8_t s_Capture[8 * 1024 * 1024];
+
+static void check_replay() {
+	const auto nLength = generate(s_Capture, sizeof(s_Capture), 2);
+	s_nArpReplies = 0;
+
+	const auto result = replay(s_Capture, nLength, nullptr, nullptr);
+
+	HOSTTEST_CHECK(result.nFrames == (2 * ((44 * 12) + 4 + 10)));
+	HOSTTEST_CHECK(result.nUdpForNode == (2 * 44 * 12));
+	HOSTTEST_CHECK(result.nReceived == result.nUdpForNode);
+	HOSTTEST_CHECK(result.nPayloadErrors == 0);
+	HOSTTEST_CHECK(s_nArpReplies == result.nArpForNode);
+	HOSTTEST_CHECK(udp_get_stats(s_nHandleArtNet)->nDropped == 0);
+}
+
+static void bench(const char *pFile) {
+	uint32_t nLength;
+	const uint8_t *pCapture = s_Capture;
+	uint8_t *pFileBuffer = nullptr;
+
+	if (pFile != nullptr) {
+		auto *pStream = fopen(pFile, "rb");
+
+		if (pStream == nullptr) {
+			perror(pFile);
+			return;
+		}
+
+		fseek(pStream, 0, SEEK_END);
+		nLength = static_cast<uint32_t>(ftell(pStream));
+		fseek(pStream, 0, SEEK_SET);
+
+		pFileBuffer = new uint8_t[nLength];
+
+		if (fread(pFileBuffer, 1, nLength, pStream) != nLength) {
+			perror(pFile);
+			nLength = 0;
+		}
+
+		fclose(pStream);
+		pCapture = pFileBuffer;
+
+		if (!pcap::Reader(pCapture, nLength).IsValid()) {
+			fprintf(stderr, "%s: not a pcap file with Ethernet frames\n", pFile);
+			delete[] pFileBuffer;
+			return;
+		}
+
+		printf("Replay of %s\n", pFile);
+	} else {
+		nLength = generate(s_Capture, sizeof(s_Capture), 60);
+		printf("Replay of 60 s generated traffic: 8 Art-Net + 4 sACN universes at 44 Hz, ARP\n");
+	}
+
+	hosttest::Histogram netHandle;
+	hosttest::Histogram recv;
+
+	const auto result = replay(pCapture, nLength, &netHandle, &recv);
+
+	printf("  %u frames, %u UDP for the node, %u received\n", result.nFrames, result.nUdpForNode, result.nReceived);
+	printf("  %-44s %12.0f packets/s\n", "net_handle", (result.nNanos != 0) ? (1e9 * result.nFrames / static_cast<double>(result.nNanos)) : 0.0);
+
+	netHandle.Print("net_handle");
+	replay_stages(pCapture, nLength);
+	recv.Print("udp_recv2");
+
+	delete[] pFileBuffer;
+
+	puts("ARP cache");
+
+	static uint32_t ips[32];
+
+	for (uint32_t nHost = 0; nHost < 32; nHost++) {
+		const uint8_t mac[ETH_ADDR_LEN] = { 0x02, 0x00, 0x00, 0x00, 0x02, static_cast<uint8_t>(nHost) };
+		ips[nHost] = make_ip(10, 0, 1, nHost + 1);
+		arp_cache_update(mac, ips[nHost]);
+	}
+
+	uint32_t nNext = 0;
+	uint8_t mac[ETH_ADDR_LEN];
+
+	hosttest::bench("arp_cache_lookup, 32 entries", 10000000, [&]() {
+		hosttest::keep(arp_cache_lookup(ips[(nNext++ * 7) & 31], mac));
+	});
+
+	puts("Checksum");
+
+	static uint8_t buffer[MTU_SIZE] __attribute__ ((aligned (4)));
+
+	for (auto& n : buffer) {
+		n = static_cast<uint8_t>(rand());
+	}
+
+	for (const uint32_t nSize : { 20U, 64U, 576U, 1472U }) {
+		char aName[48];
+
+		snprintf(aName, sizeof(aName), "net_chksum, %u bytes", nSize);
+		const auto fNanos = hosttest::bench(aName, 1000000, [&]() {
+			hosttest::keep(net_chksum(buffer, nSize));
+		});
+		printf("  %-44s %12.1f MB/s\n", "throughput", nSize * 1e3 / fNanos);
+
+		snprintf(aName, sizeof(aName), "reference, %u bytes", nSize);
+		hosttest::bench(aName, 1000000, [&]() {
+			hosttest::keep(chksum_reference(buffer, nSize));
+		});
+	}
+}
+
+int main(int argc, char **argv) {
+	srand(1);
+
+	Hardware hardware;
+
+	injector::set_transmit(transmit);
+
+	struct IpInfo ipInfo;
+	memset(&ipInfo, 0, sizeof(ipInfo));
+	ipInfo.ip.addr = NODE_IP;
+	ipInfo.netmask.addr = make_ip(255, 255, 255, 0);
+	ipInfo.gw.addr = make_ip(192, 168, 2, 1);
+
+	bool bUseDhcp = false;
+	bool isZeroconfUsed = false;
+
+	net_init(s_NodeMac, &ipInfo, "netbench", &bUseDhcp, &isZeroconfUsed);
+
+	s_nHandleArtNet = udp_begin(ARTNET_PORT);
+	s_nHandleE131 = udp_begin(E131_PORT);
+
+	check_chksum();
+	check_arp_cache();
+	check_replay();
+
+	if (hosttest::is_bench(argc, argv)) {
+		bench((argc > 2) ? argv[2] : nullptr);
+	}
+
+	return hosttest::exit_code("netbench");
+}
@@ -0,0 +1,500 @@
+/**
+ * @file tcploss.cpp
+ *
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <initializer_list>
+
+#include "net.h"
+#include "net_private.h"
+#include "net_packets.h"
+
+#include "emac_injector.h"
+#include "hardware.h"
+
+#include "hosttest.h"
+
+#include "../config/net_config.h"
+
+/*
+ * The stack sends a stream over a TCP connection to a peer in this program, on a link with a
+ * fixed delay that drops a percentage of the data segments. The peer acknowledges each segment
+ * and keeps the out of order data, as a PC does. The application writes with tcp_write and
+ * writes the rest later when only a part is queued.
+ *
+ * ./tcploss bench
+ */
+
+static constexpr uint32_t make_ip(const uint32_t a, const uint32_t b, const uint32_t c, const uint32_t d) {
+	return a | (b << 8) | (c << 16) | (d << 24);
+}
+
+static constexpr uint16_t HTTP_PORT = 80;
+static constexpr uint32_t NODE_IP = make_ip(192, 168, 2, 100);
+static constexpr uint32_t PEER_IP = make_ip(192, 168, 2, 10);
+static constexpr uint8_t s_NodeMac[ETH_ADDR_LEN] = { 0x02, 0x00, 0x00, 0x12, 0x34, 0x56 };
+static constexpr uint8_t s_PeerMac[ETH_ADDR_LEN] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x0a };
+
+static constexpr uint32_t LINK_DELAY_MILLIS = 1;	///< One way
+static constexpr uint16_t PEER_WINDOW = 65535;
+static constexpr uint32_t WRITE_SIZE = TCP_TX_BUFFER_SIZE;	///< As HttpDeamonHandleRequest::Flush, as much as fits
+static constexpr uint32_t TIMEOUT_MILLIS = 600000;
+static constexpr uint32_t STREAM_MAX = 1024 * 1024;
+
+namespace control {
+static constexpr uint8_t FIN = 0x01;
+static constexpr uint8_t SYN = 0x02;
+static constexpr uint8_t RST = 0x04;
+static constexpr uint8_t PSH = 0x08;
+static constexpr uint8_t ACK = 0x10;
+}  // namespace control
+
+static const char s_Request[] = "GET /stream HTTP/1.1\r\n\r\n";
+
+static uint8_t s_Stream[STREAM_MAX];
+static uint8_t s_Received[STREAM_MAX];
+
+/*
+ * RFC 1071 on big-endian 16-bit words, not folded
+ */
+static uint32_t sum16(const uint8_t *pData, const uint32_t nLength, uint32_t nSum) {
+	for (uint32_t i = 0; i < nLength; i += 2) {
+		nSum += (static_cast<uint32_t>(pData[i]) << 8) | ((i + 1 < nLength) ? pData[i + 1] : 0);
+	}
+
+	return nSum;
+}
+
+static uint16_t fold(uint32_t nSum) {
+	while (nSum >> 16) {
+		nSum = (nSum & 0xFFFF) + (nSum >> 16);
+	}
+
+	return static_cast<uint16_t>(nSum);
+}
+
+static uint32_t sum_pseudo(const struct t_tcp *pTcp, const uint32_t nTcpLength) {
+	uint8_t pseudo[12];
+
+	memcpy(&pseudo[0], pTcp->ip4.src, IPv4_ADDR_LEN);
+	memcpy(&pseudo[4], pTcp->ip4.dst, IPv4_ADDR_LEN);
+	pseudo[8] = 0;
+	pseudo[9] = IPv4_PROTO_TCP;
+	pseudo[10] = static_cast<uint8_t>(nTcpLength >> 8);
+	pseudo[11] = static_cast<uint8_t>(nTcpLength);
+
+	return sum16(pseudo, sizeof(pseudo), 0);
+}
+
+/*
+ * The link in one direction, the frames arrive LINK_DELAY_MILLIS after they are sent
+ */
+class Wire {
+public:
+	bool Put(const uint32_t nDueMillis, const void *pFrame, const uint32_t nLength) {
+		if ((m_nHead - m_nTail) == ENTRIES) {
+			return false;
+		}
+
+		auto& entry = m_Entries[m_nHead++ % ENTRIES];
+		entry.nDueMillis = nDueMillis;
+		entry.nLength = nLength;
+		memcpy(entry.data, pFrame, nLength);
+		return true;
+	}
+
+	const uint8_t *Get(const uint32_t nMillis, uint32_t& nLength) {
+		if ((m_nHead == m_nTail) || (static_cast<int32_t>(m_Entries[m_nTail % ENTRIES].nDueMillis - nMillis) > 0)) {
+			return nullptr;
+		}
+
+		auto& entry = m_Entries[m_nTail++ % ENTRIES];
+		nLength = entry.nLength;
+		return entry.data;
+	}
+
+	bool IsEmpty() const {
+		return m_nHead == m_nTail;
+	}
+
+	void Clear() {
+		m_nTail = m_nHead;
+	}
+
+private:
+	static constexpr uint32_t ENTRIES = 512;
+
+	struct Entry {
+		uint32_t nDueMillis;
+		uint32_t nLength;
+		uint8_t data[injector::FRAME_SIZE] __attribute__ ((aligned (4)));
+	};
+
+	Entry m_Entries[ENTRIES];
+	uint32_t m_nHead { 0 };
+	uint32_t m_nTail { 0 };
+};
+
+static Wire s_ToPeer;
+static Wire s_ToNode;
+
+struct Result {
+	uint32_t nSegments;			///< Data segments sent by the stack
+	uint32_t nDropped;
+	uint32_t nRetransmitted;	///< Data segments starting below the highest sequence number sent before
+	uint32_t nPartialWrites;	///< tcp_write queued less than asked
+	uint32_t nChecksumErrors;
+	uint32_t nDataErrors;
+	uint32_t nDelivered;		///< In order at the peer
+	uint32_t nMillis;			///< Virtual time from the request to the last byte
+	uint64_t nNanos;			///< CPU time in tcp_write and net_handle
+	bool bConnected;
+	bool bClosed;				///< tcp_write fails after the reset
+};
+
+/*
+ * The peer, a TCP client
+ */
+struct Peer {
+	uint16_t nPort;
+	uint32_t nSndNxt;
+	uint32_t nIrs;			///< The ISS of the stack
+	uint32_t nRcvNxt;
+	uint32_t nMaxSeq;		///< The highest sequence number sent by the stack + 1
+	uint32_t nStreamLength;
+	uint32_t nLossPermille;
+	bool bSynAcked;
+};
+
+static Peer s_Peer;
+static Result s_Result;
+
+static void send_segment(const uint8_t nControl, const uint32_t nSeq, const uint32_t nAck, const uint8_t *pData, const uint32_t nDataLength, const uint16_t nMss) {
+	uint8_t frame[injector::FRAME_SIZE] __attribute__ ((aligned (4)));
+	auto *pTcp = reinterpret_cast<struct t_tcp *>(frame);
+
+	const uint32_t nOptionsLength = ((nControl & control::SYN) && (nMss != 0)) ? 4 : 0;
+	const uint32_t nTcpLength = TCP_HEADER_SIZE + nOptionsLength + nDataLength;
+
+	memcpy(pTcp->ether.dst, s_NodeMac, ETH_ADDR_LEN);
+	memcpy(pTcp->ether.src, s_PeerMac, ETH_ADDR_LEN);
+	pTcp->ether.type = __builtin_bswap16(ETHER_TYPE_IPv4);
+
+	pTcp->ip4.ver_ihl = 0x45;
+	pTcp->ip4.tos = 0;
+	pTcp->ip4.len = __builtin_bswap16(static_cast<uint16_t>(sizeof(struct ip4_header) + nTcpLength));
+	pTcp->ip4.id = 0;
+	pTcp->ip4.flags_froff = __builtin_bswap16(IPv4_FLAG_DF);
+	pTcp->ip4.ttl = 64;
+	pTcp->ip4.proto = IPv4_PROTO_TCP;
+	pTcp->ip4.chksum = 0;
+	memcpy(pTcp->ip4.src, &PEER_IP, IPv4_ADDR_LEN);
+	memcpy(pTcp->ip4.dst, &NODE_IP, IPv4_ADDR_LEN);
+	pTcp->ip4.chksum = __builtin_bswap16(static_cast<uint16_t>(~fold(sum16(reinterpret_cast<const uint8_t *>(&pTcp->ip4), sizeof(struct ip4_header), 0))));
+
+	pTcp->tcp.srcpt = __builtin_bswap16(s_Peer.nPort);
+	pTcp->tcp.dstpt = __builtin_bswap16(HTTP_PORT);
+	pTcp->tcp.seqnum = __builtin_bswap32(nSeq);
+	pTcp->tcp.acknum = __builtin_bswap32(nAck);
+	pTcp->tcp.offset = static_cast<uint8_t>(((TCP_HEADER_SIZE + nOptionsLength) / 4) << 4);
+	pTcp->tcp.control = nControl;
+	pTcp->tcp.window = __builtin_bswap16(PEER_WINDOW);
+	pTcp->tcp.checksum = 0;
+	pTcp->tcp.urgent = 0;
+
+	auto *pOptions = pTcp->tcp.data;
+
+	if (nOptionsLength != 0) {
+		pOptions[0] = 2;	// MSS
+		pOptions[1] = 4;
+		pOptions[2] = static_cast<uint8_t>(nMss >> 8);
+		pOptions[3] = static_cast<uint8_t>(nMss);
+	}
+
+	if (nDataLength != 0) {
+		memcpy(&pOptions[nOptionsLength], pData, nDataLength);
+	}
+
+	const auto nSum = sum16(reinterpret_cast<const uint8_t *>(&pTcp->tcp), nTcpLength, sum_pseudo(pTcp, nTcpLength));
+	pTcp->tcp.checksum = __builtin_bswap16(static_cast<uint16_t>(~fold(nSum)));
+
+	s_ToNode.Put(injector::millis() + LINK_DELAY_MILLIS, frame, static_cast<uint32_t>(sizeof(struct ether_header) + sizeof(struct ip4_header) + nTcpLength));
+}
+
+/*
+ * Called by emac_eth_send, the loss is injected here
+ */
+static void transmit(const uint8_t *pFrame, const uint32_t nLength) {
+	const auto *pTcp = reinterpret_cast<const struct t_tcp *>(pFrame);
+
+	if ((pTcp->ether.type != __builtin_bswap16(ETHER_TYPE_IPv4)) || (pTcp->ip4.proto != IPv4_PROTO_TCP) || (__builtin_bswap16(pTcp->tcp.dstpt) != s_Peer.nPort)) {
+		return;
+	}
+
+	const auto nTcpLength = static_cast<uint32_t>(__builtin_bswap16(pTcp->ip4.len) - sizeof(struct ip4_header));
+	const auto nDataLength = nTcpLength - ((pTcp->tcp.offset >> 4) * 4U);
+
+	if (nDataLength != 0) {
+		const auto nSeq = __builtin_bswap32(pTcp->tcp.seqnum);
+
+		s_Result.nSegments++;
+
+		if (static_cast<int32_t>(nSeq - s_Peer.nMaxSeq) < 0) {
+			s_Result.nRetransmitted++;
+		}
+
+		if (static_cast<int32_t>(nSeq + nDataLength - s_Peer.nMaxSeq) > 0) {
+			s_Peer.nMaxSeq = nSeq + nDataLength;
+		}
+
+		if (static_cast<uint32_t>(rand() % 1000) < s_Peer.nLossPermille) {
+			s_Result.nDropped++;
+			return;
+		}
+	}
+
+	s_ToPeer.Put(injector::millis() + LINK_DELAY_MILLIS, pFrame, nLength);
+}
+
+static void peer_receive(const uint8_t *pFrame) {
+	const auto *pTcp = reinterpret_cast<const struct t_tcp *>(pFrame);
+	const auto nTcpLength = static_cast<uint32_t>(__builtin_bswap16(pTcp->ip4.len) - sizeof(struct ip4_header));
+
+	if (fold(sum16(reinterpret_cast<const uint8_t *>(&pTcp->tcp), nTcpLength, sum_pseudo(pTcp, nTcpLength))) != 0xFFFF) {
+		s_Result.nChecksumErrors++;
+		return;
+	}
+
+	const auto nDataOffset = (pTcp->tcp.offset >> 4) * 4U;
+	const auto nDataLength = nTcpLength - nDataOffset;
+	const auto nSeq = __builtin_bswap32(pTcp->tcp.seqnum);
+	const auto nControl = pTcp->tcp.control;
+
+	if (nControl & control::RST) {
+		return;
+	}
+
+	if (!s_Peer.bSynAcked) {
+		if ((nControl & (control::SYN | control::ACK)) == (control::SYN | control::ACK)) {
+			s_Peer.bSynAcked = true;
+			s_Peer.nIrs = nSeq;
+			s_Peer.nRcvNxt = nSeq + 1;
+			s_Peer.nMaxSeq = s_Peer.nRcvNxt;
+
+			send_segment(control::ACK, s_Peer.nSndNxt, s_Peer.nRcvNxt, nullptr, 0, 0);
+			send_segment(control::PSH | control::ACK, s_Peer.nSndNxt, s_Peer.nRcvNxt, reinterpret_cast<const uint8_t *>(s_Request), sizeof(s_Request) - 1, 0);
+			s_Peer.nSndNxt += static_cast<uint32_t>(sizeof(s_Request) - 1);
+		}
+		return;
+	}
+
+	if (nDataLength == 0) {
+		return;
+	}
+
+	const auto *pData = reinterpret_cast<const uint8_t *>(&pTcp->tcp) + nDataOffset;
+	const auto nOffset = nSeq - (s_Peer.nIrs + 1);
+
+	if ((nOffset + nDataLength) > s_Peer.nStreamLength) {
+		s_Result.nDataErrors++;
+	} else {
+		if (memcmp(pData, &s_Stream[nOffset], nDataLength) != 0) {
+			s_Result.nDataErrors++;
+		}
+
+		memset(&s_Received[nOffset], 1, nDataLength);
+
+		auto nNext = s_Peer.nRcvNxt - (s_Peer.nIrs + 1);
+
+		while ((nNext < s_Peer.nStreamLength) && s_Received[nNext]) {
+			nNext++;
+		}
+
+		s_Peer.nRcvNxt = s_Peer.nIrs + 1 + nNext;
+		s_Result.nDelivered = nNext;
+	}
+
+	send_segment(control::ACK, s_Peer.nSndNxt, s_Peer.nRcvNxt, nullptr, 0, 0);
+}
+
+static void node_handle() {
+	const auto nStart = hosttest::nanos();
+	net_handle();
+	s_Result.nNanos += hosttest::nanos() - nStart;
+}
+
+/*
+ * One connection: the peer connects and requests the stream, the stack sends it and
+ * the peer resets the connection when everything is received.
+ */
+static Result run(const uint32_t nStreamLength, const uint32_t nLossPermille, const uint16_t nMss) {
+	static uint16_t s_nPort = 40000;
+
+	memset(&s_Result, 0, sizeof(s_Result));
+	memset(&s_Peer, 0, sizeof(s_Peer));
+	memset(s_Received, 0, nStreamLength);
+
+	s_Peer.nPort = s_nPort++;
+	s_Peer.nSndNxt = 1000000U * s_Peer.nPort;
+	s_Peer.nStreamLength = nStreamLength;
+	s_Peer.nLossPermille = nLossPermille;
+
+	const auto nHandleListen = tcp_begin(HTTP_PORT);
+	const auto nStartMillis = injector::millis();
+
+	send_segment(control::SYN, s_Peer.nSndNxt, 0, nullptr, 0, nMss);
+	s_Peer.nSndNxt++;
+
+	uint32_t nHandleConnection = 0;
+	uint32_t nWritten = 0;
+	uint32_t nRequestMillis = 0;
+
+	while ((s_Result.nDelivered < nStreamLength) && ((injector::millis() - nStartMillis) < TIMEOUT_MILLIS)) {
+		if (!s_Result.bConnected) {
+			const uint8_t *pRequest;
+
+			if (tcp_read(nHandleListen, &pRequest, nHandleConnection) != 0) {
+				s_Result.bConnected = (memcmp(pRequest, s_Request, sizeof(s_Request) - 1) == 0);
+				nRequestMillis = injector::millis();
+			}
+		}
+
+		while (s_Result.bConnected && (nWritten < nStreamLength)) {
+			const auto nLength = std::min(WRITE_SIZE, nStreamLength - nWritten);
+
+			const auto nStart = hosttest::nanos();
+			const auto nQueued = tcp_write(nHandleListen, &s_Stream[nWritten], static_cast<uint16_t>(nLength), nHandleConnection);
+			s_Result.nNanos += hosttest::nanos() - nStart;
+
+			if (nQueued <= 0) {
+				break;
+			}
+
+			if (static_cast<uint32_t>(nQueued) < nLength) {
+				s_Result.nPartialWrites++;
+			}
+
+			nWritten += static_cast<uint32_t>(nQueued);
+		}
+
+		const uint8_t *pFrame;
+		uint32_t nLength;
+
+		while ((pFrame = s_ToPeer.Get(injector::millis(), nLength)) != nullptr) {
+			peer_receive(pFrame);
+		}
+
+		while ((pFrame = s_ToNode.Get(injector::millis(), nLength)) != nullptr) {
+			injector::inject(pFrame, nLength);
+			node_handle();
+		}
+
+		node_handle();	// The timers
+
+		injector::advance(1);
+	}
+
+	s_Result.nMillis = injector::millis() - nRequestMillis;
+
+	// The peer resets the connection, the TCB is in LISTEN again
+	send_segment(control::RST, s_Peer.nSndNxt, 0, nullptr, 0, 0);
+
+	injector::advance(LINK_DELAY_MILLIS);
+
+	const uint8_t *pFrame;
+	uint32_t nLength;
+
+	while ((pFrame = s_ToNode.Get(injector::millis(), nLength)) != nullptr) {
+		injector::inject(pFrame, nLength);
+		net_handle();
+	}
+
+	const uint8_t byte = 0;
+	s_Result.bClosed = (tcp_write(nHandleListen, &byte, 1, nHandleConnection) < 0);
+
+	s_ToPeer.Clear();
+	s_ToNode.Clear();
+
+	return s_Result;
+}
+
+static bool is_complete(const Result& result, const uint32_t nStreamLength) {
+	return result.bConnected && (result.nDelivered == nStreamLength) && (result.nDataErrors == 0) && (result.nChecksumErrors == 0) && result.bClosed;
+}
+
+static void print(const uint16_t nMss, const uint32_t nLossPermille, const uint32_t nStreamLength, const Result& result) {
+	const auto fSeconds = result.nMillis / 1000.0;
+
+	printf("  MSS %4u, loss %4.1f%%: %5u segments, %4u dropped, %4u retransmitted, %8.3f s, %8.1f kB/s, %6.2f ns/byte%s\n",
+			nMss, nLossPermille / 10.0, result.nSegments, result.nDropped, result.nRetransmitted, fSeconds,
+			(fSeconds != 0) ? (nStreamLength / 1000.0 / fSeconds) : 0.0,
+			static_cast<double>(result.nNanos) / nStreamLength,
+			is_complete(result, nStreamLength) ? "" : " INCOMPLETE");
+}
+
+int main(int argc, char **argv) {
+	srand(1);
+
+	Hardware hardware;
+
+	injector::set_transmit(transmit);
+
+	struct IpInfo ipInfo;
+	memset(&ipInfo, 0, sizeof(ipInfo));
+	ipInfo.ip.addr = NODE_IP;
+	ipInfo.netmask.addr = make_ip(255, 255, 255, 0);
+	ipInfo.gw.addr = make_ip(192, 168, 2, 1);
+
+	bool bUseDhcp = false;
+	bool isZeroconfUsed = false;
+
+	net_init(s_NodeMac, &ipInfo, "tcploss", &bUseDhcp, &isZeroconfUsed);
+
+	injector::set_idle_millis(0);
+
+	for (auto& n : s_Stream) {
+		n = static_cast<uint8_t>(rand());
+	}
+
+	constexpr uint32_t nStreamLength = 256 * 1024;
+
+	// MSS option 1460, the stack sends 1400 bytes segments
+	const auto clean = run(nStreamLength, 0, 1460);
+
+	HOSTTEST_CHECK(is_complete(clean, nStreamLength));
+	HOSTTEST_CHECK(clean.nDropped == 0);
+	HOSTTEST_CHECK(clean.nRetransmitted == 0);
+	HOSTTEST_CHECK(clean.nSegments < (nStreamLength / 1000));	// A SYN with the MSS option only
+
+	const auto lossy = run(nStreamLength, 50, 1460);
+
+	HOSTTEST_CHECK(is_complete(lossy, nStreamLength));
+	HOSTTEST_CHECK(lossy.nDropped != 0);
+	HOSTTEST_CHECK(lossy.nRetransmitted != 0);
+	HOSTTEST_CHECK(lossy.nPartialWrites != 0);	// The rest is written after the acknowledgments
+
+	// Without an MSS option, 536 bytes segments
+	const auto small = run(nStreamLength, 50, 0);
+
+	HOSTTEST_CHECK(is_complete(small, nStreamLength));
+	HOSTTEST_CHECK(small.nSegments > (nStreamLength / 536));
+
+	if (hosttest::is_bench(argc, argv)) {
+		printf("TCP stream of %u kB, link delay %u ms, TCP_TX_BUFFER_SIZE %u\n", STREAM_MAX / 1024, LINK_DELAY_MILLIS, TCP_TX_BUFFER_SIZE);
+
+		for (const uint16_t nMss : { 1460, 0 }) {
+			for (const uint32_t nLossPermille : { 0U, 10U, 50U, 100U }) {
+				const auto result = run(STREAM_MAX, nLossPermille, nMss);
+				print((nMss != 0) ? 1400 : 536, nLossPermille, STREAM_MAX, result);
+				HOSTTEST_CHECK(is_complete(result, STREAM_MAX));
+			}
+		}
+	}
+
+	return hosttest::exit_code("tcploss");
+}
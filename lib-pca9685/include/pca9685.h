@@ -27,6 +27,7 @@
 #define PCA9685_H_
 
 #include <cstdint>
+#include <cstring>
 
 namespace pca9685 {
 static constexpr uint8_t I2C_ADDRESS_DEFAULT = 0x40;
@@ -92,6 +93,28 @@ public:
 	void SetFullOn(const uint32_t nChannel, const bool bMode);
 	void SetFullOff(const uint32_t nChannel, const bool bMode);
 
+	/**
+	 * Only the shadow register file is updated, the changed channels are written with Flush()
+	 */
+	void SetShadow(const uint32_t nChannel, const uint16_t nOn, const uint16_t nOff) {
+		const uint8_t registers[4] = {
+				static_cast<uint8_t>(nOn & 0xFF), static_cast<uint8_t>(nOn >> 8),
+				static_cast<uint8_t>(nOff & 0xFF), static_cast<uint8_t>(nOff >> 8) };
+
+		auto *pShadow = &m_Shadow[nChannel * 4];
+
+		if (memcmp(pShadow, registers, 4) != 0) {
+			memcpy(pShadow, registers, 4);
+			m_nDirty |= static_cast<uint16_t>(1U << nChannel);
+		}
+	}
+
+	/**
+	 * Each run of contiguous changed channels is written with one auto-increment burst.
+	 * @return number of I2C write transactions
+	 */
+	uint32_t Flush();
+
 	void Dump();
 
 private:
@@ -113,8 +136,12 @@ private:
 
 	void I2cWriteReg(uint8_t, uint16_t, uint16_t);
 
+	void ShadowWrite(const uint32_t nChannel, const uint32_t nOffset, const uint8_t *pData, const uint32_t nLength);
+
 private:
 	uint8_t m_nAddress;
+	uint16_t m_nDirty { 0 };						///< Bit n is set when channel n differs from the device
+	uint8_t m_Shadow[pca9685::PWM_CHANNELS * 4];	///< LEDn_ON_L, LEDn_ON_H, LEDn_OFF_L, LEDn_OFF_H
 };
 
 #endif /* PCA9685_H_ */
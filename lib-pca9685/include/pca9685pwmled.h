@@ -62,6 +62,34 @@ public:
 			Write(nChannel, nValue);
 		}
 	}
+
+	/*
+	 * As Set(), without I2C transfers. The full on and full off bits are part of the
+	 * shadow registers, so there is no read-modify-write. The changes are written with Flush().
+	 */
+
+	void SetBuffered(const uint32_t nChannel, const uint16_t nData) {
+		if (nData >= 0xFFF) {
+			SetShadow(nChannel, FULL, 0);
+		} else if (nData == 0) {
+			SetShadow(nChannel, 0, FULL);
+		} else {
+			SetShadow(nChannel, 0, nData);
+		}
+	}
+
+	void SetBuffered(const uint32_t nChannel, const uint8_t nData) {
+		if (nData == 0xFF) {
+			SetShadow(nChannel, FULL, 0);
+		} else if (nData == 0) {
+			SetShadow(nChannel, 0, FULL);
+		} else {
+			SetShadow(nChannel, 0, static_cast<uint16_t>((nData << 4) | (nData >> 4)));
+		}
+	}
+
+private:
+	static constexpr uint16_t FULL = 0x1000;
 };
 
 #endif /* PCA9685PWMLED_H_ */
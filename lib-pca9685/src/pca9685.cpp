@@ -25,6 +25,7 @@
 
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
 #include <cassert>
 
 #include "hal_i2c.h"
@@ -192,6 +193,12 @@ void PCA9685::Write(const uint32_t nChannel, const uint16_t nOn, const uint16_t
 	}
 
 	I2cWriteReg(reg, nOn, nOff);
+
+	const uint8_t registers[4] = {
+			static_cast<uint8_t>(nOn & 0xFF), static_cast<uint8_t>(nOn >> 8),
+			static_cast<uint8_t>(nOff & 0xFF), static_cast<uint8_t>(nOff >> 8) };
+
+	ShadowWrite(nChannel, 0, registers, 4);
 }
 
 void PCA9685::Write(const uint32_t nChannel, const uint16_t nValue) {
@@ -245,6 +252,7 @@ void PCA9685::SetFullOn(const uint32_t nChannel, const bool bMode) {
 	Data = bMode ? (Data | 0x10) : (Data & 0xEF);
 
 	I2cWriteReg(reg, Data);
+	ShadowWrite(nChannel, 1, &Data, 1);
 
 	if (bMode) {
 		SetFullOff(nChannel, false);
@@ -266,6 +274,51 @@ void PCA9685::SetFullOff(const uint32_t nChannel, const bool bMode) {
 	Data = bMode ? (Data | 0x10) : (Data & 0xEF);
 
 	I2cWriteReg(reg, Data);
+	ShadowWrite(nChannel, 3, &Data, 1);
+}
+
+/*
+ * A write to the ALL_LED registers is a write to all the LEDn registers
+ */
+void PCA9685::ShadowWrite(const uint32_t nChannel, const uint32_t nOffset, const uint8_t *pData, const uint32_t nLength) {
+	if (nChannel < pca9685::PWM_CHANNELS) {
+		memcpy(&m_Shadow[nChannel * 4 + nOffset], pData, nLength);
+		return;
+	}
+
+	for (uint32_t i = 0; i < pca9685::PWM_CHANNELS; i++) {
+		memcpy(&m_Shadow[i * 4 + nOffset], pData, nLength);
+	}
+}
+
+uint32_t PCA9685::Flush() {
+	if (m_nDirty == 0) {
+		return 0;
+	}
+
+	I2cSetup();
+
+	uint32_t nDirty = m_nDirty;
+	uint32_t nTransactions = 0;
+	char buffer[1 + sizeof(m_Shadow)];
+
+	m_nDirty = 0;
+
+	while (nDirty != 0) {
+		const auto nFirst = static_cast<uint32_t>(__builtin_ctz(nDirty));
+		const auto nChannels = static_cast<uint32_t>(__builtin_ctz(~(nDirty >> nFirst)));
+		const auto nLength = nChannels * 4;
+
+		buffer[0] = static_cast<char>(PCA9685_REG_LED0_ON_L + (nFirst << 2));
+		memcpy(&buffer[1], &m_Shadow[nFirst * 4], nLength);
+
+		FUNC_PREFIX(i2c_write(buffer, 1 + nLength));
+
+		nDirty &= ~(((1U << nChannels) - 1) << nFirst);
+		nTransactions++;
+	}
+
+	return nTransactions;
 }
 
 uint8_t PCA9685::CalcPresScale(uint32_t nFrequency) {
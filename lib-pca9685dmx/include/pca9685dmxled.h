@@ -43,14 +43,27 @@ public:
 	void Stop(const uint32_t nPortIndex) override;
 
 	void SetData(const uint32_t nPortIndex, const uint8_t *pDmxData, uint32_t nLength, const bool doUpdate = true) override;
+	void SetDataRange(const uint32_t nPortIndex, const uint8_t *pDmxData, uint32_t nLength, const uint32_t nOffset, const uint32_t nCount, const bool doUpdate = true) override {
+		const uint32_t nFootprintOffset = m_nDmxStartAddress - 1U;
+
+		if ((!m_bRemapped) && ((nCount == 0) || (nOffset >= (nFootprintOffset + m_nDmxFootprint)) || ((nOffset + nCount) <= nFootprintOffset))) {
+			return;
+		}
+
+		m_bRemapped = false;
+		SetData(nPortIndex, pDmxData, nLength, doUpdate);
+	}
 	void Sync([[maybe_unused]] const uint32_t nPortIndex) override {};
-	void Sync([[maybe_unused]] const bool doForce = false) override {};
+	void Sync([[maybe_unused]] const bool doForce = false) override {
+		Flush();
+	}
 
 	bool SetDmxStartAddress(const uint16_t nDmxStartAddress) override {
 		assert((nDmxStartAddress != 0) && (nDmxStartAddress <= lightset::dmx::UNIVERSE_SIZE));
 
 		if ((nDmxStartAddress != 0) && (nDmxStartAddress <= lightset::dmx::UNIVERSE_SIZE)) {
 			m_nDmxStartAddress = nDmxStartAddress;
+			m_bRemapped = true;
 			PCA9685DmxStore::SaveDmxStartAddress(m_nDmxStartAddress);
 			return true;
 		}
@@ -70,12 +83,16 @@ public:
 
 	void Print() override;
 
+private:
+	void Flush();
+
 private:
 	uint16_t m_nBoardInstances;
 	uint16_t m_nDmxFootprint;
 	uint16_t m_nDmxStartAddress;
 	uint16_t m_nChannelCount;
 	bool m_bUse8Bit;
+	bool m_bRemapped { false };	///< The footprint has moved, the next frame is output in full
 	uint8_t m_DmxData[lightset::dmx::UNIVERSE_SIZE];
 	PCA9685PWMLed **m_pPWMLed;
 };
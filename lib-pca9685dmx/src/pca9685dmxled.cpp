@@ -102,7 +102,7 @@ void PCA9685DmxLed::Stop([[maybe_unused]] const uint32_t nPortIndex) {
 	DEBUG_EXIT
 }
 
-void PCA9685DmxLed::SetData([[maybe_unused]] uint32_t nPortIndex, const uint8_t *pDmxData, uint32_t nLength, [[maybe_unused]] const bool doUpdate) {
+void PCA9685DmxLed::SetData([[maybe_unused]] uint32_t nPortIndex, const uint8_t *pDmxData, uint32_t nLength, const bool doUpdate) {
 	assert(pDmxData != nullptr);
 	assert(nLength <= lightset::dmx::UNIVERSE_SIZE);
 
@@ -124,7 +124,7 @@ void PCA9685DmxLed::SetData([[maybe_unused]] uint32_t nPortIndex, const uint8_t
 #ifndef NDEBUG
 					printf("m_pPWMLed[%u]->SetDmx(CHANNEL(%u), %u)\n", j, i, static_cast<uint32_t>(value));
 #endif
-					m_pPWMLed[j]->Set(i, value);
+					m_pPWMLed[j]->SetBuffered(i, value);
 				}
 				pCurrentData++;
 				pPreviousData++;
@@ -149,7 +149,7 @@ void PCA9685DmxLed::SetData([[maybe_unused]] uint32_t nPortIndex, const uint8_t
 #ifndef NDEBUG
 					printf("m_pPWMLed[%u]->SetDmx(CHANNEL(%u), %u)\n", j, i, static_cast<uint32_t>(value));
 #endif
-					m_pPWMLed[j]->Set(i, value);
+					m_pPWMLed[j]->SetBuffered(i, value);
 				}
 				pCurrentData++;
 				pPreviousData++;
@@ -157,6 +157,19 @@ void PCA9685DmxLed::SetData([[maybe_unused]] uint32_t nPortIndex, const uint8_t
 			}
 		}
 	}
+
+	if (doUpdate) {
+		Flush();
+	}
+}
+
+/*
+ * All boards in one pass, a board without changes has no I2C transfer
+ */
+void PCA9685DmxLed::Flush() {
+	for (uint32_t j = 0; j < m_nBoardInstances; j++) {
+		m_pPWMLed[j]->Flush();
+	}
 }
 
 bool PCA9685DmxLed::GetSlotInfo(uint16_t nSlotOffset, lightset::SlotInfo& tSlotInfo) {
@@ -0,0 +1,351 @@
+/**
+ * @file pca9685flush.cpp
+ *
+ */
+/* Copyright (C) 2024 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "pca9685dmxled.h"
+#include "pca9685pwmled.h"
+
+#include "configstore.h"
+#include "hal_i2c.h"
+
+#include "hosttest.h"
+
+/*
+ * PCA9685DmxLed::SetDmxStartAddress saves to the configuration store, which is not used here
+ */
+ConfigStore *ConfigStore::s_pThis;
+
+void ConfigStore::Update([[maybe_unused]] configstore::Store store, [[maybe_unused]] uint32_t nOffset, [[maybe_unused]] const void *pData,
+		[[maybe_unused]] uint32_t nDataLength, [[maybe_unused]] uint32_t nSetList, [[maybe_unused]] uint32_t nOffsetSetList) {
+}
+
+static constexpr uint8_t ADDRESS = 0x40;
+static constexpr uint32_t BOARDS = 8;
+static constexpr uint32_t CHANNELS = BOARDS * pca9685::PWM_CHANNELS;
+static constexpr uint8_t REG_LED0_ON_L = 0x06;
+
+/*
+ * Address and register bytes of a burst
+ */
+static constexpr uint32_t BURST_OVERHEAD = 2;
+
+struct Traffic {
+	uint32_t nTransactions;
+	uint32_t nBytes;
+};
+
+static Traffic traffic() {
+	return Traffic { i2c_mock_get_transactions(), i2c_mock_get_bytes() };
+}
+
+/**
+ * The LEDn registers as encoded by PCA9685PWMLed::Set(nChannel, uint8_t)
+ */
+static void led_registers(uint8_t registers[4], const uint8_t nValue) {
+	uint16_t nOn = 0;
+	uint16_t nOff;
+
+	if (nValue == 0xFF) {
+		nOn = 0x1000;
+		nOff = 0;
+	} else if (nValue == 0) {
+		nOff = 0x1000;
+	} else {
+		nOff = static_cast<uint16_t>((nValue << 4) | (nValue >> 4));
+	}
+
+	registers[0] = static_cast<uint8_t>(nOn & 0xFF);
+	registers[1] = static_cast<uint8_t>(nOn >> 8);
+	registers[2] = static_cast<uint8_t>(nOff & 0xFF);
+	registers[3] = static_cast<uint8_t>(nOff >> 8);
+}
+
+/**
+ * The registers of all boards as written on the bus match the DMX data
+ */
+static bool is_device(const uint8_t *pDmxData) {
+	for (uint32_t nChannel = 0; nChannel < CHANNELS; nChannel++) {
+		const auto nAddress = static_cast<uint8_t>(ADDRESS + nChannel / pca9685::PWM_CHANNELS);
+		const auto nRegister = REG_LED0_ON_L + (nChannel % pca9685::PWM_CHANNELS) * 4;
+
+		uint8_t registers[4];
+		led_registers(registers, pDmxData[nChannel]);
+
+		for (uint32_t i = 0; i < 4; i++) {
+			if (i2c_mock_get_register(nAddress, static_cast<uint8_t>(nRegister + i)) != registers[i]) {
+				printf("  channel %u, register %02X\n", nChannel, nRegister + i);
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+static void fill(uint8_t *pDmxData) {
+	for (uint32_t i = 0; i < CHANNELS; i++) {
+		pDmxData[i] = static_cast<uint8_t>(1 + rand() % 254);
+	}
+}
+
+static Traffic frame(PCA9685DmxLed& pca9685DmxLed, const uint8_t *pDmxData) {
+	i2c_mock_reset();
+	pca9685DmxLed.SetData(0, pDmxData, lightset::dmx::UNIVERSE_SIZE, true);
+	return traffic();
+}
+
+static pca9685dmx::Configuration configuration() {
+	pca9685dmx::Configuration configuration;
+
+	configuration.nMode = 0;
+	configuration.nAddress = ADDRESS;
+	configuration.nChannelCount = CHANNELS;
+	configuration.nDmxStartAddress = 1;
+	configuration.bUse8Bit = true;
+	configuration.led.nLedPwmFrequency = pca9685::pwmled::DEFAULT_FREQUENCY;
+	configuration.led.invert = pca9685::Invert::OUTPUT_NOT_INVERTED;
+	configuration.led.output = pca9685::Output::DRIVER_TOTEMPOLE;
+
+	return configuration;
+}
+
+static void check_set_data(PCA9685DmxLed& pca9685DmxLed) {
+	uint8_t dmxData[lightset::dmx::UNIVERSE_SIZE] = {};
+
+	// Every channel changes: one burst of 16 channels per board
+	fill(dmxData);
+	auto t = frame(pca9685DmxLed, dmxData);
+
+	HOSTTEST_CHECK(t.nTransactions == BOARDS);
+	HOSTTEST_CHECK(t.nBytes == BOARDS * (BURST_OVERHEAD + pca9685::PWM_CHANNELS * 4));
+	HOSTTEST_CHECK(is_device(dmxData));
+
+	// No changes, no traffic
+	t = frame(pca9685DmxLed, dmxData);
+
+	HOSTTEST_CHECK(t.nTransactions == 0);
+	HOSTTEST_CHECK(t.nBytes == 0);
+
+	// Non-contiguous runs: board 0 channels 1-3, 9 and 15, board 5 channel 0
+	dmxData[1]++; dmxData[2]++; dmxData[3]++;
+	dmxData[9]++;
+	dmxData[15]++;
+	dmxData[5 * 16]++;
+
+	t = frame(pca9685DmxLed, dmxData);
+
+	HOSTTEST_CHECK(t.nTransactions == 4);
+	HOSTTEST_CHECK(t.nBytes == (BURST_OVERHEAD + 3 * 4) + 3 * (BURST_OVERHEAD + 4));
+	HOSTTEST_CHECK(is_device(dmxData));
+
+	// Full on and full off are in the registers, a run of 2 channels
+	dmxData[4] = 0xFF;
+	dmxData[5] = 0;
+
+	t = frame(pca9685DmxLed, dmxData);
+
+	HOSTTEST_CHECK(t.nTransactions == 1);
+	HOSTTEST_CHECK(t.nBytes == BURST_OVERHEAD + 2 * 4);
+	HOSTTEST_CHECK(is_device(dmxData));
+
+	// The last channel of a board and the first of the next board are 2 bursts
+	dmxData[15]++;
+	dmxData[16]++;
+
+	t = frame(pca9685DmxLed, dmxData);
+
+	HOSTTEST_CHECK(t.nTransactions == 2);
+	HOSTTEST_CHECK(is_device(dmxData));
+
+	// Without doUpdate nothing is written until the sync
+	dmxData[100]++;
+
+	i2c_mock_reset();
+	pca9685DmxLed.SetData(0, dmxData, lightset::dmx::UNIVERSE_SIZE, false);
+
+	HOSTTEST_CHECK(i2c_mock_get_transactions() == 0);
+
+	pca9685DmxLed.Sync();
+
+	HOSTTEST_CHECK(i2c_mock_get_transactions() == 1);
+	HOSTTEST_CHECK(is_device(dmxData));
+}
+
+/**
+ * A write to the ALL_LED registers is a write to all the LEDn registers, so the shadow is updated.
+ * Then setting a channel to the value it already has is not written again.
+ */
+static void check_all_led() {
+	PCA9685PWMLed board(ADDRESS + BOARDS);
+
+	for (uint32_t i = 0; i < pca9685::PWM_CHANNELS; i++) {
+		board.SetBuffered(i, static_cast<uint8_t>(1 + i));
+	}
+
+	HOSTTEST_CHECK(board.Flush() == 1);
+
+	// ALL_LED full off
+	board.Write(CHANNEL(16), VALUE(0), VALUE(0x1000));
+
+	for (uint32_t i = 0; i < pca9685::PWM_CHANNELS; i++) {
+		board.SetBuffered(i, static_cast<uint8_t>(0));
+	}
+
+	i2c_mock_reset();
+	HOSTTEST_CHECK(board.Flush() == 0);
+	HOSTTEST_CHECK(i2c_mock_get_transactions() == 0);
+
+	// ALL_LED full on, with the read-modify-write of the full on and full off bits
+	board.SetFullOn(CHANNEL(16), true);
+
+	for (uint32_t i = 0; i < pca9685::PWM_CHANNELS; i++) {
+		board.SetBuffered(i, static_cast<uint8_t>(0xFF));
+	}
+
+	HOSTTEST_CHECK(board.Flush() == 0);
+
+	// One channel differs from the ALL_LED value
+	board.SetBuffered(7, static_cast<uint8_t>(0x80));
+
+	i2c_mock_reset();
+	HOSTTEST_CHECK(board.Flush() == 1);
+	HOSTTEST_CHECK(i2c_mock_get_bytes() == BURST_OVERHEAD + 4);
+}
+
+/*
+ * PCA9685DmxLed::SetData before the shadow registers: a Set() per changed channel
+ */
+__attribute__((noinline)) static void set_data_before(PCA9685PWMLed **pBoards, uint8_t *pPrevious, const uint8_t *pDmxData) {
+	for (uint32_t nChannel = 0; nChannel < CHANNELS; nChannel++) {
+		if (pDmxData[nChannel] != pPrevious[nChannel]) {
+			pPrevious[nChannel] = pDmxData[nChannel];
+			pBoards[nChannel / pca9685::PWM_CHANNELS]->Set(nChannel % pca9685::PWM_CHANNELS, pDmxData[nChannel]);
+		}
+	}
+}
+
+struct Scenario {
+	const char *pName;
+	void (*pChange)(uint8_t *pDmxData, const uint32_t nFrame);
+};
+
+static const Scenario s_Scenarios[] = {
+	{ "all channels", [](uint8_t *pDmxData, const uint32_t nFrame) {
+		for (uint32_t i = 0; i < CHANNELS; i++) {
+			pDmxData[i] = static_cast<uint8_t>(1 + (nFrame + i) % 254);
+		}
+	} },
+	{ "8 random channels", [](uint8_t *pDmxData, [[maybe_unused]] const uint32_t nFrame) {
+		for (uint32_t i = 0; i < 8; i++) {
+			auto& nValue = pDmxData[static_cast<uint32_t>(rand()) % CHANNELS];
+			nValue = static_cast<uint8_t>(1 + nValue % 254);
+		}
+	} },
+	{ "all channels on/off", [](uint8_t *pDmxData, const uint32_t nFrame) {
+		for (uint32_t i = 0; i < CHANNELS; i++) {
+			pDmxData[i] = ((nFrame + i) & 0x1) ? 0xFF : 0;
+		}
+	} }
+};
+
+static void bench(PCA9685DmxLed& pca9685DmxLed) {
+	static constexpr uint32_t FRAMES = 100;
+	PCA9685PWMLed *boards[BOARDS];
+
+	for (uint32_t i = 0; i < BOARDS; i++) {
+		boards[i] = new PCA9685PWMLed(static_cast<uint8_t>(ADDRESS + 16 + i));
+	}
+
+	printf("I2C traffic per frame, %u channels on %u boards\n", CHANNELS, BOARDS);
+	printf("  %-24s %14s %14s %10s\n", "", "transactions", "bytes", "us @ 400k");
+
+	for (const auto& scenario : s_Scenarios) {
+		uint8_t dmxData[lightset::dmx::UNIVERSE_SIZE] = {};
+		uint8_t previous[CHANNELS] = {};
+
+		srand(1);
+		Traffic before {};
+
+		for (uint32_t nFrame = 0; nFrame < FRAMES; nFrame++) {
+			scenario.pChange(dmxData, nFrame);
+			i2c_mock_reset();
+			set_data_before(boards, previous, dmxData);
+			before.nTransactions += i2c_mock_get_transactions();
+			before.nBytes += i2c_mock_get_bytes();
+		}
+
+		memset(dmxData, 0, sizeof(dmxData));
+		frame(pca9685DmxLed, dmxData);
+
+		srand(1);
+		Traffic after {};
+
+		for (uint32_t nFrame = 0; nFrame < FRAMES; nFrame++) {
+			scenario.pChange(dmxData, nFrame);
+			const auto t = frame(pca9685DmxLed, dmxData);
+			after.nTransactions += t.nTransactions;
+			after.nBytes += t.nBytes;
+		}
+
+		// 9 clocks per byte, a start and a stop per transaction
+		const auto us = [](const Traffic& t) {
+			return (static_cast<double>(t.nBytes) * 9 + static_cast<double>(t.nTransactions) * 2) / (0.4 * FRAMES);
+		};
+
+		printf("  %-24s %6u -> %-6u %6u -> %-6u %4.0f -> %-4.0f\n", scenario.pName,
+				before.nTransactions / FRAMES, after.nTransactions / FRAMES,
+				before.nBytes / FRAMES, after.nBytes / FRAMES, us(before), us(after));
+	}
+
+	for (uint32_t i = 0; i < BOARDS; i++) {
+		delete boards[i];
+	}
+}
+
+int main(int argc, char **argv) {
+	srand(1);
+
+	auto *pPCA9685DmxLed = new PCA9685DmxLed(configuration());
+
+	// The constructor sets all the outputs off with ALL_LED
+	for (uint32_t i = 0; i < BOARDS; i++) {
+		HOSTTEST_CHECK(i2c_mock_get_register(static_cast<uint8_t>(ADDRESS + i), 0xFD) == 0x10);
+	}
+
+	check_set_data(*pPCA9685DmxLed);
+	check_all_led();
+
+	if (hosttest::is_bench(argc, argv)) {
+		bench(*pPCA9685DmxLed);
+	}
+
+	delete pPCA9685DmxLed;
+
+	return hosttest::exit_code("pca9685flush");
+}
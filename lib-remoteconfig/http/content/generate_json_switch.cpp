@@ -47,7 +47,10 @@ static constexpr char JSON_ENDPOINTS[][MAX_LENGTH] = {
 		"status",
 		"timedate",
 		"rtcalarm",
-		"polltable"
+		"polltable",
+		"udpstats",
+		"sequence",
+		"pixel"
 };
 
 inline uint16_t get_uint(const char *pString) {					/* djb2 */
@@ -21,6 +21,9 @@ static constexpr uint16_t STATUS      = 0x8d49;
 static constexpr uint16_t TIMEDATE    = 0x2472;
 static constexpr uint16_t RTCALARM    = 0x817b;
 static constexpr uint16_t POLLTABLE   = 0x0864;
+static constexpr uint16_t UDPSTATS    = 0x609d;
+static constexpr uint16_t SEQUENCE    = 0x489e;
+static constexpr uint16_t PIXEL       = 0x5847;
 }
 }
 }
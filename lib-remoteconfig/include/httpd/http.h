@@ -28,6 +28,7 @@
 
 namespace http {
 static constexpr uint32_t BUFSIZE = 1440; //TODO We need the TCP max segment size here
+static constexpr uint32_t HEADER_SIZE = 256;	///< Response header
 enum class Status {
 	OK = 200,
 	BAD_REQUEST = 400,
@@ -41,6 +41,14 @@ public:
 	~HttpDaemon();
 
 	void Run() {
+		if (__builtin_expect((m_pPending != nullptr), 0)) {
+			if (!m_pPending->Flush()) {
+				return;
+			}
+
+			m_pPending = nullptr;
+		}
+
 		uint32_t nConnectionHandle;
 		const auto nBytesReceived = Network::Get()->TcpRead(m_nHandle, const_cast<const uint8_t **>(reinterpret_cast<uint8_t **>(&m_RequestHeaderResponse)), nConnectionHandle);
 
@@ -51,10 +59,16 @@ public:
 		DEBUG_PRINTF("nConnectionHandle=%u", nConnectionHandle);
 
 		pHandleRequest[nConnectionHandle]->HandleRequest(nBytesReceived, m_RequestHeaderResponse);
+
+		// The TCP send buffer is full, the rest of the response is written before the next request is read
+		if (!pHandleRequest[nConnectionHandle]->Flush()) {
+			m_pPending = pHandleRequest[nConnectionHandle];
+		}
 	}
 
 private:
 	HttpDeamonHandleRequest *pHandleRequest[TCP_MAX_TCBS_ALLOWED];
+	HttpDeamonHandleRequest *m_pPending { nullptr };
 	int32_t m_nHandle { -1 };
 	char *m_RequestHeaderResponse { nullptr };
 };
@@ -41,6 +41,12 @@ public:
 	}
 
 	void HandleRequest(const uint32_t nBytesReceived, char *pRequestHeaderResponse);
+	/**
+	 * Writes what is left of the response, the TCP send buffer can be full.
+	 * The response is in static buffers, so no other request can be handled until this returns true.
+	 * @return true when the response has been written
+	 */
+	bool Flush();
 
 private:
 	http::Status ParseRequest();
@@ -58,6 +64,9 @@ private:
 	uint32_t m_nFileDataLength { 0 };
 	uint32_t m_nRequestContentLength { 0 };
 	uint32_t m_nBytesReceived { 0 };
+	uint32_t m_nHeaderLength { 0 };
+	uint32_t m_nResponseLength { 0 };
+	uint32_t m_nResponseWritten { 0 };
 
 	const char *m_pContentType;
 	char *m_pUri { nullptr };
@@ -70,6 +79,7 @@ private:
 	bool m_bContentTypeJson { false };
 	bool m_IsAction { false };
 
+	static char m_Header[http::HEADER_SIZE];
 	static char m_Content[http::BUFSIZE];
 };
 
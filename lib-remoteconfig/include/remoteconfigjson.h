@@ -36,6 +36,7 @@ uint32_t json_get_display(char *pOutBuffer, const uint32_t nOutBufferSize);
 uint32_t json_get_directory(char *pOutBuffer, const uint32_t nOutBufferSize);
 namespace net {
 uint32_t json_get_phystatus(char *pOutBuffer, const uint32_t nOutBufferSize);
+uint32_t json_get_udpstats(char *pOutBuffer, const uint32_t nOutBufferSize);
 }  // namespace net
 namespace dmx {
 uint32_t json_get_ports(char *pOutBuffer, const uint32_t nOutBufferSize);
@@ -69,10 +70,17 @@ uint32_t json_get_rtc(char *pOutBuffer, const uint32_t nOutBufferSize);
 void json_set_rtc(const char *pBuffer, const uint32_t nBufferSize);
 }  // namespace rtc
 namespace artnet {
+uint32_t json_get_sequence(char *pOutBuffer, const uint32_t nOutBufferSize);
 namespace controller {
 uint32_t json_get_polltable(char *pOutBuffer, const uint32_t nOutBufferSize);
 }  // namespace controller
 }  // namespace artnet
+namespace e131 {
+uint32_t json_get_sequence(char *pOutBuffer, const uint32_t nOutBufferSize);
+}  // namespace e131
+namespace pixel {
+uint32_t json_get_status(char *pOutBuffer, const uint32_t nOutBufferSize);
+}  // namespace pixel
 }  // namespace remoteconfig
 
 #endif /* REMOTECONFIGJSON_H_ */
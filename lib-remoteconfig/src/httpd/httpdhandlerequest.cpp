@@ -69,6 +69,7 @@
 extern uint32_t get_file_content(const char *fileName, char *pDst, http::contentTypes& contentType);
 #endif
 
+char HttpDeamonHandleRequest::m_Header[http::HEADER_SIZE];
 char HttpDeamonHandleRequest::m_Content[http::BUFSIZE];
 
 static constexpr char s_contentType[static_cast<uint32_t>(http::contentTypes::NOT_DEFINED)][32] =
@@ -151,7 +152,7 @@ void HttpDeamonHandleRequest::HandleRequest(const uint32_t nBytesReceived, char
 	}
 
 	uint8_t nLength;
-	const int nHeaderLength = snprintf(m_RequestHeaderResponse, http::BUFSIZE - 1U,
+	const int nHeaderLength = snprintf(m_Header, http::HEADER_SIZE - 1U,
 			"HTTP/1.1 %u %s\r\n"
 			"Server: %s\r\n"
 			"Content-Type: %s\r\n"
@@ -159,14 +160,48 @@ void HttpDeamonHandleRequest::HandleRequest(const uint32_t nBytesReceived, char
 			"Connection: close\r\n"
 			"\r\n", static_cast<unsigned int>(m_Status), pStatusMsg, Hardware::Get()->GetBoardName(nLength), m_pContentType, static_cast<unsigned int>(m_nContentLength));
 
-	Network::Get()->TcpWrite(m_nHandle, reinterpret_cast<uint8_t *>(m_RequestHeaderResponse), static_cast<uint16_t>(nHeaderLength), m_nConnectionHandle);
-	Network::Get()->TcpWrite(m_nHandle, reinterpret_cast<uint8_t *>(m_Content), static_cast<uint16_t>(m_nContentLength), m_nConnectionHandle);
+	m_nHeaderLength = static_cast<uint32_t>(nHeaderLength);
+	m_nResponseLength = m_nHeaderLength + m_nContentLength;
+	m_nResponseWritten = 0;
 	DEBUG_PRINTF("m_nContentLength=%u", m_nContentLength);
 
 	m_Status = http::Status::UNKNOWN_ERROR;
 	m_RequestMethod = http::RequestMethod::UNKNOWN;
 }
 
+bool HttpDeamonHandleRequest::Flush() {
+	while (m_nResponseWritten < m_nResponseLength) {
+		const char *pData;
+		uint32_t nLength;
+
+		if (m_nResponseWritten < m_nHeaderLength) {
+			pData = &m_Header[m_nResponseWritten];
+			nLength = m_nHeaderLength - m_nResponseWritten;
+		} else {
+			const auto nOffset = m_nResponseWritten - m_nHeaderLength;
+			pData = &m_Content[nOffset];
+			nLength = m_nContentLength - nOffset;
+		}
+
+		const auto nWritten = Network::Get()->TcpWrite(m_nHandle, reinterpret_cast<const uint8_t *>(pData), static_cast<uint16_t>(nLength), m_nConnectionHandle);
+
+		if (nWritten < 0) {
+			DEBUG_PUTS("Connection is not open");
+			m_nResponseWritten = m_nResponseLength;
+			return true;
+		}
+
+		if (nWritten == 0) {
+			DEBUG_PRINTF("%u: %u bytes pending", m_nConnectionHandle, m_nResponseLength - m_nResponseWritten);
+			return false;
+		}
+
+		m_nResponseWritten += static_cast<uint32_t>(nWritten);
+	}
+
+	return true;
+}
+
 http::Status HttpDeamonHandleRequest::ParseRequest() {
 	char *pLine = m_RequestHeaderResponse;
 	uint32_t nLine = 0;
@@ -357,6 +392,23 @@ http::Status HttpDeamonHandleRequest::HandleGet() {
 		case http::json::get::PHYSTATUS:
 			nLength = remoteconfig::net::json_get_phystatus(m_Content, sizeof(m_Content));
 			break;
+#endif
+		case http::json::get::UDPSTATS:
+			nLength = remoteconfig::net::json_get_udpstats(m_Content, sizeof(m_Content));
+			break;
+#if defined (NODE_ARTNET)
+		case http::json::get::SEQUENCE:
+			nLength = remoteconfig::artnet::json_get_sequence(m_Content, sizeof(m_Content));
+			break;
+#elif defined (NODE_E131)
+		case http::json::get::SEQUENCE:
+			nLength = remoteconfig::e131::json_get_sequence(m_Content, sizeof(m_Content));
+			break;
+#endif
+#if defined (OUTPUT_DMX_PIXEL_MULTI)
+		case http::json::get::PIXEL:
+			nLength = remoteconfig::pixel::json_get_status(m_Content, sizeof(m_Content));
+			break;
 #endif
 		default:
 #if defined (HAVE_DMX)
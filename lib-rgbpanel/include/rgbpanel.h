@@ -29,7 +29,22 @@
 #include "rgbpanelconst.h"
 
 namespace rgbpanel {
-static constexpr auto PWM_WIDTH = 84;
+/**
+ * Binary Code Modulation: bit plane n is shown 2^n x the LSB time.
+ * With more than 8 planes the 8-bit colour values are gamma corrected.
+ */
+#if !defined (CONFIG_RGBPANEL_BCM_PLANES)
+# define CONFIG_RGBPANEL_BCM_PLANES	8
+#endif
+static constexpr uint32_t BCM_PLANES = CONFIG_RGBPANEL_BCM_PLANES;
+static_assert((BCM_PLANES >= 8) && (BCM_PLANES <= 10), "BCM_PLANES must be 8, 9 or 10");
+/**
+ * LSB on-time in 10 ns ticks of the high speed timer. The sum of all planes is ~255 us per row.
+ */
+#if !defined (CONFIG_RGBPANEL_BCM_LSB_TICKS)
+# define CONFIG_RGBPANEL_BCM_LSB_TICKS	(100U >> (CONFIG_RGBPANEL_BCM_PLANES - 8))
+#endif
+static constexpr uint32_t BCM_LSB_TICKS = CONFIG_RGBPANEL_BCM_LSB_TICKS;
 }  // namespace rgbpanel
 
 class RgbPanel {
@@ -31,6 +31,7 @@
 #include <cstdio>
 
 #include "rgbpanel.h"
+#include "rgbpanel_internal.h"
 
 #include "h3_spi.h"
 #include "h3_i2c.h"
@@ -38,6 +39,7 @@
 #include "board/h3_opi_zero.h"
 #include "h3_cpu.h"
 #include "h3_smp.h"
+#include "h3.h"
 
 #include "arm/synchronize.h"
 
@@ -72,9 +74,14 @@ static uint32_t s_nShowCounter ;
 static volatile bool s_bDoSwap;
 static volatile uint32_t s_nUpdatesCounter;
 //
+/*
+ * Frame buffer layout: [row pair][bit plane][column], the entries are the PORTA data bits
+ */
 static uint32_t *s_pFramebuffer1 ;
 static uint32_t *s_pFramebuffer2 ;
-static uint8_t *s_pTablePWM ;
+static uint16_t *s_pTableBCM ;
+static uint32_t s_nOnTicks[rgbpanel::BCM_PLANES];
+static uint32_t s_nShiftTicks;
 //
 static bool s_bIsCoreRunning;
 
@@ -127,7 +134,7 @@ void RgbPanel::PlatformInit() {
 	h3_gpio_clr(HUB75B_G2);
 	h3_gpio_clr(HUB75B_B2);
 
-	s_nBufferSize = m_nColumns * m_nRows * PWM_WIDTH;
+	s_nBufferSize = m_nColumns * (m_nRows / 2) * BCM_PLANES;
 	DEBUG_PRINTF("nBufferSize=%u", s_nBufferSize);
 
 	s_pFramebuffer1 = new uint32_t[s_nBufferSize];
@@ -143,18 +150,24 @@ void RgbPanel::PlatformInit() {
 		s_pFramebuffer2[i] = 0;
 	}
 
-	s_pTablePWM = new uint8_t[256];
-	assert(s_pTablePWM != nullptr);
+	s_pTableBCM = new uint16_t[256];
+	assert(s_pTableBCM != nullptr);
 
 	for (uint32_t i = 0; i < 256; i++) {
-		s_pTablePWM[i] = static_cast<uint8_t>((i * PWM_WIDTH) / 255);
+		s_pTableBCM[i] = bcm::value(i);
+	}
+
+	for (uint32_t nPlane = 0; nPlane < BCM_PLANES; nPlane++) {
+		s_nOnTicks[nPlane] = bcm::on_ticks(nPlane);
 	}
+
+	s_nShiftTicks = 0;
 }
 
 void RgbPanel::PlatformCleanUp() {
 	delete[] s_pFramebuffer1;
 	delete[] s_pFramebuffer2;
-	delete[] s_pTablePWM;
+	delete[] s_pTableBCM;
 }
 
 void RgbPanel::Start() {
@@ -191,7 +204,7 @@ void RgbPanel::Dump() {
 	for (uint32_t nRow = 0; nRow < (m_nRows / 2); nRow++) {
 		printf("[");
 		for (uint32_t i = 0; i < m_nColumns; i++) {
-			const uint32_t nIndex = (nRow * m_nColumns) + i;
+			const uint32_t nIndex = (nRow * m_nColumns * BCM_PLANES) + i;
 			printf("%x ", s_pFramebuffer1[nIndex]);
 		}
 		puts("]");
@@ -229,56 +242,20 @@ void RgbPanel::SetPixel(uint32_t nColumn, uint32_t nRow, uint8_t nRed, uint8_t n
 		return;
 	}
 
-	if (nRow < (m_nRows / 2)) {
-		const uint32_t nBaseIndex = (nRow * m_nColumns * PWM_WIDTH) + nColumn;
-
-		for (uint32_t nPWM = 0; nPWM < PWM_WIDTH; nPWM++) {
-
-			const uint32_t nIndex = nBaseIndex + (nPWM * m_nColumns);
-
-			uint32_t nValue = s_pFramebuffer1[nIndex];
-
-			nValue &= ~((1U << HUB75B_R1) | (1U << HUB75B_G1) | (1U << HUB75B_B1));
-
-			if (s_pTablePWM[nRed] > nPWM) {
-				nValue |= (1U << HUB75B_R1);
-			}
-
-			if (s_pTablePWM[nGreen] > nPWM) {
-				nValue |= (1U << HUB75B_G1);
-			}
-
-			if (s_pTablePWM[nBlue] > nPWM) {
-				nValue |= (1U << HUB75B_B1);
-			}
-
-			s_pFramebuffer1[nIndex] = nValue;
-		}
-	} else {
-		const uint32_t nBaseIndex = ((nRow - (m_nRows / 2U)) * m_nColumns * PWM_WIDTH) + nColumn;
-
-		for (uint32_t nPWM = 0; nPWM < PWM_WIDTH; nPWM++) {
-
-			const uint32_t nIndex = nBaseIndex + (nPWM * m_nColumns);
+	uint32_t nShiftRed = HUB75B_R1;
+	uint32_t nShiftGreen = HUB75B_G1;
+	uint32_t nShiftBlue = HUB75B_B1;
 
-			uint32_t nValue = s_pFramebuffer1[nIndex];
-			nValue &= ~((1U << HUB75B_R2) | (1U << HUB75B_G2) | (1U << HUB75B_B2));
+	if (nRow >= (m_nRows / 2)) {
+		nRow -= (m_nRows / 2);
+		nShiftRed = HUB75B_R2;
+		nShiftGreen = HUB75B_G2;
+		nShiftBlue = HUB75B_B2;
+	}
 
-			if (s_pTablePWM[nRed] > nPWM) {
-				nValue |= (1U << HUB75B_R2);
-			}
+	auto *pPlane = &s_pFramebuffer1[(nRow * m_nColumns * BCM_PLANES) + nColumn];
 
-			if (s_pTablePWM[nGreen] > nPWM) {
-				nValue |= (1U << HUB75B_G2);
-			}
-
-			if (s_pTablePWM[nBlue] > nPWM) {
-				nValue |= (1U << HUB75B_B2);
-			}
-
-			s_pFramebuffer1[nIndex] = nValue;
-		}
-	}
+	bcm::set_planes(pPlane, m_nColumns, s_pTableBCM[nRed], s_pTableBCM[nGreen], s_pTableBCM[nBlue], nShiftRed, nShiftGreen, nShiftBlue);
 }
 
 void RgbPanel::Show() {
@@ -290,19 +267,41 @@ void RgbPanel::Show() {
 	s_nShowCounter++;
 }
 
+/*
+ * The HS timer counts down at 100 MHz
+ */
+static inline void wait_ticks(const uint32_t nStart, const uint32_t nTicks) {
+	while ((nStart - H3_HS_TIMER->CURNT_LO) < nTicks) {
+	}
+}
+
+/*
+ * Binary Code Modulation.
+ * The next bit plane is shifted in while the current plane is lit.
+ * A plane with an on-time shorter than the shift time is blanked before the shift.
+ */
 void core1_task() {
-	const uint32_t nMultiplier = s_nColumns * PWM_WIDTH;
+	const uint32_t nMultiplier = s_nColumns * BCM_PLANES;
 
 	uint32_t nGPIO = H3_PIO_PORTA->DAT & ~((1U << HUB75B_R1) | (1U << HUB75B_G1) | (1U << HUB75B_B1) | (1U << HUB75B_R2) | (1U << HUB75B_G2) | (1U << HUB75B_B2));
+	uint32_t nStart = H3_HS_TIMER->CURNT_LO;
+	uint32_t nOnTicks = 0;
 
 	for (;;) {
 		for (uint32_t nRow = 0; nRow < (s_nRows / 2); nRow++) {
 
 			const uint32_t nBaseIndex = nRow * nMultiplier;
 
-			for (uint32_t nPWM = 0; nPWM < PWM_WIDTH; nPWM++) {
+			for (uint32_t nPlane = 0; nPlane < BCM_PLANES; nPlane++) {
 
-				uint32_t nIndex = nBaseIndex + (nPWM * s_nColumns);
+				if (nOnTicks < s_nShiftTicks) {
+					wait_ticks(nStart, nOnTicks);
+					nGPIO |= (1U << HUB75B_OE);
+					H3_PIO_PORTA->DAT = nGPIO;
+				}
+
+				uint32_t nIndex = nBaseIndex + (nPlane * s_nColumns);
+				const uint32_t nShiftStart = H3_HS_TIMER->CURNT_LO;
 
 				/* Shift in next data */
 				for (uint32_t i = 0; i < s_nColumns; i++) {
@@ -313,6 +312,11 @@ void core1_task() {
 					H3_PIO_PORTA->DAT = nGPIO | nValue;
 				}
 
+				s_nShiftTicks = nShiftStart - H3_HS_TIMER->CURNT_LO;
+
+				/* The previous plane has been shown for its on-time */
+				wait_ticks(nStart, nOnTicks);
+
 				/* Blank the display */
 				H3_PIO_PORTA->DAT = nGPIO | (1U << HUB75B_OE);
 
@@ -329,6 +333,9 @@ void core1_task() {
 				/* Enable the display */
 				nGPIO &= ~(1U << HUB75B_OE);
 				H3_PIO_PORTA->DAT = nGPIO;
+
+				nStart = H3_HS_TIMER->CURNT_LO;
+				nOnTicks = s_nOnTicks[nPlane];
 			}
 		}
 
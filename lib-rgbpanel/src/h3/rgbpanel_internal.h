@@ -0,0 +1,77 @@
+/**
+ * @file rgbpanel_internal.h
+ *
+ */
+/* Copyright (C) 2024 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef H3_RGBPANEL_INTERNAL_H_
+#define H3_RGBPANEL_INTERNAL_H_
+
+#include <cstdint>
+
+#include "rgbpanel.h"
+
+namespace rgbpanel {
+namespace bcm {
+/**
+ * The BCM value of an 8-bit colour value.
+ * With 8 planes this is the value itself, with more planes it is gamma 2.0 corrected,
+ * the extra planes are used for the dark values.
+ */
+template<uint32_t PLANES = BCM_PLANES>
+inline uint16_t value(const uint32_t nValue) {
+	constexpr uint32_t nMax = (1U << PLANES) - 1;
+
+	if (PLANES == 8) {
+		return static_cast<uint16_t>(nValue);
+	}
+
+	return static_cast<uint16_t>(((nValue * nValue * nMax) + ((255U * 255U) / 2)) / (255U * 255U));
+}
+
+/**
+ * The on-time of a plane in ticks of the high speed timer
+ */
+inline uint32_t on_ticks(const uint32_t nPlane, const uint32_t nLsbTicks = BCM_LSB_TICKS) {
+	return nLsbTicks << nPlane;
+}
+
+/**
+ * Writes the colour bits of one pixel in each plane, a word per plane.
+ * pPlane points to the column in plane 0, the planes are nColumns words apart.
+ */
+template<uint32_t PLANES = BCM_PLANES>
+inline void set_planes(uint32_t *pPlane, const uint32_t nColumns, const uint32_t nValueRed, const uint32_t nValueGreen, const uint32_t nValueBlue, const uint32_t nShiftRed, const uint32_t nShiftGreen, const uint32_t nShiftBlue) {
+	const uint32_t nMask = ~((1U << nShiftRed) | (1U << nShiftGreen) | (1U << nShiftBlue));
+
+	for (uint32_t nPlane = 0; nPlane < PLANES; nPlane++) {
+		*pPlane = (*pPlane & nMask)
+				| (((nValueRed >> nPlane) & 0x1) << nShiftRed)
+				| (((nValueGreen >> nPlane) & 0x1) << nShiftGreen)
+				| (((nValueBlue >> nPlane) & 0x1) << nShiftBlue);
+		pPlane += nColumns;
+	}
+}
+}  // namespace bcm
+}  // namespace rgbpanel
+
+#endif /* H3_RGBPANEL_INTERNAL_H_ */
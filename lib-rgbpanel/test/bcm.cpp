@@ -0,0 +1,382 @@
+/**
+ * @file bcm.cpp
+ *
+ */
+/* Copyright (C) 2024 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+
+#include "rgbpanel_internal.h"
+
+#include "hosttest.h"
+
+using namespace rgbpanel;
+
+/*
+ * The PORTA data bits of the H3 HUB75 connector, see src/h3/rgbpanel.cpp
+ */
+static constexpr uint32_t R1 = 13, G1 = 14, B1 = 15;
+static constexpr uint32_t R2 = 16, G2 = 18, B2 = 19;
+
+static constexpr double TICK_NS = 10;	///< High speed timer, 100 MHz
+
+template<uint32_t PLANES>
+static constexpr uint32_t lsb_ticks() {
+	return 100U >> (PLANES - 8);
+}
+
+struct Panel {
+	uint32_t nColumns;
+	uint32_t nRows;
+};
+
+static constexpr Panel s_Panels[] = { {32, 16}, {32, 32}, {64, 32}, {128, 32}, {256, 32} };
+
+/**
+ * The duty cycle of a BCM value with the ideal plane weights
+ */
+template<uint32_t PLANES>
+static double duty(const uint32_t nValue, const double *pWeight) {
+	double fOn = 0;
+	double fTotal = 0;
+
+	for (uint32_t nPlane = 0; nPlane < PLANES; nPlane++) {
+		fOn += ((nValue >> nPlane) & 0x1) * pWeight[nPlane];
+		fTotal += pWeight[nPlane];
+	}
+
+	return fOn / fTotal;
+}
+
+template<uint32_t PLANES>
+static void check_value() {
+	constexpr uint32_t nMax = (1U << PLANES) - 1;
+	double weight[PLANES];
+
+	for (uint32_t nPlane = 0; nPlane < PLANES; nPlane++) {
+		weight[nPlane] = bcm::on_ticks(nPlane, lsb_ticks<PLANES>());
+	}
+
+	uint32_t nFailed = 0;
+
+	for (uint32_t v = 0; v < 256; v++) {
+		const auto nValue = bcm::value<PLANES>(v);
+
+		if ((v != 0) && (nValue < bcm::value<PLANES>(v - 1))) {
+			nFailed++;
+		}
+
+		const auto fExpected = (PLANES == 8) ? (v / 255.0) : ((v / 255.0) * (v / 255.0));
+
+		// 8 planes: exact, gamma: within half a step of the planes
+		if (fabs(duty<PLANES>(nValue, weight) - fExpected) > ((PLANES == 8) ? 1e-12 : (0.5 / nMax))) {
+			nFailed++;
+		}
+	}
+
+	HOSTTEST_CHECK(nFailed == 0);
+	HOSTTEST_CHECK(bcm::value<PLANES>(0) == 0);
+	HOSTTEST_CHECK(bcm::value<PLANES>(255) == nMax);
+}
+
+/*
+ * SetPixel: each plane word has the bit of the plane for the 3 colours, the other bits are kept
+ */
+template<uint32_t PLANES>
+static void check_set_planes() {
+	constexpr uint32_t COLUMNS = 64;
+	static uint32_t framebuffer[PLANES * COLUMNS];
+	static uint8_t rgb[2][COLUMNS][3];
+
+	for (uint32_t nColumn = 0; nColumn < COLUMNS; nColumn++) {
+		for (uint32_t nHalf = 0; nHalf < 2; nHalf++) {
+			for (auto& c : rgb[nHalf][nColumn]) {
+				c = static_cast<uint8_t>(rand());
+			}
+		}
+	}
+
+	constexpr uint32_t nOther = ~((1U << R1) | (1U << G1) | (1U << B1) | (1U << R2) | (1U << G2) | (1U << B2));
+
+	for (auto& n : framebuffer) {
+		n = static_cast<uint32_t>(rand()) & nOther;
+	}
+
+	uint32_t nOtherBits[PLANES * COLUMNS];
+
+	for (uint32_t i = 0; i < PLANES * COLUMNS; i++) {
+		nOtherBits[i] = framebuffer[i];
+	}
+
+	// Twice, the second write must replace the first one
+	for (uint32_t nPass = 0; nPass < 2; nPass++) {
+		for (uint32_t nColumn = 0; nColumn < COLUMNS; nColumn++) {
+			const auto *p = rgb[0][nColumn];
+			const auto *q = rgb[1][nColumn];
+			const uint32_t nInvert = (nPass == 0) ? 0xFF : 0;
+			bcm::set_planes<PLANES>(&framebuffer[nColumn], COLUMNS, bcm::value<PLANES>(p[0] ^ nInvert), bcm::value<PLANES>(p[1] ^ nInvert), bcm::value<PLANES>(p[2] ^ nInvert), R1, G1, B1);
+			bcm::set_planes<PLANES>(&framebuffer[nColumn], COLUMNS, bcm::value<PLANES>(q[0]), bcm::value<PLANES>(q[1]), bcm::value<PLANES>(q[2]), R2, G2, B2);
+		}
+	}
+
+	uint32_t nFailed = 0;
+
+	for (uint32_t nColumn = 0; nColumn < COLUMNS; nColumn++) {
+		const uint32_t nShift[2][3] = { {R1, G1, B1}, {R2, G2, B2} };
+
+		for (uint32_t nHalf = 0; nHalf < 2; nHalf++) {
+			for (uint32_t nColour = 0; nColour < 3; nColour++) {
+				uint32_t nValue = 0;
+
+				for (uint32_t nPlane = 0; nPlane < PLANES; nPlane++) {
+					nValue |= ((framebuffer[(nPlane * COLUMNS) + nColumn] >> nShift[nHalf][nColour]) & 0x1) << nPlane;
+				}
+
+				if (nValue != bcm::value<PLANES>(rgb[nHalf][nColumn][nColour])) {
+					nFailed++;
+				}
+			}
+		}
+
+		for (uint32_t nPlane = 0; nPlane < PLANES; nPlane++) {
+			const auto nIndex = (nPlane * COLUMNS) + nColumn;
+			if ((framebuffer[nIndex] & nOther) != nOtherBits[nIndex]) {
+				nFailed++;
+			}
+		}
+	}
+
+	HOSTTEST_CHECK(nFailed == 0);
+}
+
+/*
+ * Timing model of core1_task in src/h3/rgbpanel.cpp, each GPIO write takes fWriteNs.
+ * A write takes effect when it is done.
+ */
+struct Timing {
+	double fLitNs[10];	///< Lit time of each plane
+	double fRowNs;		///< All planes of a row pair
+	double fRefreshHz;
+};
+
+template<uint32_t PLANES>
+static Timing simulate(const Panel& panel, const double fWriteNs, const bool doBlankEarly = true) {
+	Timing timing {};
+
+	double t = 0;
+	double fStart = 0;
+	double fOnNs = 0;
+	double fShiftNs = 0;
+	bool isLit = false;
+	uint32_t nLitPlane = 0;
+	uint32_t nLitRow = 0;
+	double fRowStart[3] = {};
+
+	const auto blank = [&]() {
+		t += fWriteNs;
+		if (isLit && (nLitRow == 1)) {
+			timing.fLitNs[nLitPlane] = t - fStart;
+		}
+		isLit = false;
+	};
+
+	for (uint32_t nRow = 0; nRow < 3; nRow++) {
+		for (uint32_t nPlane = 0; nPlane < PLANES; nPlane++) {
+			if (doBlankEarly && (fOnNs < fShiftNs)) {
+				t = std::max(t, fStart + fOnNs);
+				blank();
+			}
+
+			// Shift in the next plane, clock high and low per column
+			const auto fShiftStart = t;
+			t += 2 * fWriteNs * panel.nColumns;
+			fShiftNs = t - fShiftStart;
+
+			// The previous plane has been shown for its on-time
+			t = std::max(t, fStart + fOnNs);
+			blank();
+
+			// Latch, OE, row select
+			t += 3 * fWriteNs;
+
+			// Enable
+			t += fWriteNs;
+			fStart = t;
+			isLit = true;
+			nLitPlane = nPlane;
+			nLitRow = nRow;
+			fOnNs = bcm::on_ticks(nPlane, lsb_ticks<PLANES>()) * TICK_NS;
+
+			if (nPlane == 0) {
+				fRowStart[nRow] = t;
+			}
+		}
+	}
+
+	timing.fRowNs = fRowStart[2] - fRowStart[1];
+	timing.fRefreshHz = 1e9 / (timing.fRowNs * (panel.nRows / 2));
+
+	return timing;
+}
+
+/*
+ * The linear PWM before BCM: 84 sub-frames per row, each with a full shift
+ */
+static double pwm_refresh_hz(const Panel& panel, const double fWriteNs) {
+	const auto fSubFrameNs = (2 * fWriteNs * panel.nColumns) + (5 * fWriteNs);
+	return 1e9 / ((panel.nRows / 2) * 84 * fSubFrameNs);
+}
+
+/**
+ * Largest duty error over all values, in steps of the planes
+ */
+template<uint32_t PLANES>
+static double duty_error(const Timing& timing) {
+	constexpr uint32_t nMax = (1U << PLANES) - 1;
+	double weight[PLANES];
+
+	for (uint32_t nPlane = 0; nPlane < PLANES; nPlane++) {
+		weight[nPlane] = bcm::on_ticks(nPlane, lsb_ticks<PLANES>());
+	}
+
+	double fError = 0;
+
+	for (uint32_t nValue = 0; nValue <= nMax; nValue++) {
+		fError = std::max(fError, fabs(duty<PLANES>(nValue, timing.fLitNs) - duty<PLANES>(nValue, weight)));
+	}
+
+	return fError * nMax;
+}
+
+/*
+ * Each plane is lit for its on-time plus the same GPIO write, also when the shift takes longer than the on-time.
+ * The refresh rate is reported with "bench", next to the linear PWM.
+ */
+template<uint32_t PLANES>
+static void check_timing() {
+	uint32_t nFailed = 0;
+
+	for (const auto fWriteNs : { 20.0, 50.0, 100.0 }) {
+		for (const auto& panel : s_Panels) {
+			const auto timing = simulate<PLANES>(panel, fWriteNs);
+
+			for (uint32_t nPlane = 0; nPlane < PLANES; nPlane++) {
+				const auto fOnNs = bcm::on_ticks(nPlane, lsb_ticks<PLANES>()) * TICK_NS;
+
+				if (fabs(timing.fLitNs[nPlane] - (fOnNs + fWriteNs)) > 1e-6) {
+					nFailed++;
+				}
+			}
+
+			// A row takes at least all on-times, at most an on-time plus a shift and the other writes per plane
+			double fOnNs = 0;
+
+			for (uint32_t nPlane = 0; nPlane < PLANES; nPlane++) {
+				fOnNs += bcm::on_ticks(nPlane, lsb_ticks<PLANES>()) * TICK_NS;
+			}
+
+			const auto fShiftNs = 2 * fWriteNs * panel.nColumns;
+
+			if ((timing.fRowNs < fOnNs) || (timing.fRowNs > (fOnNs + PLANES * (fShiftNs + 6 * fWriteNs)))) {
+				nFailed++;
+			}
+		}
+	}
+
+	HOSTTEST_CHECK(nFailed == 0);
+}
+
+template<uint32_t PLANES>
+static void report() {
+	constexpr double fWriteNs = 50;
+
+	printf("BCM %u planes, LSB %u ns, %.0f ns per GPIO write\n", PLANES, static_cast<uint32_t>(lsb_ticks<PLANES>() * TICK_NS), fWriteNs);
+	printf("  %-10s %12s %12s %12s %16s %16s\n", "panel", "PWM84 Hz", "BCM Hz", "lit %", "error (steps)", "no blank (steps)");
+
+	for (const auto& panel : s_Panels) {
+		const auto timing = simulate<PLANES>(panel, fWriteNs);
+		const auto timingNoBlank = simulate<PLANES>(panel, fWriteNs, false);
+
+		double fLitNs = 0;
+
+		for (uint32_t nPlane = 0; nPlane < PLANES; nPlane++) {
+			fLitNs += timing.fLitNs[nPlane];
+		}
+
+		char aPanel[16];
+		snprintf(aPanel, sizeof(aPanel), "%ux%u", panel.nColumns, panel.nRows);
+
+		printf("  %-10s %12.1f %12.1f %12.1f %16.2f %16.2f\n", aPanel,
+				pwm_refresh_hz(panel, fWriteNs), timing.fRefreshHz,
+				100.0 * fLitNs / timing.fRowNs,
+				duty_error<PLANES>(timing), duty_error<PLANES>(timingNoBlank));
+	}
+}
+
+template<uint32_t PLANES>
+static void bench_set_planes() {
+	constexpr uint32_t COLUMNS = 64;
+	static uint32_t framebuffer[PLANES * COLUMNS];
+	uint32_t nColumn = 0;
+	uint8_t nValue = 0;
+
+	char aName[48];
+	snprintf(aName, sizeof(aName), "SetPixel planes, %u planes", PLANES);
+
+	hosttest::bench(aName, 10000000, [&]() {
+		nColumn = (nColumn + 1) & (COLUMNS - 1);
+		nValue++;
+		bcm::set_planes<PLANES>(&framebuffer[nColumn], COLUMNS, bcm::value<PLANES>(nValue), bcm::value<PLANES>(nValue ^ 0x55), bcm::value<PLANES>(nValue ^ 0xAA), R1, G1, B1);
+		hosttest::keep(framebuffer);
+	});
+}
+
+int main(int argc, char **argv) {
+	srand(1);
+
+	check_value<8>();
+	check_value<9>();
+	check_value<10>();
+
+	check_set_planes<8>();
+	check_set_planes<9>();
+	check_set_planes<10>();
+
+	check_timing<8>();
+	check_timing<9>();
+	check_timing<10>();
+
+	if (hosttest::is_bench(argc, argv)) {
+		report<8>();
+		report<9>();
+		report<10>();
+
+		bench_set_planes<8>();
+		bench_set_planes<10>();
+	}
+
+	return hosttest::exit_code("bcm");
+}
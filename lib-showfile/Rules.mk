@@ -14,6 +14,9 @@ ifneq ($(MAKE_FLAGS),)
 	endif
 	ifneq (,$(findstring CONFIG_SHOWFILE_FORMAT_OLA,$(MAKE_FLAGS)))
 		EXTRA_SRCDIR+=src/formats/ola
+	endif
+	ifneq (,$(findstring CONFIG_SHOWFILE_FORMAT_BIN,$(MAKE_FLAGS)))
+		EXTRA_SRCDIR+=src/formats/bin
 	endif
 		ifneq (,$(findstring CONFIG_SHOWFILE_PROTOCOL_E131,$(MAKE_FLAGS)))
 		E131=1
@@ -0,0 +1,201 @@
+/**
+ * @file showfilebin.h
+ *
+ */
+/* Copyright (C) 2024 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FORMATS_SHOWFILEBIN_H_
+#define FORMATS_SHOWFILEBIN_H_
+
+#include <cstdint>
+#include <cstdio>
+
+#define SHOWFILE_PREFIX	"show"
+#define SHOWFILE_SUFFIX	".bin"
+
+namespace showfile {
+static constexpr uint32_t FILE_NAME_LENGTH = sizeof(SHOWFILE_PREFIX "NN" SHOWFILE_SUFFIX) - 1U;
+static constexpr uint32_t FILE_MAX_NUMBER = 99;
+
+bool convert_ola(const uint32_t nShowFileNumber);
+
+/**
+ * File layout (little endian):
+ *  Header
+ *  Frame, Frame, ...
+ *  IndexEntry[Header.nIndexEntries] at Header.nIndexOffset
+ *
+ * The index is written when the recording is stopped.
+ * Without an index (nIndexOffset == 0) the frames run until the end of the file.
+ */
+namespace bin {
+#if !defined (CONFIG_SHOWFILE_BIN_MAX_UNIVERSES)
+# define CONFIG_SHOWFILE_BIN_MAX_UNIVERSES	32
+#endif
+static constexpr uint32_t MAX_UNIVERSES = CONFIG_SHOWFILE_BIN_MAX_UNIVERSES;
+static constexpr uint32_t MAX_INDEX_ENTRIES = 1024;
+static constexpr uint32_t INDEX_INTERVAL_MILLIS = 1000;	///< Initial, is doubled when the index is full
+static constexpr uint32_t MAX_FRAMES_PER_RUN = 2 * MAX_UNIVERSES;
+static constexpr uint16_t VERSION = 1;
+static constexpr char MAGIC[4] = { 'S', 'H', 'O', 'W' };
+
+struct Header {
+	char aMagic[4];
+	uint16_t nVersion;
+	uint16_t nHeaderSize;
+	uint32_t nIndexOffset;
+	uint32_t nIndexEntries;
+};
+
+static_assert(sizeof(struct Header) == 16);
+
+enum class FrameType: uint8_t {
+	KEY,	///< Payload is the DMX data
+	DELTA	///< Payload is a list of runs: offset (16-bit), count (16-bit), data[count]
+};
+
+struct FrameHeader {
+	uint16_t nLength;		///< Payload length
+	FrameType type;
+	uint8_t nReserved;
+	uint32_t nMillis;		///< Since the start of the show
+	uint16_t nUniverse;
+	uint16_t nSlots;		///< DMX data length of the universe
+};
+
+static_assert(sizeof(struct FrameHeader) == 12);
+
+struct IndexEntry {
+	uint32_t nMillis;
+	uint32_t nOffset;		///< File offset of the first frame at or after nMillis
+};
+
+static constexpr uint32_t RUN_HEADER_SIZE = 4;
+static constexpr uint32_t MAX_FRAME_SIZE = sizeof(struct FrameHeader) + 512;
+
+/**
+ * Encodes the changes of pNew against pOld as runs.
+ * Unchanged gaps smaller than a run header are part of the run.
+ * @return false when the runs are not smaller than a key frame
+ */
+bool delta_encode(uint8_t *pPayload, const uint8_t *pOld, const uint8_t *pNew, const uint32_t nSlots, uint32_t& nLength);
+/**
+ * Applies the runs to pData
+ * @return false when the payload is corrupt
+ */
+bool delta_decode(uint8_t *pData, const uint32_t nSlots, const uint8_t *pPayload, const uint32_t nLength);
+
+struct Universe {
+	uint16_t nUniverse;
+	uint16_t nSlots;
+	uint8_t data[512];
+};
+
+/**
+ * Used by the recorder and the OLA converter
+ */
+class Writer {
+public:
+	void Begin(FILE *pFile);
+	/**
+	 * @param nMillis since the start of the show, not decreasing
+	 */
+	void Write(const uint8_t *pDmxData, uint32_t nSlots, const uint16_t nUniverse, const uint32_t nMillis);
+	void End();
+
+private:
+	Universe *FindUniverse(const uint16_t nUniverse);
+	void AddIndex(const uint32_t nMillis);
+
+private:
+	FILE *m_pFile { nullptr };
+	uint32_t m_nOffset { 0 };
+	uint32_t m_nIndexInterval { INDEX_INTERVAL_MILLIS };
+	uint32_t m_nIndexMillis { 0 };
+	uint32_t m_nIndexEntries { 0 };
+	uint32_t m_nUniverses { 0 };
+	bool m_bKeyPending[MAX_UNIVERSES];
+	Universe m_Universes[MAX_UNIVERSES];
+	IndexEntry m_Index[MAX_INDEX_ENTRIES];
+	uint8_t m_Buffer[MAX_FRAME_SIZE];
+};
+
+/**
+ * Used by the player.
+ * The file is read in large blocks, the delta frames are decoded against the previous data of the universe.
+ */
+class Reader {
+public:
+	/**
+	 * Reads the header and rewinds to the first frame
+	 * @return false when the file is not a valid show file
+	 */
+	bool Begin(FILE *pFile);
+
+	void Rewind() {
+		Rewind(m_nDataOffset);
+	}
+
+	/**
+	 * Jumps to the last index entry at or before nMillis
+	 * @return the time of the index entry
+	 */
+	uint32_t Seek(const uint32_t nMillis);
+
+	/**
+	 * @return the header of the next frame, nullptr at the end of the file
+	 */
+	const FrameHeader *Peek();
+
+	/**
+	 * Consumes the frame returned by Peek
+	 * @return the DMX data of the universe, nullptr when a delta frame has no previous data (after a seek) or is corrupt
+	 */
+	const uint8_t *Next();
+
+	uint32_t GetIndexEntries() const {
+		return m_nIndexEntries;
+	}
+
+private:
+	void Rewind(const uint32_t nOffset);
+	bool Fill(const uint32_t nSize);
+	Universe *FindUniverse(const uint16_t nUniverse, const bool bCreate);
+
+private:
+	FILE *m_pFile { nullptr };
+	uint32_t m_nDataOffset { 0 };		///< File offset of the first frame
+	uint32_t m_nDataEnd { 0 };			///< File offset of the index, or the file size
+	uint32_t m_nIndexEntries { 0 };
+	uint32_t m_nFileOffset { 0 };		///< File offset of m_ReadBuffer[m_nReadTail]
+	uint32_t m_nReadHead { 0 };
+	uint32_t m_nReadTail { 0 };
+	uint32_t m_nUniverses { 0 };
+	bool m_bHaveFrame { false };
+	FrameHeader m_FrameHeader;
+	Universe m_Universes[MAX_UNIVERSES];
+	uint8_t m_ReadBuffer[4 * MAX_FRAME_SIZE];
+};
+}  // namespace bin
+}  // namespace showfile
+
+#endif /* FORMATS_SHOWFILEBIN_H_ */
@@ -0,0 +1,173 @@
+/**
+ * @file showfileformatbin.h
+ *
+ */
+/* Copyright (C) 2024 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FORMATS_SHOWFILEFORMATBIN_H_
+#define FORMATS_SHOWFILEFORMATBIN_H_
+
+#if !defined(__clang__)
+# pragma GCC push_options
+# pragma GCC optimize ("O2")
+#endif
+
+#include <cstdint>
+#include <cstdio>
+#include <cassert>
+
+#include "formats/showfilebin.h"
+#include "showfileprotocol.h"
+#include "showfileconst.h"
+
+#include "hardware.h"
+
+#include "debug.h"
+
+class ShowFileFormat: ShowFileProtocol {
+public:
+	ShowFileFormat() {
+		DEBUG_ENTRY
+
+		assert(s_pThis == nullptr);
+		s_pThis = this;
+
+		ShowFileProtocol::Start();
+
+		DEBUG_EXIT
+	}
+
+	void ShowFileStart();
+
+	void ShowFileStop() {
+		DEBUG_ENTRY
+
+		if ((m_State == State::RECORD_FIRST) || (m_State == State::RECORDING)) {
+			m_Writer.End();
+			m_State = State::IDLE;
+		} else if (m_State == State::PLAYING) {
+			m_nStopMillis = Hardware::Get()->Millis();
+		}
+
+		DEBUG_EXIT
+	}
+
+	void ShowFileResume() {
+		DEBUG_ENTRY
+
+		if (m_State == State::PLAYING) {
+			m_nStartMillis += Hardware::Get()->Millis() - m_nStopMillis;
+		}
+
+		DEBUG_EXIT
+	}
+
+	void ShowFileRecord();
+
+	/**
+	 * Jump to the index entry at or before nMillis
+	 */
+	bool ShowFileSeek(const uint32_t nMillis);
+
+	void ShowFilePrint() {
+		puts(" Format: Binary");
+		ShowFileProtocol::Print();
+	}
+
+	void ShowFileRun(const bool doRun) {
+		if (doRun) {
+			Run();
+		}
+
+		ShowFileProtocol::Run();
+	}
+
+	void DoRunCleanupProcess(const bool bDoRun) {
+		ShowFileProtocol::DoRunCleanupProcess(bDoRun);
+	}
+
+	void ShowfileWrite(const uint8_t *pDmxData, const uint32_t nSize, const uint32_t nUniverse, const uint32_t nMillis) {
+		if (m_State == State::RECORD_FIRST) {
+			m_nStartMillis = nMillis;
+			m_State = State::RECORDING;
+		}
+
+		if (m_State == State::RECORDING) {
+			m_Writer.Write(pDmxData, nSize, static_cast<uint16_t>(nUniverse), nMillis - m_nStartMillis);
+		}
+	}
+
+	void BlackOut() {
+#if defined (CONFIG_SHOWFILE_ENABLE_MASTER)
+		ShowFileProtocol::DmxBlackout();
+#endif
+	}
+
+	void SetMaster([[maybe_unused]] const uint32_t nMaster) {
+#if defined (CONFIG_SHOWFILE_ENABLE_MASTER)
+		ShowFileProtocol::DmxMaster(nMaster);
+#endif
+	}
+
+	bool IsSyncDisabled() {
+		return ShowFileProtocol::IsSyncDisabled();
+	}
+
+	static ShowFileFormat *Get() {
+		return s_pThis;
+	}
+
+private:
+	void Run();
+
+protected:
+	uint32_t m_nShowFileCurrent { showfile::FILE_MAX_NUMBER + 1 };
+	bool m_bDoLoop { false };
+	FILE *m_pShowFile { nullptr };
+
+private:
+	enum class State {
+		IDLE, PLAYING, RECORD_FIRST, RECORDING
+	};
+
+	State m_State { State::IDLE };
+	uint32_t m_nStartMillis { 0 };
+	uint32_t m_nStopMillis { 0 };
+	/*
+	 * Player
+	 */
+	uint32_t m_nSyncMillis { 0 };
+	bool m_bSyncPending { false };
+	showfile::bin::Reader m_Reader;
+	/*
+	 * Recorder
+	 */
+	showfile::bin::Writer m_Writer;
+
+	static ShowFileFormat *s_pThis;
+};
+
+#if !defined(__clang__)
+# pragma GCC pop_options
+#endif
+
+#endif /* FORMATS_SHOWFILEFORMATBIN_H_ */
@@ -76,6 +76,17 @@ public:
 		m_ArtNetController.HandleSync();
 	}
 
+	/**
+	 * The universes of a frame are sent in a single batch by DmxFrameCommit
+	 */
+	void DmxFrameOut(const uint16_t nUniverse, const uint8_t *pDmxData, const uint32_t nLength) {
+		m_ArtNetController.AddUniverse(nUniverse, pDmxData, nLength);
+	}
+
+	void DmxFrameCommit() {
+		m_ArtNetController.CommitFrame();
+	}
+
 	void DmxBlackout() {
 		m_ArtNetController.HandleBlackout();
 	}
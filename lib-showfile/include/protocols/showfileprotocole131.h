@@ -75,6 +75,17 @@ public:
 		m_E131Controller.HandleSync();
 	}
 
+	/**
+	 * The universes of a frame are sent in a single batch by DmxFrameCommit
+	 */
+	void DmxFrameOut(const uint16_t nUniverse, const uint8_t *pDmxData, const uint32_t nLength) {
+		m_E131Controller.AddUniverse(nUniverse, pDmxData, nLength);
+	}
+
+	void DmxFrameCommit() {
+		m_E131Controller.CommitFrame();
+	}
+
 	void DmxBlackout() {
 		m_E131Controller.HandleBlackout();
 	}
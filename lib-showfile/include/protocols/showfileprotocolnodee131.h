@@ -103,6 +103,17 @@ public:
 	void DmxSync() {
 	}
 
+	/**
+	 * The data is handed to the node directly, there is nothing to batch
+	 */
+	void DmxFrameOut(const uint16_t nUniverse, const uint8_t *pDmxData, const uint32_t nLength) {
+		DmxOut(nUniverse, pDmxData, nLength);
+	}
+
+	void DmxFrameCommit() {
+		DmxSync();
+	}
+
 	void DmxBlackout() {
 	}
 
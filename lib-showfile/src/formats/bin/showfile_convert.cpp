@@ -0,0 +1,151 @@
+/**
+ * @file showfile_convert.cpp
+ *
+ */
+/* Copyright (C) 2024 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cctype>
+#include <cassert>
+
+#include "formats/showfilebin.h"
+
+#include "debug.h"
+
+namespace showfile {
+/**
+ * Converts the OLA show file showNN.txt into showNN.bin
+ * OLA format:
+ *  OLA Show
+ *  universe dmx,dmx,...
+ *  delay in milliseconds
+ */
+bool convert_ola(const uint32_t nShowFileNumber) {
+	DEBUG_ENTRY
+
+	if (nShowFileNumber > FILE_MAX_NUMBER) {
+		DEBUG_EXIT
+		return false;
+	}
+
+	char aFileName[FILE_NAME_LENGTH + 1];
+
+	snprintf(aFileName, sizeof(aFileName), SHOWFILE_PREFIX "%.2u.txt", static_cast<unsigned int>(nShowFileNumber));
+
+	auto *pFileOla = fopen(aFileName, "r");
+
+	if (pFileOla == nullptr) {
+		perror(aFileName);
+		DEBUG_EXIT
+		return false;
+	}
+
+	snprintf(aFileName, sizeof(aFileName), SHOWFILE_PREFIX "%.2u" SHOWFILE_SUFFIX, static_cast<unsigned int>(nShowFileNumber));
+
+	auto *pFileBin = fopen(aFileName, "w");
+
+	if (pFileBin == nullptr) {
+		perror(aFileName);
+		fclose(pFileOla);
+		DEBUG_EXIT
+		return false;
+	}
+
+	auto *pWriter = new bin::Writer;
+	assert(pWriter != nullptr);
+
+	pWriter->Begin(pFileBin);
+
+	static char line[2560];	// 5 + 512 * 4 + 2
+	uint8_t dmxData[512];
+	uint32_t nMillis = 0;
+	uint32_t nFrames = 0;
+	auto isOk = true;
+
+	while (fgets(line, sizeof(line), pFileOla) == line) {
+		if (!isdigit(line[0])) {
+			continue;
+		}
+
+		const char *p = line;
+		uint32_t nValue = 0;
+
+		while (isdigit(*p)) {
+			nValue = nValue * 10 + static_cast<uint32_t>(*p - '0');
+			p++;
+		}
+
+		if (*p != ' ') {
+			nMillis += nValue;
+			continue;
+		}
+
+		if (nValue > 0xFFFF) {
+			isOk = false;
+			break;
+		}
+
+		const auto nUniverse = static_cast<uint16_t>(nValue);
+		uint32_t nSlots = 0;
+
+		p++;
+
+		while (isdigit(*p) && (nSlots < sizeof(dmxData))) {
+			nValue = 0;
+
+			while (isdigit(*p)) {
+				nValue = nValue * 10 + static_cast<uint32_t>(*p - '0');
+				p++;
+			}
+
+			if (nValue > 255) {
+				isOk = false;
+				break;
+			}
+
+			dmxData[nSlots++] = static_cast<uint8_t>(nValue);
+
+			if (*p == ',') {
+				p++;
+			}
+		}
+
+		if (!isOk) {
+			break;
+		}
+
+		pWriter->Write(dmxData, nSlots, nUniverse, nMillis);
+		nFrames++;
+	}
+
+	pWriter->End();
+	delete pWriter;
+
+	fclose(pFileBin);
+	fclose(pFileOla);
+
+	DEBUG_PRINTF("nFrames=%u, nMillis=%u, isOk=%d", nFrames, nMillis, isOk);
+	DEBUG_EXIT
+	return isOk;
+}
+}  // namespace showfile
@@ -0,0 +1,235 @@
+/**
+ * @file showfile_reader.cpp
+ *
+ */
+/* Copyright (C) 2024 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <cassert>
+
+#include "formats/showfilebin.h"
+
+#include "debug.h"
+
+namespace showfile {
+namespace bin {
+bool Reader::Begin(FILE *pFile) {
+	DEBUG_ENTRY
+	assert(pFile != nullptr);
+
+	m_pFile = pFile;
+
+	Header header;
+
+	if ((fseek(m_pFile, 0L, SEEK_SET) != 0) || (fread(&header, sizeof(struct Header), 1, m_pFile) != 1)) {
+		perror("header");
+		DEBUG_EXIT
+		return false;
+	}
+
+	if ((memcmp(header.aMagic, MAGIC, sizeof(header.aMagic)) != 0) || (header.nVersion != VERSION) || (header.nHeaderSize < sizeof(struct Header))) {
+		DEBUG_PUTS("Invalid header");
+		DEBUG_EXIT
+		return false;
+	}
+
+	m_nDataOffset = header.nHeaderSize;
+
+	if (header.nIndexOffset != 0) {
+		m_nDataEnd = header.nIndexOffset;
+		m_nIndexEntries = header.nIndexEntries;
+	} else {
+		// The recording was not stopped properly
+		fseek(m_pFile, 0L, SEEK_END);
+		m_nDataEnd = static_cast<uint32_t>(ftell(m_pFile));
+		m_nIndexEntries = 0;
+	}
+
+	DEBUG_PRINTF("m_nDataOffset=%u, m_nDataEnd=%u, m_nIndexEntries=%u", m_nDataOffset, m_nDataEnd, m_nIndexEntries);
+
+	Rewind(m_nDataOffset);
+
+	DEBUG_EXIT
+	return true;
+}
+
+/**
+ * Binary search for the last index entry at or before nMillis
+ */
+uint32_t Reader::Seek(const uint32_t nMillis) {
+	DEBUG_ENTRY
+	DEBUG_PRINTF("nMillis=%u", nMillis);
+
+	IndexEntry entry = { 0, m_nDataOffset };
+
+	uint32_t nLow = 0;
+	uint32_t nHigh = m_nIndexEntries;
+
+	while (nLow < nHigh) {
+		const auto nMiddle = nLow + (nHigh - nLow) / 2;
+		IndexEntry middle;
+
+		if ((fseek(m_pFile, static_cast<long>(m_nDataEnd + nMiddle * sizeof(struct IndexEntry)), SEEK_SET) != 0)
+				|| (fread(&middle, sizeof(struct IndexEntry), 1, m_pFile) != 1)) {
+			perror("index");
+			break;
+		}
+
+		if (middle.nMillis <= nMillis) {
+			entry = middle;
+			nLow = nMiddle + 1;
+		} else {
+			nHigh = nMiddle;
+		}
+	}
+
+	DEBUG_PRINTF("nMillis=%u, nOffset=%u", entry.nMillis, entry.nOffset);
+
+	Rewind(entry.nOffset);
+
+	DEBUG_EXIT
+	return entry.nMillis;
+}
+
+void Reader::Rewind(const uint32_t nOffset) {
+	if (fseek(m_pFile, static_cast<long>(nOffset), SEEK_SET) != 0) {
+		perror("fseek");
+	}
+
+	m_nFileOffset = nOffset;
+	m_nReadHead = 0;
+	m_nReadTail = 0;
+	m_nUniverses = 0;
+	m_bHaveFrame = false;
+}
+
+/**
+ * Makes sure that nSize bytes are available at m_ReadBuffer[m_nReadHead].
+ * The file is read in large blocks.
+ */
+bool Reader::Fill(const uint32_t nSize) {
+	const auto nAvailable = m_nReadTail - m_nReadHead;
+
+	if (nAvailable >= nSize) {
+		return true;
+	}
+
+	if (m_nReadHead != 0) {
+		memmove(m_ReadBuffer, &m_ReadBuffer[m_nReadHead], nAvailable);
+		m_nReadHead = 0;
+		m_nReadTail = nAvailable;
+	}
+
+	const auto nRead = std::min(static_cast<uint32_t>(sizeof(m_ReadBuffer)) - m_nReadTail, m_nDataEnd - m_nFileOffset);
+
+	if (nRead != 0) {
+		const auto nBytes = static_cast<uint32_t>(fread(&m_ReadBuffer[m_nReadTail], 1, nRead, m_pFile));
+		m_nReadTail += nBytes;
+		m_nFileOffset += nBytes;
+	}
+
+	return (m_nReadTail - m_nReadHead) >= nSize;
+}
+
+const FrameHeader *Reader::Peek() {
+	if (m_bHaveFrame) {
+		return &m_FrameHeader;
+	}
+
+	if (!Fill(sizeof(struct FrameHeader))) {
+		return nullptr;
+	}
+
+	memcpy(&m_FrameHeader, &m_ReadBuffer[m_nReadHead], sizeof(struct FrameHeader));
+
+	if ((m_FrameHeader.nLength > 512) || (m_FrameHeader.nSlots > 512)) {
+		DEBUG_PUTS("Corrupt frame");
+		return nullptr;
+	}
+
+	if (!Fill(sizeof(struct FrameHeader) + m_FrameHeader.nLength)) {
+		return nullptr;
+	}
+
+	m_bHaveFrame = true;
+	return &m_FrameHeader;
+}
+
+Universe *Reader::FindUniverse(const uint16_t nUniverse, const bool bCreate) {
+	for (uint32_t i = 0; i < m_nUniverses; i++) {
+		if (m_Universes[i].nUniverse == nUniverse) {
+			return &m_Universes[i];
+		}
+	}
+
+	if ((!bCreate) || (m_nUniverses == MAX_UNIVERSES)) {
+		return nullptr;
+	}
+
+	auto *pUniverse = &m_Universes[m_nUniverses++];
+	pUniverse->nUniverse = nUniverse;
+
+	return pUniverse;
+}
+
+const uint8_t *Reader::Next() {
+	assert(m_bHaveFrame);
+
+	const auto *pPayload = &m_ReadBuffer[m_nReadHead + sizeof(struct FrameHeader)];
+	const auto nSlots = m_FrameHeader.nSlots;
+
+	m_nReadHead += static_cast<uint32_t>(sizeof(struct FrameHeader)) + m_FrameHeader.nLength;
+	m_bHaveFrame = false;
+
+	if (m_FrameHeader.type == FrameType::KEY) {
+		if (m_FrameHeader.nLength != nSlots) {
+			return nullptr;
+		}
+
+		auto *pUniverse = FindUniverse(m_FrameHeader.nUniverse, true);
+
+		if (pUniverse != nullptr) {
+			pUniverse->nSlots = nSlots;
+			memcpy(pUniverse->data, pPayload, nSlots);
+		}
+
+		return pPayload;
+	}
+
+	// A delta frame needs the previous data, which is not there after a seek.
+	auto *pUniverse = FindUniverse(m_FrameHeader.nUniverse, false);
+
+	if ((pUniverse == nullptr) || (pUniverse->nSlots != nSlots)) {
+		return nullptr;
+	}
+
+	if (!delta_decode(pUniverse->data, nSlots, pPayload, m_FrameHeader.nLength)) {
+		return nullptr;
+	}
+
+	return pUniverse->data;
+}
+}  // namespace bin
+}  // namespace showfile
@@ -0,0 +1,246 @@
+/**
+ * @file showfile_writer.cpp
+ *
+ */
+/* Copyright (C) 2024 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <cassert>
+
+#include "formats/showfilebin.h"
+
+#include "debug.h"
+
+namespace showfile {
+namespace bin {
+bool delta_encode(uint8_t *pPayload, const uint8_t *pOld, const uint8_t *pNew, const uint32_t nSlots, uint32_t& nLength) {
+	nLength = 0;
+	uint32_t i = 0;
+
+	while (i < nSlots) {
+		if (pOld[i] == pNew[i]) {
+			i++;
+			continue;
+		}
+
+		const auto nStart = i;
+		auto nEnd = i + 1;
+
+		for (auto j = nEnd; (j < nSlots) && ((j - nEnd) < RUN_HEADER_SIZE); j++) {
+			if (pOld[j] != pNew[j]) {
+				nEnd = j + 1;
+			}
+		}
+
+		const auto nCount = nEnd - nStart;
+
+		if ((nLength + RUN_HEADER_SIZE + nCount) >= nSlots) {
+			return false;
+		}
+
+		const auto nOffset16 = static_cast<uint16_t>(nStart);
+		const auto nCount16 = static_cast<uint16_t>(nCount);
+
+		memcpy(&pPayload[nLength], &nOffset16, sizeof(uint16_t));
+		memcpy(&pPayload[nLength + 2], &nCount16, sizeof(uint16_t));
+		memcpy(&pPayload[nLength + RUN_HEADER_SIZE], &pNew[nStart], nCount);
+
+		nLength += RUN_HEADER_SIZE + nCount;
+		i = nEnd;
+	}
+
+	return true;
+}
+
+bool delta_decode(uint8_t *pData, const uint32_t nSlots, const uint8_t *pPayload, const uint32_t nLength) {
+	uint32_t i = 0;
+
+	while ((i + RUN_HEADER_SIZE) <= nLength) {
+		uint16_t nOffset;
+		uint16_t nCount;
+
+		memcpy(&nOffset, &pPayload[i], sizeof(uint16_t));
+		memcpy(&nCount, &pPayload[i + 2], sizeof(uint16_t));
+
+		i += RUN_HEADER_SIZE;
+
+		if (((nOffset + nCount) > nSlots) || ((i + nCount) > nLength)) {
+			return false;
+		}
+
+		memcpy(&pData[nOffset], &pPayload[i], nCount);
+		i += nCount;
+	}
+
+	return (i == nLength);
+}
+
+void Writer::Begin(FILE *pFile) {
+	DEBUG_ENTRY
+	assert(pFile != nullptr);
+
+	m_pFile = pFile;
+
+	Header header;
+	memcpy(header.aMagic, MAGIC, sizeof(header.aMagic));
+	header.nVersion = VERSION;
+	header.nHeaderSize = sizeof(struct Header);
+	header.nIndexOffset = 0;
+	header.nIndexEntries = 0;
+
+	if (fwrite(&header, sizeof(struct Header), 1, m_pFile) != 1) {
+		perror("fwrite");
+	}
+
+	m_nOffset = sizeof(struct Header);
+	m_nIndexInterval = INDEX_INTERVAL_MILLIS;
+	m_nIndexMillis = 0;
+	m_nIndexEntries = 0;
+	m_nUniverses = 0;
+
+	AddIndex(0);
+
+	DEBUG_EXIT
+}
+
+/**
+ * After an index entry, the first frame of each universe is a key frame.
+ * Then playback can start at any index entry.
+ */
+void Writer::AddIndex(const uint32_t nMillis) {
+	if (m_nIndexEntries == MAX_INDEX_ENTRIES) {
+		for (uint32_t i = 0; i < (MAX_INDEX_ENTRIES / 2); i++) {
+			m_Index[i] = m_Index[2 * i];
+		}
+
+		m_nIndexEntries = MAX_INDEX_ENTRIES / 2;
+		m_nIndexInterval *= 2;
+
+		DEBUG_PRINTF("m_nIndexInterval=%u", m_nIndexInterval);
+	}
+
+	m_Index[m_nIndexEntries].nMillis = nMillis;
+	m_Index[m_nIndexEntries].nOffset = m_nOffset;
+	m_nIndexEntries++;
+	m_nIndexMillis = nMillis;
+
+	for (auto &bKeyPending : m_bKeyPending) {
+		bKeyPending = true;
+	}
+}
+
+Universe *Writer::FindUniverse(const uint16_t nUniverse) {
+	for (uint32_t i = 0; i < m_nUniverses; i++) {
+		if (m_Universes[i].nUniverse == nUniverse) {
+			return &m_Universes[i];
+		}
+	}
+
+	if (m_nUniverses == MAX_UNIVERSES) {
+		return nullptr;
+	}
+
+	auto *pUniverse = &m_Universes[m_nUniverses++];
+	pUniverse->nUniverse = nUniverse;
+	pUniverse->nSlots = 0;
+
+	return pUniverse;
+}
+
+void Writer::Write(const uint8_t *pDmxData, uint32_t nSlots, const uint16_t nUniverse, const uint32_t nMillis) {
+	assert(m_pFile != nullptr);
+
+	nSlots = std::min(nSlots, static_cast<uint32_t>(512));
+
+	if ((nMillis - m_nIndexMillis) >= m_nIndexInterval) {
+		AddIndex(nMillis);
+	}
+
+	auto *pFrameHeader = reinterpret_cast<FrameHeader *>(m_Buffer);
+	auto *pPayload = &m_Buffer[sizeof(struct FrameHeader)];
+	auto *pUniverse = FindUniverse(nUniverse);
+
+	uint32_t nLength = 0;
+	pFrameHeader->type = FrameType::KEY;
+
+	if (pUniverse != nullptr) {
+		const auto nIndex = static_cast<uint32_t>(pUniverse - m_Universes);
+
+		if ((!m_bKeyPending[nIndex]) && (pUniverse->nSlots == nSlots) && delta_encode(pPayload, pUniverse->data, pDmxData, nSlots, nLength)) {
+			pFrameHeader->type = FrameType::DELTA;
+		}
+
+		m_bKeyPending[nIndex] = false;
+		pUniverse->nSlots = static_cast<uint16_t>(nSlots);
+		memcpy(pUniverse->data, pDmxData, nSlots);
+	}
+
+	if (pFrameHeader->type == FrameType::KEY) {
+		memcpy(pPayload, pDmxData, nSlots);
+		nLength = nSlots;
+	}
+
+	pFrameHeader->nLength = static_cast<uint16_t>(nLength);
+	pFrameHeader->nReserved = 0;
+	pFrameHeader->nMillis = nMillis;
+	pFrameHeader->nUniverse = nUniverse;
+	pFrameHeader->nSlots = static_cast<uint16_t>(nSlots);
+
+	const auto nSize = sizeof(struct FrameHeader) + nLength;
+
+	if (fwrite(m_Buffer, 1, nSize, m_pFile) != nSize) {
+		perror("fwrite");
+	}
+
+	m_nOffset += nSize;
+}
+
+void Writer::End() {
+	DEBUG_ENTRY
+	assert(m_pFile != nullptr);
+
+	Header header;
+	memcpy(header.aMagic, MAGIC, sizeof(header.aMagic));
+	header.nVersion = VERSION;
+	header.nHeaderSize = sizeof(struct Header);
+	header.nIndexOffset = m_nOffset;
+	header.nIndexEntries = m_nIndexEntries;
+
+	if (fwrite(m_Index, sizeof(struct IndexEntry), m_nIndexEntries, m_pFile) != m_nIndexEntries) {
+		perror("fwrite");
+	}
+
+	if ((fseek(m_pFile, 0L, SEEK_SET) != 0) || (fwrite(&header, sizeof(struct Header), 1, m_pFile) != 1)) {
+		perror("header");
+	}
+
+	DEBUG_PRINTF("nIndexOffset=%u, nIndexEntries=%u", header.nIndexOffset, header.nIndexEntries);
+
+	m_pFile = nullptr;
+
+	DEBUG_EXIT
+}
+}  // namespace bin
+}  // namespace showfile
@@ -0,0 +1,148 @@
+/**
+ * @file showfileformatbin.cpp
+ *
+ */
+/* Copyright (C) 2024 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cassert>
+
+#include "formats/showfileformatbin.h"
+#include "showfile.h"
+
+#include "hardware.h"
+
+#include "debug.h"
+
+using namespace showfile::bin;
+
+ShowFileFormat *ShowFileFormat::s_pThis;
+
+void ShowFileFormat::ShowFileStart() {
+	DEBUG_ENTRY
+
+	m_State = State::IDLE;
+
+	if ((m_pShowFile == nullptr) || !m_Reader.Begin(m_pShowFile)) {
+		DEBUG_EXIT
+		return;
+	}
+
+	m_bSyncPending = false;
+	m_nStartMillis = Hardware::Get()->Millis();
+	m_nStopMillis = m_nStartMillis;
+	m_State = State::PLAYING;
+
+	DEBUG_EXIT
+}
+
+void ShowFileFormat::ShowFileRecord() {
+	DEBUG_ENTRY
+	DEBUG_PRINTF("m_pShowFile%snullptr", m_pShowFile != nullptr ? "!=" : "==");
+
+	if (m_pShowFile != nullptr) {
+		m_Writer.Begin(m_pShowFile);
+		m_State = State::RECORD_FIRST;
+	} else {
+		m_State = State::IDLE;
+	}
+
+	ShowFileProtocol::Record();
+
+	DEBUG_EXIT
+}
+
+bool ShowFileFormat::ShowFileSeek(const uint32_t nMillis) {
+	DEBUG_ENTRY
+	DEBUG_PRINTF("nMillis=%u", nMillis);
+
+	if (m_State != State::PLAYING) {
+		DEBUG_EXIT
+		return false;
+	}
+
+	const auto nIndexMillis = m_Reader.Seek(nMillis);
+
+	const auto nNow = Hardware::Get()->Millis();
+	m_nStartMillis = nNow - nIndexMillis;
+	m_nStopMillis = nNow;
+	m_bSyncPending = false;
+
+	DEBUG_EXIT
+	return true;
+}
+
+/**
+ * A bounded number of frames is handled per call, so the main loop is never stalled.
+ * The frames with the same time stamp are sent as one batch, followed by the sync.
+ */
+void ShowFileFormat::Run() {
+	if (m_State != State::PLAYING) {
+		ShowFile::Get()->SetStatus(showfile::Status::ENDED);
+		return;
+	}
+
+	const auto nElapsed = Hardware::Get()->Millis() - m_nStartMillis;
+
+	for (uint32_t i = 0; i < MAX_FRAMES_PER_RUN; i++) {
+		const auto *pFrameHeader = m_Reader.Peek();
+
+		if (pFrameHeader == nullptr) {
+			if (m_bSyncPending) {
+				ShowFileProtocol::DmxFrameCommit();
+			}
+
+			m_bSyncPending = false;
+
+			if (m_bDoLoop) {
+				m_Reader.Rewind();
+				m_nStartMillis = Hardware::Get()->Millis();
+			} else {
+				ShowFile::Get()->SetStatus(showfile::Status::ENDED);
+			}
+
+			return;
+		}
+
+		if (m_bSyncPending && (pFrameHeader->nMillis != m_nSyncMillis)) {
+			ShowFileProtocol::DmxFrameCommit();
+			m_bSyncPending = false;
+		}
+
+		if (pFrameHeader->nMillis > nElapsed) {
+			return;
+		}
+
+		const auto nUniverse = pFrameHeader->nUniverse;
+		const auto nSlots = pFrameHeader->nSlots;
+
+		m_nSyncMillis = pFrameHeader->nMillis;
+		m_bSyncPending = true;
+
+		const auto *pDmxData = m_Reader.Next();
+
+		if (pDmxData != nullptr) {
+			ShowFileProtocol::DmxFrameOut(nUniverse, pDmxData, nSlots);
+		}
+	}
+}
@@ -51,6 +51,10 @@ namespace cmd {
 #endif
 	static constexpr char TFTP[] = "tftp";
 	static constexpr char DELETE[] = "delete";
+#if defined (CONFIG_SHOWFILE_FORMAT_BIN)
+	static constexpr char SEEK[] = "seek";
+	static constexpr char CONVERT[] = "convert";
+#endif
 	// TouchOSC specific
 	static constexpr char RELOAD[] = "reload";
 	static constexpr char INDEX[] = "index";
@@ -68,6 +72,10 @@ namespace length {
 #endif
 	static constexpr uint32_t TFTP = sizeof(cmd::TFTP) - 1;
 	static constexpr uint32_t DELETE = sizeof(cmd::DELETE) - 1;
+#if defined (CONFIG_SHOWFILE_FORMAT_BIN)
+	static constexpr uint32_t SEEK = sizeof(cmd::SEEK) - 1;
+	static constexpr uint32_t CONVERT = sizeof(cmd::CONVERT) - 1;
+#endif
 	// TouchOSC specific
 	static constexpr uint32_t RELOAD = sizeof(cmd::RELOAD) - 1;
 	static constexpr uint32_t INDEX = sizeof(cmd::INDEX) - 1;
@@ -231,6 +239,45 @@ void ShowFileOSC::Process() {
 		return;
 	}
 
+#if defined (CONFIG_SHOWFILE_FORMAT_BIN)
+	if (memcmp(&m_pBuffer[length::PATH], cmd::SEEK, length::SEEK) == 0) {
+		OscSimpleMessage Msg(m_pBuffer, m_nBytesReceived);
+
+		if (Msg.GetType(0) != osc::type::INT32) {
+			return;
+		}
+
+		const auto nMillis = static_cast<uint32_t>(Msg.GetInt(0));
+
+		ShowFile::Get()->ShowFileSeek(nMillis);
+
+		DEBUG_PRINTF("Seek %u", nMillis);
+		return;
+	}
+
+	if (memcmp(&m_pBuffer[length::PATH], cmd::CONVERT, length::CONVERT) == 0) {
+		OscSimpleMessage Msg(m_pBuffer, m_nBytesReceived);
+
+		if (Msg.GetType(0) != osc::type::INT32) {
+			return;
+		}
+
+		const auto nValue = static_cast<uint32_t>(Msg.GetInt(0));
+
+		if ((nValue <= showfile::FILE_MAX_NUMBER) && (ShowFile::Get()->GetStatus() != showfile::Status::PLAYING) && (ShowFile::Get()->GetStatus() != showfile::Status::RECORDING)) {
+			if (showfile::convert_ola(nValue)) {
+				OscSimpleSend MsgStatus(m_nHandle, m_nRemoteIp, m_nPortOutgoing, "/showfile/status", "s", "Converted");
+				ShowFile::Get()->LoadShows();
+			} else {
+				OscSimpleSend MsgStatus(m_nHandle, m_nRemoteIp, m_nPortOutgoing, "/showfile/status", "s", "Not converted");
+			}
+		}
+
+		DEBUG_PRINTF("Convert %u", nValue);
+		return;
+	}
+#endif
+
 	if (memcmp(&m_pBuffer[length::PATH], cmd::INDEX, length::INDEX) == 0) {
 		OscSimpleMessage Msg(m_pBuffer, m_nBytesReceived);
 
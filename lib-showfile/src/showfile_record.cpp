@@ -29,7 +29,7 @@
 #endif
 
 #include <cstdint>
-#include "formats/showfileformatola.h"
+#include "showfileformat.h"
 
 #if defined (CONFIG_SHOWFILE_PROTOCOL_NODE_ARTNET)
 #include "artnet.h"
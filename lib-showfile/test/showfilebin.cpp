@@ -0,0 +1,402 @@
+/**
+ * @file showfilebin.cpp
+ *
+ */
+/* Copyright (C) 2024 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+#include "formats/showfilebin.h"
+
+#include "hosttest.h"
+
+using namespace showfile::bin;
+
+/*
+ * A show of 32 universes at 44 Hz, about 10 seconds
+ */
+static constexpr uint32_t UNIVERSES = 32;
+static constexpr uint32_t FRAMES = 440;
+static constexpr uint32_t SHOW_NUMBER = 1;
+
+static uint32_t universe_slots(const uint32_t nUniverse) {
+	return (nUniverse == 7) ? 170 : 512;
+}
+
+/**
+ * Universes 16 and up only change every other frame
+ */
+static bool universe_sent(const uint32_t nUniverse, const uint32_t nFrame) {
+	return (nUniverse < 16) || ((nFrame & 0x1) == 0);
+}
+
+/**
+ * Slot i changes every 1 + i % 64 frames, so most frames are delta frames
+ */
+static void generate(uint8_t *pData, const uint32_t nUniverse, const uint32_t nFrame) {
+	for (uint32_t i = 0; i < universe_slots(nUniverse); i++) {
+		pData[i] = static_cast<uint8_t>((nFrame / (1 + i % 64)) + nUniverse + i);
+	}
+}
+
+static uint32_t frame_millis(const uint32_t nFrame) {
+	return (nFrame * 1000) / 44;
+}
+
+static long file_size(const char *pFileName) {
+	auto *pFile = fopen(pFileName, "r");
+
+	if (pFile == nullptr) {
+		return 0;
+	}
+
+	fseek(pFile, 0L, SEEK_END);
+	const auto nSize = ftell(pFile);
+	fclose(pFile);
+
+	return nSize;
+}
+
+static void write_ola() {
+	char aFileName[32];
+	snprintf(aFileName, sizeof(aFileName), "show%.2u.txt", SHOW_NUMBER);
+
+	auto *pFile = fopen(aFileName, "w");
+	HOSTTEST_CHECK(pFile != nullptr);
+
+	fputs("OLA Show\n", pFile);
+
+	uint8_t data[512];
+
+	for (uint32_t nFrame = 0; nFrame < FRAMES; nFrame++) {
+		if (nFrame != 0) {
+			fprintf(pFile, "%u\n", frame_millis(nFrame) - frame_millis(nFrame - 1));
+		}
+
+		for (uint32_t nUniverse = 1; nUniverse <= UNIVERSES; nUniverse++) {
+			if (!universe_sent(nUniverse, nFrame)) {
+				continue;
+			}
+
+			generate(data, nUniverse, nFrame);
+
+			fprintf(pFile, "%u ", nUniverse);
+
+			for (uint32_t i = 0; i < universe_slots(nUniverse); i++) {
+				fprintf(pFile, (i == 0) ? "%u" : ",%u", data[i]);
+			}
+
+			fputc('\n', pFile);
+		}
+	}
+
+	fclose(pFile);
+}
+
+static uint32_t frames_total() {
+	uint32_t nFrames = 0;
+
+	for (uint32_t nFrame = 0; nFrame < FRAMES; nFrame++) {
+		for (uint32_t nUniverse = 1; nUniverse <= UNIVERSES; nUniverse++) {
+			nFrames += universe_sent(nUniverse, nFrame) ? 1 : 0;
+		}
+	}
+
+	return nFrames;
+}
+
+/**
+ * The generator frame of a universe at nMillis
+ */
+static uint32_t frame_at(const uint32_t nMillis) {
+	uint32_t nFrame = 0;
+
+	while ((nFrame + 1 < FRAMES) && (frame_millis(nFrame + 1) <= nMillis)) {
+		nFrame++;
+	}
+
+	return nFrame;
+}
+
+/**
+ * Reads all frames from the current position and compares them with the generator
+ */
+struct ReadBack {
+	uint32_t nFrames;
+	uint32_t nDelta;
+	uint32_t nNull;
+	uint32_t nMismatch;
+};
+
+static ReadBack read_back(Reader& reader) {
+	ReadBack result {};
+	uint8_t data[512];
+
+	const FrameHeader *pFrameHeader;
+
+	while ((pFrameHeader = reader.Peek()) != nullptr) {
+		const auto nUniverse = pFrameHeader->nUniverse;
+		const auto nSlots = pFrameHeader->nSlots;
+		const auto nFrame = frame_at(pFrameHeader->nMillis);
+
+		result.nDelta += (pFrameHeader->type == FrameType::DELTA) ? 1 : 0;
+
+		const auto *pDmxData = reader.Next();
+		result.nFrames++;
+
+		if (pDmxData == nullptr) {
+			result.nNull++;
+			continue;
+		}
+
+		generate(data, nUniverse, nFrame);
+
+		if ((nSlots != universe_slots(nUniverse)) || (memcmp(pDmxData, data, nSlots) != 0)) {
+			result.nMismatch++;
+		}
+	}
+
+	return result;
+}
+
+static void check_delta() {
+	uint8_t old[512];
+	uint8_t data[512];
+	uint8_t payload[512];
+	uint32_t nLength;
+
+	for (uint32_t i = 0; i < sizeof(old); i++) {
+		old[i] = static_cast<uint8_t>(rand());
+	}
+
+	// Sparse changes, with gaps smaller than a run header
+	memcpy(data, old, sizeof(data));
+	data[0]++;
+	data[2]++;
+	data[100]++;
+	data[511]++;
+
+	HOSTTEST_CHECK(delta_encode(payload, old, data, 512, nLength));
+	HOSTTEST_CHECK(nLength == (RUN_HEADER_SIZE + 3) + (RUN_HEADER_SIZE + 1) + (RUN_HEADER_SIZE + 1));
+
+	uint8_t decoded[512];
+	memcpy(decoded, old, sizeof(decoded));
+	HOSTTEST_CHECK(delta_decode(decoded, 512, payload, nLength));
+	HOSTTEST_CHECK(memcmp(decoded, data, sizeof(data)) == 0);
+
+	// A truncated payload is corrupt
+	HOSTTEST_CHECK(!delta_decode(decoded, 512, payload, nLength - 1));
+
+	// No changes, an empty delta frame
+	HOSTTEST_CHECK(delta_encode(payload, old, old, 512, nLength));
+	HOSTTEST_CHECK(nLength == 0);
+
+	// Every other slot changed, a key frame is smaller
+	memcpy(data, old, sizeof(data));
+
+	for (uint32_t i = 0; i < sizeof(data); i += 2) {
+		data[i]++;
+	}
+
+	HOSTTEST_CHECK(!delta_encode(payload, old, data, 512, nLength));
+}
+
+static void check_round_trip() {
+	write_ola();
+
+	HOSTTEST_CHECK(showfile::convert_ola(SHOW_NUMBER));
+
+	auto *pFile = fopen("show01.bin", "r");
+	HOSTTEST_CHECK(pFile != nullptr);
+
+	if (pFile == nullptr) {
+		return;
+	}
+
+	auto *pReader = new Reader;
+
+	HOSTTEST_CHECK(pReader->Begin(pFile));
+	HOSTTEST_CHECK(pReader->GetIndexEntries() >= 9);
+
+	auto result = read_back(*pReader);
+
+	printf("  %u frames, %u delta, %ld bytes (OLA %ld bytes)\n", result.nFrames, result.nDelta, file_size("show01.bin"), file_size("show01.txt"));
+
+	HOSTTEST_CHECK(result.nFrames == frames_total());
+	HOSTTEST_CHECK(result.nDelta > result.nFrames / 2);
+	HOSTTEST_CHECK(result.nNull == 0);
+	HOSTTEST_CHECK(result.nMismatch == 0);
+
+	// Seek into the middle, the first frame of each universe after an index entry is a key frame
+	const auto nMillis = frame_millis(FRAMES / 2) + 7;
+	const auto nIndexMillis = pReader->Seek(nMillis);
+
+	HOSTTEST_CHECK(nIndexMillis <= nMillis);
+	HOSTTEST_CHECK(nIndexMillis + INDEX_INTERVAL_MILLIS > nMillis);
+
+	const auto *pFrameHeader = pReader->Peek();
+	HOSTTEST_CHECK((pFrameHeader != nullptr) && (pFrameHeader->nMillis >= nIndexMillis) && (pFrameHeader->type == FrameType::KEY));
+
+	result = read_back(*pReader);
+
+	HOSTTEST_CHECK(result.nFrames > 0);
+	HOSTTEST_CHECK(result.nFrames < frames_total());
+	HOSTTEST_CHECK(result.nNull == 0);
+	HOSTTEST_CHECK(result.nMismatch == 0);
+
+	// Rewind to the start
+	pReader->Rewind();
+	result = read_back(*pReader);
+
+	HOSTTEST_CHECK(result.nFrames == frames_total());
+	HOSTTEST_CHECK(result.nMismatch == 0);
+
+	delete pReader;
+	fclose(pFile);
+}
+
+/**
+ * A recording that was not stopped has no index, the frames run until the end of the file
+ */
+static void check_no_index() {
+	auto *pFile = fopen("show02.bin", "w+");
+	HOSTTEST_CHECK(pFile != nullptr);
+
+	if (pFile == nullptr) {
+		return;
+	}
+
+	auto *pWriter = new Writer;
+	uint8_t data[512];
+
+	pWriter->Begin(pFile);
+
+	for (uint32_t nFrame = 0; nFrame < 100; nFrame++) {
+		for (uint32_t nUniverse = 1; nUniverse <= 4; nUniverse++) {
+			generate(data, nUniverse, nFrame);
+			pWriter->Write(data, universe_slots(nUniverse), static_cast<uint16_t>(nUniverse), frame_millis(nFrame));
+		}
+	}
+
+	fflush(pFile);
+
+	auto *pReader = new Reader;
+
+	HOSTTEST_CHECK(pReader->Begin(pFile));
+	HOSTTEST_CHECK(pReader->GetIndexEntries() == 0);
+
+	const auto result = read_back(*pReader);
+
+	HOSTTEST_CHECK(result.nFrames == 400);
+	HOSTTEST_CHECK(result.nDelta > 0);
+	HOSTTEST_CHECK(result.nNull == 0);
+	HOSTTEST_CHECK(result.nMismatch == 0);
+
+	// Without an index, a seek goes to the start
+	HOSTTEST_CHECK(pReader->Seek(1000) == 0);
+
+	delete pReader;
+	delete pWriter;
+	fclose(pFile);
+}
+
+/**
+ * The player handles at most MAX_FRAMES_PER_RUN frames per main loop pass.
+ * The budget for 32 universes at 44 Hz is 1408 frames per second.
+ */
+static void bench_player() {
+	auto *pFile = fopen("show01.bin", "r");
+
+	if (pFile == nullptr) {
+		return;
+	}
+
+	auto *pReader = new Reader;
+	pReader->Begin(pFile);
+
+	hosttest::Histogram histogram;
+	uint64_t nFrames = 0;
+
+	for (uint32_t nLoop = 0; nLoop < 10; nLoop++) {
+		pReader->Rewind();
+
+		for (;;) {
+			const auto nStart = hosttest::nanos();
+			uint32_t i;
+
+			for (i = 0; i < MAX_FRAMES_PER_RUN; i++) {
+				if (pReader->Peek() == nullptr) {
+					break;
+				}
+
+				hosttest::keep(pReader->Next());
+			}
+
+			histogram.Add(hosttest::nanos() - nStart);
+			nFrames += i;
+
+			if (i != MAX_FRAMES_PER_RUN) {
+				break;
+			}
+		}
+	}
+
+	const auto fNanosPerFrame = static_cast<double>(histogram.GetSum()) / static_cast<double>(nFrames);
+
+	printf("  %.1f ns per frame, %.2f%% of a core for %u universes at 44 Hz\n", fNanosPerFrame,
+			(fNanosPerFrame * UNIVERSES * 44) / 1e7, UNIVERSES);
+
+	histogram.Print("Run() pass of MAX_FRAMES_PER_RUN frames");
+
+	delete pReader;
+	fclose(pFile);
+}
+
+int main(int argc, char **argv) {
+	srand(1);
+
+	char aDirectory[] = "/tmp/showfilebinXXXXXX";
+
+	if ((mkdtemp(aDirectory) == nullptr) || (chdir(aDirectory) != 0)) {
+		perror(aDirectory);
+		return 1;
+	}
+
+	check_delta();
+	check_round_trip();
+	check_no_index();
+
+	if (hosttest::is_bench(argc, argv)) {
+		bench_player();
+	}
+
+	unlink("show01.txt");
+	unlink("show01.bin");
+	unlink("show02.bin");
+	rmdir(aDirectory);
+
+	return hosttest::exit_code("showfilebin");
+}
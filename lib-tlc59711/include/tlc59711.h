@@ -28,6 +28,8 @@
 #ifndef TLC59711_H_
 #define TLC59711_H_
 
+#include "hal_spi.h"
+
 struct TLC59711SpiSpeed {
 	static constexpr uint32_t DEFAULT = 5000000;	// 5 MHz
 	static constexpr uint32_t MAX = 10000000;		// 10 MHz
@@ -78,19 +80,33 @@ public:
 
 	void SetRgb(uint8_t nOut, uint8_t nRed, uint8_t nGreen, uint8_t nBlue);
 
+	/**
+	 * With USE_SPI_DMA the frame is streamed out while the next frame is set.
+	 * Update() only waits when the previous frame is still being sent.
+	 */
 	void Update();
 	void Blackout();
 
+	bool IsUpdating() {
+#if defined (H3)
+		return h3_spi_dma_tx_is_active();
+#else
+		return false;
+#endif
+	}
+
 	void Dump();
 
 private:
 	void UpdateFirst32();
+	void SpiSetup();
 
 private:
 	uint8_t m_nBoards;
 	uint32_t m_nSpiSpeedHz;
 	uint32_t m_nFirst32 { 0 };
-	uint16_t *m_pBuffer { nullptr };
+	uint16_t *m_pBuffer { nullptr };		///< Set() writes here, with USE_SPI_DMA this is the back buffer
+	uint16_t *m_pBufferSend { nullptr };	///< Front buffer, being sent with USE_SPI_DMA
 	uint16_t *m_pBufferBlackout { nullptr };
 	uint32_t m_nBufSize { 0 };
 };
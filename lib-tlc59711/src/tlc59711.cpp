@@ -78,11 +78,25 @@ TLC59711::TLC59711(uint8_t nBoards, uint32_t nSpiSpeedHz):
 
 	m_nBufSize = nBoards * TLC59711Channels::U16BIT;
 
+#if defined (USE_SPI_DMA)
+	uint32_t nSize;
+
+	auto *pDmaBuffer = const_cast<uint8_t *>(FUNC_PREFIX(spi_dma_tx_prepare(&nSize)));
+	assert(pDmaBuffer != nullptr);
+
+	const auto nBufferSize = (m_nBufSize * 2 + 3) & static_cast<uint32_t>(~3);
+	assert((3 * nBufferSize) <= nSize);
+
+	m_pBuffer = reinterpret_cast<uint16_t *>(pDmaBuffer);
+	m_pBufferSend = reinterpret_cast<uint16_t *>(pDmaBuffer + nBufferSize);
+	m_pBufferBlackout = reinterpret_cast<uint16_t *>(pDmaBuffer + 2 * nBufferSize);
+#else
 	m_pBuffer = new uint16_t[m_nBufSize];
 	assert(m_pBuffer != nullptr);
 
 	m_pBufferBlackout = new uint16_t[m_nBufSize];
 	assert(m_pBufferBlackout != nullptr);
+#endif
 
 	for (uint32_t i = 0; i < m_nBufSize; i++) {
 		m_pBuffer[i] = 0;
@@ -100,11 +114,26 @@ TLC59711::TLC59711(uint8_t nBoards, uint32_t nSpiSpeedHz):
 	SetGbcBlue(TLC59711_GS_DEFAULT);
 
 	memcpy(m_pBufferBlackout, m_pBuffer, m_nBufSize * 2);
+#if defined (USE_SPI_DMA)
+	memcpy(m_pBufferSend, m_pBuffer, m_nBufSize * 2);
+#endif
 }
 
 TLC59711::~TLC59711() {
+#if defined (USE_SPI_DMA)
+	while (IsUpdating()) {
+	}
+
+	m_pBufferBlackout = nullptr;
+	m_pBufferSend = nullptr;
+	m_pBuffer = nullptr;
+#else
+	delete[] m_pBufferBlackout;
+	m_pBufferBlackout = nullptr;
+
 	delete[] m_pBuffer;
 	m_pBuffer = nullptr;
+#endif
 }
 
 bool TLC59711::Get(uint32_t nChannel, uint16_t &nValue) {
@@ -349,20 +378,45 @@ void TLC59711::Dump() {
 #endif
 }
 
-void TLC59711::Update() {
-	assert(m_pBuffer != nullptr);
-
+void TLC59711::SpiSetup() {
 	FUNC_PREFIX(spi_chipSelect(SPI_CS_NONE));
 	FUNC_PREFIX(spi_set_speed_hz(m_nSpiSpeedHz));
 	FUNC_PREFIX(spi_setDataMode(SPI_MODE0));
+}
+
+void TLC59711::Update() {
+	assert(m_pBuffer != nullptr);
+#if defined (USE_SPI_DMA)
+	// The chain is much shorter than a DMX frame, so normally there is no wait
+	while (IsUpdating()) {
+	}
+
+	SpiSetup();
+
+	auto *pBuffer = m_pBufferSend;
+	m_pBufferSend = m_pBuffer;
+	m_pBuffer = pBuffer;
+
+	FUNC_PREFIX(spi_dma_tx_start(reinterpret_cast<const uint8_t *>(m_pBufferSend), m_nBufSize * 2));
+
+	// The next frame continues from the frame being sent, the DMA only reads
+	memcpy(m_pBuffer, m_pBufferSend, m_nBufSize * 2);
+#else
+	SpiSetup();
 	FUNC_PREFIX(spi_writenb(reinterpret_cast<char *>(m_pBuffer), m_nBufSize * 2));
+#endif
 }
 
 void TLC59711::Blackout() {
 	assert(m_pBufferBlackout != nullptr);
+#if defined (USE_SPI_DMA)
+	while (IsUpdating()) {
+	}
 
-	FUNC_PREFIX(spi_chipSelect(SPI_CS_NONE));
-	FUNC_PREFIX(spi_set_speed_hz(m_nSpiSpeedHz));
-	FUNC_PREFIX(spi_setDataMode(SPI_MODE0));
+	SpiSetup();
+	FUNC_PREFIX(spi_dma_tx_start(reinterpret_cast<const uint8_t *>(m_pBufferBlackout), m_nBufSize * 2));
+#else
+	SpiSetup();
 	FUNC_PREFIX(spi_writenb(reinterpret_cast<char *>(m_pBufferBlackout), m_nBufSize * 2));
+#endif
 }
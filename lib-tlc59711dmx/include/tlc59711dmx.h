@@ -47,6 +47,7 @@ public:
 	void Stop(uint32_t nPortIndex = 0) override;
 
 	void SetData(const uint32_t nPortIndex, const uint8_t *pDmxData, uint32_t nLength, const bool doUpdate = true) override;
+	void SetDataRange(const uint32_t nPortIndex, const uint8_t *pDmxData, uint32_t nLength, const uint32_t nOffset, const uint32_t nCount, const bool doUpdate = true) override;
 	void Sync(const uint32_t nPortIndex) override;
 	void Sync(const bool doForce = false) override;
 
@@ -100,6 +101,7 @@ private:
 	uint16_t m_nDmxStartAddress { 1 };
 	bool m_bIsStarted { false };
 	bool m_bBlackout { false };
+	bool m_bRemapped { false };	///< The footprint has moved, the next frame is output in full
 	TLC59711 *m_pTLC59711 { nullptr };
 #if defined (CONFIG_TLC59711DMX_ENABLE_PCT)
 	uint16_t *m_ArrayMaxValue { nullptr };
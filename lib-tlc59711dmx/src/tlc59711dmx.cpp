@@ -187,6 +187,18 @@ void TLC59711Dmx::SetData([[maybe_unused]] uint32_t nPortIndex, const uint8_t *p
 	}
 }
 
+void TLC59711Dmx::SetDataRange(const uint32_t nPortIndex, const uint8_t *pDmxData, uint32_t nLength, const uint32_t nOffset, const uint32_t nCount, const bool doUpdate) {
+	const uint32_t nFootprintOffset = m_nDmxStartAddress - 1U;
+
+	// The chain only needs to be shifted out when its footprint has changed
+	if ((m_pTLC59711 != nullptr) && (!m_bRemapped) && ((nCount == 0) || (nOffset >= (nFootprintOffset + m_nDmxFootprint)) || ((nOffset + nCount) <= nFootprintOffset))) {
+		return;
+	}
+
+	m_bRemapped = false;
+	SetData(nPortIndex, pDmxData, nLength, doUpdate);
+}
+
 void TLC59711Dmx::Sync([[maybe_unused]] uint32_t const nPortIndex) {
 	// No actions here
 }
@@ -217,6 +229,8 @@ void TLC59711Dmx::UpdateMembers() {
 	} else {
 		m_nDmxFootprint = m_nCount * 4U;
 	}
+
+	m_bRemapped = true;
 }
 
 void TLC59711Dmx::Blackout(bool bBlackout) {
@@ -236,6 +250,7 @@ bool TLC59711Dmx::SetDmxStartAddress(uint16_t nDmxStartAddress) {
 
 	if ((nDmxStartAddress != 0) && (nDmxStartAddress <= (lightset::dmx::UNIVERSE_SIZE - m_nDmxFootprint))) {
 		m_nDmxStartAddress = nDmxStartAddress;
+		m_bRemapped = true;
 		TLC59711DmxStore::SaveDmxStartAddress(m_nDmxStartAddress);
 		return true;
 	}
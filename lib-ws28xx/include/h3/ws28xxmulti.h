@@ -44,11 +44,23 @@ public:
 	void SetPixel(uint32_t nPortIndex, uint32_t nPixelIndex, uint8_t nRed, uint8_t nGreen, uint8_t nBlue);
 	void SetPixel(uint32_t nPortIndex, uint32_t nPixelIndex, uint8_t nRed, uint8_t nGreen, uint8_t nBlue, uint8_t nWhite);
 
+	void SetBytes(uint32_t nPortIndex, uint32_t nOffset, const uint8_t *pBytes, uint32_t nLength);
+
 	bool IsUpdating() {
 		return h3_spi_dma_tx_is_active();  // returns TRUE while DMA operation is active
 	}
 
 	void Update();
+	/**
+	 * Starts sending the blackout frame, without waiting for the completion.
+	 * The caller must check IsUpdating() first.
+	 */
+	void UpdateBlackout();
+	/**
+	 * Fills the pixel buffer with full on, without sending it.
+	 * Can be called while the previous frame is sent.
+	 */
+	void SetFullOn();
 	void Blackout();
 	void FullOn();
 
@@ -117,6 +117,13 @@ public:
 
 	void Validate(uint32_t& nLedsPerPixel);
 
+	/**
+	 * The time needed for sending one frame to a port, including the reset (latch) time.
+	 * Valid after Validate()
+	 * @return microseconds
+	 */
+	uint32_t GetRefreshMicros() const;
+
 	void Print();
 
 	static void GetTxH(pixel::Type type, uint8_t &nLowCode, uint8_t &nHighCode);
@@ -72,6 +72,10 @@ static constexpr uint32_t default_hz = 4000000;	///< 4 MHz
 }  // namespace p9813
 }  // namespace speed
 }  // namespace spi
+namespace reset {
+static constexpr uint32_t rtz_us = 280;		///< WS2812B-V5, the older RTZ types need 50 us
+static constexpr uint32_t ws2801_us = 500;
+}  // namespace reset
 namespace defaults {
 static constexpr auto TYPE = Type::WS2812B;
 static constexpr auto COUNT = 170;
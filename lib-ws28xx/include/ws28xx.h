@@ -71,14 +71,16 @@ public:
 	}
 
 private:
+	void SetupSymbols();
 	void SetupBuffers();
-	void SetColorWS28xx(uint32_t nOffset, uint8_t nValue);
+	void SetColorWS28xx(uint32_t nOffset, const uint8_t *pValues, uint32_t nCount);
 
 private:
 	PixelConfiguration *m_pPixelConfiguration;
 	uint32_t m_nBufSize;
 	uint8_t *m_pBuffer { nullptr };
 	uint8_t *m_pBlackoutBuffer { nullptr };
+	uint64_t m_nSymbols[256];	///< RTZ: colour value (gamma corrected) -> 8 SPI bytes, MSB first
 
 	static WS28xx *s_pThis;
 };
@@ -52,6 +52,10 @@ WS28xx::WS28xx(PixelConfiguration *pPixelConfiguration): m_pPixelConfiguration(p
 	uint32_t nLedsPerPixel;
 	m_pPixelConfiguration->Validate(nLedsPerPixel);
 
+	if (m_pPixelConfiguration->IsRTZProtocol()) {
+		SetupSymbols();
+	}
+
 	const auto nCount = m_pPixelConfiguration->GetCount();
 
 	m_nBufSize = nCount * nLedsPerPixel;
@@ -39,6 +39,8 @@
 #include "pixelconfiguration.h"
 #include "pixeltype.h"
 
+#include "ws28xxmulti_internal.h"
+
 #include "hal_gpio.h"
 #include "hal_spi.h"
 
@@ -218,65 +220,38 @@ uint8_t WS28xxMulti::ReverseBits(uint8_t nBits) {
 	return static_cast<uint8_t>((output >> 24));
 }
 
-#define BIT_SET(a,b) 	((a) |= static_cast<uint8_t>((1<<(b))))
-#define BIT_CLEAR(a,b) 	((a) &= static_cast<uint8_t>(~(1<<(b))))
-
 void WS28xxMulti::SetColour(uint32_t nPortIndex, uint32_t nPixelIndex, uint8_t nColour1, uint8_t nColour2, uint8_t nColour3) {
-	uint32_t j = 0;
-	const uint32_t k = nPixelIndex * pixel::single::RGB;
+	auto *pBuffer = &m_pBuffer[nPixelIndex * pixel::single::RGB];
 
-	for (uint8_t mask = 0x80; mask != 0; mask = static_cast<uint8_t>(mask >> 1)) {
-		if (mask & nColour1) {
-			BIT_SET(m_pBuffer[k + j], nPortIndex);
-		} else {
-			BIT_CLEAR(m_pBuffer[k + j], nPortIndex);
-		}
-		if (mask & nColour2) {
-			BIT_SET(m_pBuffer[8 + k + j], nPortIndex);
-		} else {
-			BIT_CLEAR(m_pBuffer[8 + k + j], nPortIndex);
-		}
-		if (mask & nColour3) {
-			BIT_SET(m_pBuffer[16 + k + j], nPortIndex);
-		} else {
-			BIT_CLEAR(m_pBuffer[16 + k + j], nPortIndex);
-		}
-
-		j++;
-	}
+	encode_byte(&pBuffer[0], nPortIndex, nColour1);
+	encode_byte(&pBuffer[8], nPortIndex, nColour2);
+	encode_byte(&pBuffer[16], nPortIndex, nColour3);
 }
 
 void WS28xxMulti::SetPixel4Bytes(uint32_t nPortIndex, uint32_t nPixelIndex, uint8_t nRed, uint8_t nGreen, uint8_t nBlue, uint8_t nWhite) {
-	const auto k = nPixelIndex * pixel::single::RGBW;
-	uint32_t j = 0;
+	auto *pBuffer = &m_pBuffer[nPixelIndex * pixel::single::RGBW];
 
-	for (uint8_t mask = 0x80; mask != 0; mask = static_cast<uint8_t>(mask >> 1)) {
-		// GRBW
-		if (mask & nGreen) {
-			BIT_SET(m_pBuffer[k + j], nPortIndex);
-		} else {
-			BIT_CLEAR(m_pBuffer[k + j], nPortIndex);
-		}
-
-		if (mask & nRed) {
-			BIT_SET(m_pBuffer[8 + k + j], nPortIndex);
-		} else {
-			BIT_CLEAR(m_pBuffer[8 + k + j], nPortIndex);
-		}
+	// GRBW
+	encode_byte(&pBuffer[0], nPortIndex, nGreen);
+	encode_byte(&pBuffer[8], nPortIndex, nRed);
+	encode_byte(&pBuffer[16], nPortIndex, nBlue);
+	encode_byte(&pBuffer[24], nPortIndex, nWhite);
+}
 
-		if (mask & nBlue) {
-			BIT_SET(m_pBuffer[16 + k + j], nPortIndex);
-		} else {
-			BIT_CLEAR(m_pBuffer[16 + k + j], nPortIndex);
-		}
+/**
+ * Batch encode for one port.
+ * @param nOffset the first byte, in the order as sent on the wire
+ * @param pBytes the bytes, already in the order as sent on the wire (and gamma corrected)
+ */
+void WS28xxMulti::SetBytes(uint32_t nPortIndex, uint32_t nOffset, const uint8_t *pBytes, uint32_t nLength) {
+	assert(nPortIndex < 8);
+	assert(((nOffset + nLength) * 8) <= m_nBufSize);
 
-		if (mask & nWhite) {
-			BIT_SET(m_pBuffer[24 + k + j], nPortIndex);
-		} else {
-			BIT_CLEAR(m_pBuffer[24 + k + j], nPortIndex);
-		}
+	auto *pBuffer = &m_pBuffer[nOffset * 8];
 
-		j++;
+	for (uint32_t i = 0; i < nLength; i++) {
+		encode_byte(pBuffer, nPortIndex, pBytes[i]);
+		pBuffer += 8;
 	}
 }
 
@@ -321,37 +296,7 @@ void WS28xxMulti::SetPixel(uint32_t nPortIndex, uint32_t nPixelIndex, uint8_t nR
 	nWhite = pGammaTable[nWhite];
 #endif
 
-	const auto k = nPixelIndex * pixel::single::RGBW;
-	uint32_t j = 0;
-
-	for (uint8_t mask = 0x80; mask != 0; mask = static_cast<uint8_t>(mask >> 1)) {
-		// GRBW
-		if (mask & nGreen) {
-			BIT_SET(m_pBuffer[k + j], nPortIndex);
-		} else {
-			BIT_CLEAR(m_pBuffer[k + j], nPortIndex);
-		}
-
-		if (mask & nRed) {
-			BIT_SET(m_pBuffer[8 + k + j], nPortIndex);
-		} else {
-			BIT_CLEAR(m_pBuffer[8 + k + j], nPortIndex);
-		}
-
-		if (mask & nBlue) {
-			BIT_SET(m_pBuffer[16 + k + j], nPortIndex);
-		} else {
-			BIT_CLEAR(m_pBuffer[16 + k + j], nPortIndex);
-		}
-
-		if (mask & nWhite) {
-			BIT_SET(m_pBuffer[24 + k + j], nPortIndex);
-		} else {
-			BIT_CLEAR(m_pBuffer[24 + k + j], nPortIndex);
-		}
-
-		j++;
-	}
+	SetPixel4Bytes(nPortIndex, nPixelIndex, nRed, nGreen, nBlue, nWhite);
 }
 
 inline void memcpy64(void *dest, void const *src, size_t n) {
@@ -379,6 +324,12 @@ void WS28xxMulti::Update() {
 	FUNC_PREFIX(spi_dma_tx_start(m_pDmaBuffer, m_nBufSize));
 }
 
+void WS28xxMulti::UpdateBlackout() {
+	assert(!FUNC_PREFIX(spi_dma_tx_is_active()));
+
+	FUNC_PREFIX(spi_dma_tx_start(m_pDmaBufferBlackout, m_nBufSize));
+}
+
 void WS28xxMulti::Blackout() {
 	DEBUG_ENTRY
 
@@ -397,14 +348,7 @@ void WS28xxMulti::Blackout() {
 	DEBUG_EXIT
 }
 
-void WS28xxMulti::FullOn() {
-	DEBUG_ENTRY
-
-	// Can be called any time.
-	do {
-		asm volatile ("isb" ::: "memory");
-	} while (FUNC_PREFIX(spi_dma_tx_is_active()));
-
+void WS28xxMulti::SetFullOn() {
 	const auto type = m_PixelConfiguration.GetType();
 
 	if ((type == Type::APA102) || (type == Type::SK9822) || (type == Type::P9813)) {
@@ -426,7 +370,17 @@ void WS28xxMulti::FullOn() {
 	} else {
 		memset(m_pBuffer, 0xFF, m_nBufSize);
 	}
+}
+
+void WS28xxMulti::FullOn() {
+	DEBUG_ENTRY
+
+	// Can be called any time.
+	do {
+		asm volatile ("isb" ::: "memory");
+	} while (FUNC_PREFIX(spi_dma_tx_is_active()));
 
+	SetFullOn();
 	Update();
 
 	// May not be interrupted.
@@ -0,0 +1,55 @@
+/**
+ * @file ws28xxmulti_internal.h
+ *
+ */
+/* Copyright (C) 2024 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef H3_WS28XXMULTI_INTERNAL_H_
+#define H3_WS28XXMULTI_INTERNAL_H_
+
+#include <cstdint>
+#include <cstring>
+
+/*
+ * Each colour byte is sent as 8 bytes, MSB first.
+ * Bit n of such a byte is the bit for port n.
+ */
+
+/**
+ * Spread the bits of nByte, MSB first, over the LSB of 8 bytes.
+ */
+inline uint64_t spread(const uint8_t nByte) {
+	const auto x = (static_cast<uint64_t>(nByte) * 0x0101010101010101ULL) & 0x0102040810204080ULL;
+	return ((x + 0x7F7F7F7F7F7F7F7FULL) >> 7) & 0x0101010101010101ULL;
+}
+
+/**
+ * Replace the bit of one port in the 8 bytes of a colour byte.
+ */
+inline void encode_byte(uint8_t *pBuffer, const uint32_t nPortIndex, const uint8_t nByte) {
+	uint64_t nBits;
+	memcpy(&nBits, pBuffer, sizeof(uint64_t));
+	nBits = (nBits & ~(0x0101010101010101ULL << nPortIndex)) | (spread(nByte) << nPortIndex);
+	memcpy(pBuffer, &nBits, sizeof(uint64_t));
+}
+
+#endif /* H3_WS28XXMULTI_INTERNAL_H_ */
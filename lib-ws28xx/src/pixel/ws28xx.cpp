@@ -39,29 +39,72 @@
 
 #include "gamma/gamma_tables.h"
 
-void WS28xx::SetColorWS28xx(uint32_t nOffset, uint8_t nValue) {
+/**
+ * Build the RTZ symbol table, once the low and high codes are known.
+ * The gamma correction is part of the table.
+ */
+void WS28xx::SetupSymbols() {
+	const auto nLowCode = m_pPixelConfiguration->GetLowCode();
+	const auto nHighCode = m_pPixelConfiguration->GetHighCode();
+#if defined(CONFIG_PIXELDMX_ENABLE_GAMMATABLE)
+	const auto pGammaTable = m_pPixelConfiguration->GetGammaTable();
+#endif
+
+	for (uint32_t nValue = 0; nValue < 256; nValue++) {
+#if defined(CONFIG_PIXELDMX_ENABLE_GAMMATABLE)
+		const auto nColour = pGammaTable[nValue];
+#else
+		const auto nColour = nValue;
+#endif
+		uint64_t nSymbol = 0;
+
+		for (uint32_t i = 0; i < 8; i++) {
+			const uint64_t nCode = (nColour & (0x80U >> i)) ? nHighCode : nLowCode;
+			nSymbol |= nCode << (i * 8);
+		}
+
+		m_nSymbols[nValue] = nSymbol;
+	}
+}
+
+/**
+ * The RTZ data starts at m_pBuffer[1], after the leading 0x00.
+ * The DMA buffer is strongly-ordered memory, hence only aligned words are written.
+ * m_pBuffer[nOffset] is word aligned and holds the last byte of the previous colour.
+ */
+void WS28xx::SetColorWS28xx(uint32_t nOffset, const uint8_t *pValues, uint32_t nCount) {
 	assert(m_pPixelConfiguration->GetType() != pixel::Type::WS2801);
 	assert(m_pBuffer != nullptr);
-	assert(nOffset + 7 < m_nBufSize);
+	assert(nOffset + (nCount * 8) < m_nBufSize);
+	assert((reinterpret_cast<uintptr_t>(&m_pBuffer[nOffset]) & 0x3) == 0);
 
-	nOffset += 1;
+	auto *pBuffer = &m_pBuffer[nOffset];
+	uint32_t nCarry = pBuffer[0];
 
-	const auto nLowCode = m_pPixelConfiguration->GetLowCode();
-	const auto nHighCode = m_pPixelConfiguration->GetHighCode();
+	for (uint32_t i = 0; i < nCount; i++) {
+		const auto nSymbol = m_nSymbols[pValues[i]];
+		const auto nLow = static_cast<uint32_t>(nSymbol);
+		const auto nHigh = static_cast<uint32_t>(nSymbol >> 32);
 
-	for (uint8_t mask = 0x80; mask != 0; mask = static_cast<uint8_t>(mask >> 1)) {
-		if (nValue & mask) {
-			m_pBuffer[nOffset] = nHighCode;
-		} else {
-			m_pBuffer[nOffset] = nLowCode;
-		}
-		nOffset++;
+		reinterpret_cast<uint32_t *>(pBuffer)[0] = nCarry | (nLow << 8);
+		reinterpret_cast<uint32_t *>(pBuffer)[1] = (nLow >> 24) | (nHigh << 8);
+
+		nCarry = nHigh >> 24;
+		pBuffer += 8;
 	}
+
+	pBuffer[0] = static_cast<uint8_t>(nCarry);
 }
 
 void WS28xx::SetPixel(uint32_t nPixelIndex, uint8_t nRed, uint8_t nGreen, uint8_t nBlue) {
 	assert(nPixelIndex < m_pPixelConfiguration->GetCount());
 
+	if (m_pPixelConfiguration->IsRTZProtocol()) {
+		const uint8_t nValues[3] = { nRed, nGreen, nBlue };
+		SetColorWS28xx(nPixelIndex * 24U, nValues, 3);
+		return;
+	}
+
 #if defined(CONFIG_PIXELDMX_ENABLE_GAMMATABLE)
 	const auto pGammaTable = m_pPixelConfiguration->GetGammaTable();
 
@@ -70,15 +113,6 @@ void WS28xx::SetPixel(uint32_t nPixelIndex, uint8_t nRed, uint8_t nGreen, uint8_
 	nBlue = pGammaTable[nBlue];
 #endif
 
-	if (m_pPixelConfiguration->IsRTZProtocol()) {
-		const auto nOffset = nPixelIndex * 24U;
-
-		SetColorWS28xx(nOffset, nRed);
-		SetColorWS28xx(nOffset + 8, nGreen);
-		SetColorWS28xx(nOffset + 16, nBlue);
-		return;
-	}
-
 	assert(m_pBuffer != nullptr);
 
 	const auto type = m_pPixelConfiguration->GetType();
@@ -128,19 +162,6 @@ void WS28xx::SetPixel(uint32_t nPixelIndex, uint8_t nRed, uint8_t nGreen, uint8_
 	assert(nPixelIndex < m_pPixelConfiguration->GetCount());
 	assert(m_pPixelConfiguration->GetType() == pixel::Type::SK6812W);
 
-#if defined(CONFIG_PIXELDMX_ENABLE_GAMMATABLE)
-	const auto pGammaTable = m_pPixelConfiguration->GetGammaTable();
-
-	nRed = pGammaTable[nRed];
-	nGreen = pGammaTable[nGreen];
-	nBlue = pGammaTable[nBlue];
-	nWhite = pGammaTable[nWhite];
-#endif
-
-	const auto nOffset = nPixelIndex * 32U;
-
-	SetColorWS28xx(nOffset, nGreen);
-	SetColorWS28xx(nOffset + 8, nRed);
-	SetColorWS28xx(nOffset + 16, nBlue);
-	SetColorWS28xx(nOffset + 24, nWhite);
+	const uint8_t nValues[4] = { nGreen, nRed, nBlue, nWhite };
+	SetColorWS28xx(nPixelIndex * 32U, nValues, 4);
 }
@@ -119,6 +119,31 @@ void PixelConfiguration::Validate(uint32_t& nLedsPerPixel) {
 	DEBUG_EXIT
 }
 
+uint32_t PixelConfiguration::GetRefreshMicros() const {
+	if (m_nClockSpeedHz == 0) {
+		return 0;
+	}
+
+	const uint32_t nLedsPerPixel = (m_type == Type::SK6812W) ? 4 : 3;
+	uint64_t nBits;
+	uint32_t nResetMicros;
+
+	if (m_bIsRTZProtocol) {
+		// Each bit is 8 clock cycles
+		nBits = static_cast<uint64_t>(m_nCount) * nLedsPerPixel * 8U * 8U;
+		nResetMicros = reset::rtz_us;
+	} else if (m_type == Type::WS2801) {
+		nBits = static_cast<uint64_t>(m_nCount) * nLedsPerPixel * 8U;
+		nResetMicros = reset::ws2801_us;
+	} else {
+		// Start frame, 32 bits per pixel, end frame
+		nBits = (static_cast<uint64_t>(m_nCount) + 2U) * 32U;
+		nResetMicros = 0;
+	}
+
+	return static_cast<uint32_t>((nBits * 1000000U) / m_nClockSpeedHz) + nResetMicros;
+}
+
 void PixelConfiguration::GetTxH(Type type, uint8_t &nLowCode, uint8_t &nHighCode) {
 	nLowCode = 0xC0;
 	nHighCode = (type == Type::WS2812B ? 0xF8 :
@@ -143,6 +168,7 @@ void PixelConfiguration::Print() {
 	}
 
 	printf(" Clock: %u Hz\n", static_cast<unsigned int>(m_nClockSpeedHz));
+	printf(" Refresh: %u us\n", static_cast<unsigned int>(GetRefreshMicros()));
 
 #if defined (CONFIG_PIXELDMX_ENABLE_GAMMATABLE)
 	printf(" Gamma correction %s\n", m_bEnableGammaCorrection ? "Yes" :  "No");
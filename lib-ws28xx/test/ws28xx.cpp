@@ -0,0 +1,244 @@
+/**
+ * @file ws28xx.cpp
+ *
+ */
+/* Copyright (C) 2024 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "ws28xx.h"
+#include "pixelconfiguration.h"
+#include "pixeltype.h"
+
+#include "hosttest.h"
+
+/*
+ * The platform part of WS28xx for the host, see src/h3/ws28xx.cpp
+ * Update() copies the SPI data out.
+ */
+
+static constexpr uint32_t RGB_BYTES = pixel::max::ledcount::RGB * pixel::single::RGB;
+static constexpr uint32_t RGBW_BYTES = pixel::max::ledcount::RGBW * pixel::single::RGBW;
+
+static uint8_t s_Wire[1 + (RGB_BYTES > RGBW_BYTES ? RGB_BYTES : RGBW_BYTES)];
+static uint32_t s_nWireLength;
+
+WS28xx *WS28xx::s_pThis;
+
+WS28xx::WS28xx(PixelConfiguration *pPixelConfiguration): m_pPixelConfiguration(pPixelConfiguration) {
+	s_pThis = this;
+
+	uint32_t nLedsPerPixel;
+	m_pPixelConfiguration->Validate(nLedsPerPixel);
+
+	if (m_pPixelConfiguration->IsRTZProtocol()) {
+		SetupSymbols();
+	}
+
+	m_nBufSize = (m_pPixelConfiguration->GetCount() * nLedsPerPixel * 8) + 1;
+
+	SetupBuffers();
+}
+
+WS28xx::~WS28xx() {
+	delete [] m_pBuffer;
+	m_pBuffer = nullptr;
+
+	s_pThis = nullptr;
+}
+
+void WS28xx::SetupBuffers() {
+	m_pBuffer = new uint8_t[m_nBufSize];
+	m_pBuffer[0] = 0x00;
+	memset(&m_pBuffer[1], m_pPixelConfiguration->GetLowCode(), m_nBufSize - 1);
+}
+
+void WS28xx::Update() {
+	memcpy(s_Wire, m_pBuffer, m_nBufSize);
+	s_nWireLength = m_nBufSize;
+}
+
+/*
+ * The encoder before the symbol table: gamma correction, then a branch per bit
+ */
+struct Reference {
+	uint8_t buffer[sizeof(s_Wire)];
+	uint8_t nLowCode;
+	uint8_t nHighCode;
+	const uint8_t *pGammaTable;
+
+	void SetColorWS28xx(uint32_t nOffset, uint8_t nValue) {
+		nOffset += 1;
+
+		for (uint8_t mask = 0x80; mask != 0; mask = static_cast<uint8_t>(mask >> 1)) {
+			if (nValue & mask) {
+				buffer[nOffset] = nHighCode;
+			} else {
+				buffer[nOffset] = nLowCode;
+			}
+			nOffset++;
+		}
+	}
+
+	__attribute__((noinline)) void SetPixel(uint32_t nPixelIndex, uint8_t nRed, uint8_t nGreen, uint8_t nBlue) {
+		const auto nOffset = nPixelIndex * 24U;
+
+		SetColorWS28xx(nOffset, pGammaTable[nRed]);
+		SetColorWS28xx(nOffset + 8, pGammaTable[nGreen]);
+		SetColorWS28xx(nOffset + 16, pGammaTable[nBlue]);
+	}
+
+	__attribute__((noinline)) void SetPixel(uint32_t nPixelIndex, uint8_t nRed, uint8_t nGreen, uint8_t nBlue, uint8_t nWhite) {
+		const auto nOffset = nPixelIndex * 32U;
+
+		SetColorWS28xx(nOffset, pGammaTable[nGreen]);
+		SetColorWS28xx(nOffset + 8, pGammaTable[nRed]);
+		SetColorWS28xx(nOffset + 16, pGammaTable[nBlue]);
+		SetColorWS28xx(nOffset + 24, pGammaTable[nWhite]);
+	}
+};
+
+static uint8_t random_byte() {
+	return static_cast<uint8_t>(rand());
+}
+
+static void check_type(const pixel::Type type, const bool bGamma) {
+	PixelConfiguration pixelConfiguration;
+	pixelConfiguration.SetType(type);
+	pixelConfiguration.SetCount(pixel::max::ledcount::RGB);
+	pixelConfiguration.SetEnableGammaCorrection(bGamma);
+
+	auto *pWS28xx = new WS28xx(&pixelConfiguration);
+	const auto nCount = pixelConfiguration.GetCount();
+	const auto isRGBW = (type == pixel::Type::SK6812W);
+
+	static Reference reference;
+	reference.nLowCode = pixelConfiguration.GetLowCode();
+	reference.nHighCode = pixelConfiguration.GetHighCode();
+	reference.pGammaTable = pixelConfiguration.GetGammaTable();
+	reference.buffer[0] = 0x00;
+	memset(&reference.buffer[1], reference.nLowCode, sizeof(reference.buffer) - 1);
+
+	// All values on each colour, then random pixels in a random order
+	for (uint32_t i = 0; i < (nCount * 4); i++) {
+		const auto nPixelIndex = (i < nCount) ? i : static_cast<uint32_t>(rand()) % nCount;
+		const auto nValue = static_cast<uint8_t>(i);
+		const auto nRed = (i < nCount) ? nValue : random_byte();
+		const auto nGreen = (i < nCount) ? static_cast<uint8_t>(~nValue) : random_byte();
+		const auto nBlue = (i < nCount) ? static_cast<uint8_t>(nValue * 7) : random_byte();
+
+		if (isRGBW) {
+			const auto nWhite = random_byte();
+			pWS28xx->SetPixel(nPixelIndex, nRed, nGreen, nBlue, nWhite);
+			reference.SetPixel(nPixelIndex, nRed, nGreen, nBlue, nWhite);
+		} else {
+			pWS28xx->SetPixel(nPixelIndex, nRed, nGreen, nBlue);
+			reference.SetPixel(nPixelIndex, nRed, nGreen, nBlue);
+		}
+	}
+
+	pWS28xx->Update();
+
+	if (!HOSTTEST_CHECK(memcmp(s_Wire, reference.buffer, s_nWireLength) == 0)) {
+		fprintf(stderr, "  type %s, gamma %d\n", PixelType::GetType(type), bGamma);
+	}
+
+	delete pWS28xx;
+}
+
+static void bench(const pixel::Type type) {
+	static constexpr uint32_t ITERATIONS = 20000;
+	static constexpr uint32_t PIXELS = 170;
+
+	PixelConfiguration pixelConfiguration;
+	pixelConfiguration.SetType(type);
+	pixelConfiguration.SetCount(PIXELS);
+
+	auto *pWS28xx = new WS28xx(&pixelConfiguration);
+
+	static Reference reference;
+	reference.nLowCode = pixelConfiguration.GetLowCode();
+	reference.nHighCode = pixelConfiguration.GetHighCode();
+	reference.pGammaTable = pixelConfiguration.GetGammaTable();
+
+	uint8_t colours[PIXELS][4];
+	for (auto& colour : colours) {
+		for (auto& nValue : colour) {
+			nValue = random_byte();
+		}
+	}
+
+	const auto isRGBW = (type == pixel::Type::SK6812W);
+
+	printf("Encode %u %s pixels\n", PIXELS, PixelType::GetType(type));
+
+	const auto fBits = hosttest::bench("bit loop (before)", ITERATIONS, [&]() {
+		for (uint32_t i = 0; i < PIXELS; i++) {
+			if (isRGBW) {
+				reference.SetPixel(i, colours[i][0], colours[i][1], colours[i][2], colours[i][3]);
+			} else {
+				reference.SetPixel(i, colours[i][0], colours[i][1], colours[i][2]);
+			}
+		}
+		hosttest::keep(reference.buffer);
+	});
+
+	const auto fTable = hosttest::bench("symbol table", ITERATIONS, [&]() {
+		for (uint32_t i = 0; i < PIXELS; i++) {
+			if (isRGBW) {
+				pWS28xx->SetPixel(i, colours[i][0], colours[i][1], colours[i][2], colours[i][3]);
+			} else {
+				pWS28xx->SetPixel(i, colours[i][0], colours[i][1], colours[i][2]);
+			}
+		}
+		hosttest::keep(pWS28xx);
+	});
+
+	printf("  pixels/us: bit loop %.1f, symbol table %.1f\n", PIXELS * 1e3 / fBits, PIXELS * 1e3 / fTable);
+
+	delete pWS28xx;
+}
+
+int main(int argc, char **argv) {
+	srand(1);
+
+	for (uint32_t i = 0; i < static_cast<uint32_t>(pixel::Type::UNDEFINED); i++) {
+		const auto type = static_cast<pixel::Type>(i);
+
+		if ((type == pixel::Type::WS2801) || (type == pixel::Type::APA102) || (type == pixel::Type::SK9822) || (type == pixel::Type::P9813)) {
+			continue;
+		}
+
+		check_type(type, false);
+		check_type(type, true);
+	}
+
+	if (hosttest::is_bench(argc, argv)) {
+		bench(pixel::Type::WS2812B);
+		bench(pixel::Type::SK6812W);
+	}
+
+	return hosttest::exit_code("ws28xx");
+}
@@ -0,0 +1,163 @@
+/**
+ * @file ws28xxmulti.cpp
+ *
+ */
+/* Copyright (C) 2024 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "ws28xxmulti_internal.h"
+
+#include "hosttest.h"
+
+static constexpr uint32_t PORTS = 8;
+static constexpr uint32_t PIXELS = 170;
+static constexpr uint32_t BYTES = PIXELS * 3;	///< Colour bytes per port
+
+#define BIT_SET(a,b) 	((a) |= static_cast<uint8_t>((1<<(b))))
+#define BIT_CLEAR(a,b) 	((a) &= static_cast<uint8_t>(~(1<<(b))))
+
+/*
+ * The encoder before the bit slicing: a read-modify-write per bit
+ */
+__attribute__((noinline)) static void encode_bits(uint8_t *pBuffer, const uint32_t nPortIndex, const uint8_t *pBytes, const uint32_t nLength) {
+	for (uint32_t i = 0; i < nLength; i++) {
+		uint32_t j = 0;
+
+		for (uint8_t mask = 0x80; mask != 0; mask = static_cast<uint8_t>(mask >> 1)) {
+			if (mask & pBytes[i]) {
+				BIT_SET(pBuffer[(i * 8) + j], nPortIndex);
+			} else {
+				BIT_CLEAR(pBuffer[(i * 8) + j], nPortIndex);
+			}
+			j++;
+		}
+	}
+}
+
+/*
+ * As WS28xxMulti::SetBytes(nPortIndex, ...)
+ */
+__attribute__((noinline)) static void encode_port(uint8_t *pBuffer, const uint32_t nPortIndex, const uint8_t *pBytes, const uint32_t nLength) {
+	for (uint32_t i = 0; i < nLength; i++) {
+		encode_byte(pBuffer, nPortIndex, pBytes[i]);
+		pBuffer += 8;
+	}
+}
+
+static void fill(uint8_t *pData, const uint32_t nLength) {
+	for (uint32_t i = 0; i < nLength; i++) {
+		pData[i] = static_cast<uint8_t>(rand());
+	}
+}
+
+static void check_encode_byte() {
+	uint32_t nFailed = 0;
+
+	for (uint32_t nPortIndex = 0; nPortIndex < PORTS; nPortIndex++) {
+		for (uint32_t nValue = 0; nValue < 256; nValue++) {
+			uint8_t buffer[8], bufferRef[8];
+			fill(buffer, sizeof(buffer));
+			memcpy(bufferRef, buffer, sizeof(buffer));
+
+			const auto nByte = static_cast<uint8_t>(nValue);
+			encode_byte(buffer, nPortIndex, nByte);
+			encode_bits(bufferRef, nPortIndex, &nByte, 1);
+
+			if (memcmp(buffer, bufferRef, sizeof(buffer)) != 0) {
+				nFailed++;
+			}
+		}
+	}
+
+	HOSTTEST_CHECK(nFailed == 0);
+}
+
+static void check_encode_port() {
+	static uint8_t rows[PORTS][BYTES];
+	static uint8_t buffer[BYTES * 8], bufferRef[BYTES * 8];
+
+	for (uint32_t nRun = 0; nRun < 16; nRun++) {
+		fill(&rows[0][0], sizeof(rows));
+		fill(buffer, sizeof(buffer));
+		memcpy(bufferRef, buffer, sizeof(buffer));
+
+		for (uint32_t nPortIndex = 0; nPortIndex < PORTS; nPortIndex++) {
+			encode_port(buffer, nPortIndex, rows[nPortIndex], BYTES);
+			encode_bits(bufferRef, nPortIndex, rows[nPortIndex], BYTES);
+		}
+
+		HOSTTEST_CHECK(memcmp(buffer, bufferRef, sizeof(buffer)) == 0);
+
+		// One port updated, the other ports must be kept
+		const auto nPortIndex = nRun % PORTS;
+		fill(rows[nPortIndex], BYTES);
+
+		encode_port(buffer, nPortIndex, rows[nPortIndex], BYTES);
+		encode_bits(bufferRef, nPortIndex, rows[nPortIndex], BYTES);
+
+		HOSTTEST_CHECK(memcmp(buffer, bufferRef, sizeof(buffer)) == 0);
+	}
+}
+
+static void bench() {
+	static constexpr uint32_t ITERATIONS = 20000;
+	static uint8_t rows[PORTS][BYTES];
+	static uint8_t buffer[BYTES * 8];
+
+	fill(&rows[0][0], sizeof(rows));
+
+	printf("Encode %u RGB pixels on %u ports\n", PIXELS, PORTS);
+
+	const auto fBits = hosttest::bench("bit loop (before)", ITERATIONS, [&]() {
+		for (uint32_t nPortIndex = 0; nPortIndex < PORTS; nPortIndex++) {
+			encode_bits(buffer, nPortIndex, rows[nPortIndex], BYTES);
+		}
+		hosttest::keep(buffer);
+	});
+
+	const auto fPort = hosttest::bench("encode_byte, per port", ITERATIONS, [&]() {
+		for (uint32_t nPortIndex = 0; nPortIndex < PORTS; nPortIndex++) {
+			encode_port(buffer, nPortIndex, rows[nPortIndex], BYTES);
+		}
+		hosttest::keep(buffer);
+	});
+
+	const auto nPixels = PIXELS * PORTS * 1e3;
+	printf("  pixels/us: bit loop %.1f, per port %.1f\n", nPixels / fBits, nPixels / fPort);
+}
+
+int main(int argc, char **argv) {
+	srand(1);
+
+	check_encode_byte();
+	check_encode_port();
+
+	if (hosttest::is_bench(argc, argv)) {
+		bench();
+	}
+
+	return hosttest::exit_code("ws28xxmulti");
+}
@@ -11,6 +11,9 @@ ifneq ($(MAKE_FLAGS),)
  ifneq (,$(findstring OUTPUT_DMX_PIXEL_MULTI,$(MAKE_FLAGS)))
  	 EXTRA_SRCDIR+=src/dmxmulti
   endif
+	ifneq (,$(findstring NODE_DDP_DISPLAY,$(MAKE_FLAGS)))
+		EXTRA_INCLUDES+=../lib-ddp/include
+	endif
 	ifneq (,$(findstring CONFIG_RDM_ENABLE_MANUFACTURER_PIDS,$(MAKE_FLAGS)))
 		EXTRA_INCLUDES+=../lib-rdm/include
 		EXTRA_SRCDIR+=src/rdm
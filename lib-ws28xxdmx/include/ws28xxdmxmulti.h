@@ -27,6 +27,7 @@
 #define WS28XXDMXMULTI_H_
 
 #include <cstdint>
+#include <algorithm>
 #include <cassert>
 
 #include "lightset.h"
@@ -39,14 +40,98 @@
 
 #include "logic_analyzer.h"
 
+#if defined (NODE_DDP_DISPLAY)
+# include "ddpdisplayoutput.h"
+#endif
+
+#if defined (H3)
+# include "h3_hs_timer.h"
+#endif
+
+#if defined (CONFIG_PIXELDMX_ENABLE_CORE1)
+# if !defined (H3)
+#  error CONFIG_PIXELDMX_ENABLE_CORE1 is H3 only
+# endif
+# if !defined (ARM_ALLOW_MULTI_CORE)
+#  error CONFIG_PIXELDMX_ENABLE_CORE1 needs ARM_ALLOW_MULTI_CORE
+# endif
+#endif
+
 namespace ws28xxdmxmulti {
 #if !defined (CONFIG_PIXELDMX_MAX_PORTS)
 # define CONFIG_PIXELDMX_MAX_PORTS	8
 #endif
 static constexpr auto MAX_PORTS = CONFIG_PIXELDMX_MAX_PORTS;
+static constexpr auto MAX_UNIVERSES = MAX_PORTS * 4;
+
+/**
+ * Arguments for the encode kernels, which are selected once in the constructor.
+ */
+struct Pixels {
+	WS28xxMulti *pWS28xxMulti;
+	const uint8_t *pData;
+	uint32_t nOutIndex;
+	uint32_t nBeginIndex;
+	uint32_t nEndIndex;
+	uint32_t nGroupingCount;
+#if defined (CONFIG_PIXELDMX_ENABLE_GAMMATABLE)
+	const uint8_t *pGammaTable;
+#endif
+};
+
+typedef void (*SetPixels)(const Pixels& pixels);
+
+struct EncodeTime {
+	uint32_t nLast;	///< microseconds
+	uint32_t nMax;	///< microseconds
+};
+
+struct Refresh {
+	uint32_t nFrames;	///< Presented with new data for the output port
+	uint32_t nDropped;	///< Replaced by a newer frame before it was presented
+	uint32_t nFps;		///< Presented during the last second
+};
+
+#if defined (CONFIG_PIXELDMX_ENABLE_CORE1)
+/**
+ * Frame hand-off from core 0 (network receive and merge) to core 1 (encode and DMA start).
+ * Single producer, single consumer: only core 0 writes nProduced, only core 1 writes nConsumed.
+ * Frame (n % FRAMES) is owned by core 0 while (nProduced - nConsumed) < FRAMES.
+ */
+namespace core1 {
+static constexpr uint32_t FRAMES = 2;
+
+struct Slot {
+	uint16_t nLength;		///< 0 : not changed
+	uint16_t nPixelOffset;
+	uint8_t data[lightset::dmx::UNIVERSE_SIZE];	///< The changed slots, starting at nPixelOffset
+};
+
+struct Frame {
+	uint32_t nPorts;
+	Slot slot[MAX_UNIVERSES];
+};
+
+struct Stats {
+	uint32_t nFrames;			///< Encoded by core 1
+	uint32_t nUniverses;		///< Encoded by core 1
+	uint32_t nEncodeMicros;		///< Core 1 busy time, nUniverses / nEncodeMicros is the encode rate
+	uint32_t nProducerWaits;	///< Core 0 had to wait for a free frame
+};
+
+struct Rate {
+	uint32_t nUniverses;		///< Encoded by core 1 during the last second
+	uint32_t nLoad;				///< Core 1 busy during the last second, percent
+};
+}  // namespace core1
+#endif
 }  // namespace ws28xxdmxmulti
 
-class WS28xxDmxMulti final: public LightSet {
+class WS28xxDmxMulti final: public LightSet
+#if defined (NODE_DDP_DISPLAY)
+	, public DdpDisplayOutput
+#endif
+{
 public:
 	WS28xxDmxMulti(PixelDmxConfiguration& pixelDmxConfiguration);
 	~WS28xxDmxMulti() override;
@@ -54,9 +139,15 @@ public:
 	void Start(const uint32_t nPortIndex) override;
 	void Stop(const uint32_t nPortIndex) override;
 
-	void SetData(const uint32_t nPortIndex, [[maybe_unused]] const uint8_t *pData, [[maybe_unused]] uint32_t nLength, const bool doUpdate) override {
+	void SetData(const uint32_t nPortIndex, const uint8_t *pData, uint32_t nLength, const bool doUpdate) override {
+		SetDataRange(nPortIndex, pData, nLength, 0, nLength, doUpdate);
+	}
+
+	void SetDataRange(const uint32_t nPortIndex, [[maybe_unused]] const uint8_t *pData, [[maybe_unused]] uint32_t nLength, const uint32_t nOffset, const uint32_t nCount, const bool doUpdate) override {
 		logic_analyzer::ch0_set();
 
+		SetChanged(nPortIndex, nOffset, nOffset + nCount);
+
 		if (!doUpdate) {
 			logic_analyzer::ch0_clear();
 			return;
@@ -64,53 +155,39 @@ public:
 
 		if (nPortIndex == m_PortInfo.nProtocolPortIndexLast) {
 			logic_analyzer::ch1_set();
-
+#if defined (CONFIG_PIXELDMX_ENABLE_CORE1)
+			Publish();
+#else
 			for (uint32_t nIndex = 0 ; nIndex <= m_PortInfo.nProtocolPortIndexLast;nIndex++) {
 				logic_analyzer::ch2_set();
-				SetData(nIndex, lightset::Data::Backup(nIndex), lightset::Data::GetLength(nIndex));
+				SetDataChanged(nIndex);
 				logic_analyzer::ch2_clear();
 			}
-
-#if defined (H3)
-			logic_analyzer::ch3_set();
-
-			while (m_pWS28xxMulti->IsUpdating()) {
-				// wait for completion
-			}
-
-			logic_analyzer::ch3_clear();
 #endif
-
-			m_pWS28xxMulti->Update();
-
+			Complete();
 			logic_analyzer::ch1_clear();
 		}
 
 		logic_analyzer::ch0_clear();
 	}
 
-	void Sync(const uint32_t nPortIndex) override {
+	void Sync([[maybe_unused]] const uint32_t nPortIndex) override {
+#if !defined (CONFIG_PIXELDMX_ENABLE_CORE1)
 		logic_analyzer::ch2_set();
 
-		SetData(nPortIndex, lightset::Data::Backup(nPortIndex), lightset::Data::GetLength(nPortIndex));
+		SetDataChanged(nPortIndex);
 
 		logic_analyzer::ch2_clear();
+#endif
 	}
 
 	void Sync(const bool doForce) override {
 		if (__builtin_expect((!doForce), 1)) {
 			logic_analyzer::ch1_set();
-
-			logic_analyzer::ch3_set();
-
-			while (m_pWS28xxMulti->IsUpdating()) {
-				// wait for completion
-			}
-
-			logic_analyzer::ch3_clear();
-
-			m_pWS28xxMulti->Update();
-
+#if defined (CONFIG_PIXELDMX_ENABLE_CORE1)
+			Publish();
+#endif
+			Complete();
 			logic_analyzer::ch1_clear();
 		}
 	}
@@ -122,12 +199,52 @@ public:
 	}
 #endif
 
+#if defined (NODE_DDP_DISPLAY)
+	/*
+	 * DdpDisplayOutput
+	 */
+	void SetPixels(const uint32_t nPortIndex, const uint32_t nPixelIndex, const uint8_t *pData, const uint32_t nPixels) override;
+
+	void Update() override {
+		Complete();
+	}
+#endif
+
+	/**
+	 * Presents the newest complete frame as soon as the outputs are ready.
+	 * Called from the main loop, it never waits.
+	 */
+	void Run() {
+		if ((m_bBlackout ? m_bBlackoutPending : m_bUpdatePending) && (m_nFramePorts == 0)) {
+			Present();
+		}
+#if defined (H3)
+		const auto nMicros = h3_hs_timer_lo_us();
+
+		if (__builtin_expect(((nMicros - m_nSecondMicros) >= 1000000U), 0)) {
+			m_nSecondMicros = nMicros;
+
+			for (uint32_t nOutIndex = 0; nOutIndex < ws28xxdmxmulti::MAX_PORTS; nOutIndex++) {
+				auto &refresh = m_Refresh[nOutIndex];
+				refresh.nFps = refresh.nFrames - m_nFramesSecond[nOutIndex];
+				m_nFramesSecond[nOutIndex] = refresh.nFrames;
+			}
+#if defined (CONFIG_PIXELDMX_ENABLE_CORE1)
+			const auto nUniverses = m_Core1Stats.nUniverses;
+			const auto nEncodeMicros = m_Core1Stats.nEncodeMicros;
+			m_Core1Rate.nUniverses = nUniverses - m_Core1Second.nUniverses;
+			m_Core1Rate.nLoad = (nEncodeMicros - m_Core1Second.nEncodeMicros) / 10000U;
+			m_Core1Second.nUniverses = nUniverses;
+			m_Core1Second.nEncodeMicros = nEncodeMicros;
+#endif
+		}
+#endif
+	}
+
 	void Blackout(bool bBlackout) override;
 	void FullOn() override;
 
-	void Print() override {
-		m_pixelDmxConfiguration.Print();
-	}
+	void Print() override;
 
 	pixel::Type GetType() const {
 		return m_pixelDmxConfiguration.GetType();
@@ -161,6 +278,61 @@ public:
 		return m_nChannelsPerPixel;
 	}
 
+	/**
+	 * The time needed for encoding the changed pixels of a universe (H3 only)
+	 */
+	const ws28xxdmxmulti::EncodeTime& GetEncodeTime(const uint32_t nPortIndex) const {
+		assert(nPortIndex < ws28xxdmxmulti::MAX_UNIVERSES);
+		return m_EncodeTime[nPortIndex];
+	}
+
+	/**
+	 * The encode time of an output port: nLast is the sum over its universes, nMax is the maximum of a single universe
+	 */
+	ws28xxdmxmulti::EncodeTime GetOutEncodeTime(const uint32_t nOutIndex) const {
+		assert(nOutIndex < ws28xxdmxmulti::MAX_PORTS);
+#if defined (NODE_DDP_DISPLAY)
+		const uint32_t nUniverses = 4;
+#else
+		const auto nUniverses = m_pixelDmxConfiguration.GetUniverses();
+#endif
+		const auto nEnd = std::min((nOutIndex + 1) * nUniverses, static_cast<uint32_t>(ws28xxdmxmulti::MAX_UNIVERSES));
+		ws28xxdmxmulti::EncodeTime encodeTime {};
+
+		for (auto nPortIndex = nOutIndex * nUniverses; nPortIndex < nEnd; nPortIndex++) {
+			encodeTime.nLast += m_EncodeTime[nPortIndex].nLast;
+			encodeTime.nMax = std::max(encodeTime.nMax, m_EncodeTime[nPortIndex].nMax);
+		}
+
+		return encodeTime;
+	}
+
+	const ws28xxdmxmulti::Refresh& GetRefresh(const uint32_t nOutIndex) const {
+		assert(nOutIndex < ws28xxdmxmulti::MAX_PORTS);
+		return m_Refresh[nOutIndex];
+	}
+
+	/**
+	 * The minimum time between two frames, the ports are sent in parallel
+	 */
+	uint32_t GetRefreshMicros() const {
+		return m_nRefreshMicros;
+	}
+
+#if defined (CONFIG_PIXELDMX_ENABLE_CORE1)
+	const ws28xxdmxmulti::core1::Stats& GetCore1Stats() const {
+		return m_Core1Stats;
+	}
+
+	const ws28xxdmxmulti::core1::Rate& GetCore1Rate() const {
+		return m_Core1Rate;
+	}
+#endif
+
+	static WS28xxDmxMulti *Get() {
+		return s_pThis;
+	}
+
 	// RDMNet LLRP Device Only
 	bool SetDmxStartAddress([[maybe_unused]] uint16_t nDmxStartAddress) override {
 		return false;
@@ -175,7 +347,103 @@ public:
 	}
 
 private:
-	void SetData(const uint32_t nPortIndex, const uint8_t *pData, uint32_t nLength);
+	void SetData(const uint32_t nPortIndex, const uint8_t *pData, uint32_t nLength, const uint32_t nPixelOffset);
+
+	void SetChanged(const uint32_t nPortIndex, const uint32_t nOffset, const uint32_t nEnd) {
+		assert(nPortIndex < ws28xxdmxmulti::MAX_UNIVERSES);
+
+		if (nOffset == nEnd) {
+			return;
+		}
+
+		auto &changed = m_Changed[nPortIndex];
+
+		if (changed.nEnd == 0) {
+			changed.nOffset = static_cast<uint16_t>(nOffset);
+			changed.nEnd = static_cast<uint16_t>(nEnd);
+			return;
+		}
+
+		changed.nOffset = static_cast<uint16_t>(std::min(static_cast<uint32_t>(changed.nOffset), nOffset));
+		changed.nEnd = static_cast<uint16_t>(std::max(static_cast<uint32_t>(changed.nEnd), nEnd));
+	}
+
+	void SetChangedAll() {
+		for (auto &changed : m_Changed) {
+			changed.nOffset = 0;
+			changed.nEnd = lightset::dmx::UNIVERSE_SIZE;
+		}
+	}
+
+	/**
+	 * The changed slots, extended to whole pixels. The changed range is cleared.
+	 * @return false when there are no complete pixels to encode
+	 */
+	bool TakeChanged(const uint32_t nPortIndex, uint32_t& nOffset, uint32_t& nLength, uint32_t& nPixelOffset) {
+		assert(nPortIndex < ws28xxdmxmulti::MAX_UNIVERSES);
+
+		auto &changed = m_Changed[nPortIndex];
+
+		if (changed.nEnd == 0) {
+			return false;
+		}
+
+		nPixelOffset = static_cast<uint32_t>(changed.nOffset) / m_nChannelsPerPixel;
+		nOffset = nPixelOffset * m_nChannelsPerPixel;
+		const auto nEnd = std::min(lightset::Data::GetLength(nPortIndex), static_cast<uint32_t>(changed.nEnd) + m_nChannelsPerPixel - 1U);
+
+		changed.nOffset = 0;
+		changed.nEnd = 0;
+
+		if (nEnd > nOffset) {
+			nLength = nEnd - nOffset;
+			return true;
+		}
+
+		return false;
+	}
+
+	void Encode(const uint32_t nPortIndex, const uint8_t *pData, const uint32_t nLength, const uint32_t nPixelOffset) {
+#if defined (H3)
+		const auto nMicros = h3_hs_timer_lo_us();
+#endif
+		SetData(nPortIndex, pData, nLength, nPixelOffset);
+#if defined (H3)
+		auto &encodeTime = m_EncodeTime[nPortIndex];
+		encodeTime.nLast = h3_hs_timer_lo_us() - nMicros;
+		encodeTime.nMax = std::max(encodeTime.nMax, encodeTime.nLast);
+#endif
+	}
+
+	/**
+	 * Encode the pixels which are covered by the changed slots only
+	 */
+	void SetDataChanged(const uint32_t nPortIndex) {
+		uint32_t nOffset, nLength, nPixelOffset;
+
+		if (TakeChanged(nPortIndex, nOffset, nLength, nPixelOffset)) {
+			Encode(nPortIndex, lightset::Data::Backup(nPortIndex) + nOffset, nLength, nPixelOffset);
+			m_nFramePorts |= (1U << OutIndex(nPortIndex));
+		}
+	}
+
+	uint32_t OutIndex(const uint32_t nPortIndex) const {
+#if defined (NODE_DDP_DISPLAY)
+		return nPortIndex / 4;
+#else
+		return nPortIndex / m_pixelDmxConfiguration.GetUniverses();
+#endif
+	}
+
+	void Complete();
+	void Present();
+
+#if defined (CONFIG_PIXELDMX_ENABLE_CORE1)
+	void Publish();
+	void WaitCore1Idle();
+	void Consume();
+	static void Core1Task();
+#endif
 
 private:
 	PixelDmxConfiguration m_pixelDmxConfiguration;
@@ -183,9 +451,43 @@ private:
 	uint32_t m_nChannelsPerPixel;
 
 	WS28xxMulti *m_pWS28xxMulti { nullptr };
+	ws28xxdmxmulti::SetPixels m_pSetPixels { nullptr };
 
 	uint32_t m_bIsStarted { 0 };
 	bool m_bBlackout { false };
+	bool m_bBlackoutPending { false };
+	bool m_bUpdatePending { false };	///< A complete frame is waiting in the pixel buffer
+	/*
+	 * Refresh scheduler
+	 */
+	uint32_t m_nFramePorts { 0 };		///< Output ports with encoded data of the frame which is not complete yet
+	uint32_t m_nPendingPorts { 0 };		///< Output ports with new data in the waiting frame
+	uint32_t m_nRefreshMicros { 0 };
+	uint32_t m_nPresentMicros { 0 };
+	uint32_t m_nSecondMicros { 0 };
+	uint32_t m_nFramesSecond[ws28xxdmxmulti::MAX_PORTS] {};
+	ws28xxdmxmulti::Refresh m_Refresh[ws28xxdmxmulti::MAX_PORTS] {};
+
+	struct Changed {
+		uint16_t nOffset;
+		uint16_t nEnd;	///< 0 : nothing has changed
+	};
+
+	Changed m_Changed[ws28xxdmxmulti::MAX_UNIVERSES];
+	ws28xxdmxmulti::EncodeTime m_EncodeTime[ws28xxdmxmulti::MAX_UNIVERSES] {};
+
+#if defined (CONFIG_PIXELDMX_ENABLE_CORE1)
+	ws28xxdmxmulti::core1::Frame *m_pFrames { nullptr };
+	volatile uint32_t m_nProduced { 0 };
+	volatile uint32_t m_nConsumed { 0 };
+	ws28xxdmxmulti::core1::Stats m_Core1Stats {};
+	ws28xxdmxmulti::core1::Stats m_Core1Second {};	///< m_Core1Stats at the start of the second
+	ws28xxdmxmulti::core1::Rate m_Core1Rate {};
+
+	static WS28xxDmxMulti *volatile s_pCore1;	///< The instance core 1 encodes for
+#endif
+
+	static WS28xxDmxMulti *s_pThis;
 };
 
 #endif /* WS28XXDMXMULTI_H_ */
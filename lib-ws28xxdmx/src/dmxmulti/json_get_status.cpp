@@ -0,0 +1,84 @@
+/**
+ * @file json_get_status.cpp
+ *
+ */
+/* Copyright (C) 2024 by Arjan van Vught mailto:info@gd32-dmx.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cassert>
+
+#include "ws28xxdmxmulti.h"
+
+namespace remoteconfig {
+namespace pixel {
+static uint32_t get_port(const uint32_t nOutIndex, char *pOutBuffer, const uint32_t nOutBufferSize) {
+	const auto& refresh = WS28xxDmxMulti::Get()->GetRefresh(nOutIndex);
+	const auto encodeTime = WS28xxDmxMulti::Get()->GetOutEncodeTime(nOutIndex);
+	const auto nLength = static_cast<uint32_t>(snprintf(pOutBuffer, nOutBufferSize,
+			"{\"port\":\"%c\",\"frames\":%u,\"dropped\":%u,\"fps\":%u,\"encode\":{\"last\":%u,\"max\":%u}},",
+			static_cast<char>('A' + nOutIndex),
+			static_cast<unsigned int>(refresh.nFrames),
+			static_cast<unsigned int>(refresh.nDropped),
+			static_cast<unsigned int>(refresh.nFps),
+			static_cast<unsigned int>(encodeTime.nLast),
+			static_cast<unsigned int>(encodeTime.nMax)));
+
+	return nLength < nOutBufferSize ? nLength : 0;
+}
+
+uint32_t json_get_status(char *pOutBuffer, const uint32_t nOutBufferSize) {
+	auto *pPixelDmxMulti = WS28xxDmxMulti::Get();
+	assert(pPixelDmxMulti != nullptr);
+
+	auto nLength = static_cast<uint32_t>(snprintf(pOutBuffer, nOutBufferSize,
+			"{\"frametime\":%u,\"ports\":[",
+			static_cast<unsigned int>(pPixelDmxMulti->GetRefreshMicros())));
+
+	for (uint32_t nOutIndex = 0; nOutIndex < pPixelDmxMulti->GetOutputPorts(); nOutIndex++) {
+		nLength += get_port(nOutIndex, &pOutBuffer[nLength], nOutBufferSize - nLength);
+	}
+
+	if (pOutBuffer[nLength - 1] == ',') {
+		nLength--;
+	}
+
+#if defined (CONFIG_PIXELDMX_ENABLE_CORE1)
+	const auto& stats = pPixelDmxMulti->GetCore1Stats();
+	const auto& rate = pPixelDmxMulti->GetCore1Rate();
+
+	nLength += static_cast<uint32_t>(snprintf(&pOutBuffer[nLength], nOutBufferSize - nLength,
+			"],\"core1\":{\"ups\":%u,\"load\":%u,\"frames\":%u,\"universes\":%u,\"waits\":%u}}",
+			static_cast<unsigned int>(rate.nUniverses),
+			static_cast<unsigned int>(rate.nLoad),
+			static_cast<unsigned int>(stats.nFrames),
+			static_cast<unsigned int>(stats.nUniverses),
+			static_cast<unsigned int>(stats.nProducerWaits)));
+#else
+	nLength += static_cast<uint32_t>(snprintf(&pOutBuffer[nLength], nOutBufferSize - nLength, "]}"));
+#endif
+
+	assert(nLength < nOutBufferSize);
+	return nLength;
+}
+}  // namespace pixel
+}  // namespace remoteconfig
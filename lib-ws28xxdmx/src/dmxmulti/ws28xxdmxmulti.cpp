@@ -29,6 +29,7 @@
 #pragma GCC optimize ("-fprefetch-loop-arrays")
 
 #include <cstdint>
+#include <cstdio>
 #include <algorithm>
 #include <cassert>
 
@@ -43,28 +44,253 @@
 # include "hal_gpio.h"
 #endif
 
+#if defined (CONFIG_PIXELDMX_ENABLE_CORE1)
+# include <cstring>
+# include "h3_smp.h"
+# include "arm/synchronize.h"
+#endif
+
 #include "debug.h"
 
+namespace ws28xxdmxmulti {
+#if defined (CONFIG_PIXELDMX_ENABLE_GAMMATABLE)
+static inline uint8_t colour(const Pixels& pixels, const uint8_t nValue) {
+	return pixels.pGammaTable[nValue];
+}
+#else
+static inline uint8_t colour([[maybe_unused]] const Pixels& pixels, const uint8_t nValue) {
+	return nValue;
+}
+#endif
+
+/**
+ * Generic kernel, the pixel type is handled by WS28xxMulti::SetPixel
+ * R, G, B are the slot offsets for the red, green and blue arguments.
+ */
+template<uint32_t R, uint32_t G, uint32_t B, bool isGrouped>
+static void set_pixels(const Pixels& pixels) {
+	auto *pData = pixels.pData;
+
+	for (auto j = pixels.nBeginIndex; j < pixels.nEndIndex; j++) {
+		if constexpr (isGrouped) {
+			const auto nPixelIndexStart = j * pixels.nGroupingCount;
+
+			for (uint32_t k = 0; k < pixels.nGroupingCount; k++) {
+				pixels.pWS28xxMulti->SetPixel(pixels.nOutIndex, nPixelIndexStart + k, pData[R], pData[G], pData[B]);
+			}
+		} else {
+			pixels.pWS28xxMulti->SetPixel(pixels.nOutIndex, j, pData[R], pData[G], pData[B]);
+		}
+
+		pData += 3;
+	}
+}
+
+template<bool isGrouped>
+static void set_pixels_rgbw(const Pixels& pixels) {
+	auto *pData = pixels.pData;
+
+	for (auto j = pixels.nBeginIndex; j < pixels.nEndIndex; j++) {
+		if constexpr (isGrouped) {
+			const auto nPixelIndexStart = j * pixels.nGroupingCount;
+
+			for (uint32_t k = 0; k < pixels.nGroupingCount; k++) {
+				pixels.pWS28xxMulti->SetPixel(pixels.nOutIndex, nPixelIndexStart + k, pData[0], pData[1], pData[2], pData[3]);
+			}
+		} else {
+			pixels.pWS28xxMulti->SetPixel(pixels.nOutIndex, j, pData[0], pData[1], pData[2], pData[3]);
+		}
+
+		pData += 4;
+	}
+}
+
+#if defined (H3)
+/**
+ * RTZ and WS2801: 3 bytes per pixel, sent in the mapped order.
+ * The pixels are mapped (and gamma corrected) into a row, which is encoded with one WS28xxMulti::SetBytes.
+ */
+template<uint32_t R, uint32_t G, uint32_t B, bool isGrouped>
+static void set_bytes(const Pixels& pixels) {
+	constexpr auto ROW_SIZE = (lightset::dmx::UNIVERSE_SIZE / 3) * 3;
+	auto *pData = pixels.pData;
+
+	if constexpr (isGrouped) {
+		uint8_t row[ROW_SIZE];
+		uint32_t nLength = 0;
+		auto nOffset = pixels.nBeginIndex * pixels.nGroupingCount * 3;
+
+		for (auto j = pixels.nBeginIndex; j < pixels.nEndIndex; j++) {
+			const auto nColour1 = colour(pixels, pData[R]);
+			const auto nColour2 = colour(pixels, pData[G]);
+			const auto nColour3 = colour(pixels, pData[B]);
+
+			for (uint32_t k = 0; k < pixels.nGroupingCount; k++) {
+				row[nLength + 0] = nColour1;
+				row[nLength + 1] = nColour2;
+				row[nLength + 2] = nColour3;
+				nLength += 3;
+
+				if (nLength == ROW_SIZE) {
+					pixels.pWS28xxMulti->SetBytes(pixels.nOutIndex, nOffset, row, nLength);
+					nOffset += nLength;
+					nLength = 0;
+				}
+			}
+
+			pData += 3;
+		}
+
+		if (nLength != 0) {
+			pixels.pWS28xxMulti->SetBytes(pixels.nOutIndex, nOffset, row, nLength);
+		}
+	} else {
+		const auto nLength = (pixels.nEndIndex - pixels.nBeginIndex) * 3;
+		assert(nLength <= ROW_SIZE);
+#if !defined (CONFIG_PIXELDMX_ENABLE_GAMMATABLE)
+		if constexpr ((R == 0) && (G == 1) && (B == 2)) {
+			// The DMX data is already in the order as sent on the wire
+			pixels.pWS28xxMulti->SetBytes(pixels.nOutIndex, pixels.nBeginIndex * 3, pData, nLength);
+			return;
+		}
+#endif
+		uint8_t row[ROW_SIZE];
+
+		for (uint32_t i = 0; i < nLength; i += 3) {
+			row[i + 0] = colour(pixels, pData[R]);
+			row[i + 1] = colour(pixels, pData[G]);
+			row[i + 2] = colour(pixels, pData[B]);
+			pData += 3;
+		}
+
+		pixels.pWS28xxMulti->SetBytes(pixels.nOutIndex, pixels.nBeginIndex * 3, row, nLength);
+	}
+}
+#endif
+
+/**
+ * The slot offsets of the SetPixel(nRed, nGreen, nBlue) arguments, indexed by pixel::Map
+ */
+#define KERNELS(kernel, isGrouped) {	\
+	kernel<0, 1, 2, isGrouped>,	/* RGB */	\
+	kernel<0, 2, 1, isGrouped>,	/* RBG */	\
+	kernel<1, 0, 2, isGrouped>,	/* GRB */	\
+	kernel<2, 0, 1, isGrouped>,	/* GBR */	\
+	kernel<1, 2, 0, isGrouped>,	/* BRG */	\
+	kernel<2, 1, 0, isGrouped>	/* BGR */	\
+}
+
+static constexpr SetPixels s_SetPixels[2][6] = {
+	KERNELS(set_pixels, false),
+	KERNELS(set_pixels, true)
+};
+
+#if defined (H3)
+static constexpr SetPixels s_SetBytes[2][6] = {
+	KERNELS(set_bytes, false),
+	KERNELS(set_bytes, true)
+};
+#endif
+
+#undef KERNELS
+
+static SetPixels select(const PixelDmxConfiguration& pixelDmxConfiguration, const uint32_t nChannelsPerPixel) {
+	const auto isGrouped = pixelDmxConfiguration.GetGroupingCount() > 1;
+
+	if (nChannelsPerPixel == 4) {
+		return isGrouped ? set_pixels_rgbw<true> : set_pixels_rgbw<false>;
+	}
+
+	assert(nChannelsPerPixel == 3);
+
+	const auto nMap = static_cast<uint32_t>(pixelDmxConfiguration.GetMap());
+	assert(nMap < 6);
+
+#if defined (H3)
+	if ((pixelDmxConfiguration.IsRTZProtocol()) || (pixelDmxConfiguration.GetType() == pixel::Type::WS2801)) {
+		return s_SetBytes[isGrouped][nMap];
+	}
+#endif
+
+	return s_SetPixels[isGrouped][nMap];
+}
+}  // namespace ws28xxdmxmulti
+
+WS28xxDmxMulti *WS28xxDmxMulti::s_pThis;
+
+#if defined (CONFIG_PIXELDMX_ENABLE_CORE1)
+WS28xxDmxMulti *volatile WS28xxDmxMulti::s_pCore1;
+/*
+ * It is not possible to stop/start the additional core, it keeps running.
+ */
+static bool s_bIsCoreRunning;
+static volatile uint32_t s_nCore1Passes;	///< Incremented by core 1 after each pass of Core1Task
+#endif
+
 WS28xxDmxMulti::WS28xxDmxMulti(PixelDmxConfiguration& pixelDmxConfiguration): m_pixelDmxConfiguration(pixelDmxConfiguration){
 	DEBUG_ENTRY
 
+	assert(s_pThis == nullptr);
+	s_pThis = this;
+
 	m_pixelDmxConfiguration.Validate(ws28xxdmxmulti::MAX_PORTS , m_nChannelsPerPixel, m_PortInfo);
 
 	m_pWS28xxMulti = new WS28xxMulti(pixelDmxConfiguration);
 	assert(m_pWS28xxMulti != nullptr);
 	m_pWS28xxMulti->Blackout();
 
+	m_pSetPixels = ws28xxdmxmulti::select(m_pixelDmxConfiguration, m_nChannelsPerPixel);
+	m_nRefreshMicros = m_pixelDmxConfiguration.GetRefreshMicros();
+
+	SetChangedAll();
+
 #if defined (PIXELDMXSTARTSTOP_GPIO)
 	FUNC_PREFIX(gpio_fsel(PIXELDMXSTARTSTOP_GPIO, GPIO_FSEL_OUTPUT));
 	FUNC_PREFIX(gpio_clr(PIXELDMXSTARTSTOP_GPIO));
 #endif
 
+#if defined (CONFIG_PIXELDMX_ENABLE_CORE1)
+	m_pFrames = new ws28xxdmxmulti::core1::Frame[ws28xxdmxmulti::core1::FRAMES];
+	assert(m_pFrames != nullptr);
+
+	assert(s_pCore1 == nullptr);
+	s_pCore1 = this;
+	dmb();
+
+	if (!s_bIsCoreRunning) {
+		smp_start_core(1, Core1Task);
+		s_bIsCoreRunning = true;
+	}
+#endif
+
 	DEBUG_EXIT
 }
 
 WS28xxDmxMulti::~WS28xxDmxMulti() {
+#if defined (CONFIG_PIXELDMX_ENABLE_CORE1)
+	WaitCore1Idle();
+
+	/*
+	 * Core 1 can still be in Consume(), with the pointer read before the detach.
+	 * After two more passes of Core1Task, core 1 has seen the nullptr.
+	 */
+	s_pCore1 = nullptr;
+	dmb();
+
+	const auto nPasses = s_nCore1Passes;
+
+	while ((s_nCore1Passes - nPasses) < 2) {
+		dmb();
+	}
+
+	delete[] m_pFrames;
+	m_pFrames = nullptr;
+#endif
+
 	delete m_pWS28xxMulti;
 	m_pWS28xxMulti = nullptr;
+
+	s_pThis = nullptr;
 }
 
 void WS28xxDmxMulti::Start(const uint32_t nPortIndex) {
@@ -93,7 +319,7 @@ void WS28xxDmxMulti::Stop(const uint32_t nPortIndex) {
 	}
 }
 
-void WS28xxDmxMulti::SetData(const uint32_t nPortIndex, const uint8_t* pData, uint32_t nLength) {
+void WS28xxDmxMulti::SetData(const uint32_t nPortIndex, const uint8_t* pData, uint32_t nLength, const uint32_t nPixelOffset) {
 	assert(pData != nullptr);
 	assert(nLength <= lightset::dmx::UNIVERSE_SIZE);
 
@@ -107,104 +333,292 @@ void WS28xxDmxMulti::SetData(const uint32_t nPortIndex, const uint8_t* pData, ui
 #endif
 
 	const auto nGroups = m_pixelDmxConfiguration.GetGroups();
-	const auto beginIndex = m_PortInfo.nBeginIndexPort[nSwitch];
+	const auto beginIndex = m_PortInfo.nBeginIndexPort[nSwitch] + nPixelOffset;
 	const auto endIndex = std::min(nGroups, (beginIndex + (nLength / m_nChannelsPerPixel)));
 
-	uint32_t d = 0;
+	ws28xxdmxmulti::Pixels pixels;
 
-	const auto nGroupingCount = m_pixelDmxConfiguration.GetGroupingCount();
+	pixels.pWS28xxMulti = m_pWS28xxMulti;
+	pixels.pData = pData;
+	pixels.nOutIndex = nOutIndex;
+	pixels.nBeginIndex = beginIndex;
+	pixels.nEndIndex = endIndex;
+	pixels.nGroupingCount = m_pixelDmxConfiguration.GetGroupingCount();
+#if defined (CONFIG_PIXELDMX_ENABLE_GAMMATABLE)
+	pixels.pGammaTable = m_pixelDmxConfiguration.GetGammaTable();
+#endif
 
-	if (m_nChannelsPerPixel == 3) {
-		switch (m_pixelDmxConfiguration.GetMap()) {
-		case pixel::Map::RGB:
-			for (uint32_t j = beginIndex; (j < endIndex) && (d < nLength); j++) {
-				auto const nPixelIndexStart = (j * nGroupingCount);
-				for (uint32_t k = 0; k < nGroupingCount; k++) {
-					m_pWS28xxMulti->SetPixel(nOutIndex, nPixelIndexStart + k, pData[d + 0], pData[d + 1], pData[d + 2]);
-				}
-				d = d + 3;
-			}
-			break;
-		case pixel::Map::RBG:
-			for (uint32_t j = beginIndex; (j < endIndex) && (d < nLength); j++) {
-				auto const nPixelIndexStart = (j * nGroupingCount);
-				for (uint32_t k = 0; k < nGroupingCount; k++) {
-					m_pWS28xxMulti->SetPixel(nOutIndex, nPixelIndexStart + k, pData[d + 0], pData[d + 2], pData[d + 1]);
-				}
-				d = d + 3;
-			}
-			break;
-		case pixel::Map::GRB:
-			for (uint32_t j = beginIndex; (j < endIndex) && (d < nLength); j++) {
-				auto const nPixelIndexStart = (j * nGroupingCount);
-				for (uint32_t k = 0; k < nGroupingCount; k++) {
-					m_pWS28xxMulti->SetPixel(nOutIndex, nPixelIndexStart + k, pData[d + 1], pData[d + 0], pData[d + 2]);
-				}
-				d = d + 3;
-			}
-			break;
-		case pixel::Map::GBR:
-			for (uint32_t j = beginIndex; (j < endIndex) && (d < nLength); j++) {
-				auto const nPixelIndexStart = (j * nGroupingCount);
-				for (uint32_t k = 0; k < nGroupingCount; k++) {
-					m_pWS28xxMulti->SetPixel(nOutIndex, nPixelIndexStart + k, pData[d + 2], pData[d + 0], pData[d + 1]);
-				}
-				d = d + 3;
-			}
-			break;
-		case pixel::Map::BRG:
-			for (uint32_t j = beginIndex; (j < endIndex) && (d < nLength); j++) {
-				auto const nPixelIndexStart = (j * nGroupingCount);
-				for (uint32_t k = 0; k < nGroupingCount; k++) {
-					m_pWS28xxMulti->SetPixel(nOutIndex, nPixelIndexStart + k, pData[d + 1], pData[d + 2], pData[d + 0]);
-				}
-				d = d + 3;
-			}
-			break;
-		case pixel::Map::BGR:
-			for (uint32_t j = beginIndex; (j < endIndex) && (d < nLength); j++) {
-				auto const nPixelIndexStart = (j * nGroupingCount);
-				for (uint32_t k = 0; k < nGroupingCount; k++) {
-					m_pWS28xxMulti->SetPixel(nOutIndex, nPixelIndexStart + k, pData[d + 2], pData[d + 1], pData[d + 0]);
-				}
-				d = d + 3;
-			}
-			break;
-		default:
-			assert(0);
-			__builtin_unreachable();
-			break;
+	if (beginIndex < endIndex) {
+		m_pSetPixels(pixels);
+	}
+}
+
+#if defined (NODE_DDP_DISPLAY)
+void WS28xxDmxMulti::SetPixels(const uint32_t nPortIndex, const uint32_t nPixelIndex, const uint8_t *pData, const uint32_t nPixels) {
+	assert(pData != nullptr);
+#if defined (CONFIG_PIXELDMX_ENABLE_CORE1)
+	WaitCore1Idle();
+#endif
+
+	// The kernels encode at most a universe at the time
+	const auto nPixelsMax = lightset::dmx::UNIVERSE_SIZE / m_nChannelsPerPixel;
+	const auto nEndIndex = std::min(m_pixelDmxConfiguration.GetGroups(), nPixelIndex + nPixels);
+
+	ws28xxdmxmulti::Pixels pixels;
+
+	pixels.pWS28xxMulti = m_pWS28xxMulti;
+	pixels.pData = pData;
+	pixels.nOutIndex = nPortIndex;
+	pixels.nBeginIndex = nPixelIndex;
+	pixels.nGroupingCount = m_pixelDmxConfiguration.GetGroupingCount();
+#if defined (CONFIG_PIXELDMX_ENABLE_GAMMATABLE)
+	pixels.pGammaTable = m_pixelDmxConfiguration.GetGammaTable();
+#endif
+
+	while (pixels.nBeginIndex < nEndIndex) {
+		pixels.nEndIndex = std::min(nEndIndex, pixels.nBeginIndex + nPixelsMax);
+
+		m_pSetPixels(pixels);
+
+		pixels.pData += (pixels.nEndIndex - pixels.nBeginIndex) * m_nChannelsPerPixel;
+		pixels.nBeginIndex = pixels.nEndIndex;
+	}
+
+	m_nFramePorts |= (1U << nPortIndex);
+}
+#endif
+
+/*
+ * The frame in the pixel buffer is complete. When the previous frame is still waiting,
+ * it is replaced: the newest frame is presented, the older frame is counted as dropped.
+ */
+void WS28xxDmxMulti::Complete() {
+	if (m_nFramePorts == 0) {
+		return;
+	}
+
+	auto nDropped = m_nFramePorts & m_nPendingPorts;
+
+	while (nDropped != 0) {
+		m_Refresh[__builtin_ctz(nDropped)].nDropped++;
+		nDropped &= (nDropped - 1);
+	}
+
+	m_nPendingPorts |= m_nFramePorts;
+	m_nFramePorts = 0;
+	m_bUpdatePending = true;
+
+	Run();
+}
+
+/*
+ * Start the DMA when the previous frame, including the reset time, has been sent.
+ * Otherwise the frame keeps waiting for the next Run().
+ */
+void WS28xxDmxMulti::Present() {
+	if (m_pWS28xxMulti->IsUpdating()) {
+		return;
+	}
+
+#if defined (CONFIG_PIXELDMX_ENABLE_CORE1)
+	// Core 1 is still encoding
+	if (m_nConsumed != m_nProduced) {
+		return;
+	}
+
+	dmb();
+#endif
+
+#if defined (H3)
+	const auto nMicros = h3_hs_timer_lo_us();
+
+	if ((nMicros - m_nPresentMicros) < m_nRefreshMicros) {
+		return;
+	}
+
+	m_nPresentMicros = nMicros;
+#endif
+
+	logic_analyzer::ch3_set();
+
+	if (m_bBlackout) {
+		m_pWS28xxMulti->UpdateBlackout();
+		m_bBlackoutPending = false;
+		logic_analyzer::ch3_clear();
+		return;
+	}
+
+	m_pWS28xxMulti->Update();
+	m_bUpdatePending = false;
+
+	logic_analyzer::ch3_clear();
+
+	auto nPorts = m_nPendingPorts;
+
+	while (nPorts != 0) {
+		m_Refresh[__builtin_ctz(nPorts)].nFrames++;
+		nPorts &= (nPorts - 1);
+	}
+
+	m_nPendingPorts = 0;
+}
+
+#if defined (CONFIG_PIXELDMX_ENABLE_CORE1)
+/*
+ * Core 0: copy the changed slots into a free frame and hand it over to core 1.
+ * Only when core 1 is two frames behind, core 0 waits.
+ */
+void WS28xxDmxMulti::Publish() {
+	using namespace ws28xxdmxmulti::core1;
+
+	const auto nPorts = m_PortInfo.nProtocolPortIndexLast + 1U;
+	uint32_t nIndex = 0;
+
+	while ((nIndex < nPorts) && (m_Changed[nIndex].nEnd == 0)) {
+		nIndex++;
+	}
+
+	if (nIndex == nPorts) {
+		return;
+	}
+
+	if ((m_nProduced - m_nConsumed) == FRAMES) {
+		m_Core1Stats.nProducerWaits++;
+
+		do {
+			dmb();
+		} while ((m_nProduced - m_nConsumed) == FRAMES);
+	}
+
+	dmb();
+
+	auto &frame = m_pFrames[m_nProduced % FRAMES];
+
+	for (nIndex = 0; nIndex < nPorts; nIndex++) {
+		auto &slot = frame.slot[nIndex];
+		uint32_t nOffset, nLength, nPixelOffset;
+
+		if (TakeChanged(nIndex, nOffset, nLength, nPixelOffset)) {
+			memcpy(slot.data, lightset::Data::Backup(nIndex) + nOffset, nLength);
+			slot.nLength = static_cast<uint16_t>(nLength);
+			slot.nPixelOffset = static_cast<uint16_t>(nPixelOffset);
+			m_nFramePorts |= (1U << OutIndex(nIndex));
+		} else {
+			slot.nLength = 0;
 		}
-	} else {
-		assert(m_nChannelsPerPixel == 4);
-		for (uint32_t j = beginIndex; (j < endIndex) && (d < nLength); j++) {
-			auto const nPixelIndexStart = (j * nGroupingCount);
-			for (uint32_t k = 0; k < nGroupingCount; k++) {
-				m_pWS28xxMulti->SetPixel(nOutIndex, nPixelIndexStart + k, pData[d], pData[d + 1], pData[d + 2], pData[d + 3]);
-			}
-			d = d + 4;
+	}
+
+	frame.nPorts = nPorts;
+
+	dmb();
+	m_nProduced = m_nProduced + 1;
+}
+
+/*
+ * Core 0: the pixel buffer can be used when core 1 has nothing left to do.
+ */
+void WS28xxDmxMulti::WaitCore1Idle() {
+	while (m_nConsumed != m_nProduced) {
+		dmb();
+	}
+
+	dmb();
+}
+
+/*
+ * Core 1: encode a frame while the previous frame is sent.
+ * The DMA is started by core 0, see Present().
+ */
+void WS28xxDmxMulti::Consume() {
+	using namespace ws28xxdmxmulti::core1;
+
+	if (m_nConsumed == m_nProduced) {
+		return;
+	}
+
+	dmb();
+
+	const auto nMicros = h3_hs_timer_lo_us();
+	const auto &frame = m_pFrames[m_nConsumed % FRAMES];
+
+	for (uint32_t nIndex = 0; nIndex < frame.nPorts; nIndex++) {
+		const auto &slot = frame.slot[nIndex];
+
+		if (slot.nLength != 0) {
+			Encode(nIndex, slot.data, slot.nLength, slot.nPixelOffset);
+			m_Core1Stats.nUniverses++;
 		}
 	}
+
+	m_Core1Stats.nFrames++;
+	m_Core1Stats.nEncodeMicros += h3_hs_timer_lo_us() - nMicros;
+
+	dmb();
+	m_nConsumed = m_nConsumed + 1;
 }
 
+void WS28xxDmxMulti::Core1Task() {
+	for (;;) {
+		auto *pThis = s_pCore1;
+
+		if (pThis != nullptr) {
+			pThis->Consume();
+		}
+
+		dmb();
+		s_nCore1Passes = s_nCore1Passes + 1;
+	}
+}
+#endif
+
+/*
+ * The blackout frame is sent by the refresh scheduler. While in blackout,
+ * the incoming frames are coalesced and the newest is presented after the blackout.
+ */
 void WS28xxDmxMulti::Blackout(bool bBlackout) {
 	m_bBlackout = bBlackout;
+	m_bBlackoutPending = bBlackout;
 
-	while (m_pWS28xxMulti->IsUpdating()) {
-		// wait for completion
+	if (!bBlackout) {
+		m_bUpdatePending = true;
 	}
 
-	if (bBlackout) {
-		m_pWS28xxMulti->Blackout();
-	} else {
-		m_pWS28xxMulti->Update();
-	}
+	Run();
 }
 
+/*
+ * The full on frame is sent by the refresh scheduler, as Blackout.
+ * The pixel buffer is not sent by the DMA, hence it can be filled while the previous frame is sent.
+ */
 void WS28xxDmxMulti::FullOn() {
-	while (m_pWS28xxMulti->IsUpdating()) {
-		// wait for completion
-	}
+#if defined (CONFIG_PIXELDMX_ENABLE_CORE1)
+	WaitCore1Idle();
+#endif
+	m_pWS28xxMulti->SetFullOn();
 
-	m_pWS28xxMulti->FullOn();
+	// The pixel buffer has been overwritten
+	SetChangedAll();
+	m_nFramePorts = 0;
+	m_nPendingPorts = 0;
+	m_bUpdatePending = true;
+
+	Run();
+}
+
+void WS28xxDmxMulti::Print() {
+	m_pixelDmxConfiguration.Print();
+#if defined (CONFIG_PIXELDMX_ENABLE_CORE1)
+	printf(" Encode on core 1 : %u universes/s, %u%% busy\n", static_cast<unsigned int>(m_Core1Rate.nUniverses), static_cast<unsigned int>(m_Core1Rate.nLoad));
+	printf("  frames %u, universes %u, core 0 waits %u\n",
+			static_cast<unsigned int>(m_Core1Stats.nFrames), static_cast<unsigned int>(m_Core1Stats.nUniverses), static_cast<unsigned int>(m_Core1Stats.nProducerWaits));
+#endif
+	printf(" Frame time : %u us\n", static_cast<unsigned int>(m_nRefreshMicros));
+
+	for (uint32_t nOutIndex = 0; nOutIndex < m_pixelDmxConfiguration.GetOutputPorts(); nOutIndex++) {
+		const auto& refresh = m_Refresh[nOutIndex];
+		const auto encodeTime = GetOutEncodeTime(nOutIndex);
+		printf(" %c: frames %u, dropped %u, %u fps, encode %u us [max universe %u us]\n", static_cast<char>('A' + nOutIndex),
+				static_cast<unsigned int>(refresh.nFrames), static_cast<unsigned int>(refresh.nDropped), static_cast<unsigned int>(refresh.nFps),
+				static_cast<unsigned int>(encodeTime.nLast), static_cast<unsigned int>(encodeTime.nMax));
+	}
 }
@@ -152,6 +152,10 @@ int main(int argc, char **argv) {
 
 	const auto nActivePorts = node.GetActiveOutputPorts();
 
+	for (uint32_t nPortIndex = 0; nPortIndex < artnetnode::MAX_PORTS; nPortIndex++) {
+		monitor.SetSequenceStats(nPortIndex, node.GetSequenceStats(nPortIndex));
+	}
+
 	node.SetRdmUID(RdmResponder.GetUID());
 	node.SetRdmResponder(&RdmResponder);
 	node.SetRdm(static_cast<uint32_t>(0), true);
@@ -184,6 +188,7 @@ int main(int argc, char **argv) {
 	node.Start();
 
 	while (keepRunning) {
+		nw.Run();
 		node.Run();
 #if defined (NODE_SHOWFILE)
 		showFile.Run();
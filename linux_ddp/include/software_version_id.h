@@ -0,0 +1 @@
+constexpr uint32_t DEVICE_SOFTWARE_VERSION_ID=1792216908;
@@ -133,6 +133,7 @@ int main(int argc, char **argv) {
 	ddpDisplay.Start();
 
 	while (keepRunning) {
+		nw.Run();
 		ddpDisplay.Run();
 		mDns.Run();
 		remoteConfig.Run();
@@ -138,6 +138,10 @@ int main(int argc, char **argv) {
 
 	const auto nActivePorts = bridge.GetActiveOutputPorts();
 
+	for (uint32_t nPortIndex = 0; nPortIndex < e131bridge::MAX_PORTS; nPortIndex++) {
+		monitor.SetSequenceStats(nPortIndex, bridge.GetSequenceStats(nPortIndex));
+	}
+
 	char aDescription[rdm::personality::DESCRIPTION_MAX_LENGTH + 1];
 	snprintf(aDescription, sizeof(aDescription) - 1, "sACN E1.31 DMX %d", nActivePorts);
 
@@ -191,6 +195,7 @@ int main(int argc, char **argv) {
 	bridge.Start();
 
 	while (keepRunning) {
+		nw.Run();
 		bridge.Run();
 #if defined (NODE_SHOWFILE)
 		showFile.Run();
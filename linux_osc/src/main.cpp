@@ -136,6 +136,7 @@ int main(int argc, char **argv) {
 	server.Start();
 
 	while (keepRunning) {
+		nw.Run();
 		server.Run();
 		mDns.Run();
 		remoteConfig.Run();
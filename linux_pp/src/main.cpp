@@ -131,6 +131,7 @@ int main(int argc, char **argv) {
 	pp.Start();
 
 	while (keepRunning) {
+		nw.Run();
 		pp.Run();
 		mDns.Run();
 		remoteConfig.Run();
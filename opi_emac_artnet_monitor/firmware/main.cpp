@@ -131,6 +131,7 @@ int main() {
 	DMXMonitor monitor;
 	// There is support for HEX output only
 	node.SetOutput(&monitor);
+	monitor.SetSequenceStats(0, node.GetSequenceStats(0));
 	monitor.Cls();
 	console_set_top_row(20);
 	console_clear_top_row();
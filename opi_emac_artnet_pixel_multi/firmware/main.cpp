@@ -234,6 +234,7 @@ int main() {
 		hw.WatchdogFeed();
 		nw.Run();
 		node.Run();
+		pixelDmxMulti.Run();
 #if defined (NODE_SHOWFILE)
 		showFile.Run();
 #endif
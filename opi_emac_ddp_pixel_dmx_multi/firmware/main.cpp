@@ -133,6 +133,11 @@ int main() {
 	lightSet.Print();
 
 	ddpDisplay.SetOutput(&lightSet);
+
+	if (PixelTestPattern::Get()->GetPattern() == pixelpatterns::Pattern::NONE) {
+		ddpDisplay.SetPixelOutput(&pixelDmxMulti);
+	}
+
 	ddpDisplay.Print();
 
 #if defined (NODE_RDMNET_LLRP_ONLY)
@@ -206,6 +211,7 @@ int main() {
 		hw.WatchdogFeed();
 		nw.Run();
 		ddpDisplay.Run();
+		pixelDmxMulti.Run();
 		remoteConfig.Run();
 		configStore.Flash();
 		pixelTestPattern.Run();
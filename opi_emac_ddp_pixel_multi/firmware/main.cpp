@@ -110,6 +110,11 @@ int main() {
 	PixelTestPattern pixelTestPattern(nTestPattern, nActivePorts);
 
 	ddpDisplay.SetOutput(&pixelDmxMulti);
+
+	if (nTestPattern == pixelpatterns::Pattern::NONE) {
+		ddpDisplay.SetPixelOutput(&pixelDmxMulti);
+	}
+
 	ddpDisplay.Print();
 
 #if defined (NODE_RDMNET_LLRP_ONLY)
@@ -183,6 +188,7 @@ int main() {
 		hw.WatchdogFeed();
 		nw.Run();
 		ddpDisplay.Run();
+		pixelDmxMulti.Run();
 		remoteConfig.Run();
 		configStore.Flash();
 		pixelTestPattern.Run();
@@ -153,6 +153,7 @@ int main() {
 	DMXMonitor monitor;
 	// There is support for HEX output only
 	bridge.SetOutput(&monitor);
+	monitor.SetSequenceStats(0, bridge.GetSequenceStats(0));
 	monitor.Cls();
 	console_set_top_row(20);
 	console_clear_top_row();
@@ -228,6 +228,7 @@ int main() {
 		hw.WatchdogFeed();
 		nw.Run();
 		bridge.Run();
+		pixelDmxMulti.Run();
 #if defined (NODE_SHOWFILE)
 		showFile.Run();
 #endif
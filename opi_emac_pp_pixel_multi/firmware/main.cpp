@@ -182,6 +182,7 @@ int main() {
 		hw.WatchdogFeed();
 		nw.Run();
 		pp.Run();
+		pixelDmxMulti.Run();
 		remoteConfig.Run();
 		configStore.Flash();
 		pixelTestPattern.Run();